@@ -0,0 +1,110 @@
+// Sorted output of integer-keyed elements: map filled in random order and
+// then copied to an array and sorted with qsort, compared with B-tree filled
+// in the same order and walked over leaves. Then lookup in both containers,
+// range query and building a tree from already sorted elements.
+typedef struct pair_t {
+	uint64_t key;
+	uint64_t val;
+	cbuild_map_tombstone_t tombstone;
+} pair_t;
+typedef struct map_t {
+	pair_t* data;
+	size_t size;
+	size_t capacity;
+	cbuild_map_hash_t hash;
+	cbuild_map_keycmp_t keycmp;
+	size_t used;
+	size_t deleted;
+} map_t;
+volatile size_t sink = 0;
+int pair_cmp(const void* a, const void* b) {
+	uint64_t ka = ((const pair_t*)a)->key;
+	uint64_t kb = ((const pair_t*)b)->key;
+	return (ka > kb) - (ka < kb);
+}
+void report(const char* name, size_t n, uint64_t time) {
+	BENCH_REPORT(name, "%8.2f ns/op", (double)time / (double)n);
+	fflush(stdout);
+}
+void run(size_t n) {
+	size_t checkpoint = cbuild_temp_checkpoint();
+	// Distinct keys in random order
+	uint64_t* keys = malloc(n * sizeof(uint64_t));
+	for(size_t i = 0; i < n; i++) keys[i] = i * 2;
+	uint64_t state = 0x9e3779b97f4a7c15;
+	for(size_t i = n - 1; i > 0; i--) {
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		size_t j = state % (i + 1);
+		uint64_t tmp = keys[i];
+		keys[i] = keys[j];
+		keys[j] = tmp;
+	}
+	size_t acc = 0;
+	map_t map = {0};
+	cbuild_map_init_num(&map);
+	uint64_t start = cbuild_time_nanos();
+	for(size_t i = 0; i < n; i++) cbuild_map_put(&map, keys[i])->val = i;
+	pair_t* sorted = malloc(n * sizeof(pair_t));
+	size_t count = 0;
+	cbuild_span_foreach(&map, pair) {
+		if(pair->tombstone == CBUILD_MAP_FULL) sorted[count++] = *pair;
+	}
+	qsort(sorted, count, sizeof(pair_t), pair_cmp);
+	for(size_t i = 0; i < count; i++) acc += sorted[i].key ^ sorted[i].val;
+	report(cbuild_temp_sprintf("map + qsort, %zu keys, fill and sort", n), n,
+		cbuild_time_nanos() - start);
+	cbuild_btree_t tree = {0};
+	cbuild_btree_init_uint(&tree);
+	cbuild_btree_init(&tree, uint64_t, uint64_t, cbuild_allocator_from_libc());
+	start = cbuild_time_nanos();
+	for(size_t i = 0; i < n; i++) *(uint64_t*)cbuild_btree_get(&tree, &keys[i], NULL) = i;
+	cbuild_btree_foreach(&tree, it) acc += *(uint64_t*)it.key ^ *(uint64_t*)it.val;
+	report(cbuild_temp_sprintf("btree, %zu keys, fill and sort", n), n,
+		cbuild_time_nanos() - start);
+	start = cbuild_time_nanos();
+	for(size_t i = 0; i < n; i++) acc += cbuild_map_find(&map, keys[i])->val;
+	report(cbuild_temp_sprintf("map, %zu keys, find", n), n, cbuild_time_nanos() - start);
+	start = cbuild_time_nanos();
+	for(size_t i = 0; i < n; i++) acc += *(uint64_t*)cbuild_btree_find(&tree, &keys[i]);
+	report(cbuild_temp_sprintf("btree, %zu keys, find", n), n, cbuild_time_nanos() - start);
+	// 1000 ranges of 100 elements
+	start = cbuild_time_nanos();
+	for(size_t i = 0; i < 1000; i++) {
+		uint64_t from = keys[i] % (2 * n);
+		uint64_t to = from + 200;
+		cbuild_btree_foreach_range(&tree, &from, &to, it) acc += *(uint64_t*)it.val;
+	}
+	report(cbuild_temp_sprintf("btree, %zu keys, range of 100", n), 1000,
+		cbuild_time_nanos() - start);
+	cbuild_btree_free(&tree);
+	for(size_t i = 0; i < n; i++) {
+		keys[i] = sorted[i].key;
+		sorted[i].val = sorted[i].key;
+	}
+	uint64_t* vals = malloc(n * sizeof(uint64_t));
+	for(size_t i = 0; i < n; i++) vals[i] = sorted[i].val;
+	start = cbuild_time_nanos();
+	for(size_t i = 0; i < n; i++) cbuild_btree_insert(&tree, &keys[i], &vals[i]);
+	report(cbuild_temp_sprintf("btree, %zu keys, sorted insert", n), n,
+		cbuild_time_nanos() - start);
+	cbuild_btree_free(&tree);
+	start = cbuild_time_nanos();
+	cbuild_btree_bulk_load(&tree, keys, vals, n);
+	report(cbuild_temp_sprintf("btree, %zu keys, bulk load", n), n,
+		cbuild_time_nanos() - start);
+	sink += acc + tree.size;
+	cbuild_btree_free(&tree);
+	cbuild_da_clear(&map);
+	free(keys);
+	free(vals);
+	free(sorted);
+	cbuild_temp_reset(checkpoint);
+}
+int main(void) {
+	run(10000);
+	run(100000);
+	run(1000000);
+	return 0;
+}
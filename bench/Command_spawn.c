@@ -0,0 +1,34 @@
+// Measures how many commands per second can be started from a parent with
+// a large resident set, using 'fork' and 'posix_spawnp' paths.
+#define SPAWNS 1000
+#define RSS_MB 256
+typedef cbuild_proc_t (*spawn_fn_t)(cbuild_cmd_t*, struct cbuild_cmd_opts_t*,
+	cbuild_fd_t, cbuild_fd_t, cbuild_fd_t);
+void run(const char* name, spawn_fn_t spawn) {
+	cbuild_cmd_t cmd = {0};
+	cbuild_da_append(&cmd, "true");
+	struct cbuild_cmd_opts_t opts = {0};
+	uint64_t start = cbuild_time_nanos();
+	for(size_t i = 0; i < SPAWNS; i++) {
+		cbuild_proc_t proc = spawn(&cmd, &opts, CBUILD_INVALID_FD,
+			CBUILD_INVALID_FD, CBUILD_INVALID_FD);
+		cbuild_proc_wait_code(proc);
+	}
+	uint64_t total = cbuild_time_nanos() - start;
+	BENCH_REPORT(name, "%8.2f ms total, %8.0f spawns/s",
+		BENCH_NS_TO_MS(total), (double)SPAWNS / ((double)total / 1e9));
+	fflush(stdout);
+	cbuild_da_clear(&cmd);
+}
+int main(void) {
+	// Touch every page, so it really is resident
+	size_t size = (size_t)RSS_MB * 1024 * 1024;
+	char* ballast = malloc(size);
+	memset(ballast, 1, size);
+	printf("  %d spawns, %d MiB resident\n", SPAWNS, RSS_MB);
+	fflush(stdout);
+	run("fork + execvp", __cbuild_cmd_run_fork);
+	run("posix_spawnp", __cbuild_cmd_run_spawn);
+	free(ballast);
+	return 0;
+}
@@ -0,0 +1,75 @@
+// Compares io_uring batches with one system call per operation on a flat
+// directory of small files: create, stat sweep and unlink. System calls are
+// counted by a batch itself. Then directory is copied and removed, both use
+// batches internally.
+#define FILES 4096
+void report(const char* name, uint64_t time, size_t syscalls) {
+	BENCH_REPORT(name, "%8.2f ms, %6zu syscalls", BENCH_NS_TO_MS(time), syscalls);
+	fflush(stdout);
+}
+void run(char** names, bool sync) {
+	cbuild_fs_batch_t batch = { .sync = sync };
+	const char* mode = sync ? "sync" : "batched";
+	uint64_t start = cbuild_time_nanos();
+	for(size_t i = 0; i < FILES; i++) {
+		cbuild_fs_batch_open(&batch, CBUILD_FS_CWD, names[i],
+			O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	}
+	cbuild_fs_batch_submit(&batch);
+	for(size_t i = 0; i < FILES; i++) {
+		cbuild_fs_batch_close(&batch, (cbuild_fd_t)batch.data[i].result);
+	}
+	cbuild_fs_batch_submit(&batch);
+	report(cbuild_temp_sprintf("create, %s", mode), cbuild_time_nanos() - start,
+		batch.syscalls);
+	cbuild_fs_batch_reset(&batch);
+	batch.syscalls = 0;
+	struct stat* stats = malloc(FILES * sizeof(struct stat));
+	start = cbuild_time_nanos();
+	for(size_t i = 0; i < FILES; i++) {
+		cbuild_fs_batch_stat(&batch, CBUILD_FS_CWD, names[i], &stats[i], false);
+	}
+	cbuild_fs_batch_submit(&batch);
+	report(cbuild_temp_sprintf("stat, %s", mode), cbuild_time_nanos() - start,
+		batch.syscalls);
+	free(stats);
+	cbuild_fs_batch_reset(&batch);
+	batch.syscalls = 0;
+	start = cbuild_time_nanos();
+	for(size_t i = 0; i < FILES; i++) {
+		cbuild_fs_batch_unlink(&batch, CBUILD_FS_CWD, names[i], false);
+	}
+	cbuild_fs_batch_submit(&batch);
+	report(cbuild_temp_sprintf("unlink, %s", mode), cbuild_time_nanos() - start,
+		batch.syscalls);
+	cbuild_fs_batch_free(&batch);
+}
+int main(void) {
+	const char* dir = BUILD_FOLDER"/bench_batch";
+	if(cbuild_dir_check(dir)) cbuild_dir_remove(dir);
+	cbuild_dir_create(dir);
+	char** names = malloc(FILES * sizeof(char*));
+	for(size_t i = 0; i < FILES; i++) {
+		names[i] = cbuild_temp_sprintf("%s/file%zu", dir, i);
+	}
+	run(names, true);
+	run(names, false);
+	for(size_t i = 0; i < FILES; i++) {
+		cbuild_fd_t fd = cbuild_fd_open_write(names[i]);
+		cbuild_fd_write(fd, "ABCD", 4);
+		cbuild_fd_close(fd);
+	}
+	const char* copy = BUILD_FOLDER"/bench_batch_copy";
+	if(cbuild_dir_check(copy)) cbuild_dir_remove(copy);
+	uint64_t start = cbuild_time_nanos();
+	cbuild_dir_copy(dir, copy);
+	BENCH_REPORT("cbuild_dir_copy", "%8.2f ms",
+		BENCH_NS_TO_MS(cbuild_time_nanos() - start));
+	start = cbuild_time_nanos();
+	cbuild_dir_remove(copy);
+	BENCH_REPORT("cbuild_dir_remove", "%8.2f ms",
+		BENCH_NS_TO_MS(cbuild_time_nanos() - start));
+	cbuild_dir_remove(dir);
+	free(names);
+	return 0;
+}
@@ -0,0 +1,53 @@
+// Compares serial and parallel directory walkers on a synthetic deep and
+// wide tree, collecting paths of all regular files.
+#define WIDTH 8
+#define DEPTH 4
+#define FILES 8
+void make_tree(const char* dir, size_t depth) {
+	cbuild_dir_create(dir);
+	for(size_t i = 0; i < FILES; i++) {
+		cbuild_fd_t fd = cbuild_fd_open_write(cbuild_temp_sprintf("%s/file%zu.c", dir, i));
+		cbuild_fd_close(fd);
+	}
+	if(depth == 0) return;
+	for(size_t i = 0; i < WIDTH; i++) {
+		make_tree(cbuild_temp_sprintf("%s/dir%zu", dir, i), depth - 1);
+	}
+}
+bool collect(cbuild_dir_walk_func_args_t args) {
+	if(args.type == CBUILD_FTYPE_REGULAR) cbuild_dir_walk_collect(args);
+	return true;
+}
+void report(const char* name, uint64_t time, size_t files) {
+	BENCH_REPORT(name, "%8.2f ms, %10.0f files/s", BENCH_NS_TO_MS(time),
+		(double)files / ((double)time / 1e9));
+	fflush(stdout);
+}
+int main(void) {
+	const char* dir = BUILD_FOLDER"/bench_walk_tree";
+	if(cbuild_dir_check(dir)) cbuild_dir_remove(dir);
+	make_tree(dir, DEPTH);
+	cbuild_temp_reset(0);
+	cbuild_pathlist_t files = {0};
+	uint64_t start = cbuild_time_nanos();
+	cbuild_dir_walk(dir, collect, .output = &files);
+	report("cbuild_dir_walk", cbuild_time_nanos() - start, files.size);
+	printf("  %zu files\n", files.size);
+	cbuild_pathlist_clear(&files);
+	int jobs[] = {1, 2, 4, cbuild_nproc()};
+	for(size_t i = 0; i < cbuild_arr_len(jobs); i++) {
+		start = cbuild_time_nanos();
+		cbuild_dir_walk_parallel(dir, collect, .jobs = jobs[i], .output = &files);
+		report(cbuild_temp_sprintf("cbuild_dir_walk_parallel, %d jobs", jobs[i]),
+			cbuild_time_nanos() - start, files.size);
+		cbuild_pathlist_clear(&files);
+		start = cbuild_time_nanos();
+		cbuild_dir_walk_parallel(dir, collect, .jobs = jobs[i], .output = &files,
+			.sorted = true);
+		report("  sorted", cbuild_time_nanos() - start, files.size);
+		cbuild_pathlist_clear(&files);
+		cbuild_temp_reset(0);
+	}
+	cbuild_dir_remove(dir);
+	return 0;
+}
@@ -0,0 +1,51 @@
+// Measures file copy throughput of in-kernel copy engines against old
+// read/write loop with a full-size buffer, on many small and few large files.
+#define SMALL_FILES 2000
+#define SMALL_SIZE (4 * 1024)
+#define LARGE_FILES 4
+#define LARGE_SIZE (64 * 1024 * 1024)
+typedef bool (*copy_fn_t)(const char* src, const char* dst);
+bool copy_loop(const char* src, const char* dst) {
+	cbuild_fd_t src_fd = cbuild_fd_open_read(src);
+	cbuild_fd_t dst_fd = cbuild_fd_open_write(dst);
+	int ret = __cbuild_fs_copy_loop(src_fd, dst_fd, src, dst, CBUILD_FS_TMP_SIZE);
+	cbuild_fd_close(src_fd);
+	cbuild_fd_close(dst_fd);
+	return ret > 0;
+}
+void make_file(const char* path, size_t size) {
+	cbuild_sb_t sb = {0};
+	cbuild_da_resize(&sb, size);
+	for(size_t i = 0; i < size; i++) sb.data[i] = (char)(i * 31 + size);
+	sb.size = size;
+	cbuild_file_write(path, &sb);
+	cbuild_da_clear(&sb);
+}
+void run(const char* name, copy_fn_t copy, size_t files, size_t size) {
+	const char* src = BUILD_FOLDER"/bench_copy_src";
+	make_file(src, size);
+	uint64_t start = cbuild_time_nanos();
+	for(size_t i = 0; i < files; i++) {
+		copy(src, cbuild_temp_sprintf(BUILD_FOLDER"/bench_copy_dst_%zu", i % 8));
+		cbuild_temp_reset(0);
+	}
+	uint64_t total = cbuild_time_nanos() - start;
+	double mib = (double)files * (double)size / (1024.0 * 1024.0);
+	BENCH_REPORT(name, "%8.2f ms total, %8.0f files/s, %8.1f MiB/s",
+		BENCH_NS_TO_MS(total), (double)files / ((double)total / 1e9),
+		mib / ((double)total / 1e9));
+	fflush(stdout);
+	for(size_t i = 0; i < 8 && i < files; i++) {
+		cbuild_file_remove(cbuild_temp_sprintf(BUILD_FOLDER"/bench_copy_dst_%zu", i));
+	}
+	cbuild_file_remove(src);
+}
+int main(void) {
+	printf("  %d small files of %d KiB\n", SMALL_FILES, SMALL_SIZE / 1024);
+	run("read/write loop", copy_loop, SMALL_FILES, SMALL_SIZE);
+	run("cbuild_file_copy", cbuild_file_copy, SMALL_FILES, SMALL_SIZE);
+	printf("  %d large files of %d MiB\n", LARGE_FILES, LARGE_SIZE / 1024 / 1024);
+	run("read/write loop", copy_loop, LARGE_FILES, LARGE_SIZE);
+	run("cbuild_file_copy", cbuild_file_copy, LARGE_FILES, LARGE_SIZE);
+	return 0;
+}
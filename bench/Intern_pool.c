@@ -0,0 +1,103 @@
+// Deduplication of path-like strings: copying each distinct string with
+// malloc and indexing it with map keyed by c-strings, compared with interning
+// pool. Every string is added twice, second time as a separate copy. Then
+// threaded pool is filled by several threads at once, each thread interns
+// all strings.
+typedef struct pair_t {
+	const char* key;
+	size_t val;
+	cbuild_map_tombstone_t tombstone;
+} pair_t;
+typedef struct map_t {
+	pair_t* data;
+	size_t size;
+	size_t capacity;
+	cbuild_map_hash_t hash;
+	cbuild_map_keycmp_t keycmp;
+	size_t used;
+	size_t deleted;
+} map_t;
+volatile size_t sink = 0;
+typedef struct worker_t {
+	pthread_t thread;
+	cbuild_intern_t* pool;
+	char** strings;
+	size_t n;
+	size_t offset;
+	size_t acc;
+} worker_t;
+void* worker(void* arg) {
+	worker_t* w = arg;
+	for(size_t i = 0; i < w->n; i++) {
+		w->acc += cbuild_intern_cstr(w->pool, w->strings[(i + w->offset) % w->n]);
+	}
+	return NULL;
+}
+void run(size_t n) {
+	size_t checkpoint = cbuild_temp_checkpoint();
+	char** strings = malloc(2 * n * sizeof(char*));
+	for(size_t i = 0; i < 2 * n; i++) {
+		size_t k = i % n;
+		strings[i] = malloc(64);
+		snprintf(strings[i], 64, "src/module%zu/sub%zu/file%zu.c", k % 97, k % 13, k);
+	}
+	size_t acc = 0;
+	map_t map = {0};
+	cbuild_map_init_cstr(&map);
+	uint64_t start = cbuild_time_nanos();
+	for(size_t i = 0; i < 2 * n; i++) {
+		pair_t* pair = cbuild_map_find(&map, strings[i]);
+		if(pair == NULL) {
+			size_t len = strlen(strings[i]);
+			char* copy = malloc(len + 1);
+			memcpy(copy, strings[i], len + 1);
+			pair = cbuild_map_put_new(&map, copy);
+			pair->val = map.used - 1;
+		}
+		acc += pair->val;
+	}
+	uint64_t time = cbuild_time_nanos() - start;
+	BENCH_REPORT(cbuild_temp_sprintf("malloc + map, %zu strings", n), "%8.2f ns/op",
+		(double)time / (double)(2 * n));
+	fflush(stdout);
+	cbuild_intern_t pool = {0};
+	start = cbuild_time_nanos();
+	for(size_t i = 0; i < 2 * n; i++) acc += cbuild_intern_cstr(&pool, strings[i]);
+	time = cbuild_time_nanos() - start;
+	BENCH_REPORT(cbuild_temp_sprintf("intern, %zu strings", n), "%8.2f ns/op",
+		(double)time / (double)(2 * n));
+	fflush(stdout);
+	cbuild_intern_free(&pool);
+	for(size_t threads = 1; threads <= 8; threads *= 2) {
+		cbuild_intern_init_threaded(&pool);
+		worker_t workers[8];
+		start = cbuild_time_nanos();
+		for(size_t t = 0; t < threads; t++) {
+			workers[t] = (worker_t){ .pool = &pool, .strings = strings, .n = n,
+				.offset = t * n / threads };
+			pthread_create(&workers[t].thread, NULL, worker, &workers[t]);
+		}
+		for(size_t t = 0; t < threads; t++) {
+			pthread_join(workers[t].thread, NULL);
+			acc += workers[t].acc;
+		}
+		time = cbuild_time_nanos() - start;
+		BENCH_REPORT(cbuild_temp_sprintf("threaded, %zu strings, %zu threads", n,
+			threads), "%8.2f Mop/s", (double)(threads * n) * 1e3 / (double)time);
+		fflush(stdout);
+		cbuild_intern_free(&pool);
+	}
+	sink += acc;
+	cbuild_span_foreach(&map, pair) {
+		if(pair->tombstone == CBUILD_MAP_FULL) free((char*)pair->key);
+	}
+	cbuild_da_clear(&map);
+	for(size_t i = 0; i < 2 * n; i++) free(strings[i]);
+	free(strings);
+	cbuild_temp_reset(checkpoint);
+}
+int main(void) {
+	run(100000);
+	run(1000000);
+	return 0;
+}
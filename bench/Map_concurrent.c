@@ -0,0 +1,96 @@
+// Scaling of a concurrent map from 1 to 8 threads, compared with swiss map
+// behind one mutex. Map is prefilled with 1M keys, each thread does 90%
+// lookups, 5% insertions and 5% removals of random keys from same range.
+typedef struct pair_t {
+	size_t key;
+	size_t val;
+} pair_t;
+typedef struct smap_t {
+	pair_t* data;
+	size_t size;
+	size_t capacity;
+	cbuild_map_hash_t hash;
+	cbuild_map_keycmp_t keycmp;
+	uint8_t* ctrl;
+	size_t deleted;
+} smap_t;
+#define KEYS ((size_t)1000000)
+#define OPS ((size_t)2000000)
+cbuild_cmap_t cmap = {0};
+smap_t smap = {0};
+pthread_mutex_t smap_lock = PTHREAD_MUTEX_INITIALIZER;
+typedef struct worker_t {
+	pthread_t thread;
+	uint64_t seed;
+	size_t acc;
+} worker_t;
+uint64_t next(uint64_t* state) {
+	*state = *state * 6364136223846793005ull + 1442695040888963407ull;
+	return *state >> 33;
+}
+void* cmap_worker(void* arg) {
+	worker_t* w = arg;
+	for(size_t i = 0; i < OPS; i++) {
+		uint64_t r = next(&w->seed);
+		pair_t pair = { .key = (size_t)(r % KEYS), .val = (size_t)r };
+		uint64_t op = (r >> 20) % 20;
+		if(op == 0) w->acc += cbuild_cmap_get(&cmap, &pair);
+		else if(op == 1) w->acc += cbuild_cmap_remove(&cmap, &pair);
+		else w->acc += cbuild_cmap_find(&cmap, &pair);
+	}
+	return NULL;
+}
+void* smap_worker(void* arg) {
+	worker_t* w = arg;
+	for(size_t i = 0; i < OPS; i++) {
+		uint64_t r = next(&w->seed);
+		size_t key = (size_t)(r % KEYS);
+		uint64_t op = (r >> 20) % 20;
+		pthread_mutex_lock(&smap_lock);
+		if(op == 0) {
+			bool found = false;
+			cbuild_smap_get_ex(&smap, key, &found)->val = (size_t)r;
+			w->acc += found;
+		} else {
+			pair_t* pair = cbuild_smap_find(&smap, key);
+			if(pair != NULL && op == 1) cbuild_smap_remove(&smap, pair);
+			w->acc += pair != NULL;
+		}
+		pthread_mutex_unlock(&smap_lock);
+	}
+	return NULL;
+}
+volatile size_t sink = 0;
+void run(const char* name, void* (*func)(void*), size_t threads) {
+	worker_t workers[8];
+	uint64_t start = cbuild_time_nanos();
+	for(size_t t = 0; t < threads; t++) {
+		workers[t] = (worker_t){ .seed = t + 1 };
+		pthread_create(&workers[t].thread, NULL, func, &workers[t]);
+	}
+	for(size_t t = 0; t < threads; t++) {
+		pthread_join(workers[t].thread, NULL);
+		sink += workers[t].acc;
+	}
+	uint64_t time = cbuild_time_nanos() - start;
+	BENCH_REPORT(cbuild_temp_sprintf("%s, %zu threads", name, threads), "%8.2f Mop/s",
+		(double)(threads * OPS) * 1e3 / (double)time);
+	fflush(stdout);
+}
+int main(void) {
+	cbuild_map_init_num(&cmap);
+	cbuild_cmap_init(&cmap, pair_t);
+	cbuild_map_init_num(&smap);
+	for(size_t i = 0; i < KEYS; i += 2) {
+		pair_t pair = { .key = i, .val = i };
+		cbuild_cmap_get(&cmap, &pair);
+		cbuild_smap_get(&smap, i)->val = i;
+	}
+	for(size_t threads = 1; threads <= 8; threads *= 2) {
+		run("smap + mutex", smap_worker, threads);
+		run("cmap", cmap_worker, threads);
+	}
+	cbuild_cmap_free(&cmap);
+	cbuild_smap_clear(&smap);
+	return 0;
+}
@@ -0,0 +1,43 @@
+// Hashing throughput of all map hash functions on inputs from short keys to
+// file-sized buffers. Each size hashes about 256 MiB in total, input offset
+// changes every call, so results are not cached.
+typedef size_t (*hash_func_t)(const void* data, size_t len);
+typedef struct hash_t {
+	const char* name;
+	hash_func_t func;
+} hash_t;
+const hash_t hashes[] = {
+	{ "djb2", cbuild_map_hash_djb2 },
+	{ "fnv1", cbuild_map_hash_fnv1 },
+	{ "fnv1a", cbuild_map_hash_fnv1a },
+	{ "sdbm", cbuild_map_hash_sdbm },
+	{ "wyhash", cbuild_map_hash_wyhash },
+	{ "xxh3", cbuild_map_hash_xxh3 },
+};
+const size_t sizes[] = { 8, 16, 32, 64, 256, 1024, 64 * 1024 };
+#define TOTAL ((size_t)256 * 1024 * 1024)
+volatile size_t sink = 0;
+int main(void) {
+	size_t buf_size = 64 * 1024 + 64;
+	uint8_t* buf = malloc(buf_size);
+	for(size_t i = 0; i < buf_size; i++) buf[i] = (uint8_t)(i * 2654435761u >> 13);
+	for(size_t s = 0; s < cbuild_arr_len(sizes); s++) {
+		size_t size = sizes[s];
+		size_t calls = TOTAL / size;
+		for(size_t h = 0; h < cbuild_arr_len(hashes); h++) {
+			size_t acc = 0;
+			uint64_t start = cbuild_time_nanos();
+			for(size_t i = 0; i < calls; i++) {
+				acc += hashes[h].func(buf + (i & 63), size);
+			}
+			uint64_t time = cbuild_time_nanos() - start;
+			sink += acc;
+			BENCH_REPORT(cbuild_temp_sprintf("%s, %zu bytes", hashes[h].name, size),
+				"%8.2f GB/s, %7.2f ns/hash", (double)TOTAL / (double)time,
+				(double)time / (double)calls);
+			fflush(stdout);
+		}
+	}
+	free(buf);
+	return 0;
+}
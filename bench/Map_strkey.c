@@ -0,0 +1,121 @@
+// Compares map keyed by c-strings with map keyed by strings with cached hash
+// on path-like keys: insertion with automatic growth, successful and failed
+// lookup (query strings are separate copies, as in real use) and rehash into
+// map of double size. Keys are allocated one by one, so they are scattered
+// across heap.
+typedef struct cpair_t {
+	const char* key;
+	size_t val;
+	cbuild_map_tombstone_t tombstone;
+} cpair_t;
+typedef struct cmap_t {
+	cpair_t* data;
+	size_t size;
+	size_t capacity;
+	cbuild_map_hash_t hash;
+	cbuild_map_keycmp_t keycmp;
+	size_t used;
+	size_t deleted;
+} cmap_t;
+typedef struct spair_t {
+	cbuild_map_strkey_t key;
+	size_t val;
+	cbuild_map_tombstone_t tombstone;
+} spair_t;
+typedef struct smap_t {
+	spair_t* data;
+	size_t size;
+	size_t capacity;
+	cbuild_map_hash_t hash;
+	cbuild_map_keycmp_t keycmp;
+	size_t used;
+	size_t deleted;
+} smap_t;
+volatile size_t sink = 0;
+char* path(size_t i, bool present) {
+	const char* str = cbuild_temp_sprintf("src/module%zu/sub%zu/file%zu%s.c", i % 97,
+		i % 13, i, present ? "" : "_missing");
+	size_t len = strlen(str);
+	char* res = malloc(len + 1);
+	memcpy(res, str, len + 1);
+	return res;
+}
+// Zeroed allocation may be lazily mapped, fault pages in before timing
+void touch(void* data, size_t size) {
+	for(size_t i = 0; i < size; i += 4096) ((volatile char*)data)[i] = 0;
+}
+void report(const char* name, size_t n, uint64_t time) {
+	BENCH_REPORT(name, "%8.2f ns/op", (double)time / (double)n);
+	fflush(stdout);
+}
+void run(size_t n) {
+	size_t checkpoint = cbuild_temp_checkpoint();
+	char** keys = malloc(n * sizeof(char*));
+	char** hits = malloc(n * sizeof(char*));
+	char** misses = malloc(n * sizeof(char*));
+	for(size_t i = 0; i < n; i++) {
+		keys[i] = path(i, true);
+		hits[i] = path(i, true);
+		misses[i] = path(i, false);
+		cbuild_temp_reset(checkpoint);
+	}
+	cmap_t cmap = {0};
+	cbuild_map_init_cstr(&cmap);
+	uint64_t start = cbuild_time_nanos();
+	for(size_t i = 0; i < n; i++) cbuild_map_put(&cmap, keys[i])->val = i;
+	report(cbuild_temp_sprintf("cstr, %zu keys, insert", n), n, cbuild_time_nanos() - start);
+	smap_t smap = {0};
+	cbuild_map_init_strkey(&smap);
+	start = cbuild_time_nanos();
+	for(size_t i = 0; i < n; i++) cbuild_map_put(&smap, cbuild_map_strkey(keys[i]))->val = i;
+	report(cbuild_temp_sprintf("strkey, %zu keys, insert", n), n, cbuild_time_nanos() - start);
+	size_t acc = 0;
+	start = cbuild_time_nanos();
+	for(size_t i = 0; i < n; i++) acc += cbuild_map_find(&cmap, hits[i])->val;
+	report(cbuild_temp_sprintf("cstr, %zu keys, hit", n), n, cbuild_time_nanos() - start);
+	start = cbuild_time_nanos();
+	for(size_t i = 0; i < n; i++) {
+		acc += cbuild_map_find(&smap, cbuild_map_strkey(hits[i]))->val;
+	}
+	report(cbuild_temp_sprintf("strkey, %zu keys, hit", n), n, cbuild_time_nanos() - start);
+	start = cbuild_time_nanos();
+	for(size_t i = 0; i < n; i++) acc += cbuild_map_find(&cmap, misses[i]) == NULL;
+	report(cbuild_temp_sprintf("cstr, %zu keys, miss", n), n, cbuild_time_nanos() - start);
+	start = cbuild_time_nanos();
+	for(size_t i = 0; i < n; i++) {
+		acc += cbuild_map_find(&smap, cbuild_map_strkey(misses[i])) == NULL;
+	}
+	report(cbuild_temp_sprintf("strkey, %zu keys, miss", n), n, cbuild_time_nanos() - start);
+	cmap_t cmap2 = cmap;
+	cmap2.data = NULL;
+	cbuild_map_resize(&cmap2, cmap.capacity * 2);
+	touch(cmap2.data, cmap2.capacity * sizeof(*cmap2.data));
+	start = cbuild_time_nanos();
+	cbuild_map_rehash(&cmap, &cmap2);
+	report(cbuild_temp_sprintf("cstr, %zu keys, rehash", n), n, cbuild_time_nanos() - start);
+	smap_t smap2 = smap;
+	smap2.data = NULL;
+	cbuild_map_resize(&smap2, smap.capacity * 2);
+	touch(smap2.data, smap2.capacity * sizeof(*smap2.data));
+	start = cbuild_time_nanos();
+	cbuild_map_rehash(&smap, &smap2);
+	report(cbuild_temp_sprintf("strkey, %zu keys, rehash", n), n, cbuild_time_nanos() - start);
+	sink += acc;
+	cbuild_da_clear(&cmap2);
+	cbuild_da_clear(&smap2);
+	for(size_t i = 0; i < n; i++) {
+		free(keys[i]);
+		free(hits[i]);
+		free(misses[i]);
+	}
+	free(keys);
+	free(hits);
+	free(misses);
+	cbuild_temp_reset(checkpoint);
+}
+int main(void) {
+	run(10000);
+	run(100000);
+	run(1000000);
+	return 0;
+}
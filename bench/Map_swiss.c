@@ -0,0 +1,71 @@
+// Compares swiss map with normal map on integer keys: insertion, successful
+// lookup and failed lookup. Normal map is sized for load factor below 0.5,
+// swiss map is reserved for all keys, so growth is not measured.
+typedef struct pair_t {
+	uint32_t key;
+	uint32_t val;
+	cbuild_map_tombstone_t tombstone;
+} pair_t;
+typedef struct map_t {
+	pair_t* data;
+	size_t size;
+	size_t capacity;
+	cbuild_map_hash_t hash;
+	cbuild_map_keycmp_t keycmp;
+} map_t;
+typedef struct spair_t {
+	uint32_t key;
+	uint32_t val;
+} spair_t;
+typedef struct smap_t {
+	spair_t* data;
+	size_t size;
+	size_t capacity;
+	cbuild_map_hash_t hash;
+	cbuild_map_keycmp_t keycmp;
+	uint8_t* ctrl;
+	size_t deleted;
+} smap_t;
+// Distinct keys, odd keys are present and even are missing
+uint32_t key(size_t i, bool present) {
+	return (uint32_t)((i * 2 + (present ? 1 : 0)) * 2654435761u);
+}
+volatile uint32_t sink = 0;
+void report(const char* name, size_t n, uint64_t time) {
+	BENCH_REPORT(name, "%8.2f ns/op", (double)time / (double)n);
+	fflush(stdout);
+}
+void run(size_t n) {
+	map_t map = {0};
+	cbuild_map_init_num(&map);
+	cbuild_map_resize(&map, n * 2);
+	uint64_t start = cbuild_time_nanos();
+	for(size_t i = 0; i < n; i++) cbuild_map_get(&map, key(i, true))->val = (uint32_t)i;
+	report(cbuild_temp_sprintf("%zu, map insert", n), n, cbuild_time_nanos() - start);
+	start = cbuild_time_nanos();
+	uint32_t sum = 0;
+	for(size_t i = 0; i < n; i++) sum += cbuild_map_find(&map, key(i, true))->val;
+	report(cbuild_temp_sprintf("%zu, map hit", n), n, cbuild_time_nanos() - start);
+	start = cbuild_time_nanos();
+	for(size_t i = 0; i < n; i++) sum += cbuild_map_find(&map, key(i, false)) == NULL;
+	report(cbuild_temp_sprintf("%zu, map miss", n), n, cbuild_time_nanos() - start);
+	cbuild_da_clear(&map);
+	smap_t smap = {0};
+	cbuild_map_init_num(&smap);
+	cbuild_smap_reserve(&smap, n);
+	start = cbuild_time_nanos();
+	for(size_t i = 0; i < n; i++) cbuild_smap_get(&smap, key(i, true))->val = (uint32_t)i;
+	report(cbuild_temp_sprintf("%zu, swiss insert", n), n, cbuild_time_nanos() - start);
+	start = cbuild_time_nanos();
+	for(size_t i = 0; i < n; i++) sum += cbuild_smap_find(&smap, key(i, true))->val;
+	report(cbuild_temp_sprintf("%zu, swiss hit", n), n, cbuild_time_nanos() - start);
+	start = cbuild_time_nanos();
+	for(size_t i = 0; i < n; i++) sum += cbuild_smap_find(&smap, key(i, false)) == NULL;
+	report(cbuild_temp_sprintf("%zu, swiss miss", n), n, cbuild_time_nanos() - start);
+	cbuild_smap_clear(&smap);
+	sink += sum;
+}
+int main(void) {
+	for(size_t n = 1000; n <= 10000000; n *= 10) run(n);
+	return 0;
+}
@@ -0,0 +1,75 @@
+// Measures how fast freed slot is noticed by 'cbuild_procs_wait_any'.
+// Each job records its exit timestamp into shared memory, so latency is
+// measured from moment job is done to moment parent can refill the slot.
+#define JOBS 4000
+int job(void* context) {
+	uint64_t* stamp = context;
+	*stamp = cbuild_time_nanos();
+	return 0;
+}
+// Previous implementation, kept as a baseline
+size_t legacy_wait_any(cbuild_proclist_t procs, int* code) {
+	while(true) {
+		for(size_t i = 0; i < procs.size; i++) {
+			int status = 0;
+			int ret = waitpid(procs.data[i], &status, WNOHANG);
+			if(ret < 0) {
+				*code = INT_MAX;
+				return i;
+			} else if(ret > 0) {
+				*code = WEXITSTATUS(status);
+				return i;
+			}
+		}
+		const struct timespec duration = {
+			.tv_sec = 0,
+			.tv_nsec = 1000*100,
+		};
+		nanosleep(&duration, NULL);
+	}
+}
+void run(const char* name, size_t (*wait_any)(cbuild_proclist_t, int*),
+	uint64_t* stamps, size_t slots) {
+	cbuild_proclist_t procs = {0};
+	size_t* slot_job = calloc(slots, sizeof(size_t));
+	uint64_t lat_sum = 0;
+	uint64_t lat_max = 0;
+	size_t started = 0;
+	uint64_t start = cbuild_time_nanos();
+	for(; started < slots && started < JOBS; started++) {
+		slot_job[started] = started;
+		cbuild_da_append(&procs, cbuild_proc_start(job, &stamps[started]));
+	}
+	for(size_t done = 0; done < JOBS; done++) {
+		int code = 0;
+		size_t idx = wait_any(procs, &code);
+		uint64_t lat = cbuild_time_nanos() - stamps[slot_job[idx]];
+		lat_sum += lat;
+		lat_max = CBUILD_MAX(lat_max, lat);
+		if(started < JOBS) {
+			slot_job[idx] = started;
+			procs.data[idx] = cbuild_proc_start(job, &stamps[started]);
+			started++;
+		} else {
+			procs.data[idx] = procs.data[--procs.size];
+			slot_job[idx] = slot_job[procs.size];
+		}
+	}
+	uint64_t total = cbuild_time_nanos() - start;
+	BENCH_REPORT(name, "%8.2f ms total, %8.0f jobs/s, refill latency avg %7.1f us, max %8.1f us",
+		BENCH_NS_TO_MS(total), (double)JOBS / ((double)total / 1e9),
+		(double)lat_sum / JOBS / 1e3, (double)lat_max / 1e3);
+	fflush(stdout);
+	free(slot_job);
+	cbuild_da_clear(&procs);
+}
+int main(void) {
+	size_t slots = (size_t)cbuild_nproc() + 1;
+	printf("  %d jobs, %zu slots\n", JOBS, slots);
+	fflush(stdout); // Children inherit stdio buffers
+	cbuild_proc_ptr_t stamps = cbuild_proc_malloc(JOBS * sizeof(uint64_t));
+	run("waitpid(WNOHANG) + nanosleep polling", legacy_wait_any, stamps.ptr, slots);
+	run("cbuild_procs_wait_any", cbuild_procs_wait_any, stamps.ptr, slots);
+	cbuild_proc_free(stamps);
+	return 0;
+}
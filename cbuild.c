@@ -207,6 +207,54 @@ test_case_t TESTS[] = {
 		.file = "mtime_multi",
 		.platforms = TPLM_ALL,
 	},
+	{
+		.file = "mtime_same_second",
+		.platforms = TPLM_ALL,
+	},
+	{
+		.file = "mtime_bulk",
+		.platforms = TPLM_ALL,
+	},
+	{
+		.file = "depfile_parse",
+		.platforms = TPLM_ALL,
+	},
+	{
+		.file = "depfile_stale",
+		.platforms = TPLM_ALL,
+	},
+	{
+		.file = "hash_stale",
+		.platforms = TPLM_ALL,
+	},
+	{
+		.file = "BuildLog",
+		.group = true,
+	},
+	{
+		.file = "check",
+		.platforms = TPLM_ALL,
+	},
+	{
+		.file = "compact",
+		.platforms = TPLM_ALL,
+	},
+	{
+		.file = "Cache",
+		.group = true,
+	},
+	{
+		.file = "run",
+		.platforms = TPLM_ALL,
+	},
+	{
+		.file = "Watch",
+		.group = true,
+	},
+	{
+		.file = "basic",
+		.platforms = TPLM_ALL,
+	},
 	{
 		.file = "DynArray",
 		.group = true,
@@ -365,6 +413,10 @@ test_case_t TESTS[] = {
 		.file = "ctrl",
 		.platforms = TPLM_ALL,
 	},
+	{
+		.file = "wait_any",
+		.platforms = TPLM_ALL,
+	},
 	{
 		.file = "Command",
 		.group = true,
@@ -385,6 +437,22 @@ test_case_t TESTS[] = {
 		.file = "redirect",
 		.platforms = TPLM_ALL,
 	},
+	{
+		.file = "run_missing",
+		.platforms = TPLM_ALL,
+	},
+	{
+		.file = "Graph",
+		.group = true,
+	},
+	{
+		.file = "order",
+		.platforms = TPLM_ALL,
+	},
+	{
+		.file = "fail",
+		.platforms = TPLM_ALL,
+	},
 	{
 		.file = "Map",
 		.group = true,
@@ -405,6 +473,72 @@ test_case_t TESTS[] = {
 		.file = "append",
 		.platforms = TPLM_ALL,
 	},
+	{
+		.file = "cstr",
+		.platforms = TPLM_ALL,
+	},
+	{
+		.file = "grow",
+		.platforms = TPLM_ALL,
+	},
+	{
+		.file = "compact",
+		.platforms = TPLM_ALL,
+	},
+	{
+		.file = "hash",
+		.platforms = TPLM_ALL,
+	},
+	{
+		.file = "strkey",
+		.platforms = TPLM_ALL,
+	},
+	{
+		.file = "hash_scalar",
+		.platforms = TPLM_ALL,
+		.cargs = {.data = (const char*[]){
+			"-DCBUILD_MAP_SIMD=0",
+		}, .size = 1},
+	},
+	{
+		.file = "swiss",
+		.platforms = TPLM_ALL,
+	},
+	{
+		.file = "swiss_scalar",
+		.platforms = TPLM_ALL,
+		.cargs = {.data = (const char*[]){
+			"-DCBUILD_MAP_SIMD=0",
+		}, .size = 1},
+	},
+	{
+		.file = "concurrent",
+		.platforms = TPLM_ALL,
+	},
+	{
+		.file = "Intern",
+		.group = true,
+	},
+	{
+		.file = "pool",
+		.platforms = TPLM_ALL,
+	},
+	{
+		.file = "threaded",
+		.platforms = TPLM_ALL,
+	},
+	{
+		.file = "BTree",
+		.group = true,
+	},
+	{
+		.file = "insert",
+		.platforms = TPLM_ALL,
+	},
+	{
+		.file = "strings",
+		.platforms = TPLM_ALL,
+	},
 	{
 		.file = "LL",
 		.group = true,
@@ -425,10 +559,22 @@ test_case_t TESTS[] = {
 		.file = "file_read",
 		.platforms = TPLM_ALL,
 	},
+	{
+		.file = "file_map",
+		.platforms = TPLM_ALL,
+	},
 	{
 		.file = "file_write",
 		.platforms = TPLM_ALL,
 	},
+	{
+		.file = "file_writer",
+		.platforms = TPLM_ALL,
+	},
+	{
+		.file = "batch",
+		.platforms = TPLM_ALL,
+	},
 	{
 		.file = "file_copy",
 		.platforms = TPLM_ALL,
@@ -443,6 +589,13 @@ test_case_t TESTS[] = {
 			"-DCBUILD_TMP_BUFF_SIZE=64",
 		}, .size = 1},
 	},
+	{
+		.file = "file_copy_engines",
+		.platforms = TPLM_ALL,
+		.cargs = {.data = (const char*[]){
+			"-DCBUILD_FS_TMP_SIZE=64",
+		}, .size = 1},
+	},
 	{
 		.file = "file_check",
 		.platforms = TPLM_ALL,
@@ -475,6 +628,14 @@ test_case_t TESTS[] = {
 		.file = "dir_walk_symlink",
 		.platforms = TPLM_ALL, // They are all POSIX it is work on all of them
 	},
+	{
+		.file = "dir_walk_stat",
+		.platforms = TPLM_ALL,
+	},
+	{
+		.file = "dir_walk_parallel",
+		.platforms = TPLM_ALL,
+	},
 	{
 		.file = "dir_create",
 		.platforms = TPLM_ALL,
@@ -491,6 +652,10 @@ test_case_t TESTS[] = {
 		.file = "dir_remove",
 		.platforms = TPLM_ALL,
 	},
+	{
+		.file = "dir_tree",
+		.platforms = TPLM_ALL,
+	},
 	{
 		.file = "path_check_type",
 		.platforms = TPLM_ALL,
@@ -511,6 +676,10 @@ test_case_t TESTS[] = {
 		.file = "path_normalize",
 		.platforms = TPLM_ALL,
 	},
+	{
+		.file = "stat_cache",
+		.platforms = TPLM_ALL,
+	},
 	{
 		.file = "FlagParse",
 		.group = true,
@@ -610,7 +779,7 @@ void test_cmd_append_clang_san(cbuild_cmd_t* cmd) {
 	cbuild_da_append(cmd, "-fsanitize=address");
 }
 void test_cmd_append_cc_base(test_case_t test, cbuild_cmd_t* cmd) {
-	cbuild_da_append_many(cmd, CBUILD_CARGS_WARN, CBUILD_CARGS_WERROR);
+	cbuild_da_append_many(cmd, CBUILD_CARGS_WARN, CBUILD_CARGS_WERROR, CBUILD_CARGS_MT);
 	cbuild_da_append_many(cmd, CBUILD_CARGS_INCLUDE("framework.h"));
 	cbuild_da_append_many(cmd, "-fmacro-prefix-map=tests/=");
 	cbuild_da_append_many(cmd,
@@ -1286,6 +1455,130 @@ bool test(void) {
 	free(statuses);
 	return failed;
 }
+// Benchmarks
+typedef struct bench_case_t {
+	union {
+		struct {
+			uint32_t group : 1;
+			uint32_t       : 31;
+		};
+		uint32_t flags;
+	};
+	const char* file;
+	cbuild_cmd_t cargs; // 'capacity' can be unset. Runner guarantee to not update this DA
+} bench_case_t;
+bench_case_t BENCHES[] = {
+	{
+		.file = "Command",
+		.group = true,
+	},
+	{
+		.file = "spawn",
+	},
+	{
+		.file = "FS",
+		.group = true,
+	},
+	{
+		.file = "file_copy",
+	},
+	{
+		.file = "dir_walk",
+	},
+	{
+		.file = "batch",
+	},
+	{
+		.file = "Map",
+		.group = true,
+	},
+	{
+		.file = "swiss",
+	},
+	{
+		.file = "hash",
+	},
+	{
+		.file = "strkey",
+	},
+	{
+		.file = "concurrent",
+	},
+	{
+		.file = "Intern",
+		.group = true,
+	},
+	{
+		.file = "pool",
+	},
+	{
+		.file = "BTree",
+		.group = true,
+	},
+	{
+		.file = "ordered",
+	},
+	{
+		.file = "Proc",
+		.group = true,
+	},
+	{
+		.file = "wait_any",
+	},
+};
+bool bench_case(const char* group, bench_case_t bench) {
+	cbuild_log_info("Running benchmark \"%s:%s\"", group, bench.file);
+	cbuild_cmd_t cmd = {0};
+	const char* fname = cbuild_temp_sprintf(BENCH_FOLDER"/%s_%s.c", group, bench.file);
+	const char* oname = cbuild_temp_sprintf(BUILD_FOLDER"/bench_%s_%s."EXE_NAME,
+		group, bench.file);
+	cbuild_da_append(&cmd, CC);
+	cbuild_da_append_many(&cmd, CBUILD_CARGS_WARN, CBUILD_CARGS_WERROR);
+	cbuild_da_append_many(&cmd, CBUILD_CARGS_INCLUDE("framework.h"));
+	cbuild_da_append_many(&cmd, "-fmacro-prefix-map=bench/=");
+	cbuild_da_append(&cmd, "-DTEST_RUN_PLATFORM=\"bench\"");
+	cbuild_da_append_many(&cmd, "-O2", CBUILD_CARGS_MT);
+	cbuild_da_append_arr(&cmd, bench.cargs.data, bench.cargs.size);
+	cbuild_da_append_many(&cmd, "-o", oname, fname);
+	if(!cbuild_cmd_run(&cmd)) {
+		cbuild_log_error("Benchmark \"%s:%s\" failed to build.", group, bench.file);
+		cbuild_da_clear(&cmd);
+		return false;
+	}
+	cbuild_da_append(&cmd, oname);
+	bool ret = cbuild_cmd_run(&cmd);
+	cbuild_da_clear(&cmd);
+	if(!ret) cbuild_log_error("Benchmark \"%s:%s\" failed.", group, bench.file);
+	return ret;
+}
+// Run all benchmarks from group (or all groups if NULL) matching a glob
+bool bench(const char* group, const char* name) {
+	bool failed = false;
+	bool found = false;
+	cbuild_glob_t glob_state = {0};
+	if(!cbuild_glob_compile(&glob_state, name ? name : "*")) return false;
+	const char* curr_group = NULL;
+	for(size_t i = 0; i < cbuild_arr_len(BENCHES); i++) {
+		if(BENCHES[i].group) {
+			curr_group = BENCHES[i].file;
+			continue;
+		}
+		if(group != NULL && strcmp(group, curr_group) != 0) continue;
+		if(!cbuild_glob_match_single(&glob_state, BENCHES[i].file)) continue;
+		found = true;
+		printf("%s:%s\n", curr_group, BENCHES[i].file);
+		size_t checkpoint = cbuild_temp_checkpoint();
+		if(!bench_case(curr_group, BENCHES[i])) failed = true;
+		cbuild_temp_reset(checkpoint);
+	}
+	cbuild_glob_free(&glob_state);
+	if(!found) {
+		cbuild_log_error("Invalid benchmark specified: \"%s:%s\"!",
+			group ? group : "*", name ? name : "*");
+		return false;
+	}
+	return !failed;
+}
 // Amalgamation
 #define SOURCE_DIR "src"
 #define CHANGELOG_DIR "changelog"
@@ -1311,9 +1604,9 @@ bool amalgamate(void) {
 	cbuild_sb_append_cstr(&output, "// along with this program.  If not, see <https://www.gnu.org/licenses/>.\n");
 	cbuild_sb_append_cstr(&output, "//\n");
 	cbuild_sb_append_cstr(&output, "/* CHANGELOG\n");
-	cbuild_sb_t changelog_old = {0};
-	if (!cbuild_file_read(CHANGELOG_DIR"/changelog.txt", &changelog_old)) return false;
-	cbuild_sv_t changelog_old_content = cbuild_sb_to_sv(changelog_old);
+	cbuild_file_map_t changelog_old = {0};
+	if (!cbuild_file_map(CHANGELOG_DIR"/changelog.txt", &changelog_old)) return false;
+	cbuild_sv_t changelog_old_content = changelog_old.content;
 	// NOTE: This removes "markdown" header used by wikimk
 	for (size_t i = 0; i < 4; i++) cbuild_sv_chop_by_delim(&changelog_old_content, '\n');
 	while (changelog_old_content.size > 0) {
@@ -1323,15 +1616,15 @@ bool amalgamate(void) {
 		cbuild_sb_append_sv(&output, line);
 		cbuild_sb_append_cstr(&output, "\n");
 	}
-	cbuild_da_clear(&changelog_old);
+	cbuild_file_unmap(&changelog_old);
 	// NOTE: For now I use zerover, so it is really easy to iterate over versions
 	int version = CHANGELOG_FIRST_NEW_ZEROVER;
 	const char* ch_path = cbuild_temp_sprintf(CHANGELOG_DIR"/v0.%d.md", version++);
-	cbuild_sb_t changelog = {0};
 	while (cbuild_file_check(ch_path)) {
 		cbuild_sb_append_cstr(&output, " * --------------------------------------------\n");
-		if (!cbuild_file_read(ch_path, &changelog)) return false;
-		cbuild_sv_t ch = cbuild_sb_to_sv(changelog);
+		cbuild_file_map_t changelog = {0};
+		if (!cbuild_file_map(ch_path, &changelog)) return false;
+		cbuild_sv_t ch = changelog.content;
 		cbuild_sv_chop_by_delim(&ch, '\n'); // ---
 		cbuild_sv_chop_by_delim(&ch, '\n'); // title: ...
 		cbuild_sv_chop_by_delim(&ch, ' ');  // date: 
@@ -1354,10 +1647,9 @@ bool amalgamate(void) {
 				line = cbuild_sv_chop_by_delim(&ch, '\n');
 			}
 		}
-		changelog.size = 0;
+		cbuild_file_unmap(&changelog);
 		ch_path = cbuild_temp_sprintf(CHANGELOG_DIR"/v0.%d.md", version++);
 	}
-	cbuild_da_clear(&changelog);
 	cbuild_sb_append_cstr(&output, " */\n");
 	// Headers
 	cbuild_sb_append_cstr(&output, "#ifndef __CBUILD_H__\n");
@@ -1375,11 +1667,17 @@ bool amalgamate(void) {
 		SOURCE_DIR"/StringView.h",
 		SOURCE_DIR"/StringBuilder.h",
 		SOURCE_DIR"/Map.h",
+		SOURCE_DIR"/Intern.h",
+		SOURCE_DIR"/BTree.h",
 		SOURCE_DIR"/LL.h",
 		SOURCE_DIR"/Proc.h",
 		SOURCE_DIR"/Command.h",
+		SOURCE_DIR"/Graph.h",
 		SOURCE_DIR"/FS.h",
 		SOURCE_DIR"/Compile.h",
+		SOURCE_DIR"/BuildLog.h",
+		SOURCE_DIR"/Cache.h",
+		SOURCE_DIR"/Watch.h",
 		SOURCE_DIR"/FlagParse.h",
 		SOURCE_DIR"/RGlob.h",
 	};
@@ -1415,11 +1713,17 @@ bool amalgamate(void) {
 		SOURCE_DIR"/StringView.c",
 		SOURCE_DIR"/StringBuilder.c",
 		SOURCE_DIR"/Map.c",
+		SOURCE_DIR"/Intern.c",
+		SOURCE_DIR"/BTree.c",
 		SOURCE_DIR"/LL.c",
 		SOURCE_DIR"/Proc.c",
 		SOURCE_DIR"/Command.c",
+		SOURCE_DIR"/Graph.c",
 		SOURCE_DIR"/FS.c",
 		SOURCE_DIR"/Compile.c",
+		SOURCE_DIR"/BuildLog.c",
+		SOURCE_DIR"/Cache.c",
+		SOURCE_DIR"/Watch.c",
 		SOURCE_DIR"/FlagParse.c",
 		SOURCE_DIR"/RGlob.c",
 	};
@@ -1454,6 +1758,81 @@ bool amalgamate(void) {
 	cbuild_da_clear(&output);
 	return true;
 }
+// Watch mode
+// Run tests from a group (any group if NULL) whose source is path (any if NULL)
+bool watch_test(const char* group, const char* path) {
+	bool failed = false;
+	const char* curr_group = NULL;
+	for(size_t i = 0; i < cbuild_arr_len(TESTS); i++) {
+		test_case_t test = TESTS[i];
+		if(test.group) {
+			curr_group = test.file;
+			continue;
+		}
+		if(group != NULL && strcmp(group, curr_group) != 0) continue;
+		if(path != NULL && strcmp(path, cbuild_temp_sprintf(TEST_FOLDER"/%s_%s.c",
+					curr_group, test.file)) != 0) {
+			continue;
+		}
+		cbuild_cmd_t cmd = {0};
+		cbuild_da_append_many(&cmd, "sh", "-c",
+			cbuild_temp_sprintf("rm -rf "BUILD_FOLDER"/test_*_%s_%s_*", curr_group,
+				test.file));
+		if(!cbuild_cmd_run(&cmd)) return false;
+		TPL_RUN_REGISTERED_GROUP = curr_group;
+		if(test_case(test)) failed = true;
+		TPL_RUN_REGISTERED_GROUP = NULL;
+	}
+	return !failed;
+}
+// Changed source rebuilds cbuild.h and reruns tests of its module, changed
+// test is rerun alone
+bool watch_rebuild(cbuild_pathlist_t* changed, void* context) {
+	CBUILD_UNUSED(context);
+	size_t checkpoint = cbuild_temp_checkpoint();
+	bool build = false;
+	cbuild_pathlist_t groups = {0};
+	cbuild_pathlist_t tests = {0};
+	cbuild_span_foreach(changed, path) {
+		cbuild_log_trace("Changed \"%s\"", *path);
+		if(strncmp(*path, SOURCE_DIR"/", strlen(SOURCE_DIR"/")) == 0) {
+			build = true;
+			char* group = cbuild_path_name(*path);
+			char* ext = strrchr(group, '.');
+			if(ext != NULL) *ext = '\0';
+			bool found = false;
+			cbuild_span_foreach(&groups, elem) {
+				if(strcmp(*elem, group) == 0) found = true;
+			}
+			if(!found) cbuild_da_append(&groups, group);
+		} else if(strncmp(*path, CHANGELOG_DIR"/", strlen(CHANGELOG_DIR"/")) == 0 ||
+			strcmp(*path, "LICENSE") == 0) {
+			build = true;
+		} else if(strncmp(*path, TEST_FOLDER"/", strlen(TEST_FOLDER"/")) == 0) {
+			cbuild_da_append(&tests, *path);
+		}
+	}
+	if(build) {
+		if(amalgamate()) cbuild_log_info("Successfully created cbuild.h");
+		else cbuild_log_error("Creation of cbuild.h failed.");
+	}
+	bool ok = true;
+	cbuild_span_foreach(&groups, group) {
+		if(!watch_test(*group, NULL)) ok = false;
+	}
+	cbuild_span_foreach(&tests, path) {
+		if(!watch_test(NULL, *path)) ok = false;
+	}
+	if(groups.size > 0 || tests.size > 0) {
+		if(ok) cbuild_log_info("All affected tests passed.");
+		else cbuild_log_error("Some of affected tests failed.");
+	}
+	cbuild_da_clear(&groups);
+	cbuild_da_clear(&tests);
+	cbuild_temp_reset(checkpoint);
+	cbuild_log_info("Waiting for changes...");
+	return true;
+}
 // Hooks
 void help(const char* app_name) {
 	printf("Usage: %s [OPTIONS] <subcommand> [argument]\n", app_name);
@@ -1471,6 +1850,8 @@ void help(const char* app_name) {
 	// printf("\t\tdoxygen    Build doxygen\n");
 	// printf("\t\tserve      Host local copy of wiki on localhost:\n");
 	printf("\ttest     Run test. Format of argument is <group>:<test>[/platform]. If no platform is specified that test is run for all registered platforms.\n");
+	printf("\tbench    Run benchmarks. Format of argument is <group>[:<bench>]. If no argument is specified all benchmarks are run.\n");
+	printf("\twatch    Watch sources, rebuild cbuild.h and rerun affected tests on each change\n");
 	printf("\tclean    Clean all generated files\n");
 	printf("\ttags     Generate CTags\n");
 	printf("Tests:\n");
@@ -1481,6 +1862,14 @@ void help(const char* app_name) {
 			printf("\t\t- %s\n", TESTS[i].file);
 		}
 	}
+	printf("Benchmarks:\n");
+	for(size_t i = 0; i < cbuild_arr_len(BENCHES); i++) {
+		if(BENCHES[i].group) {
+			printf("\tGroup %s\n", BENCHES[i].file);
+		} else {
+			printf("\t\t- %s\n", BENCHES[i].file);
+		}
+	}
 	printf("Test platforms:\n");
 	for(size_t i = 0; i < TPL_COUNT; i++) {
 		printf("\t%s\n", TPL_NAMES[i]);
@@ -1652,6 +2041,29 @@ int main(int argc, char** argv) {
 				TPL_RUN_REGISTERED_GROUP = NULL;
 			}
 		}
+	} else if(strcmp(subcommand, "bench") == 0) {
+		if(pargs.size == 0) {
+			if(!bench(NULL, NULL)) return 1;
+		} else {
+			cbuild_span_foreach(&pargs, bench_spec) {
+				char* bench_name = strchr(*bench_spec, ':');
+				if(bench_name != NULL) {
+					*bench_name = '\0';
+					bench_name++;
+				}
+				if(!bench(*bench_spec, bench_name)) return 1;
+			}
+		}
+	} else if(strcmp(subcommand, "watch") == 0) {
+		cbuild_watch_t watch = {0};
+		if(!cbuild_watch_add(&watch, SOURCE_DIR)) return 1;
+		if(!cbuild_watch_add(&watch, CHANGELOG_DIR)) return 1;
+		if(!cbuild_watch_add(&watch, TEST_FOLDER)) return 1;
+		if(!cbuild_watch_add(&watch, "LICENSE")) return 1;
+		cbuild_log_info("Waiting for changes...");
+		bool ok = cbuild_watch_run(&watch, watch_rebuild, NULL);
+		cbuild_watch_free(&watch);
+		if(!ok) return 1;
 	} else if(strcmp(subcommand, "clean") == 0) {
 		cbuild_dir_remove(BUILD_FOLDER);
 		cbuild_dir_remove("wiki/doxygen/html");
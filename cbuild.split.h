@@ -12,11 +12,17 @@
 #include "src/StringBuilder.h"
 #include "src/StringView.h"
 #include "src/Map.h"
+#include "src/Intern.h"
+#include "src/BTree.h"
 #include "src/LL.h"
 #include "src/Proc.h"
 #include "src/Command.h"
+#include "src/Graph.h"
 #include "src/FS.h"
 #include "src/Compile.h"
+#include "src/BuildLog.h"
+#include "src/Cache.h"
+#include "src/Watch.h"
 #include "src/FlagParse.h"
 #include "src/RGlob.h"
 #endif // __CBUILD_H__
@@ -29,11 +35,17 @@
 #include "src/StringBuilder.c"
 #include "src/StringView.c"
 #include "src/Map.c"
+#include "src/Intern.c"
+#include "src/BTree.c"
 #include "src/LL.c"
 #include "src/Proc.c"
 #include "src/Command.c"
+#include "src/Graph.c"
 #include "src/FS.c"
 #include "src/Compile.c"
+#include "src/BuildLog.c"
+#include "src/Cache.c"
+#include "src/Watch.c"
 #include "src/FlagParse.c"
 #include "src/RGlob.c"
 #endif // CBUILD_IMPLEMENTATION
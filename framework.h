@@ -29,6 +29,7 @@
 #define BUILD_VERSION "v2.0"
 #define BUILD_FOLDER "build"
 #define TEST_FOLDER "tests"
+#define BENCH_FOLDER "bench"
 // Asserts
 #define TEST_ASSERT_EQ(val, expected, msg, ...)                                \
 	cbuild_assert((val) == (expected), msg "\n" __VA_OPT__(,) __VA_ARGS__);
@@ -51,4 +52,18 @@
 		(int)strlen(__FILE_NAME__) - 2, __FILE_NAME__, __LINE__                    \
 		__VA_OPT__(,) __VA_ARGS__)
 #define TEST_TEMP_FILE TEST_TEMP_FILE_EX("tmp.txt")
+// Files
+static inline void test_write_file(const char* path, const char* data, size_t size) {
+	cbuild_sb_t sb = {0};
+	cbuild_da_append_arr(&sb, data, size);
+	TEST_ASSERT(cbuild_file_write(path, &sb), "Could not write \"%s\"", path);
+	cbuild_da_clear(&sb);
+}
+static inline void test_write_str(const char* path, const char* str) {
+	test_write_file(path, str, strlen(str));
+}
+// Benchmarks
+#define BENCH_REPORT(name, fmt, ...)                                           \
+	printf("  %-40s " fmt "\n", name __VA_OPT__(,) __VA_ARGS__)
+#define BENCH_NS_TO_MS(ns) ((double)(ns) / 1e6)
 #endif // __FRAMEWORK_H__
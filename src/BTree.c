@@ -0,0 +1,315 @@
+//! Ordered map based on B+ tree.
+//!
+//! License: `GPL-3.0-or-later`.
+
+#include "BTree.h"
+#include "Common.h"
+#include "Allocator.h"
+#include "StringView.h"
+// Keys start right after a header, aligned as malloc would align them
+#define __CBUILD_BTREE_KEYS ((sizeof(__cbuild_btree_node_t) + 15) & ~(size_t)15)
+#define __cbuild_btree_key(tree, node, idx)                                    \
+	((char*)(node) + __CBUILD_BTREE_KEYS + (idx) * (tree)->key_size)
+#define __cbuild_btree_val(tree, node, idx)                                    \
+	((char*)(node) + (tree)->vals_offset + (idx) * (tree)->val_size)
+#define __cbuild_btree_children(tree, node)                                    \
+	((__cbuild_btree_node_t**)(void*)((char*)(node) + (tree)->vals_offset))
+CBUILDDEF void __cbuild_btree_init(cbuild_btree_t* tree, size_t key_size,
+	size_t val_size, cbuild_allocator_t allocator) {
+	tree->allocator = allocator;
+	tree->key_size = key_size;
+	tree->val_size = val_size;
+	tree->order = CBUILD_MAX(CBUILD_BTREE_NODE_SIZE / key_size, (size_t)4);
+	tree->vals_offset = (__CBUILD_BTREE_KEYS + tree->order * key_size + 15) & ~(size_t)15;
+	tree->root = NULL;
+	tree->height = 0;
+	tree->size = 0;
+}
+#define __cbuild_btree_cmp_num(type, k1, k2)                                   \
+	({                                                                           \
+		type __btree_a, __btree_b;                                                 \
+		memcpy(&__btree_a, (k1), sizeof(__btree_a));                               \
+		memcpy(&__btree_b, (k2), sizeof(__btree_b));                               \
+		(__btree_a > __btree_b) - (__btree_a < __btree_b);                         \
+	})
+CBUILDDEF int __cbuild_btree_int_cmp(const void* tree, const void* k1,
+	const void* k2, size_t klen) {
+	CBUILD_UNUSED(tree);
+	switch(klen) {
+	case 1: return __cbuild_btree_cmp_num(int8_t, k1, k2);
+	case 2: return __cbuild_btree_cmp_num(int16_t, k1, k2);
+	case 4: return __cbuild_btree_cmp_num(int32_t, k1, k2);
+	case 8: return __cbuild_btree_cmp_num(int64_t, k1, k2);
+	default:
+		cbuild_assert(false, "Unsupported integer key size %zu.\n", klen);
+		return 0;
+	}
+}
+CBUILDDEF int __cbuild_btree_uint_cmp(const void* tree, const void* k1,
+	const void* k2, size_t klen) {
+	CBUILD_UNUSED(tree);
+	switch(klen) {
+	case 1: return __cbuild_btree_cmp_num(uint8_t, k1, k2);
+	case 2: return __cbuild_btree_cmp_num(uint16_t, k1, k2);
+	case 4: return __cbuild_btree_cmp_num(uint32_t, k1, k2);
+	case 8: return __cbuild_btree_cmp_num(uint64_t, k1, k2);
+	default:
+		cbuild_assert(false, "Unsupported integer key size %zu.\n", klen);
+		return 0;
+	}
+}
+CBUILDDEF int __cbuild_btree_cstr_cmp(const void* tree, const void* k1,
+	const void* k2, size_t klen) {
+	CBUILD_UNUSED(tree);
+	CBUILD_UNUSED(klen);
+	return strcmp(*(const char* const*)k1, *(const char* const*)k2);
+}
+CBUILDDEF int __cbuild_btree_sv_cmp(const void* tree, const void* k1,
+	const void* k2, size_t klen) {
+	CBUILD_UNUSED(tree);
+	CBUILD_UNUSED(klen);
+	const cbuild_sv_t* a = k1;
+	const cbuild_sv_t* b = k2;
+	size_t len = CBUILD_MIN(a->size, b->size);
+	int res = len == 0 ? 0 : memcmp(a->data, b->data, len);
+	if(res != 0) return res;
+	return (a->size > b->size) - (a->size < b->size);
+}
+CBUILDDEF __cbuild_btree_node_t* __cbuild_btree_node_alloc(cbuild_btree_t* tree,
+	bool leaf) {
+	size_t size = tree->vals_offset;
+	if(leaf) size += tree->order * tree->val_size;
+	else size += (tree->order + 1) * sizeof(__cbuild_btree_node_t*);
+	__cbuild_btree_node_t* node = tree->allocator.malloc(&tree->allocator, size);
+	cbuild_assert(node != NULL, "Allocation failed.\n");
+	node->next = NULL;
+	node->count = 0;
+	node->leaf = leaf;
+	return node;
+}
+// Index of first key that is greater than a key, or not less if 'lower'
+CBUILDDEF size_t __cbuild_btree_search(cbuild_btree_t* tree,
+	__cbuild_btree_node_t* node, const void* key, bool lower) {
+	size_t lo = 0;
+	size_t hi = node->count;
+	while(lo < hi) {
+		size_t mid = (lo + hi) / 2;
+		int res = tree->cmp(tree, __cbuild_btree_key(tree, node, mid), key, tree->key_size);
+		if(res < 0 || (!lower && res == 0)) lo = mid + 1;
+		else hi = mid;
+	}
+	return lo;
+}
+// Split full child of a node that is not full. Left half stays in place.
+CBUILDDEF void __cbuild_btree_split(cbuild_btree_t* tree,
+	__cbuild_btree_node_t* parent, size_t idx) {
+	__cbuild_btree_node_t** children = __cbuild_btree_children(tree, parent);
+	__cbuild_btree_node_t* child = children[idx];
+	__cbuild_btree_node_t* right = __cbuild_btree_node_alloc(tree, child->leaf);
+	size_t mid = child->count / 2;
+	const char* sep = NULL;
+	if(child->leaf) {
+		// Separator is copied, first key of right leaf stays there
+		right->count = child->count - (uint32_t)mid;
+		memcpy(__cbuild_btree_key(tree, right, 0), __cbuild_btree_key(tree, child, mid),
+			right->count * tree->key_size);
+		memcpy(__cbuild_btree_val(tree, right, 0), __cbuild_btree_val(tree, child, mid),
+			right->count * tree->val_size);
+		right->next = child->next;
+		child->next = right;
+		sep = __cbuild_btree_key(tree, right, 0);
+	} else {
+		// Separator moves up
+		right->count = child->count - (uint32_t)mid - 1;
+		memcpy(__cbuild_btree_key(tree, right, 0),
+			__cbuild_btree_key(tree, child, mid + 1), right->count * tree->key_size);
+		memcpy(__cbuild_btree_children(tree, right),
+			__cbuild_btree_children(tree, child) + mid + 1,
+			(right->count + 1) * sizeof(__cbuild_btree_node_t*));
+		sep = __cbuild_btree_key(tree, child, mid);
+	}
+	child->count = (uint32_t)mid;
+	memmove(__cbuild_btree_key(tree, parent, idx + 1), __cbuild_btree_key(tree, parent, idx),
+		(parent->count - idx) * tree->key_size);
+	memcpy(__cbuild_btree_key(tree, parent, idx), sep, tree->key_size);
+	memmove(children + idx + 2, children + idx + 1,
+		(parent->count - idx) * sizeof(__cbuild_btree_node_t*));
+	children[idx + 1] = right;
+	parent->count++;
+}
+// Full nodes are split on the way down, so parent always has room for a
+// separator
+CBUILDDEF void* cbuild_btree_get(cbuild_btree_t* tree, const void* key,
+	bool* found) {
+	if(tree->root == NULL) {
+		tree->root = __cbuild_btree_node_alloc(tree, true);
+		tree->height = 1;
+	}
+	if(tree->root->count == tree->order) {
+		__cbuild_btree_node_t* root = __cbuild_btree_node_alloc(tree, false);
+		__cbuild_btree_children(tree, root)[0] = tree->root;
+		__cbuild_btree_split(tree, root, 0);
+		tree->root = root;
+		tree->height++;
+	}
+	__cbuild_btree_node_t* node = tree->root;
+	while(!node->leaf) {
+		size_t idx = __cbuild_btree_search(tree, node, key, false);
+		__cbuild_btree_node_t* child = __cbuild_btree_children(tree, node)[idx];
+		if(child->count == tree->order) {
+			__cbuild_btree_split(tree, node, idx);
+			if(tree->cmp(tree, key, __cbuild_btree_key(tree, node, idx),
+				tree->key_size) >= 0) {
+				idx++;
+			}
+			child = __cbuild_btree_children(tree, node)[idx];
+		}
+		node = child;
+	}
+	size_t idx = __cbuild_btree_search(tree, node, key, true);
+	if(idx < node->count && tree->cmp(tree, __cbuild_btree_key(tree, node, idx), key,
+		tree->key_size) == 0) {
+		if(found != NULL) *found = true;
+		return __cbuild_btree_val(tree, node, idx);
+	}
+	memmove(__cbuild_btree_key(tree, node, idx + 1), __cbuild_btree_key(tree, node, idx),
+		(node->count - idx) * tree->key_size);
+	memmove(__cbuild_btree_val(tree, node, idx + 1), __cbuild_btree_val(tree, node, idx),
+		(node->count - idx) * tree->val_size);
+	memcpy(__cbuild_btree_key(tree, node, idx), key, tree->key_size);
+	memset(__cbuild_btree_val(tree, node, idx), 0, tree->val_size);
+	node->count++;
+	tree->size++;
+	if(found != NULL) *found = false;
+	return __cbuild_btree_val(tree, node, idx);
+}
+CBUILDDEF bool cbuild_btree_insert(cbuild_btree_t* tree, const void* key,
+	const void* val) {
+	bool found = false;
+	void* dst = cbuild_btree_get(tree, key, &found);
+	memcpy(dst, val, tree->val_size);
+	return !found;
+}
+CBUILDDEF cbuild_btree_iter_t __cbuild_btree_iter_at(cbuild_btree_t* tree,
+	__cbuild_btree_node_t* node, size_t idx) {
+	if(node != NULL && idx >= node->count) {
+		node = node->next;
+		idx = 0;
+	}
+	if(node == NULL) return (cbuild_btree_iter_t){0};
+	return (cbuild_btree_iter_t){
+		.node = node,
+		.idx = idx,
+		.key = __cbuild_btree_key(tree, node, idx),
+		.val = __cbuild_btree_val(tree, node, idx),
+	};
+}
+CBUILDDEF cbuild_btree_iter_t cbuild_btree_lower_bound(cbuild_btree_t* tree,
+	const void* key) {
+	__cbuild_btree_node_t* node = tree->root;
+	if(node == NULL) return (cbuild_btree_iter_t){0};
+	while(!node->leaf) {
+		size_t idx = __cbuild_btree_search(tree, node, key, false);
+		node = __cbuild_btree_children(tree, node)[idx];
+	}
+	// If all keys of a leaf are less, first key of next leaf is the answer
+	return __cbuild_btree_iter_at(tree, node, __cbuild_btree_search(tree, node, key, true));
+}
+CBUILDDEF void* cbuild_btree_find(cbuild_btree_t* tree, const void* key) {
+	cbuild_btree_iter_t iter = cbuild_btree_lower_bound(tree, key);
+	if(iter.node == NULL || tree->cmp(tree, iter.key, key, tree->key_size) != 0) {
+		return NULL;
+	}
+	return iter.val;
+}
+CBUILDDEF cbuild_btree_iter_t cbuild_btree_begin(cbuild_btree_t* tree) {
+	__cbuild_btree_node_t* node = tree->root;
+	if(node == NULL) return (cbuild_btree_iter_t){0};
+	while(!node->leaf) node = __cbuild_btree_children(tree, node)[0];
+	return __cbuild_btree_iter_at(tree, node, 0);
+}
+CBUILDDEF void cbuild_btree_next(cbuild_btree_t* tree, cbuild_btree_iter_t* iter) {
+	*iter = __cbuild_btree_iter_at(tree, iter->node, iter->idx + 1);
+}
+CBUILDDEF bool cbuild_btree_iter_before(cbuild_btree_t* tree,
+	cbuild_btree_iter_t iter, const void* to) {
+	if(iter.node == NULL) return false;
+	return to == NULL || tree->cmp(tree, iter.key, to, tree->key_size) < 0;
+}
+CBUILDDEF void cbuild_btree_bulk_load(cbuild_btree_t* tree, const void* keys,
+	const void* vals, size_t count) {
+	cbuild_assert(tree->root == NULL, "Bulk load into non-empty tree.\n");
+	if(count == 0) return;
+	const char* key_bytes = keys;
+	for(size_t i = 1; i < count; i++) {
+		cbuild_assert(tree->cmp(tree, key_bytes + (i - 1) * tree->key_size,
+			key_bytes + i * tree->key_size, tree->key_size) < 0,
+			"Keys are not sorted or not unique at index %zu.\n", i);
+	}
+	// Nodes of current level and pointers to smallest keys in their subtrees
+	size_t n = (count + tree->order - 1) / tree->order;
+	__cbuild_btree_node_t** nodes = __CBUILD_MALLOC(n * sizeof(__cbuild_btree_node_t*));
+	const void** mins = __CBUILD_MALLOC(n * sizeof(const void*));
+	cbuild_assert(nodes != NULL && mins != NULL, "Allocation failed.\n");
+	// Elements are spread evenly, so last node is not almost empty
+	size_t start = 0;
+	for(size_t i = 0; i < n; i++) {
+		size_t len = count / n + (i < count % n);
+		__cbuild_btree_node_t* leaf = __cbuild_btree_node_alloc(tree, true);
+		leaf->count = (uint32_t)len;
+		memcpy(__cbuild_btree_key(tree, leaf, 0), key_bytes + start * tree->key_size,
+			len * tree->key_size);
+		if(vals != NULL) {
+			memcpy(__cbuild_btree_val(tree, leaf, 0),
+				(const char*)vals + start * tree->val_size, len * tree->val_size);
+		} else {
+			memset(__cbuild_btree_val(tree, leaf, 0), 0, len * tree->val_size);
+		}
+		if(i > 0) nodes[i - 1]->next = leaf;
+		nodes[i] = leaf;
+		mins[i] = __cbuild_btree_key(tree, leaf, 0);
+		start += len;
+	}
+	tree->height = 1;
+	// Parents are written over their children, each one is written after
+	// its children were read
+	while(n > 1) {
+		size_t parents = (n + tree->order) / (tree->order + 1);
+		start = 0;
+		for(size_t i = 0; i < parents; i++) {
+			size_t len = n / parents + (i < n % parents);
+			__cbuild_btree_node_t* parent = __cbuild_btree_node_alloc(tree, false);
+			parent->count = (uint32_t)len - 1;
+			memcpy(__cbuild_btree_children(tree, parent), nodes + start,
+				len * sizeof(__cbuild_btree_node_t*));
+			for(size_t j = 1; j < len; j++) {
+				memcpy(__cbuild_btree_key(tree, parent, j - 1), mins[start + j],
+					tree->key_size);
+			}
+			nodes[i] = parent;
+			mins[i] = mins[start];
+			start += len;
+		}
+		n = parents;
+		tree->height++;
+	}
+	tree->root = nodes[0];
+	tree->size = count;
+	__CBUILD_FREE(nodes);
+	__CBUILD_FREE(mins);
+}
+CBUILDDEF void __cbuild_btree_free_node(cbuild_btree_t* tree,
+	__cbuild_btree_node_t* node) {
+	if(!node->leaf) {
+		for(size_t i = 0; i <= node->count; i++) {
+			__cbuild_btree_free_node(tree, __cbuild_btree_children(tree, node)[i]);
+		}
+	}
+	tree->allocator.free(&tree->allocator, node);
+}
+CBUILDDEF void cbuild_btree_free(cbuild_btree_t* tree) {
+	if(tree->root != NULL) __cbuild_btree_free_node(tree, tree->root);
+	tree->root = NULL;
+	tree->height = 0;
+	tree->size = 0;
+}
@@ -0,0 +1,201 @@
+#pragma once // For LSP
+//! Ordered map based on B+ tree.
+//!
+//! License: `GPL-3.0-or-later`.
+//!
+//! Keys of each node are stored one after another in one array, so search
+//! inside a node is a binary search over contiguous memory. Fanout is
+//! [`CBUILD_BTREE_NODE_SIZE`](DOC:CBUILD_BTREE_NODE_SIZE) divided by key size.
+//! Values are stored only in leaves and leaves are linked, so iteration in
+//! sorted order and range queries just walk over leaves. Nodes are allocated
+//! with [`cbuild_allocator_t`](DOC:cbuild_allocator_t), so whole tree can live
+//! in an arena.
+//!
+//! Tree should be zero-initialized, then one of `cbuild_btree_init_*`
+//! macros should set key comparison function and
+//! [`cbuild_btree_init`](DOC:cbuild_btree_init) should set types and
+//! allocator:
+//!
+//! ```cpp
+//! cbuild_btree_t tree = {0};
+//! cbuild_btree_init_cstr(&tree);
+//! cbuild_btree_init(&tree, const char*, int, cbuild_allocator_from_libc());
+//! const char* key = "src/Map.c";
+//! int val = 1;
+//! cbuild_btree_insert(&tree, &key, &val);
+//! const char* from = "src/";
+//! const char* to = "src0";
+//! cbuild_btree_foreach_range(&tree, &from, &to, it) {
+//!     printf("%s = %d\n", *(const char**)it.key, *(int*)it.val);
+//! }
+//! cbuild_btree_free(&tree);
+//! ```
+//!
+//! Pointers to keys and values are invalidated when element is inserted.
+
+#include "Common.h"
+#include "Allocator.h"
+#include "StringView.h"
+
+/// Key comparison function.
+///
+/// * [pl:tree] Pointer to tree object. Can be used to retrieve extra data.
+/// * [pl:k1] Pointer to key 1.
+/// * [pl:k2] Pointer to key 2.
+/// * [pl:klen] Size of key.
+///
+/// [r:] Negative if key 1 is less than key 2, `0`{.c} if they are equal, positive otherwise.
+typedef int (*cbuild_btree_cmp_t)(const void* tree, const void* k1,
+	const void* k2, size_t klen);
+/// Node of a tree. Should not be used directly.
+///
+/// Header is followed by keys and then by values (in leaves) or by children
+/// (in internal nodes).
+typedef struct __cbuild_btree_node_t {
+	struct __cbuild_btree_node_t* next; // Next leaf
+	uint32_t count; // Number of keys
+	bool leaf;
+} __cbuild_btree_node_t;
+/// Ordered map.
+///
+/// * [fl:cmp] Key comparison function.
+/// * [fl:allocator] Allocator for nodes.
+/// * [fl:key_size] Size of a key.
+/// * [fl:val_size] Size of a value.
+/// * [fl:order] Maximum number of keys in a node.
+/// * [fl:vals_offset] Offset of values or children in a node.
+/// * [fl:root] Root node.
+/// * [fl:height] Number of levels.
+/// * [fl:size] Number of elements.
+typedef struct cbuild_btree_t {
+	cbuild_btree_cmp_t cmp;
+	cbuild_allocator_t allocator;
+	size_t key_size;
+	size_t val_size;
+	size_t order;
+	size_t vals_offset;
+	__cbuild_btree_node_t* root;
+	size_t height;
+	size_t size;
+} cbuild_btree_t;
+/// Position in a tree.
+///
+/// * [fl:node] Leaf, `NULL`{.c} if iterator is past the end.
+/// * [fl:idx] Index in a leaf.
+/// * [fl:key] Pointer to a key.
+/// * [fl:val] Pointer to a value.
+typedef struct cbuild_btree_iter_t {
+	__cbuild_btree_node_t* node;
+	size_t idx;
+	void* key;
+	void* val;
+} cbuild_btree_iter_t;
+/// Initialize tree which uses signed integers as keys.
+///
+/// * [pl:tree:cbuild_btree_t*] Tree object.
+#define cbuild_btree_init_int(tree) (tree)->cmp = __cbuild_btree_int_cmp;
+/// Initialize tree which uses unsigned integers as keys.
+///
+/// * [pl:tree:cbuild_btree_t*] Tree object.
+#define cbuild_btree_init_uint(tree) (tree)->cmp = __cbuild_btree_uint_cmp;
+/// Initialize tree which uses c-strings as keys. Strings are not copied.
+///
+/// * [pl:tree:cbuild_btree_t*] Tree object.
+#define cbuild_btree_init_cstr(tree) (tree)->cmp = __cbuild_btree_cstr_cmp;
+/// Initialize tree which uses string views as keys. Strings are not copied.
+///
+/// * [pl:tree:cbuild_btree_t*] Tree object.
+#define cbuild_btree_init_sv(tree) (tree)->cmp = __cbuild_btree_sv_cmp;
+/// Set types and allocator of a tree.
+///
+/// * [pl:tree:cbuild_btree_t*] Tree object.
+/// * [pl:key_type:type] Type of keys.
+/// * [pl:val_type:type] Type of values.
+/// * [pl:alloc:cbuild_allocator_t] Allocator for nodes.
+#define cbuild_btree_init(tree, key_type, val_type, alloc)                       \
+	__cbuild_btree_init((tree), sizeof(key_type), sizeof(val_type), (alloc))
+/// Iterate over all elements of a tree in sorted order.
+///
+/// * [pl:tree:cbuild_btree_t*] Tree object.
+/// * [pl:iter:name] Name of an iterator, it will have type [`cbuild_btree_iter_t`](DOC:cbuild_btree_iter_t).
+#define cbuild_btree_foreach(tree, iter)                                       \
+	for (cbuild_btree_iter_t iter = cbuild_btree_begin(tree); iter.node != NULL; \
+		cbuild_btree_next((tree), &iter))
+/// Iterate over elements with keys in range `[from, to)`.
+///
+/// * [pl:tree:cbuild_btree_t*] Tree object.
+/// * [pl:from:const void*] Pointer to a lower bound (inclusive).
+/// * [pl:to:const void*] Pointer to an upper bound (exclusive), `NULL`{.c} if there is no upper bound.
+/// * [pl:iter:name] Name of an iterator, it will have type [`cbuild_btree_iter_t`](DOC:cbuild_btree_iter_t).
+#define cbuild_btree_foreach_range(tree, from, to, iter)                       \
+	for (cbuild_btree_iter_t iter = cbuild_btree_lower_bound((tree), (from));    \
+		cbuild_btree_iter_before((tree), iter, (to)); cbuild_btree_next((tree), &iter))
+/// Insert element or overwrite value of existing one.
+///
+/// * [pl:tree] Tree object.
+/// * [pl:key] Pointer to a key.
+/// * [pl:val] Pointer to a value.
+///
+/// [r:] `true`{.c} if key was not in a tree.
+CBUILDDEF bool cbuild_btree_insert(cbuild_btree_t* tree, const void* key,
+	const void* val);
+/// Get value by key, insert element with zeroed value if key is not in a tree.
+///
+/// * [pl:tree] Tree object.
+/// * [pl:key] Pointer to a key.
+/// * [pl:found] Set to `true`{.c} if key was in a tree. Can be `NULL`{.c}.
+///
+/// [r:] Pointer to a value.
+CBUILDDEF void* cbuild_btree_get(cbuild_btree_t* tree, const void* key,
+	bool* found);
+/// Find value by key.
+///
+/// [r:] Pointer to a value, `NULL`{.c} if key is not in a tree.
+CBUILDDEF void* cbuild_btree_find(cbuild_btree_t* tree, const void* key);
+/// Find first element with key that is not less than given one.
+///
+/// [r:] Iterator, past the end if all keys are less.
+CBUILDDEF cbuild_btree_iter_t cbuild_btree_lower_bound(cbuild_btree_t* tree,
+	const void* key);
+/// Iterator to a smallest element.
+CBUILDDEF cbuild_btree_iter_t cbuild_btree_begin(cbuild_btree_t* tree);
+/// Move iterator to a next element.
+CBUILDDEF void cbuild_btree_next(cbuild_btree_t* tree, cbuild_btree_iter_t* iter);
+/// Check that iterator is not past the end and its key is less than a bound.
+///
+/// * [pl:tree] Tree object.
+/// * [pl:iter] Iterator.
+/// * [pl:to] Pointer to an upper bound, `NULL`{.c} if there is no upper bound.
+CBUILDDEF bool cbuild_btree_iter_before(cbuild_btree_t* tree,
+	cbuild_btree_iter_t iter, const void* to);
+/// Build tree from sorted elements. It is faster than inserting them one by
+/// one and leaves are filled completely. Tree should be empty.
+///
+/// * [pl:tree] Tree object.
+/// * [pl:keys] Array of keys, sorted in strictly ascending order.
+/// * [pl:vals] Array of values. If `NULL`{.c} values are zeroed.
+/// * [pl:count] Number of elements.
+CBUILDDEF void cbuild_btree_bulk_load(cbuild_btree_t* tree, const void* keys,
+	const void* vals, size_t count);
+/// Free all nodes. Elements are not cleared. Tree can be reused afterwards.
+CBUILDDEF void cbuild_btree_free(cbuild_btree_t* tree);
+
+//! # Internal functions [line:cbuild-btree-internal]
+
+//@ cbuild-btree-internal
+
+///
+CBUILDDEF void __cbuild_btree_init(cbuild_btree_t* tree, size_t key_size,
+	size_t val_size, cbuild_allocator_t allocator);
+/// Supports keys of 1, 2, 4 and 8 bytes.
+CBUILDDEF int __cbuild_btree_int_cmp(const void* tree, const void* k1,
+	const void* k2, size_t klen);
+/// Supports keys of 1, 2, 4 and 8 bytes.
+CBUILDDEF int __cbuild_btree_uint_cmp(const void* tree, const void* k1,
+	const void* k2, size_t klen);
+///
+CBUILDDEF int __cbuild_btree_cstr_cmp(const void* tree, const void* k1,
+	const void* k2, size_t klen);
+/// Bytewise, shorter string is less if it is a prefix of longer one.
+CBUILDDEF int __cbuild_btree_sv_cmp(const void* tree, const void* k1,
+	const void* k2, size_t klen);
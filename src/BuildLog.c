@@ -0,0 +1,323 @@
+//! Persistent build log.
+//!
+//! License: `GPL-3.0-or-later`.
+
+#include "BuildLog.h"
+#include "Common.h"
+#include "Log.h"
+#include "Map.h"
+#include "DynArray.h"
+#include "Span.h"
+#include "StringBuilder.h"
+#include "FS.h"
+#include "Temp.h"
+#include "Compile.h"
+#define __CBUILD_BUILDLOG_MAGIC   0x474F4C444C494243ull // "CBILDLOG"
+#define __CBUILD_BUILDLOG_VERSION 1
+typedef struct __cbuild_buildlog_header_t {
+	uint64_t magic;
+	uint32_t version;
+	uint32_t reserved;
+} __cbuild_buildlog_header_t;
+typedef struct __cbuild_buildlog_rec_t {
+	uint64_t cmd_hash;
+	uint64_t inputs_hash;
+	int64_t mtime;
+	uint64_t duration;
+	uint32_t path_len; // Without NULL-terminator
+	uint32_t reserved;
+} __cbuild_buildlog_rec_t;
+CBUILDDEF size_t __cbuild_buildlog_rec_size(size_t path_len) {
+	return sizeof(__cbuild_buildlog_rec_t) + ((path_len + 1 + 7) & ~(size_t)7);
+}
+// FNV-1a, 64 bit
+CBUILDDEF uint64_t __cbuild_buildlog_hash(uint64_t hash, const void* data, size_t len) {
+	const unsigned char* bytes = data;
+	for(size_t i = 0; i < len; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+CBUILDDEF uint64_t cbuild_buildlog_hash_cmd(cbuild_cmd_t cmd) {
+	uint64_t hash = 14695981039346656037ull;
+	for(size_t i = 0; i < cmd.size; i++) {
+		hash = __cbuild_buildlog_hash(hash, cmd.data[i], strlen(cmd.data[i]) + 1);
+	}
+	return hash;
+}
+CBUILDDEF uint64_t cbuild_buildlog_hash_inputs(const char** inputs,
+	size_t num_inputs) {
+	cbuild_cmd_t list = { .data = inputs, .size = num_inputs };
+	return cbuild_buildlog_hash_cmd(list);
+}
+CBUILDDEF void __cbuild_buildlog_index_set(cbuild_buildlog_t* log,
+	cbuild_buildlog_entry_t entry) {
+	if(log->index.capacity == 0) {
+		cbuild_map_init_strkey(&log->index);
+	}
+	cbuild_map_strkey_t key = cbuild_map_strkey(entry.output);
+	__cbuild_buildlog_pair_t* pair = cbuild_map_put(&log->index, key);
+	pair->key = key;
+	pair->entry = entry;
+}
+CBUILDDEF const cbuild_buildlog_entry_t* cbuild_buildlog_find(cbuild_buildlog_t* log,
+	const char* output) {
+	if(log->index.capacity == 0) return NULL;
+	__cbuild_buildlog_pair_t* pair = cbuild_map_find(&log->index,
+		cbuild_map_strkey(output));
+	if(pair == NULL) return NULL;
+	return &pair->entry;
+}
+CBUILDDEF void __cbuild_buildlog_serialize(cbuild_sb_t* sb,
+	const cbuild_buildlog_entry_t* entry) {
+	size_t path_len = strlen(entry->output);
+	__cbuild_buildlog_rec_t rec = {
+		.cmd_hash = entry->cmd_hash,
+		.inputs_hash = entry->inputs_hash,
+		.mtime = entry->mtime,
+		.duration = entry->duration,
+		.path_len = (uint32_t)path_len,
+	};
+	size_t start = sb->size;
+	cbuild_da_append_arr(sb, (const char*)&rec, sizeof(rec));
+	cbuild_da_append_arr(sb, entry->output, path_len);
+	while(sb->size - start < __cbuild_buildlog_rec_size(path_len)) {
+		cbuild_da_append(sb, '\0');
+	}
+}
+#if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
+	CBUILDDEF bool __cbuild_buildlog_write(cbuild_fd_t fd, const char* path,
+		cbuild_sb_t* sb) {
+		const char* buf = sb->data;
+		size_t cnt = sb->size;
+		while(cnt > 0) {
+			ssize_t written = cbuild_fd_write_file(fd, buf, cnt, path);
+			if(written < 0) return false;
+			cnt -= (size_t)written;
+			buf += written;
+		}
+		return true;
+	}
+	CBUILDDEF cbuild_fd_t __cbuild_buildlog_open_fd(const char* path) {
+		cbuild_fd_t fd = open(path, O_RDWR | O_CREAT | O_APPEND,
+			S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+		if(fd < 0) {
+			cbuild_log_error("Could not open build log \"%s\", error: \"%s\"",
+				path, strerror(errno));
+			return CBUILD_INVALID_FD;
+		}
+		fcntl(fd, F_SETFD, FD_CLOEXEC);
+		return fd;
+	}
+	CBUILDDEF bool __cbuild_buildlog_reset(cbuild_buildlog_t* log) {
+		if(ftruncate(log->fd, 0) < 0) {
+			cbuild_log_error("Could not truncate build log \"%s\", error: \"%s\"",
+				log->path, strerror(errno));
+			return false;
+		}
+		__cbuild_buildlog_header_t header = {
+			.magic = __CBUILD_BUILDLOG_MAGIC,
+			.version = __CBUILD_BUILDLOG_VERSION,
+		};
+		cbuild_sb_t sb = {0};
+		cbuild_da_append_arr(&sb, (const char*)&header, sizeof(header));
+		bool ret = __cbuild_buildlog_write(log->fd, log->path, &sb);
+		cbuild_da_clear(&sb);
+		return ret;
+	}
+	CBUILDDEF bool cbuild_buildlog_open(cbuild_buildlog_t* log, const char* path) {
+		memset(log, 0, sizeof(*log));
+		log->path = path;
+		log->fd = __cbuild_buildlog_open_fd(path);
+		if(log->fd == CBUILD_INVALID_FD) return false;
+		struct stat statbuff;
+		if(fstat(log->fd, &statbuff) < 0) {
+			cbuild_log_error("Could not stat build log \"%s\", error: \"%s\"",
+				path, strerror(errno));
+			cbuild_buildlog_close(log);
+			return false;
+		}
+		size_t size = (size_t)statbuff.st_size;
+		if(size < sizeof(__cbuild_buildlog_header_t)) {
+			if(!__cbuild_buildlog_reset(log)) {
+				cbuild_buildlog_close(log);
+				return false;
+			}
+			return true;
+		}
+		log->map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, log->fd, 0);
+		if(log->map == MAP_FAILED) {
+			cbuild_log_error("Could not map build log \"%s\", error: \"%s\"",
+				path, strerror(errno));
+			log->map = NULL;
+			cbuild_buildlog_close(log);
+			return false;
+		}
+		log->map_size = size;
+		const char* data = log->map;
+		const __cbuild_buildlog_header_t* header = log->map;
+		if(header->magic != __CBUILD_BUILDLOG_MAGIC ||
+			header->version != __CBUILD_BUILDLOG_VERSION) {
+			cbuild_log_warn("Build log \"%s\" has unknown format, starting from scratch.",
+				path);
+			if(!__cbuild_buildlog_reset(log)) {
+				cbuild_buildlog_close(log);
+				return false;
+			}
+			return true;
+		}
+		size_t offset = sizeof(__cbuild_buildlog_header_t);
+		while(offset + sizeof(__cbuild_buildlog_rec_t) <= size) {
+			const __cbuild_buildlog_rec_t* rec = (const void*)(data + offset);
+			size_t rec_size = __cbuild_buildlog_rec_size(rec->path_len);
+			if(offset + rec_size > size) break;
+			const char* output = data + offset + sizeof(*rec);
+			if(output[rec->path_len] != '\0') break;
+			cbuild_buildlog_entry_t entry = {
+				.output = output,
+				.cmd_hash = rec->cmd_hash,
+				.inputs_hash = rec->inputs_hash,
+				.mtime = rec->mtime,
+				.duration = rec->duration,
+			};
+			__cbuild_buildlog_index_set(log, entry);
+			log->records++;
+			offset += rec_size;
+		}
+		if(offset < size) {
+			cbuild_log_warn("Build log \"%s\" has truncated record, dropping it.", path);
+			if(ftruncate(log->fd, (off_t)offset) < 0) {
+				cbuild_log_error("Could not truncate build log \"%s\", error: \"%s\"",
+					path, strerror(errno));
+				cbuild_buildlog_close(log);
+				return false;
+			}
+		}
+		if(log->records >= CBUILD_BUILDLOG_COMPACT_MIN &&
+			log->records > log->index.used * 2) {
+			cbuild_buildlog_compact(log);
+		}
+		return true;
+	}
+	CBUILDDEF void cbuild_buildlog_close(cbuild_buildlog_t* log) {
+		if(log->fd != CBUILD_INVALID_FD) cbuild_fd_close(log->fd);
+		if(log->map != NULL) munmap(log->map, log->map_size);
+		cbuild_da_clear(&log->index);
+		cbuild_span_foreach(&log->strings, str) __CBUILD_FREE(*str);
+		cbuild_da_clear(&log->strings);
+		log->fd = CBUILD_INVALID_FD;
+		log->map = NULL;
+		log->map_size = 0;
+		log->records = 0;
+		log->index.used = 0;
+		log->index.deleted = 0;
+	}
+	CBUILDDEF bool cbuild_buildlog_compact(cbuild_buildlog_t* log) {
+		const char* tmp = cbuild_temp_sprintf("%s.tmp", log->path);
+		cbuild_fd_t fd = cbuild_fd_open_write(tmp);
+		if(fd == CBUILD_INVALID_FD) return false;
+		__cbuild_buildlog_header_t header = {
+			.magic = __CBUILD_BUILDLOG_MAGIC,
+			.version = __CBUILD_BUILDLOG_VERSION,
+		};
+		cbuild_sb_t sb = {0};
+		cbuild_da_append_arr(&sb, (const char*)&header, sizeof(header));
+		cbuild_span_foreach(&log->index, pair) {
+			if(pair->tombstone != CBUILD_MAP_FULL) continue;
+			__cbuild_buildlog_serialize(&sb, &pair->entry);
+		}
+		bool ok = __cbuild_buildlog_write(fd, tmp, &sb);
+		cbuild_da_clear(&sb);
+		if(ok && fsync(fd) < 0) {
+			cbuild_log_error("Could not sync file \"%s\", error: \"%s\"",
+				tmp, strerror(errno));
+			ok = false;
+		}
+		cbuild_fd_close(fd);
+		if(!ok || !cbuild_file_rename(tmp, log->path)) {
+			cbuild_file_remove(tmp);
+			return false;
+		}
+		// Old mapping is still valid and still owns path strings
+		cbuild_fd_t new_fd = __cbuild_buildlog_open_fd(log->path);
+		if(new_fd == CBUILD_INVALID_FD) return false;
+		cbuild_fd_close(log->fd);
+		log->fd = new_fd;
+		log->records = log->index.used;
+		return true;
+	}
+	CBUILDDEF bool cbuild_buildlog_record(cbuild_buildlog_t* log, const char* output,
+		cbuild_cmd_t cmd, const char** inputs, size_t num_inputs, uint64_t duration) {
+		struct stat statbuff;
+		if(stat(output, &statbuff) < 0) {
+			cbuild_log_error("Could not stat file \"%s\", error: \"%s\"",
+				output, strerror(errno));
+			return false;
+		}
+		char* path = __CBUILD_MALLOC(strlen(output) + 1);
+		cbuild_assert(path != NULL, "Allocation failed.\n");
+		strcpy(path, output);
+		cbuild_da_append(&log->strings, path);
+		cbuild_buildlog_entry_t entry = {
+			.output = path,
+			.cmd_hash = cbuild_buildlog_hash_cmd(cmd),
+			.inputs_hash = cbuild_buildlog_hash_inputs(inputs, num_inputs),
+			.mtime = __cbuild_compile_mtime_ns(&statbuff),
+			.duration = duration,
+		};
+		// Contents of inputs are kept in a stamp next to output
+		if(!cbuild_compare_hash_update(output, inputs, num_inputs)) return false;
+		cbuild_sb_t sb = {0};
+		__cbuild_buildlog_serialize(&sb, &entry);
+		bool ret = __cbuild_buildlog_write(log->fd, log->path, &sb);
+		cbuild_da_clear(&sb);
+		if(!ret) return false;
+		__cbuild_buildlog_index_set(log, entry);
+		log->records++;
+		return true;
+	}
+	CBUILDDEF int cbuild_buildlog_check(cbuild_buildlog_t* log, const char* output,
+		cbuild_cmd_t cmd, const char** inputs, size_t num_inputs) {
+		const cbuild_buildlog_entry_t* entry = cbuild_buildlog_find(log, output);
+		if(entry == NULL) return 1;
+		if(entry->cmd_hash != cbuild_buildlog_hash_cmd(cmd)) return 1;
+		if(entry->inputs_hash != cbuild_buildlog_hash_inputs(inputs, num_inputs)) {
+			return 1;
+		}
+		// Output and inputs are stat-ed in one sweep
+		const char** paths = __CBUILD_MALLOC((num_inputs + 1) * sizeof(const char*));
+		cbuild_assert(paths != NULL, "Allocation failed.\n");
+		__cbuild_bulk_file_t* files =
+			__CBUILD_MALLOC((num_inputs + 1) * sizeof(__cbuild_bulk_file_t));
+		cbuild_assert(files != NULL, "Allocation failed.\n");
+		paths[0] = output;
+		memcpy(paths + 1, inputs, num_inputs * sizeof(const char*));
+		__cbuild_compile_stat_bulk(paths, num_inputs + 1, files, 0);
+		int ret = 0;
+		if(files[0].error != 0 && files[0].error != ENOENT) {
+			cbuild_log_error("Could not stat file \"%s\", error: \"%s\"",
+				output, strerror(files[0].error));
+			ret = -1;
+		} else if(files[0].error != 0 || files[0].mtime != entry->mtime) {
+			// Output was removed, changed or replaced after it was built
+			ret = 1;
+		} else {
+			for(size_t i = 1; i <= num_inputs && ret == 0; i++) {
+				if(files[i].error == ENOENT) {
+					// Input was removed, let build report it
+					ret = 1;
+				} else if(files[i].error != 0) {
+					cbuild_log_error("Could not stat file \"%s\", error: \"%s\"",
+						paths[i], strerror(files[i].error));
+					ret = -1;
+				}
+			}
+			// Inputs with changed metadata are compared by content
+			if(ret == 0) ret = cbuild_compare_hash_many(output, inputs, num_inputs);
+		}
+		__CBUILD_FREE(paths);
+		__CBUILD_FREE(files);
+		return ret;
+	}
+#endif // CBUILD_API_*
@@ -0,0 +1,117 @@
+#pragma once // For LSP
+//! Persistent build log.
+//!
+//! License: `GPL-3.0-or-later`.
+//!
+//! Log remembers, for every output, hash of a command that produced it, hash
+//! of its list of inputs, mtime of output right after it was built and how
+//! long it took to build. With this information staleness check detects
+//! changed commands and lists of inputs, and output that was removed or
+//! modified after it was built. Output and inputs are stat-ed in one sweep,
+//! same as in [`cbuild_compare_mtime_bulk`](DOC:cbuild_compare_mtime_bulk).
+//! Contents of inputs are tracked with `<output>.chash` stamps of
+//! [`cbuild_compare_hash_many`](DOC:cbuild_compare_hash_many), so inputs that
+//! were only touched do not cause a rebuild.
+//!
+//! # File format
+//!
+//! Log is an append-only binary file in native byte order. It starts with
+//! 16 byte header and is followed by records, each one is 40 bytes of
+//! metadata plus `NULL`{.c}-terminated output path padded to 8 bytes. Newer
+//! records override older ones with the same path. On open file is
+//! memory-mapped and indexed, and if it contains too many overridden records
+//! it is compacted (rewritten with only latest records). Partially written
+//! record at the end of a file (eg. after crash) is dropped.
+
+#include "Common.h"
+#include "Command.h"
+#include "Map.h"
+
+/// Single entry of a build log.
+///
+/// * [fl:output] Path to output.
+/// * [fl:cmd_hash] Hash of a command, see [`cbuild_buildlog_hash_cmd`](DOC:cbuild_buildlog_hash_cmd).
+/// * [fl:inputs_hash] Hash of list of inputs, see [`cbuild_buildlog_hash_inputs`](DOC:cbuild_buildlog_hash_inputs).
+/// * [fl:mtime] Mtime of output in nanoseconds since epoch, at the moment it was recorded.
+/// * [fl:duration] How long output took to build, in nanoseconds.
+typedef struct cbuild_buildlog_entry_t {
+	const char* output;
+	uint64_t cmd_hash;
+	uint64_t inputs_hash;
+	int64_t mtime;
+	uint64_t duration;
+} cbuild_buildlog_entry_t;
+/// Index of a build log. Should not be used directly.
+typedef struct __cbuild_buildlog_pair_t {
+	cbuild_map_strkey_t key;
+	cbuild_buildlog_entry_t entry;
+	cbuild_map_tombstone_t tombstone;
+} __cbuild_buildlog_pair_t;
+/// Build log.
+///
+/// Should be zero-initialized and opened with [`cbuild_buildlog_open`](DOC:cbuild_buildlog_open).
+typedef struct cbuild_buildlog_t {
+	const char* path;
+	cbuild_fd_t fd;
+	void* map;
+	size_t map_size;
+	size_t records; // Number of records in a file, including overridden
+	struct {
+		__cbuild_buildlog_pair_t* data;
+		size_t size;
+		size_t capacity;
+		cbuild_map_hash_t hash;
+		cbuild_map_keycmp_t keycmp;
+		size_t used;
+		size_t deleted;
+	} index;
+	cbuild_da_new(char*) strings; // Output paths that are not in 'map'
+} cbuild_buildlog_t;
+/// Open build log. File is created if it does not exist.
+///
+/// * [pl:log] Build log.
+/// * [pl:path] Path to a log file. Should outlive log.
+///
+/// [r:] `false`{.c} on error.
+CBUILDDEF bool cbuild_buildlog_open(cbuild_buildlog_t* log, const char* path);
+/// Close build log and free all memory.
+CBUILDDEF void cbuild_buildlog_close(cbuild_buildlog_t* log);
+/// Rewrite log file with only latest record for each output.
+///
+/// [r:] `false`{.c} on error. Log is still usable in this case.
+CBUILDDEF bool cbuild_buildlog_compact(cbuild_buildlog_t* log);
+/// Find latest entry for an output.
+///
+/// [r:] `NULL`{.c} if output is not in a log.
+CBUILDDEF const cbuild_buildlog_entry_t* cbuild_buildlog_find(cbuild_buildlog_t* log,
+	const char* output);
+/// Record that output was just built. Output is stat-ed to get its mtime and
+/// content stamp of inputs is written with
+/// [`cbuild_compare_hash_update`](DOC:cbuild_compare_hash_update).
+///
+/// * [pl:log] Build log.
+/// * [pl:output] Path to output.
+/// * [pl:cmd] Command that built output.
+/// * [pl:inputs] List of inputs.
+/// * [pl:num_inputs] Number of inputs.
+/// * [pl:duration] How long it took, in nanoseconds.
+///
+/// [r:] `false`{.c} on error.
+CBUILDDEF bool cbuild_buildlog_record(cbuild_buildlog_t* log, const char* output,
+	cbuild_cmd_t cmd, const char** inputs, size_t num_inputs, uint64_t duration);
+/// Check if output needs to be rebuilt.
+///
+/// Output is stale if it is not in a log, if command or list of inputs
+/// changed, if output is missing or its mtime differs from recorded one, if
+/// any input is missing or if content of any input changed.
+///
+/// * [r:=0] - Output is up to date.
+/// * [r:<0] - Error.
+/// * [r:>0] - Output is stale.
+CBUILDDEF int cbuild_buildlog_check(cbuild_buildlog_t* log, const char* output,
+	cbuild_cmd_t cmd, const char** inputs, size_t num_inputs);
+/// Hash of a command line.
+CBUILDDEF uint64_t cbuild_buildlog_hash_cmd(cbuild_cmd_t cmd);
+/// Hash of a list of input paths. Order matters.
+CBUILDDEF uint64_t cbuild_buildlog_hash_inputs(const char** inputs,
+	size_t num_inputs);
@@ -0,0 +1,301 @@
+//! Local cache of compilation results.
+//!
+//! License: `GPL-3.0-or-later`.
+
+#include "Cache.h"
+#include "Common.h"
+#include "Log.h"
+#include "DynArray.h"
+#include "Span.h"
+#include "StringBuilder.h"
+#include "FS.h"
+#include "Temp.h"
+#include "Command.h"
+#include "Compile.h"
+#include "Map.h"
+#if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
+	// Arguments that only tell compiler where to write output
+	CBUILDDEF bool __cbuild_cache_is_output_arg(const char* arg) {
+		return strcmp(arg, "-o") == 0 || strcmp(arg, "-MF") == 0 ||
+			strcmp(arg, "-MT") == 0 || strcmp(arg, "-MQ") == 0;
+	}
+	CBUILDDEF bool __cbuild_cache_is_dep_flag(const char* arg) {
+		return strcmp(arg, "-MD") == 0 || strcmp(arg, "-MMD") == 0 ||
+			strcmp(arg, "-MP") == 0;
+	}
+	// Compiler identity: resolved path, size and mtime of a binary
+	CBUILDDEF bool __cbuild_cache_compiler_id(const char* cc, cbuild_sb_t* out) {
+		const char* path = NULL;
+		struct stat statbuff;
+		if(strchr(cc, '/') != NULL) {
+			if(stat(cc, &statbuff) == 0) path = cc;
+		} else {
+			const char* env = getenv("PATH");
+			cbuild_sv_t dirs = cbuild_sv_from_cstr(env != NULL ? env : "/usr/bin:/bin");
+			while(dirs.size > 0 && path == NULL) {
+				cbuild_sv_t dir = cbuild_sv_chop_by_delim(&dirs, ':');
+				const char* candidate = cbuild_temp_sprintf(CBuildSVFmt"/%s",
+					CBuildSVArg(dir), cc);
+				if(access(candidate, X_OK) == 0 && stat(candidate, &statbuff) == 0) {
+					path = candidate;
+				}
+			}
+		}
+		if(path == NULL) return false;
+		cbuild_sb_appendf(out, "%s %"PRIu64" %"PRId64, path, (uint64_t)statbuff.st_size,
+			__cbuild_compile_mtime_ns(&statbuff));
+		cbuild_sb_append_null(out);
+		return true;
+	}
+	CBUILDDEF bool __cbuild_cache_place(cbuild_cache_t* cache, const char* entry,
+		const char* dst) {
+		if(cbuild_file_check(dst)) cbuild_file_remove(dst);
+		if(cache->hardlink && link(entry, dst) == 0) {
+			cbuild_stat_invalidate(dst);
+			return true;
+		}
+		// Uses reflink if filesystem supports it
+		return cbuild_file_copy(entry, dst);
+	}
+	// Append target as compiler writes it for '-MQ'
+	CBUILDDEF void __cbuild_cache_quote_target(cbuild_sb_t* sb, const char* target) {
+		size_t slashes = 0;
+		for(const char* c = target; *c != '\0'; c++) {
+			if(*c == ' ' || *c == '\t') {
+				for(size_t i = 0; i < slashes + 1; i++) cbuild_da_append(sb, '\\');
+			} else if(*c == '#') {
+				cbuild_da_append(sb, '\\');
+			} else if(*c == '$') {
+				cbuild_da_append(sb, '$');
+			}
+			slashes = *c == '\\' ? slashes + 1 : 0;
+			cbuild_da_append(sb, *c);
+		}
+	}
+	// Depfile is stored without targets of its first rule, because they
+	// depend on '-o', '-MT' and '-MQ', which are not part of a key. Targets
+	// are written again when depfile is placed.
+	CBUILDDEF bool __cbuild_cache_store_dep(const char* src, const char* entry) {
+		cbuild_file_map_t map = {0};
+		if(!cbuild_file_map(src, &map)) return false;
+		cbuild_sv_t content = map.content;
+		bool ok = false;
+		for(size_t i = 0; i < content.size && !ok; i++) {
+			if(content.data[i] != ':') continue;
+			if(i + 1 < content.size && !isspace((unsigned char)content.data[i + 1])) continue;
+			cbuild_sb_t rules = {0};
+			cbuild_sb_append_sv(&rules, cbuild_sv_from_parts(content.data + i, content.size - i));
+			ok = cbuild_file_write(entry, &rules);
+			cbuild_da_clear(&rules);
+			if(!ok) break;
+		}
+		cbuild_file_unmap(&map);
+		return ok;
+	}
+	CBUILDDEF bool __cbuild_cache_place_dep(const char* entry, cbuild_sv_t target,
+		const char* dst) {
+		cbuild_sb_t rules = {0};
+		if(!cbuild_file_read(entry, &rules)) return false;
+		cbuild_sb_t content = {0};
+		cbuild_sb_append_sv(&content, target);
+		cbuild_sb_append_sv(&content, cbuild_sb_to_sv(rules));
+		cbuild_da_clear(&rules);
+		// Old depfile can be a hard link to an entry, so it is replaced
+		bool ok = cbuild_file_write(dst, &content);
+		cbuild_da_clear(&content);
+		return ok;
+	}
+	CBUILDDEF bool __cbuild_cache_store(const char* src, const char* entry) {
+		const char* tmp = cbuild_temp_sprintf("%s.tmp.%ld", entry, (long)getpid());
+		if(!cbuild_file_copy(src, tmp)) return false;
+		if(rename(tmp, entry) < 0) {
+			cbuild_log_error("Could not rename \"%s\" to \"%s\", error: \"%s\"",
+				tmp, entry, strerror(errno));
+			cbuild_file_remove(tmp);
+			return false;
+		}
+		cbuild_stat_invalidate(entry);
+		return true;
+	}
+	typedef struct __cbuild_cache_file_t {
+		char* path;
+		uint64_t size;
+		int64_t mtime;
+	} __cbuild_cache_file_t;
+	typedef cbuild_da_new(__cbuild_cache_file_t) __cbuild_cache_files_t;
+	CBUILDDEF bool __cbuild_cache_collect(cbuild_dir_walk_func_args_t args) {
+		if(args.type != CBUILD_FTYPE_REGULAR) return true;
+		struct stat statbuff;
+		if(!cbuild_dir_walk_stat(args, &statbuff)) return true;
+		__cbuild_cache_file_t file = {
+			.path = __CBUILD_MALLOC(strlen(args.path) + 1),
+			.size = (uint64_t)statbuff.st_size,
+			.mtime = __cbuild_compile_mtime_ns(&statbuff),
+		};
+		cbuild_assert(file.path != NULL, "Allocation failed.\n");
+		strcpy(file.path, args.path);
+		cbuild_da_append((__cbuild_cache_files_t*)args.context, file);
+		return true;
+	}
+	CBUILDDEF int __cbuild_cache_file_compare(const void* a, const void* b) {
+		const __cbuild_cache_file_t* fa = a;
+		const __cbuild_cache_file_t* fb = b;
+		return (fa->mtime > fb->mtime) - (fa->mtime < fb->mtime);
+	}
+	CBUILDDEF bool cbuild_cache_evict(cbuild_cache_t* cache) {
+		__cbuild_cache_files_t files = {0};
+		if(!cbuild_dir_walk(cache->dir, __cbuild_cache_collect, .context = &files)) {
+			return false;
+		}
+		uint64_t size = 0;
+		cbuild_span_foreach(&files, file) size += file->size;
+		if(cache->max_size != 0 && size > cache->max_size) {
+			qsort(files.data, files.size, sizeof(*files.data), __cbuild_cache_file_compare);
+			uint64_t target = cache->max_size / 10 * 9;
+			for(size_t i = 0; i < files.size && size > target; i++) {
+				if(!cbuild_file_remove(files.data[i].path)) continue;
+				size -= files.data[i].size;
+				cache->evictions++;
+			}
+		}
+		cbuild_span_foreach(&files, file) __CBUILD_FREE(file->path);
+		cbuild_da_clear(&files);
+		cache->__size = size;
+		cache->__size_known = true;
+		return true;
+	}
+	CBUILDDEF bool cbuild_cache_run(cbuild_cache_t* cache, cbuild_cmd_t* cmd) {
+		const char* output = NULL;
+		const char* depfile = NULL;
+		bool compile = false;
+		bool deps = false;
+		// Targets of a depfile
+		cbuild_sb_t target = {0};
+		for(size_t i = 0; i < cmd->size; i++) {
+			if(strcmp(cmd->data[i], "-c") == 0) compile = true;
+			if(strcmp(cmd->data[i], "-MD") == 0 || strcmp(cmd->data[i], "-MMD") == 0) {
+				deps = true;
+			}
+			if(i + 1 >= cmd->size) continue;
+			if(strcmp(cmd->data[i], "-o") == 0) output = cmd->data[i + 1];
+			if(strcmp(cmd->data[i], "-MF") == 0) depfile = cmd->data[i + 1];
+			if(strcmp(cmd->data[i], "-MT") == 0) {
+				if(target.size > 0) cbuild_da_append(&target, ' ');
+				cbuild_sb_append_cstr(&target, cmd->data[i + 1]);
+			}
+		}
+		// Compiler writes '-MQ' targets after '-MT' ones
+		for(size_t i = 0; i + 1 < cmd->size; i++) {
+			if(strcmp(cmd->data[i], "-MQ") != 0) continue;
+			if(target.size > 0) cbuild_da_append(&target, ' ');
+			__cbuild_cache_quote_target(&target, cmd->data[i + 1]);
+		}
+		if(!compile || output == NULL || cmd->size == 0 ||
+			(!cbuild_dir_check(cache->dir) && !cbuild_dir_create(cache->dir))) {
+			cbuild_da_clear(&target);
+			return cbuild_cmd_run(cmd);
+		}
+		size_t checkpoint = cbuild_temp_checkpoint();
+		if(deps && depfile == NULL) {
+			// Without '-MF' compiler replaces suffix of an object with '.d'
+			const char* base = strrchr(output, '/');
+			base = base == NULL ? output : base + 1;
+			const char* dot = strrchr(base, '.');
+			size_t len = dot == NULL ? strlen(output) : (size_t)(dot - output);
+			depfile = cbuild_temp_sprintf("%.*s.d", (int)len, output);
+		}
+		if(target.size == 0) __cbuild_cache_quote_target(&target, output);
+		// Normalized command line and command that preprocesses source
+		cbuild_sb_t meta = {0};
+		cbuild_cmd_t pp = {0};
+		for(size_t i = 0; i < cmd->size; i++) {
+			if(__cbuild_cache_is_output_arg(cmd->data[i])) {
+				i++;
+				continue;
+			}
+			cbuild_sb_append_cstr(&meta, cmd->data[i]);
+			cbuild_sb_append_null(&meta);
+			if(__cbuild_cache_is_dep_flag(cmd->data[i])) continue;
+			cbuild_da_append(&pp, strcmp(cmd->data[i], "-c") == 0 ? "-E" : cmd->data[i]);
+		}
+		bool cacheable = __cbuild_cache_compiler_id(cmd->data[0], &meta);
+		const char* pp_path = cbuild_temp_sprintf("%s/pp.%ld.i", cache->dir, (long)getpid());
+		cbuild_sb_t pp_out = {0};
+		if(cacheable) {
+			cacheable = cbuild_cmd_run(&pp, .file_stdout = pp_path, .no_print_cmd = true) &&
+				cbuild_file_read(pp_path, &pp_out);
+		}
+		if(cbuild_file_check(pp_path)) cbuild_file_remove(pp_path);
+		cbuild_da_clear(&pp);
+		if(!cacheable) {
+			cbuild_da_clear(&meta);
+			cbuild_da_clear(&pp_out);
+			cbuild_da_clear(&target);
+			cbuild_temp_reset(checkpoint);
+			return cbuild_cmd_run(cmd);
+		}
+		// 128 bit key
+		uint64_t k0 = cbuild_map_hash_wyhash_seed(meta.data, meta.size,
+			cbuild_map_hash_wyhash_seed(pp_out.data, pp_out.size, 0));
+		uint64_t k1 = cbuild_map_hash_wyhash_seed(meta.data, meta.size,
+			cbuild_map_hash_wyhash_seed(pp_out.data, pp_out.size, 1));
+		cbuild_da_clear(&meta);
+		cbuild_da_clear(&pp_out);
+		const char* shard = cbuild_temp_sprintf("%s/%02x", cache->dir,
+			(unsigned)(k0 >> 56));
+		const char* entry = cbuild_temp_sprintf("%s/%016"PRIx64"%016"PRIx64".o", shard,
+			k0, k1);
+		const char* entry_dep = cbuild_temp_sprintf("%s/%016"PRIx64"%016"PRIx64".d", shard,
+			k0, k1);
+		if(cbuild_file_check(entry) && (depfile == NULL || cbuild_file_check(entry_dep))) {
+			bool ok = __cbuild_cache_place(cache, entry, output);
+			if(ok && depfile != NULL) {
+				ok = __cbuild_cache_place_dep(entry_dep, cbuild_sb_to_sv(target), depfile);
+			}
+			if(ok) {
+				// For LRU
+				utimes(entry, NULL);
+				cbuild_stat_invalidate(entry);
+				if(depfile != NULL) {
+					utimes(entry_dep, NULL);
+					cbuild_stat_invalidate(entry_dep);
+				}
+				cache->hits++;
+				cmd->size = 0;
+				cbuild_da_clear(&target);
+				cbuild_temp_reset(checkpoint);
+				return true;
+			}
+		}
+		cache->misses++;
+		cbuild_da_clear(&target);
+		if(!cbuild_cmd_run(cmd)) {
+			cbuild_temp_reset(checkpoint);
+			return false;
+		}
+		if(!cbuild_dir_check(shard)) cbuild_dir_create(shard);
+		// Depfile goes first, so object's existence means whole entry exists
+		bool stored = depfile == NULL || __cbuild_cache_store_dep(depfile, entry_dep);
+		if(stored) stored = __cbuild_cache_store(output, entry);
+		if(stored) {
+			cache->stores++;
+			if(cache->max_size != 0) {
+				if(!cache->__size_known) {
+					cbuild_cache_evict(cache);
+				} else {
+					struct stat statbuff;
+					if(stat(entry, &statbuff) == 0) cache->__size += (uint64_t)statbuff.st_size;
+					if(cache->__size > cache->max_size) cbuild_cache_evict(cache);
+				}
+			}
+		}
+		cbuild_temp_reset(checkpoint);
+		return true;
+	}
+#endif // CBUILD_API_*
+CBUILDDEF void cbuild_cache_log_stats(cbuild_cache_t* cache) {
+	size_t total = cache->hits + cache->misses;
+	cbuild_log_info("Cache: %zu hits, %zu misses (%.1f%% hit rate), %zu stores, %zu evictions",
+		cache->hits, cache->misses, total == 0 ? 0.0 : 100.0 * (double)cache->hits / (double)total,
+		cache->stores, cache->evictions);
+}
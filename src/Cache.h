@@ -0,0 +1,69 @@
+#pragma once // For LSP
+//! Local cache of compilation results.
+//!
+//! License: `GPL-3.0-or-later`.
+//!
+//! Cache works similarly to `ccache` in preprocessor mode. Before running a
+//! compiler, source is preprocessed and hashed together with normalized
+//! command line and compiler identity. If an object with such hash is
+//! already in a cache it is placed to the output path and compiler is not
+//! run.
+//!
+//! Only commands that compile single object (have `-c` and `-o`) are cached,
+//! all other commands are just executed. If command writes depfile (with
+//! `-MD` or `-MMD`), depfile is cached too. Its targets are not cached, they
+//! are written again from `-MT`, `-MQ` or `-o`, so same entry can be used
+//! for different outputs.
+//!
+//! # Cache directory layout
+//!
+//! Entries are stored in `<dir>/<xx>/<hash>.o` (and `.d`), where `xx` is
+//! first byte of a hash. New entries are first written to a temporary file
+//! and then renamed into place, so concurrent builds never see partially
+//! written entry. Modification time of an entry is updated on each hit and
+//! used for LRU eviction.
+
+#include "Common.h"
+#include "Command.h"
+
+/// Compilation cache.
+///
+/// Should be zero-initialized, only configuration fields need to be set.
+///
+/// * Configuration:
+///   - [fl:dir] Cache directory. Will be created if missing.
+///   - [fl:max_size] Maximal size of a cache in bytes, `0` means unlimited. When cache grows above this size, least recently used entries are removed until cache is at 90% of this size.
+///   - [fl:hardlink] Place hits using hard links. This is fastest option, but if output is modified in place (eg. with `strip`) cache entry is modified too.
+/// * Statistics:
+///   - [fl:hits] Number of commands that were not executed.
+///   - [fl:misses] Number of commands that were executed.
+///   - [fl:stores] Number of new entries.
+///   - [fl:evictions] Number of removed entries.
+typedef struct cbuild_cache_t {
+	const char* dir;
+	uint64_t max_size;
+	bool hardlink;
+	size_t hits;
+	size_t misses;
+	size_t stores;
+	size_t evictions;
+	// Internal state
+	uint64_t __size; // Estimate of a cache size
+	bool __size_known;
+} cbuild_cache_t;
+/// Run command using a cache. This is synchronous.
+///
+/// Like [`cbuild_cmd_run`](DOC:cbuild_cmd_run) command is reset after execution.
+///
+/// * [pl:cache] Cache.
+/// * [pl:cmd] Compiler command.
+///
+/// [r:] `false`{.c} if command failed.
+CBUILDDEF bool cbuild_cache_run(cbuild_cache_t* cache, cbuild_cmd_t* cmd);
+/// Remove least recently used entries until cache fits into 90% of
+/// [fl:max_size]. Called automatically by [`cbuild_cache_run`](DOC:cbuild_cache_run).
+///
+/// [r:] `false`{.c} on error.
+CBUILDDEF bool cbuild_cache_evict(cbuild_cache_t* cache);
+/// Print cache statistics as `INFO` log.
+CBUILDDEF void cbuild_cache_log_stats(cbuild_cache_t* cache);
@@ -44,8 +44,14 @@ CBUILDDEF cbuild_sb_t cbuild_cmd_to_sb(cbuild_cmd_t cmd) {
 	return sb;
 }
 #if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
-	// We needs opts here, because I dont want to bloat function signature when I will add more call-level flags
-	CBUILDDEF cbuild_proc_t __cbuild_cmd_run_opt(cbuild_cmd_t* cmd,
+	#if defined(CBUILD_OS_MACOS)
+		#define __cbuild_environ (*_NSGetEnviron())
+	#else
+		extern char** environ;
+		#define __cbuild_environ environ
+	#endif // CBUILD_OS_MACOS
+	// Fork path. Used when child needs to do something 'posix_spawn' can not.
+	CBUILDDEF cbuild_proc_t __cbuild_cmd_run_fork(cbuild_cmd_t* cmd,
 		struct cbuild_cmd_opts_t* opts, cbuild_fd_t fdstdin, 
 		cbuild_fd_t fdstdout, cbuild_fd_t fdstderr) {
 		// Get args
@@ -60,7 +66,6 @@ CBUILDDEF cbuild_sb_t cbuild_cmd_to_sb(cbuild_cmd_t cmd) {
 			return CBUILD_INVALID_PROC;
 		}
 		if(proc == 0) {
-			fflush(NULL);
 			// Setup stdin, stdout and stderr
 			if(fdstdin != CBUILD_INVALID_FD) {
 				if(dup2(fdstdin, STDIN_FILENO) < 0) {
@@ -108,6 +113,86 @@ CBUILDDEF cbuild_sb_t cbuild_cmd_to_sb(cbuild_cmd_t cmd) {
 		cbuild_da_clear(&argv);
 		return proc;
 	}
+	// Children that should be killed when we exit. Used by 'posix_spawn' path,
+	// because it can not set 'PR_SET_PDEATHSIG'.
+	cbuild_proclist_t __cbuild_cmd_autokill_procs = {0};
+	CBUILDDEF void __cbuild_cmd_autokill_atexit(void) {
+		for(size_t i = 0; i < __cbuild_cmd_autokill_procs.size; i++) {
+			cbuild_proc_t proc = __cbuild_cmd_autokill_procs.data[i];
+			// Only kill processes that are still our unreaped children,
+			// otherwise pid could be already reused.
+			int status = 0;
+			if(waitpid(proc, &status, WNOHANG) == 0) kill(proc, SIGKILL);
+		}
+		cbuild_da_clear(&__cbuild_cmd_autokill_procs);
+	}
+	CBUILDDEF void __cbuild_cmd_autokill_register(cbuild_proc_t proc) {
+		if(__cbuild_cmd_autokill_procs.data == NULL) {
+			atexit(__cbuild_cmd_autokill_atexit);
+		}
+		// Drop already reaped processes, so list does not grow without bound
+		for(size_t i = 0; i < __cbuild_cmd_autokill_procs.size;) {
+			if(kill(__cbuild_cmd_autokill_procs.data[i], 0) < 0 && errno == ESRCH) {
+				cbuild_da_remove_unordered(&__cbuild_cmd_autokill_procs, i);
+			} else {
+				i++;
+			}
+		}
+		cbuild_da_append(&__cbuild_cmd_autokill_procs, proc);
+	}
+	// Spawn path. Does not copy page tables of the parent.
+	CBUILDDEF cbuild_proc_t __cbuild_cmd_run_spawn(cbuild_cmd_t* cmd,
+		struct cbuild_cmd_opts_t* opts, cbuild_fd_t fdstdin, 
+		cbuild_fd_t fdstdout, cbuild_fd_t fdstderr) {
+		cbuild_cmd_t argv = {0};
+		cbuild_da_append_arr(&argv, cmd->data, cmd->size);
+		cbuild_da_append(&argv, (char*)NULL);
+		posix_spawn_file_actions_t actions;
+		int err = posix_spawn_file_actions_init(&actions);
+		if(err == 0 && fdstdin != CBUILD_INVALID_FD) {
+			err = posix_spawn_file_actions_adddup2(&actions, fdstdin, STDIN_FILENO);
+		}
+		if(err == 0 && fdstdout != CBUILD_INVALID_FD) {
+			err = posix_spawn_file_actions_adddup2(&actions, fdstdout, STDOUT_FILENO);
+		}
+		if(err == 0 && fdstderr != CBUILD_INVALID_FD) {
+			err = posix_spawn_file_actions_adddup2(&actions, fdstderr, STDERR_FILENO);
+		}
+		cbuild_proc_t proc = CBUILD_INVALID_PROC;
+		if(err != 0) {
+			cbuild_log_error("Could not setup redirects for child process, error: \"%s\"",
+				strerror(err));
+		} else {
+			err = posix_spawnp(&proc, argv.data[0], &actions, NULL,
+				(char* const*)argv.data, __cbuild_environ);
+			if(err != 0) {
+				cbuild_log_error("Could not execute command in child process, error: \"%s\"",
+					strerror(err));
+				proc = CBUILD_INVALID_PROC;
+			} else if(opts->autokill) {
+				__cbuild_cmd_autokill_register(proc);
+			}
+		}
+		posix_spawn_file_actions_destroy(&actions);
+		cbuild_da_clear(&argv);
+		return proc;
+	}
+	// We needs opts here, because I dont want to bloat function signature when I will add more call-level flags
+	CBUILDDEF cbuild_proc_t __cbuild_cmd_run_opt(cbuild_cmd_t* cmd,
+		struct cbuild_cmd_opts_t* opts, cbuild_fd_t fdstdin, 
+		cbuild_fd_t fdstdout, cbuild_fd_t fdstderr) {
+		// Child should not get our buffered output
+		fflush(NULL);
+		// Child can change any file while it runs
+		cbuild_stat_invalidate_all();
+		// Linux can do real autokill, but only from inside of a child
+		#if defined(CBUILD_API_POSIX) && defined(CBUILD_OS_LINUX)
+			if(opts->autokill) {
+				return __cbuild_cmd_run_fork(cmd, opts, fdstdin, fdstdout, fdstderr);
+			}
+		#endif // Extension check
+		return __cbuild_cmd_run_spawn(cmd, opts, fdstdin, fdstdout, fdstderr);
+	}
 #endif // CBUILD_API_*
 CBUILDDEF bool cbuild_cmd_run_opt(cbuild_cmd_t* cmd, struct cbuild_cmd_opts_t opts) {
 	if(cmd->size == 0) {
@@ -41,7 +41,7 @@ CBUILDDEF cbuild_sb_t cbuild_cmd_to_sb(cbuild_cmd_t cmd);
 ///   - [fl:file_stderr] Redirect `stderr` to some file.
 /// * Miscellaneous lags:
 ///   - [fl:no_reset] By default `size` filed of command is reset. This flag disables this feature.
-///   - [fl:autokill] Works only on Linux. Automatically kills process if parent dies.
+///   - [fl:autokill] Automatically kills process if parent dies. Only Linux can do this on crash of a parent, other platforms kill process from `atexit`{.c} handler.
 ///   - [fl:no_print_cmd] By default command is printed as `TRACE` log. This flag disable this log message.
 ///   - [fl:no_abort_on_error] If `procs` is used and internal scheduler decides to wait on free slot do not abort if that command exits with error.
 struct cbuild_cmd_opts_t {
@@ -70,6 +70,12 @@ struct cbuild_cmd_opts_t {
 	};
 };
 /// Run command. This function is semi-internal.
+///
+/// ::: note
+/// Commands are started using `posix_spawnp`{.c}, so large parent process
+/// does not need to copy its page tables. On Linux [fl:autokill] requires
+/// `fork`{.c}, so it is used instead.
+/// :::
 CBUILDDEF bool cbuild_cmd_run_opt(cbuild_cmd_t* cmd, struct cbuild_cmd_opts_t opts);
 /// Run command.
 ///
@@ -43,6 +43,14 @@
 //! By default CBuild provides _debug_ logging from most of its modules. All logging goes
 //! trough `cbuild_log`, so if your app does no need any messages in terminal you can
 //! disable CBuild's logger (which will hide all messages).
+//!
+//! # Threads
+//!
+//! On POSIX APIs CBuild uses POSIX threads, so apps that use it should be
+//! compiled and linked with `-pthread` (`CBUILD_CARGS_MT`). They are used by
+//! stat cache, parallel directory walk, tree copy and remove, concurrent map,
+//! process tracking and file writer. `cbuild_selfrebuild` adds this flag by
+//! default, but custom `CBUILD_SELFREBUILD_ARGS` should include it too.
 
 //@ cbuild-cc-defines
 #if !defined(CBUILD_CC_DEFINED)
@@ -158,12 +166,17 @@
 	#include <dlfcn.h>
 	#include <errno.h>
 	#include <fcntl.h>
+	#include <poll.h>
+	#include <pthread.h>
 	#include <termios.h>
 	#include <signal.h>
+	#include <spawn.h>
 	#include <sys/mman.h>
+	#include <sys/resource.h>
 	#include <sys/stat.h>
 	#include <sys/time.h>
 	#include <sys/types.h>
+	#include <sys/uio.h>
 	#include <sys/wait.h>
 	#include <sys/ioctl.h>
 	#include <unistd.h>
@@ -179,6 +192,10 @@
 			#define CBUILD_OS_LINUX_MUSL
 		#endif // Libc select
 		#include <sys/prctl.h>
+		#include <sys/inotify.h>
+		#include <sys/sendfile.h>
+		#include <sys/syscall.h>
+		#include <sys/sysmacros.h>
 	#endif // CBUILD_OS_LINUX
 	/// Process handle
 	typedef pid_t cbuild_proc_t;
@@ -205,12 +222,17 @@
 	#include <dlfcn.h>
 	#include <errno.h>
 	#include <fcntl.h>
+	#include <poll.h>
+	#include <pthread.h>
 	#include <termios.h>
 	#include <signal.h>
+	#include <spawn.h>
 	#include <sys/mman.h>
+	#include <sys/resource.h>
 	#include <sys/stat.h>
 	#include <sys/time.h>
 	#include <sys/types.h>
+	#include <sys/uio.h>
 	#include <sys/wait.h>
 	#include <sys/ioctl.h>
 	#include <unistd.h>
@@ -260,6 +282,14 @@
 #include <string.h>
 #include <time.h>
 #include <regex.h> // mingw seems to provide it too
+// SIMD is optional, every user has scalar fallback
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#elif defined(__SSE2__)
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+	#include <arm_neon.h>
+#endif // SIMD
 
 //! # Configuration values [line:cbuild-configuration]
 //!
@@ -290,6 +320,47 @@
 	/// Type: `size_t`{.c}.
 	#define CBUILD_FS_TMP_SIZE ((size_t)32 * (size_t)1024 * (size_t)1024)
 #endif // CBUILD_FS_TMP_SIZE
+#ifndef CBUILD_FILE_MAP_MIN
+	/// Minimal size of a file that `cbuild_file_map` maps into memory.
+	/// Smaller files are read into a pooled buffer of this size.
+	///
+	/// Type: `size_t`{.c}.
+	#define CBUILD_FILE_MAP_MIN ((size_t)64 * (size_t)1024)
+#endif // CBUILD_FILE_MAP_MIN
+#ifndef CBUILD_FILE_WRITER_SIZE
+	/// Default size of a buffer of a file writer. Bigger writes bypass buffer.
+	///
+	/// Type: `size_t`{.c}.
+	#define CBUILD_FILE_WRITER_SIZE ((size_t)64 * (size_t)1024)
+#endif // CBUILD_FILE_WRITER_SIZE
+#ifndef CBUILD_FS_BATCH_SIZE
+	/// Maximal number of file system operations submitted to kernel at once
+	/// (size of `io_uring`{.c} submission queue).
+	///
+	/// Type: `unsigned`{.c}.
+	#define CBUILD_FS_BATCH_SIZE 128u
+#endif // CBUILD_FS_BATCH_SIZE
+#ifndef CBUILD_FS_URING
+	/// Use `io_uring`{.c} for batches of file system operations on Linux.
+	/// If it is not available at runtime, operations are executed one by one.
+	///
+	/// Type: `bool`{.c}.
+	#define CBUILD_FS_URING 1
+#endif // CBUILD_FS_URING
+#ifndef CBUILD_WATCH_DEBOUNCE
+	/// Default time in milliseconds that file watcher waits after the last
+	/// change before reporting. Changes inside this window are coalesced.
+	///
+	/// Type: `int`{.c}.
+	#define CBUILD_WATCH_DEBOUNCE 50
+#endif // CBUILD_WATCH_DEBOUNCE
+#ifndef CBUILD_WATCH_INTERVAL
+	/// Default interval in milliseconds between rescans of a polling file
+	/// watcher.
+	///
+	/// Type: `int`{.c}.
+	#define CBUILD_WATCH_INTERVAL 500
+#endif // CBUILD_WATCH_INTERVAL
 #ifndef CBUILD_TEMP_ARENA_SIZE
 	/// Size of temporary allocator.
 	///
@@ -297,10 +368,11 @@
 	#define CBUILD_TEMP_ARENA_SIZE ((size_t)8 * (size_t)1024 * (size_t)1024)
 #endif // CBUILD_TEMP_ARENA_SIZE
 #ifndef CBUILD_SELFREBUILD_ARGS
-	/// Default arguments for `cbuild_selfrebuild`.
+	/// Default arguments for `cbuild_selfrebuild`. Should include
+	/// `CBUILD_CARGS_MT`, as CBuild depends on POSIX threads.
 	///
 	/// Type: Comma-separated list of `const char*`{.c}.
-	#define CBUILD_SELFREBUILD_ARGS CBUILD_CARGS_WARN
+	#define CBUILD_SELFREBUILD_ARGS CBUILD_CARGS_WARN, CBUILD_CARGS_MT
 #endif // CBUILD_SEFLREBUILD_ARGS
 #ifndef CBUILD_LOG_MIN_LEVEL
 	/// Minimal log level for `cbuild_log`.
@@ -308,6 +380,19 @@
 	/// [Type](DOC:cbuild_log_level_t): `cbuild_log_level_t`.
 	#define CBUILD_LOG_MIN_LEVEL CBUILD_LOG_ERROR
 #endif // CBUILD_LOG_MIN_LEVEL
+#ifndef CBUILD_STAT_CACHE
+	/// Enable process-wide stat cache. Set to `0` to always call `stat`{.c}.
+	///
+	/// Type: `bool`{.c}.
+	#define CBUILD_STAT_CACHE 1
+#endif // CBUILD_STAT_CACHE
+#ifndef CBUILD_BUILDLOG_COMPACT_MIN
+	/// Minimal number of records in build log before it is compacted on open.
+	/// Log is compacted only if more than half of records are overridden.
+	///
+	/// Type: `size_t`{.c}.
+	#define CBUILD_BUILDLOG_COMPACT_MIN (size_t)1024
+#endif // CBUILD_BUILDLOG_COMPACT_MIN
 #ifndef CBUILD_GLOB_CAPTURE_COUNT
 	/// Number of "capture groups" glob supports. This is used for underlying regex engine.
 	#define CBUILD_GLOB_CAPTURE_COUNT 10
@@ -321,8 +406,50 @@
 	/// It can be overridden at runtime for specific map instance. 
 	/// :::
 	///
-	#define CBUILD_MAP_DEFAULT_HASH cbuild_map_hash_djb2
+	#define CBUILD_MAP_DEFAULT_HASH cbuild_map_hash_wyhash
 #endif // CBUILD_MAP_DEFAULT_HASH
+#ifndef CBUILD_MAP_MAX_LOAD
+	/// Maximum load factor of a map with counters, in percents. Both used
+	/// and deleted slots are counted. Should be in range `(0, 100]`.
+	///
+	/// Type: `size_t`{.c}.
+	#define CBUILD_MAP_MAX_LOAD 75
+#endif // CBUILD_MAP_MAX_LOAD
+#ifndef CBUILD_MAP_SIMD
+	/// Probe control bytes of swiss map and hash long inputs with XXH3 using
+	/// AVX2, SSE2 or NEON if they are available. If disabled, scalar code is
+	/// used.
+	///
+	/// Type: `bool`{.c}.
+	#define CBUILD_MAP_SIMD 1
+#endif // CBUILD_MAP_SIMD
+#ifndef CBUILD_INTERN_BLOCK_SIZE
+	/// Size of a block string interning pool stores strings in. Longer strings
+	/// get a block of their own.
+	///
+	/// Type: `size_t`{.c}.
+	#define CBUILD_INTERN_BLOCK_SIZE (size_t)(64 * 1024)
+#endif // CBUILD_INTERN_BLOCK_SIZE
+#ifndef CBUILD_INTERN_SHARDS
+	/// Number of shards of a threaded string interning pool. Rounded up to
+	/// power of 2.
+	///
+	/// Type: `size_t`{.c}.
+	#define CBUILD_INTERN_SHARDS 16
+#endif // CBUILD_INTERN_SHARDS
+#ifndef CBUILD_CMAP_SHARDS
+	/// Number of shards of a concurrent map. Rounded up to power of 2.
+	///
+	/// Type: `size_t`{.c}.
+	#define CBUILD_CMAP_SHARDS 64
+#endif // CBUILD_CMAP_SHARDS
+#ifndef CBUILD_BTREE_NODE_SIZE
+	/// Size of keys array of a B-tree node in bytes. Number of keys in a node is
+	/// this divided by key size, but at least 4.
+	///
+	/// Type: `size_t`{.c}.
+	#define CBUILD_BTREE_NODE_SIZE ((size_t)512)
+#endif // CBUILD_BTREE_NODE_SIZE
 #ifndef CBUILDDEF
 	/// This is prepended to all cbuild's functions. Can be set to eg. `static inline`
 	/// for build that use only one translation unit.
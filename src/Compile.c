@@ -7,6 +7,9 @@
 #include "DynArray.h"
 #include "FS.h"
 #include "Command.h"
+#include "Map.h"
+#include "StringView.h"
+#include "Proc.h"
 CBUILDDEF void __cbuild_int_compile_mark_exec(const char* file);
 #if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
 	CBUILDDEF void __cbuild_int_compile_mark_exec(const char* file) {
@@ -15,6 +18,7 @@ CBUILDDEF void __cbuild_int_compile_mark_exec(const char* file);
 			cbuild_log_error("Could not mark file \"%s\" as executable, error: \"%s\".",
 				file, strerror(errno));
 		}
+		cbuild_stat_invalidate(file);
 	}
 #endif // CBUILD_API_*
 void (*cbuild_selfrebuild_hook)(cbuild_cmd_t* cmd) = NULL;
@@ -75,15 +79,40 @@ CBUILDDEF void __cbuild_selfrebuild(int argc, char** argv,
 	exit(0);
 }
 #if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
+	// 'st_mtim' is only in POSIX.1-2008, older systems have 1 second resolution
+	#if defined(CBUILD_OS_MACOS) || defined(CBUILD_API_POSIX) || \
+		_POSIX_C_SOURCE >= 200809L
+		#define __CBUILD_MTIME_NS
+	#endif // Feature check
+	CBUILDDEF int64_t __cbuild_compile_mtime_ns(const struct stat* statbuff) {
+		#if defined(CBUILD_OS_MACOS)
+			return (int64_t)statbuff->st_mtimespec.tv_sec * 1000000000ll +
+				statbuff->st_mtimespec.tv_nsec;
+		#elif defined(__CBUILD_MTIME_NS)
+			return (int64_t)statbuff->st_mtim.tv_sec * 1000000000ll +
+				statbuff->st_mtim.tv_nsec;
+		#else
+			return (int64_t)statbuff->st_mtime * 1000000000ll;
+		#endif // Platform select
+	}
+	// With 1 second resolution files from the same second can not be ordered,
+	// so input is treated as newer to not miss a rebuild
+	CBUILDDEF bool __cbuild_compile_mtime_newer(int64_t input, int64_t output) {
+		#if defined(__CBUILD_MTIME_NS)
+			return input > output;
+		#else
+			return input >= output;
+		#endif // Feature check
+	}
 	CBUILDDEF int cbuild_compare_mtime(const char* output, const char* input) {
 		struct stat statbuff;
-		if(stat(input, &statbuff) < 0) {
+		if(!cbuild_stat(input, &statbuff)) {
 			cbuild_log_error("Could not stat file \"%s\", error: \"%s\"",
 				input, strerror(errno));
 			return -1;
 		}
-		time_t in_mtime = statbuff.st_mtime;
-		if(stat(output, &statbuff) < 0) {
+		int64_t in_mtime = __cbuild_compile_mtime_ns(&statbuff);
+		if(!cbuild_stat(output, &statbuff)) {
 			if(errno == ENOENT) {
 				return 1;
 			}
@@ -91,7 +120,7 @@ CBUILDDEF void __cbuild_selfrebuild(int argc, char** argv,
 				output, strerror(errno));
 			return -1;
 		}
-		if(in_mtime > statbuff.st_mtime) {
+		if(__cbuild_compile_mtime_newer(in_mtime, __cbuild_compile_mtime_ns(&statbuff))) {
 			return 1;
 		} else {
 			return 0;
@@ -111,3 +140,511 @@ CBUILDDEF int cbuild_compare_mtime_many(const char* output, const char** inputs,
 	}
 	return ret;
 }
+#if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
+	// Unique file checked by bulk compare
+	typedef struct __cbuild_bulk_file_t {
+		int64_t mtime;
+		int error;
+	} __cbuild_bulk_file_t;
+	// Lookup of a file, entries are sorted by directory
+	typedef struct __cbuild_bulk_entry_t {
+		const char* path;
+		size_t dir_len; // 0 for files in current directory
+		size_t file;
+	} __cbuild_bulk_entry_t;
+	typedef struct __cbuild_bulk_t {
+		__cbuild_bulk_file_t* files;
+		__cbuild_bulk_entry_t* entries;
+		size_t* groups; // Start of each directory, plus end of last one
+		size_t num_groups;
+		size_t workers;
+	} __cbuild_bulk_t;
+	typedef struct __cbuild_bulk_worker_t {
+		__cbuild_bulk_t* bulk;
+		size_t index;
+		pthread_t thread;
+	} __cbuild_bulk_worker_t;
+	typedef struct __cbuild_bulk_pair_t {
+		const char* key;
+		size_t file;
+		cbuild_map_tombstone_t tombstone;
+	} __cbuild_bulk_pair_t;
+	CBUILDDEF int __cbuild_bulk_entry_compare(const void* a, const void* b) {
+		const __cbuild_bulk_entry_t* ea = a;
+		const __cbuild_bulk_entry_t* eb = b;
+		if(ea->dir_len != eb->dir_len) return ea->dir_len < eb->dir_len ? -1 : 1;
+		return memcmp(ea->path, eb->path, ea->dir_len);
+	}
+	CBUILDDEF void __cbuild_bulk_stat_group(__cbuild_bulk_t* bulk, size_t group) {
+		__cbuild_bulk_entry_t* first = &bulk->entries[bulk->groups[group]];
+		__cbuild_bulk_entry_t* last = &bulk->entries[bulk->groups[group + 1]];
+		#if defined(__CBUILD_STAT_AT)
+			const char* dir = ".";
+			char* dir_buff = NULL;
+			if(first->dir_len > 0) {
+				dir_buff = __CBUILD_MALLOC(first->dir_len + 1);
+				cbuild_assert(dir_buff != NULL, "Allocation failed.\n");
+				memcpy(dir_buff, first->path, first->dir_len);
+				dir_buff[first->dir_len] = '\0';
+				dir = dir_buff;
+			}
+			int dirfd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+			int dir_error = dirfd < 0 ? errno : 0;
+			__CBUILD_FREE(dir_buff);
+		#endif // __CBUILD_STAT_AT
+		for(__cbuild_bulk_entry_t* it = first; it < last; it++) {
+			__cbuild_bulk_file_t* file = &bulk->files[it->file];
+			const char* name = it->path + it->dir_len;
+			if(*name == '/') name++;
+			#if defined(__CBUILD_STAT_AT)
+				if(*name == '\0') {
+					// Path ends with '/', so it should be resolved as a whole
+				} else if(dirfd < 0) {
+					file->error = dir_error;
+					continue;
+				} else {
+					#if defined(CBUILD_OS_LINUX) && defined(STATX_MTIME)
+						struct statx statxbuff;
+						if(statx(dirfd, name, 0, STATX_MTIME, &statxbuff) < 0) {
+							file->error = errno;
+						} else {
+							file->mtime = (int64_t)statxbuff.stx_mtime.tv_sec * 1000000000ll +
+								statxbuff.stx_mtime.tv_nsec;
+						}
+					#else
+						struct stat statbuff;
+						if(fstatat(dirfd, name, &statbuff, 0) < 0) {
+							file->error = errno;
+						} else {
+							file->mtime = __cbuild_compile_mtime_ns(&statbuff);
+						}
+					#endif // Extension check
+					continue;
+				}
+			#endif // __CBUILD_STAT_AT
+			struct stat statbuff;
+			if(stat(it->path, &statbuff) < 0) {
+				file->error = errno;
+			} else {
+				file->mtime = __cbuild_compile_mtime_ns(&statbuff);
+			}
+		}
+		#if defined(__CBUILD_STAT_AT)
+			if(dirfd >= 0) close(dirfd);
+		#endif // __CBUILD_STAT_AT
+	}
+	CBUILDDEF void* __cbuild_bulk_worker(void* arg) {
+		__cbuild_bulk_worker_t* worker = arg;
+		__cbuild_bulk_t* bulk = worker->bulk;
+		for(size_t g = worker->index; g < bulk->num_groups; g += bulk->workers) {
+			__cbuild_bulk_stat_group(bulk, g);
+		}
+		return NULL;
+	}
+	// Stat each unique path once, relative to its directory. 'files' receives
+	// result for each path, in order.
+	CBUILDDEF void __cbuild_compile_stat_bulk(const char** paths, size_t num_paths,
+		__cbuild_bulk_file_t* files, int jobs) {
+		if(num_paths == 0) return;
+		// Deduplicate paths, 'refs' holds file for each path
+		struct {
+			__cbuild_bulk_pair_t* data;
+			size_t size;
+			size_t capacity;
+			cbuild_map_hash_t hash;
+			cbuild_map_keycmp_t keycmp;
+		} unique = {0};
+		cbuild_map_init_cstr(&unique);
+		cbuild_map_resize(&unique, num_paths * 2);
+		size_t* refs = __CBUILD_MALLOC(num_paths * sizeof(size_t));
+		cbuild_assert(refs != NULL, "Allocation failed.\n");
+		__cbuild_bulk_t bulk = {0};
+		bulk.entries = __CBUILD_MALLOC(num_paths * sizeof(__cbuild_bulk_entry_t));
+		cbuild_assert(bulk.entries != NULL, "Allocation failed.\n");
+		size_t num_files = 0;
+		for(size_t i = 0; i < num_paths; i++) {
+			const char* path = paths[i];
+			__cbuild_bulk_pair_t* pair = cbuild_map_get(&unique, path);
+			if(pair->file == 0) {
+				const char* slash = strrchr(path, '/');
+				bulk.entries[num_files] = (__cbuild_bulk_entry_t){
+					.path = path,
+					.dir_len = slash == NULL ? 0 : (slash == path ? 1 : (size_t)(slash - path)),
+					.file = num_files,
+				};
+				pair->file = ++num_files; // 0 marks new pair
+			}
+			refs[i] = pair->file - 1;
+		}
+		cbuild_da_clear(&unique);
+		bulk.files = __CBUILD_MALLOC(num_files * sizeof(__cbuild_bulk_file_t));
+		cbuild_assert(bulk.files != NULL, "Allocation failed.\n");
+		memset(bulk.files, 0, num_files * sizeof(__cbuild_bulk_file_t));
+		// Group by directory
+		qsort(bulk.entries, num_files, sizeof(__cbuild_bulk_entry_t),
+			__cbuild_bulk_entry_compare);
+		bulk.groups = __CBUILD_MALLOC((num_files + 1) * sizeof(size_t));
+		cbuild_assert(bulk.groups != NULL, "Allocation failed.\n");
+		for(size_t i = 0; i < num_files; i++) {
+			if(i == 0 || __cbuild_bulk_entry_compare(&bulk.entries[i - 1],
+					&bulk.entries[i]) != 0) {
+				bulk.groups[bulk.num_groups++] = i;
+			}
+		}
+		bulk.groups[bulk.num_groups] = num_files;
+		// Stat everything
+		if(jobs < 0) jobs = cbuild_nproc();
+		bulk.workers = jobs < 1 ? 1 : (size_t)jobs;
+		if(bulk.workers > bulk.num_groups) bulk.workers = bulk.num_groups;
+		__cbuild_bulk_worker_t* workers =
+			__CBUILD_MALLOC(bulk.workers * sizeof(__cbuild_bulk_worker_t));
+		cbuild_assert(workers != NULL, "Allocation failed.\n");
+		bool* started = __CBUILD_MALLOC(bulk.workers * sizeof(bool));
+		cbuild_assert(started != NULL, "Allocation failed.\n");
+		for(size_t i = 0; i < bulk.workers; i++) {
+			workers[i].bulk = &bulk;
+			workers[i].index = i;
+			started[i] = i > 0 &&
+				pthread_create(&workers[i].thread, NULL, __cbuild_bulk_worker, &workers[i]) == 0;
+		}
+		for(size_t i = 0; i < bulk.workers; i++) {
+			if(!started[i]) __cbuild_bulk_worker(&workers[i]);
+		}
+		for(size_t i = 0; i < bulk.workers; i++) {
+			if(started[i]) pthread_join(workers[i].thread, NULL);
+		}
+		__CBUILD_FREE(started);
+		__CBUILD_FREE(workers);
+		for(size_t i = 0; i < num_paths; i++) files[i] = bulk.files[refs[i]];
+		__CBUILD_FREE(refs);
+		__CBUILD_FREE(bulk.files);
+		__CBUILD_FREE(bulk.entries);
+		__CBUILD_FREE(bulk.groups);
+	}
+	CBUILDDEF int cbuild_compare_mtime_bulk_opt(const cbuild_mtime_target_t* targets,
+		size_t num_targets, uint8_t* stale, struct cbuild_compare_mtime_bulk_opts_t opts) {
+		memset(stale, 0, (num_targets + 7) / 8);
+		size_t total = 0;
+		for(size_t i = 0; i < num_targets; i++) total += 1 + targets[i].num_inputs;
+		if(total == 0) return 0;
+		// Output and each input of each target, in order
+		const char** paths = __CBUILD_MALLOC(total * sizeof(const char*));
+		cbuild_assert(paths != NULL, "Allocation failed.\n");
+		__cbuild_bulk_file_t* files = __CBUILD_MALLOC(total * sizeof(__cbuild_bulk_file_t));
+		cbuild_assert(files != NULL, "Allocation failed.\n");
+		size_t r = 0;
+		for(size_t i = 0; i < num_targets; i++) {
+			paths[r++] = targets[i].output;
+			for(size_t j = 0; j < targets[i].num_inputs; j++) paths[r++] = targets[i].inputs[j];
+		}
+		__cbuild_compile_stat_bulk(paths, total, files, opts.jobs);
+		__CBUILD_FREE(paths);
+		// Evaluate targets
+		int ret = 0;
+		bool error = false;
+		r = 0;
+		for(size_t i = 0; i < num_targets; i++) {
+			__cbuild_bulk_file_t* out = &files[r++];
+			bool is_stale = false;
+			if(out->error != 0) {
+				is_stale = true;
+				if(out->error != ENOENT) {
+					cbuild_log_error("Could not stat file \"%s\", error: \"%s\"",
+						targets[i].output, strerror(out->error));
+					error = true;
+				}
+			}
+			for(size_t j = 0; j < targets[i].num_inputs; j++) {
+				__cbuild_bulk_file_t* in = &files[r++];
+				if(in->error != 0) {
+					cbuild_log_error("Could not stat file \"%s\", error: \"%s\"",
+						targets[i].inputs[j], strerror(in->error));
+					error = true;
+					is_stale = true;
+				} else if(out->error == 0 &&
+					__cbuild_compile_mtime_newer(in->mtime, out->mtime)) {
+					is_stale = true;
+				}
+			}
+			if(is_stale) {
+				stale[i / 8] = (uint8_t)(stale[i / 8] | (1u << (i % 8)));
+				ret++;
+			}
+		}
+		__CBUILD_FREE(files);
+		return error ? -1 : ret;
+	}
+#endif // CBUILD_API_*
+CBUILDDEF void __cbuild_depfile_token(cbuild_depfile_t* depfile, size_t start,
+	bool* targets) {
+	cbuild_sb_t* sb = &depfile->strings;
+	if(*targets) {
+		// Targets end with ':', after that prerequisites follow
+		if(sb->size > start && sb->data[sb->size - 1] == ':') *targets = false;
+		sb->size = start;
+		return;
+	}
+	if(sb->size == start) return;
+	cbuild_sb_append_null(sb);
+	cbuild_da_append(&depfile->deps, start);
+}
+CBUILDDEF void cbuild_depfile_parse(cbuild_depfile_t* depfile, cbuild_sv_t content) {
+	cbuild_sb_t* sb = &depfile->strings;
+	bool targets = true;
+	size_t start = sb->size;
+	for(size_t i = 0; i < content.size; i++) {
+		char c = content.data[i];
+		if(c == '\\') {
+			// Line continuation
+			if(i + 1 < content.size && content.data[i + 1] == '\n') {
+				__cbuild_depfile_token(depfile, start, &targets);
+				start = sb->size;
+				i++;
+				continue;
+			}
+			if(i + 2 < content.size && content.data[i + 1] == '\r' &&
+				content.data[i + 2] == '\n') {
+				__cbuild_depfile_token(depfile, start, &targets);
+				start = sb->size;
+				i += 2;
+				continue;
+			}
+			// Same rules as make - 2n backslashes before space are n literal
+			// backslashes, 2n+1 also escape that space
+			size_t n = 0;
+			while(i + n < content.size && content.data[i + n] == '\\') n++;
+			char next = i + n < content.size ? content.data[i + n] : '\0';
+			if(next == ' ' || next == '#') {
+				for(size_t j = 0; j < n / 2; j++) cbuild_da_append(sb, '\\');
+				if(n % 2 == 1) {
+					cbuild_da_append(sb, next);
+					i++;
+				}
+			} else {
+				for(size_t j = 0; j < n; j++) cbuild_da_append(sb, '\\');
+			}
+			i += n - 1;
+		} else if(c == '$' && i + 1 < content.size && content.data[i + 1] == '$') {
+			cbuild_da_append(sb, '$');
+			i++;
+		} else if(c == ' ' || c == '\t' || c == '\r') {
+			__cbuild_depfile_token(depfile, start, &targets);
+			start = sb->size;
+		} else if(c == '\n') {
+			__cbuild_depfile_token(depfile, start, &targets);
+			start = sb->size;
+			targets = true;
+		} else {
+			cbuild_da_append(sb, c);
+		}
+	}
+	__cbuild_depfile_token(depfile, start, &targets);
+}
+CBUILDDEF bool cbuild_depfile_read(cbuild_depfile_t* depfile, const char* path) {
+	cbuild_file_map_t map = {0};
+	if(!cbuild_file_map(path, &map)) return false;
+	cbuild_depfile_parse(depfile, map.content);
+	cbuild_file_unmap(&map);
+	return true;
+}
+CBUILDDEF void cbuild_depfile_clear(cbuild_depfile_t* depfile) {
+	cbuild_da_clear(&depfile->strings);
+	cbuild_da_clear(&depfile->deps);
+}
+#if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
+	CBUILDDEF int cbuild_compare_mtime_depfile(const char* output, const char* depfile) {
+		struct stat statbuff;
+		if(!cbuild_stat(output, &statbuff)) {
+			if(errno == ENOENT) {
+				return 1;
+			}
+			cbuild_log_error("Could not stat file \"%s\", error: \"%s\"",
+				output, strerror(errno));
+			return -1;
+		}
+		int64_t out_mtime = __cbuild_compile_mtime_ns(&statbuff);
+		if(!cbuild_file_check(depfile)) return 1;
+		cbuild_depfile_t deps = {0};
+		if(!cbuild_depfile_read(&deps, depfile)) return -1;
+		int ret = 0;
+		for(size_t i = 0; i < deps.deps.size; i++) {
+			const char* path = cbuild_depfile_get(&deps, i);
+			if(!cbuild_stat(path, &statbuff)) {
+				if(errno == ENOENT) {
+					ret++;
+					continue;
+				}
+				cbuild_log_error("Could not stat file \"%s\", error: \"%s\"",
+					path, strerror(errno));
+				ret = -1;
+				break;
+			}
+			if(__cbuild_compile_mtime_newer(__cbuild_compile_mtime_ns(&statbuff), out_mtime)) {
+				ret++;
+			}
+		}
+		cbuild_depfile_clear(&deps);
+		return ret;
+	}
+#endif //CBUILD_API_*
+#if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
+	// Identity of a file content. If it did not change, content did not change
+	typedef struct __cbuild_file_id_t {
+		uint64_t dev;
+		uint64_t ino;
+		uint64_t size;
+		int64_t mtime;
+	} __cbuild_file_id_t;
+	typedef struct __cbuild_hash_cache_pair_t {
+		__cbuild_file_id_t key;
+		uint64_t hash;
+		cbuild_map_tombstone_t tombstone;
+	} __cbuild_hash_cache_pair_t;
+	struct {
+		__cbuild_hash_cache_pair_t* data;
+		size_t size;
+		size_t capacity;
+		cbuild_map_hash_t hash;
+		cbuild_map_keycmp_t keycmp;
+		size_t used;
+		size_t deleted;
+	} __cbuild_hash_cache = {
+		.hash = __cbuild_map_num_hash,
+		.keycmp = __cbuild_map_num_keycmp,
+	};
+	CBUILDDEF bool __cbuild_file_id(const char* path, __cbuild_file_id_t* id) {
+		struct stat statbuff;
+		if(stat(path, &statbuff) < 0) {
+			cbuild_log_error("Could not stat file \"%s\", error: \"%s\"",
+				path, strerror(errno));
+			return false;
+		}
+		memset(id, 0, sizeof(*id));
+		id->dev = (uint64_t)statbuff.st_dev;
+		id->ino = (uint64_t)statbuff.st_ino;
+		id->size = (uint64_t)statbuff.st_size;
+		id->mtime = __cbuild_compile_mtime_ns(&statbuff);
+		return true;
+	}
+	CBUILDDEF bool __cbuild_file_hash_id(const char* path, __cbuild_file_id_t id,
+		uint64_t* hash) {
+		if(__cbuild_hash_cache.capacity > 0) {
+			__cbuild_hash_cache_pair_t* pair = cbuild_map_find(&__cbuild_hash_cache, id);
+			if(pair != NULL) {
+				*hash = pair->hash;
+				return true;
+			}
+		}
+		cbuild_file_map_t map = {0};
+		if(!cbuild_file_map(path, &map)) return false;
+		*hash = cbuild_map_hash_wyhash_seed(map.content.data, map.content.size, 0);
+		cbuild_file_unmap(&map);
+		// File could be changed again within same mtime tick, so do not trust
+		// metadata of recently modified files
+		if(id.mtime / 1000000000ll >= (int64_t)time(NULL) - 2) return true;
+		__cbuild_hash_cache_pair_t* pair = cbuild_map_put_new(&__cbuild_hash_cache, id);
+		pair->hash = *hash;
+		return true;
+	}
+	CBUILDDEF bool cbuild_file_hash(const char* path, uint64_t* hash) {
+		__cbuild_file_id_t id;
+		if(!__cbuild_file_id(path, &id)) return false;
+		return __cbuild_file_hash_id(path, id, hash);
+	}
+	CBUILDDEF uint64_t __cbuild_compile_sv_to_u64(cbuild_sv_t sv) {
+		uint64_t ret = 0;
+		for(size_t i = 0; i < sv.size; i++) ret = ret * 10 + (uint64_t)(sv.data[i] - '0');
+		return ret;
+	}
+	CBUILDDEF bool __cbuild_compare_hash_write(const char* output,
+		const char** inputs, size_t num_inputs, __cbuild_file_id_t* ids,
+		uint64_t* hashes) {
+		cbuild_sb_t stamp = {0};
+		for(size_t i = 0; i < num_inputs; i++) {
+			cbuild_sb_appendf(&stamp, "%"PRIu64" %"PRIu64" %"PRIu64" %"PRIu64" %"PRIu64" %s\n",
+				ids[i].dev, ids[i].ino, ids[i].size, (uint64_t)ids[i].mtime, hashes[i],
+				inputs[i]);
+		}
+		// Torn stamp would be read as a valid one
+		bool ret = cbuild_file_write(cbuild_temp_sprintf("%s.chash", output), &stamp);
+		cbuild_da_clear(&stamp);
+		return ret;
+	}
+	CBUILDDEF bool cbuild_compare_hash_update(const char* output, const char** inputs,
+		size_t num_inputs) {
+		__cbuild_file_id_t* ids = __CBUILD_MALLOC(num_inputs * sizeof(*ids) + 1);
+		cbuild_assert(ids != NULL, "Allocation failed.\n");
+		uint64_t* hashes = __CBUILD_MALLOC(num_inputs * sizeof(*hashes) + 1);
+		cbuild_assert(hashes != NULL, "Allocation failed.\n");
+		bool ret = true;
+		for(size_t i = 0; i < num_inputs && ret; i++) {
+			ret = __cbuild_file_id(inputs[i], &ids[i]) &&
+				__cbuild_file_hash_id(inputs[i], ids[i], &hashes[i]);
+		}
+		if(ret) ret = __cbuild_compare_hash_write(output, inputs, num_inputs, ids, hashes);
+		__CBUILD_FREE(ids);
+		__CBUILD_FREE(hashes);
+		return ret;
+	}
+	CBUILDDEF int cbuild_compare_hash_many(const char* output, const char** inputs,
+		size_t num_inputs) {
+		if(!cbuild_file_check(output)) return 1;
+		const char* stamp_path = cbuild_temp_sprintf("%s.chash", output);
+		struct stat statbuff;
+		if(stat(stamp_path, &statbuff) < 0) return 1;
+		// Inputs modified within same mtime tick as stamp was written could
+		// change without change in metadata
+		int64_t stamp_mtime = __cbuild_compile_mtime_ns(&statbuff);
+		cbuild_sb_t stamp = {0};
+		if(!cbuild_file_read(stamp_path, &stamp)) return -1;
+		__cbuild_file_id_t* ids = __CBUILD_MALLOC(num_inputs * sizeof(*ids) + 1);
+		cbuild_assert(ids != NULL, "Allocation failed.\n");
+		uint64_t* hashes = __CBUILD_MALLOC(num_inputs * sizeof(*hashes) + 1);
+		cbuild_assert(hashes != NULL, "Allocation failed.\n");
+		cbuild_sv_t content = cbuild_sb_to_sv(stamp);
+		int ret = 0;
+		bool meta_changed = false;
+		size_t i = 0;
+		for(; i < num_inputs && content.size > 0; i++) {
+			cbuild_sv_t line = cbuild_sv_chop_by_delim(&content, '\n');
+			__cbuild_file_id_t old = {0};
+			old.dev = __cbuild_compile_sv_to_u64(cbuild_sv_chop_by_delim(&line, ' '));
+			old.ino = __cbuild_compile_sv_to_u64(cbuild_sv_chop_by_delim(&line, ' '));
+			old.size = __cbuild_compile_sv_to_u64(cbuild_sv_chop_by_delim(&line, ' '));
+			old.mtime = (int64_t)__cbuild_compile_sv_to_u64(cbuild_sv_chop_by_delim(&line, ' '));
+			uint64_t old_hash = __cbuild_compile_sv_to_u64(cbuild_sv_chop_by_delim(&line, ' '));
+			// List of inputs changed
+			if(cbuild_sv_cmp(line, cbuild_sv_from_cstr(inputs[i])) != 0) break;
+			if(!__cbuild_file_id(inputs[i], &ids[i])) {
+				ret = -1;
+				break;
+			}
+			if(memcmp(&old, &ids[i], sizeof(old)) == 0 && old.mtime < stamp_mtime) {
+				hashes[i] = old_hash;
+				continue;
+			}
+			if(!__cbuild_file_hash_id(inputs[i], ids[i], &hashes[i])) {
+				ret = -1;
+				break;
+			}
+			if(hashes[i] != old_hash) {
+				ret++;
+			} else {
+				meta_changed = true;
+			}
+		}
+		if(ret >= 0 && (i != num_inputs || content.size > 0)) {
+			ret = 1;
+		} else if(ret == 0 && meta_changed) {
+			// Content is same, so remember new metadata to not read files next time
+			__cbuild_compare_hash_write(output, inputs, num_inputs, ids, hashes);
+		}
+		cbuild_da_clear(&stamp);
+		__CBUILD_FREE(ids);
+		__CBUILD_FREE(hashes);
+		return ret;
+	}
+	CBUILDDEF int cbuild_compare_hash(const char* output, const char* input) {
+		return cbuild_compare_hash_many(output, &input, 1);
+	}
+#endif //CBUILD_API_*
@@ -15,6 +15,9 @@
 
 #include "Common.h"
 #include "Command.h"
+#include "StringView.h"
+#include "StringBuilder.h"
+#include "DynArray.h"
 
 //@ cbuild-compiler-self
 #if !defined(CBUILD_CC)
@@ -71,6 +74,9 @@
 #define CBUILD_CARGS_LIBLDIR(src, obj) "-L"obj
 /// Set standard based on compile-time literal.
 #define CBUILD_CARGS_STD(std)         "-std="std
+/// Make compiler write Makefile-style depfile with all non-system headers.
+/// Can be used with runtime string.
+#define CBUILD_CARGS_DEPFILE(file)    "-MMD", "-MF", (file)
 
 /// Simple wrapper for self-rebuild. Only `argv[0]`{.c} is used.
 /// Other elements are used only to re-exec new binary with same arguments.
@@ -116,6 +122,9 @@ extern cbuild_selfrebuild_hook_t cbuild_selfrebuild_hook;
 /// Compare mtime of 2 files.
 /// Same check as done by `make`.
 ///
+/// Nanosecond timestamps are used if platform provides them. Otherwise
+/// files modified in the same second are treated as if input is newer.
+///
 /// * [r:=0] - Output is newer than input.
 /// * [r:<0] - Error.
 /// * [r:>0] - Output is older than input.
@@ -128,3 +137,122 @@ CBUILDDEF int cbuild_compare_mtime(const char* output, const char* input);
 /// * [r:>0] - Output is older than input. Number of files that are newer.
 CBUILDDEF int cbuild_compare_mtime_many(const char* output, const char** inputs,
 	size_t num_inputs);
+/// Output and its inputs for [`cbuild_compare_mtime_bulk`](DOC:cbuild_compare_mtime_bulk).
+typedef struct cbuild_mtime_target_t {
+	const char* output;
+	const char** inputs;
+	size_t num_inputs;
+} cbuild_mtime_target_t;
+/// Optional arguments for [`cbuild_compare_mtime_bulk`](DOC:cbuild_compare_mtime_bulk).
+///
+/// * [fl:jobs] Number of threads. `0`{.c} or `1`{.c} means that all work is done on calling thread, negative value means [`cbuild_nproc`](DOC:cbuild_nproc).
+struct cbuild_compare_mtime_bulk_opts_t {
+	int jobs;
+};
+/// Compare mtime of many outputs at once. Semi-internal.
+CBUILDDEF int cbuild_compare_mtime_bulk_opt(const cbuild_mtime_target_t* targets,
+	size_t num_targets, uint8_t* stale, struct cbuild_compare_mtime_bulk_opts_t opts);
+/// Compare mtime of many outputs at once. Same check as
+/// [`cbuild_compare_mtime_many`](DOC:cbuild_compare_mtime_many) for each target,
+/// but each file is stat-ed only once, files are stat-ed relative to their
+/// directory (with `statx`{.c} on Linux) and work can be split between threads.
+///
+/// Stat cache is not used, as all files are stat-ed anyway.
+///
+/// * [pl:targets:const cbuild_mtime_target_t*] Array of targets.
+/// * [pl:num_targets:size_t] Number of targets.
+/// * [pl:stale:uint8_t*] Bitmap of stale outputs, at least `(num_targets + 7) / 8`{.c} bytes. Can be checked with [`cbuild_bitmap_get`](DOC:cbuild_bitmap_get).
+/// * [pl:...:...cbuild_compare_mtime_bulk_opts_t] Fields of configuration structure in initializer-list form.
+///
+/// * [r:=0] - All outputs are up to date.
+/// * [r:<0] - Error (eg. missing input). Targets with errors are marked as stale, so bitmap is still valid.
+/// * [r:>0] - Number of stale outputs.
+#define cbuild_compare_mtime_bulk(targets, num_targets, stale, ...)            \
+	cbuild_compare_mtime_bulk_opt(targets, num_targets, stale,                   \
+		(struct cbuild_compare_mtime_bulk_opts_t){ __VA_ARGS__ })
+/// Get bit from a bitmap.
+///
+/// * [pl:bitmap:const uint8_t*] Bitmap.
+/// * [pl:i:size_t] Index of a bit.
+///
+/// [r:bool]
+#define cbuild_bitmap_get(bitmap, i) ((((bitmap)[(i) / 8] >> ((i) % 8)) & 1) != 0)
+/// Hash content of a file with fast non-cryptographic hash (wyhash).
+///
+/// Results are cached in memory and keyed by device, inode, size and mtime of
+/// a file, so unchanged file is read only once per process.
+///
+/// * [pl:path] Path to a file.
+/// * [pl:hash] Output hash.
+///
+/// [r:] `false`{.c} on error.
+CBUILDDEF bool cbuild_file_hash(const char* path, uint64_t* hash);
+/// Compare content of input with content it had when output was built.
+/// Same as [`cbuild_compare_hash_many`](DOC:cbuild_compare_hash_many) with
+/// one input.
+CBUILDDEF int cbuild_compare_hash(const char* output, const char* input);
+/// Compare content of inputs with content they had when output was built.
+///
+/// Hashes of inputs are stored in `<output>.chash` stamp file by
+/// [`cbuild_compare_hash_update`](DOC:cbuild_compare_hash_update), which should
+/// be called after output was successfully built. Stamp also contains device,
+/// inode, size and mtime of each input, so input whose metadata did not change
+/// is not read at all. If only metadata changed (eg. after `git checkout`),
+/// stamp is updated and input is not treated as changed. Input modified within
+/// same timestamp tick as stamp was written is always read.
+///
+/// * [r:=0] - Output is up to date.
+/// * [r:<0] - Error.
+/// * [r:>0] - Output or stamp is missing or list of inputs changed, or number of changed inputs.
+CBUILDDEF int cbuild_compare_hash_many(const char* output, const char** inputs,
+	size_t num_inputs);
+/// Write stamp used by [`cbuild_compare_hash_many`](DOC:cbuild_compare_hash_many).
+///
+/// [r:] `false`{.c} on error.
+CBUILDDEF bool cbuild_compare_hash_update(const char* output, const char** inputs,
+	size_t num_inputs);
+/// Prerequisites parsed from Makefile-style depfile.
+///
+/// All paths are stored in single buffer [fl:strings], each one is
+/// `NULL`{.c}-terminated. [fl:deps] contains offsets into this buffer.
+/// Use [`cbuild_depfile_get`](DOC:cbuild_depfile_get) to get a path.
+///
+/// Should be zero-initialized.
+typedef struct cbuild_depfile_t {
+	cbuild_sb_t strings;
+	cbuild_da_new(size_t) deps;
+} cbuild_depfile_t;
+/// Parse depfile content and append all prerequisites to [p:depfile].
+/// Targets are skipped.
+///
+/// Supports `\\` continuation lines, escaped spaces and `#` and `$$`.
+///
+/// * [pl:depfile] Output.
+/// * [pl:content] Content of a depfile.
+CBUILDDEF void cbuild_depfile_parse(cbuild_depfile_t* depfile, cbuild_sv_t content);
+/// Read and parse depfile.
+///
+/// * [pl:depfile] Output.
+/// * [pl:path] Path to a depfile.
+///
+/// [r:] `false`{.c} if file could not be read.
+CBUILDDEF bool cbuild_depfile_read(cbuild_depfile_t* depfile, const char* path);
+/// Get path of a prerequisite.
+///
+/// * [pl:depfile:cbuild_depfile_t*] Depfile.
+/// * [pl:idx:size_t] Prerequisite index.
+///
+/// [r:const char*] Path.
+#define cbuild_depfile_get(depfile, idx)                                       \
+	((const char*)((depfile)->strings.data + (depfile)->deps.data[(idx)]))
+/// Free memory used by depfile.
+CBUILDDEF void cbuild_depfile_clear(cbuild_depfile_t* depfile);
+/// Compare mtime of output file and all prerequisites recorded in a depfile.
+///
+/// Missing prerequisite (eg. removed header) and missing depfile are treated
+/// as newer than output.
+///
+/// * [r:=0] - Output is newer than input.
+/// * [r:<0] - Error.
+/// * [r:>0] - Output is older than input. Number of files that are newer.
+CBUILDDEF int cbuild_compare_mtime_depfile(const char* output, const char* depfile);
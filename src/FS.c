@@ -6,6 +6,143 @@
 #include "DynArray.h"
 #include "Log.h"
 #include "Temp.h"
+#include "Map.h"
+#include "Proc.h"
+#if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
+	// 'openat' and 'fstatat' are only in POSIX.1-2008
+	#if defined(CBUILD_API_POSIX) || _POSIX_C_SOURCE >= 200809L
+		#define __CBUILD_STAT_AT
+	#endif // Feature check
+#endif // CBUILD_API_*
+// Kernel-side batches of file system operations
+#if defined(CBUILD_API_POSIX) && defined(CBUILD_OS_LINUX) && defined(SYS_io_uring_setup) && \
+	CBUILD_FS_URING
+	#define __CBUILD_FS_URING
+#endif // Extension check
+cbuild_stat_cache_stats_t cbuild_stat_cache_stats = {0};
+uint64_t __cbuild_stat_generation = 1; // 0 marks invalidated entries
+CBUILDDEF void __cbuild_path_normalize_sb(const char* path_, cbuild_sb_t* buff);
+#if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
+	// Cache can be used from worker threads, so it is locked and keys are not
+	// allocated with temp allocator
+	pthread_mutex_t __cbuild_stat_lock = PTHREAD_MUTEX_INITIALIZER;
+	// Result of 'stat' or 'lstat' is valid only if its generation is current
+	typedef struct __cbuild_stat_result_t {
+		uint64_t generation;
+		int error;
+		struct stat statbuff;
+	} __cbuild_stat_result_t;
+	typedef struct __cbuild_stat_pair_t {
+		cbuild_map_strkey_t key;
+		__cbuild_stat_result_t stat;
+		__cbuild_stat_result_t lstat;
+		cbuild_map_tombstone_t tombstone;
+	} __cbuild_stat_pair_t;
+	struct {
+		__cbuild_stat_pair_t* data;
+		size_t size;
+		size_t capacity;
+		cbuild_map_hash_t hash;
+		cbuild_map_keycmp_t keycmp;
+		size_t used;
+		size_t deleted;
+	} __cbuild_stat_cache = {
+		.hash = __cbuild_map_strkey_hash,
+		.keycmp = __cbuild_map_strkey_keycmp,
+	};
+	// Trailing '/' is kept, as it changes meaning of a path. Key is
+	// 'NULL'-terminated, but terminator is not counted in its size.
+	CBUILDDEF cbuild_map_strkey_t __cbuild_stat_key(const char* path,
+		cbuild_sb_t* buff) {
+		size_t len = strlen(path);
+		__cbuild_path_normalize_sb(path, buff);
+		if(len > 1 && path[len - 1] == '/' && buff->data[buff->size - 1] != '/') {
+			cbuild_da_append(buff, '/');
+		}
+		cbuild_sb_append_null(buff);
+		return cbuild_map_strkey_sv(cbuild_sv_from_parts(buff->data, buff->size - 1));
+	}
+	CBUILDDEF __cbuild_stat_pair_t* __cbuild_stat_cache_get(cbuild_map_strkey_t key) {
+		__cbuild_stat_pair_t* pair = NULL;
+		if(__cbuild_stat_cache.capacity > 0) pair = cbuild_map_find(&__cbuild_stat_cache, key);
+		if(pair == NULL) {
+			char* owned = __CBUILD_MALLOC(key.size + 1);
+			cbuild_assert(owned != NULL, "Allocation failed.\n");
+			memcpy(owned, key.data, key.size + 1);
+			key.data = owned;
+			pair = cbuild_map_put_new(&__cbuild_stat_cache, key);
+			pair->stat.generation = 0;
+			pair->lstat.generation = 0;
+		}
+		return pair;
+	}
+	CBUILDDEF bool __cbuild_stat_cached(const char* path, struct stat* statbuff,
+		bool link) {
+		#if CBUILD_STAT_CACHE
+			cbuild_sb_t key = {0};
+			pthread_mutex_lock(&__cbuild_stat_lock);
+			__cbuild_stat_pair_t* pair = __cbuild_stat_cache_get(
+				__cbuild_stat_key(path, &key));
+			__cbuild_stat_result_t* res = link ? &pair->lstat : &pair->stat;
+			uint64_t generation = __atomic_load_n(&__cbuild_stat_generation,
+				__ATOMIC_ACQUIRE);
+			if(res->generation == generation) {
+				cbuild_stat_cache_stats.hits++;
+			} else {
+				// Lock is held during syscall, so result is never stored after
+				// concurrent invalidation of the same path
+				cbuild_stat_cache_stats.misses++;
+				int ret = link ? lstat(path, &res->statbuff) : stat(path, &res->statbuff);
+				res->error = ret < 0 ? errno : 0;
+				res->generation = generation;
+			}
+			int error = res->error;
+			if(error == 0) *statbuff = res->statbuff;
+			pthread_mutex_unlock(&__cbuild_stat_lock);
+			cbuild_da_clear(&key);
+			if(error != 0) {
+				errno = error;
+				return false;
+			}
+			return true;
+		#else
+			__atomic_add_fetch(&cbuild_stat_cache_stats.misses, 1, __ATOMIC_RELAXED);
+			return (link ? lstat(path, statbuff) : stat(path, statbuff)) == 0;
+		#endif // CBUILD_STAT_CACHE
+	}
+	CBUILDDEF bool cbuild_stat(const char* path, struct stat* statbuff) {
+		return __cbuild_stat_cached(path, statbuff, false);
+	}
+	CBUILDDEF bool cbuild_lstat(const char* path, struct stat* statbuff) {
+		return __cbuild_stat_cached(path, statbuff, true);
+	}
+	CBUILDDEF void cbuild_stat_invalidate(const char* path) {
+		#if CBUILD_STAT_CACHE
+			cbuild_sb_t key = {0};
+			pthread_mutex_lock(&__cbuild_stat_lock);
+			if(__cbuild_stat_cache.capacity > 0) {
+				__cbuild_stat_pair_t* pair = cbuild_map_find(&__cbuild_stat_cache,
+					__cbuild_stat_key(path, &key));
+				if(pair != NULL) {
+					pair->stat.generation = 0;
+					pair->lstat.generation = 0;
+					cbuild_stat_cache_stats.invalidations++;
+				}
+			}
+			pthread_mutex_unlock(&__cbuild_stat_lock);
+			cbuild_da_clear(&key);
+		#else
+			(void)path;
+		#endif // CBUILD_STAT_CACHE
+	}
+#endif // CBUILD_API_*
+CBUILDDEF uint64_t cbuild_stat_invalidate_all(void) {
+	__atomic_add_fetch(&cbuild_stat_cache_stats.invalidations, 1, __ATOMIC_RELAXED);
+	return __atomic_add_fetch(&__cbuild_stat_generation, 1, __ATOMIC_ACQ_REL);
+}
+CBUILDDEF uint64_t cbuild_stat_generation(void) {
+	return __atomic_load_n(&__cbuild_stat_generation, __ATOMIC_ACQUIRE);
+}
 #if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
 	CBUILDDEF bool cbuild_fd_close(cbuild_fd_t fd) {
 		if(fd == CBUILD_INVALID_FD) {
@@ -34,6 +171,7 @@
 			return CBUILD_INVALID_FD;
 		}
 		fcntl(fd, F_SETFD, FD_CLOEXEC);
+		cbuild_stat_invalidate(path);
 		return fd;
 	}
 	CBUILDDEF bool cbuild_fd_open_pipe(cbuild_fd_t* read, cbuild_fd_t* write) {
@@ -85,97 +223,490 @@
 			cbuild_log_error("Could not write to file \"%s\", error: \"%s\"",
 				path, strerror(errno));
 		}
+		cbuild_stat_invalidate(path);
 		return len;
 	}
 	CBUILDDEF ssize_t cbuild_file_len(const char* path) {
 		struct stat statbuff;
-		if(stat(path, &statbuff) < 0) {
+		if(!cbuild_stat(path, &statbuff)) {
 			cbuild_log_error("Could not stat \"%s\", error: \"%s\"", path,
 				strerror(errno));
 			return -1;
 		}
 		return statbuff.st_size;
 	}
-#endif // CBUILD_API_*
-CBUILDDEF bool cbuild_file_read(const char* path, cbuild_sb_t* data) {
-	cbuild_fd_t fd = cbuild_fd_open_read(path);
-	if(CBUILD_INVALID_FD == fd) {
-		return false;
+	CBUILDDEF bool cbuild_file_read(const char* path, cbuild_sb_t* data) {
+		cbuild_fd_t fd = cbuild_fd_open_read(path);
+		if(CBUILD_INVALID_FD == fd) {
+			return false;
+		}
+		struct stat statbuff;
+		if(fstat(fd, &statbuff) < 0) {
+			cbuild_log_error("Could not stat file \"%s\", error: \"%s\"", path,
+				strerror(errno));
+			cbuild_fd_close(fd);
+			return false;
+		}
+		// One byte more, so end of file is found without resize. Special
+		// files may report size 0, so read is done until end of file anyway
+		size_t size = (size_t)statbuff.st_size + 1;
+		if(data->capacity < size) cbuild_da_resize(data, size);
+		data->size = 0;
+		while(true) {
+			if(data->size == data->capacity) cbuild_da_resize(data, 0);
+			ssize_t len = cbuild_fd_read_file(fd, data->data + data->size,
+				data->capacity - data->size, path);
+			if(len < 0) {
+				cbuild_fd_close(fd);
+				return false;
+			}
+			if(len == 0) break;
+			data->size += (size_t)len;
+		}
+		cbuild_fd_close(fd);
+		return true;
 	}
-	size_t size = (size_t)cbuild_file_len(path);
-	cbuild_da_resize(data, size); // Assert data != NULL
-	ssize_t len = cbuild_fd_read_file(fd, data->data, size, path);
-	if(len < 0) {
+	// Buffers for small files, each is 'CBUILD_FILE_MAP_MIN' bytes, grown
+	// buffers are not pooled
+	pthread_mutex_t __cbuild_file_map_lock = PTHREAD_MUTEX_INITIALIZER;
+	char* __cbuild_file_map_pool[8];
+	size_t __cbuild_file_map_pool_size = 0;
+	CBUILDDEF bool cbuild_file_map(const char* path, cbuild_file_map_t* map) {
+		*map = (cbuild_file_map_t){0};
+		cbuild_fd_t fd = cbuild_fd_open_read(path);
+		if(CBUILD_INVALID_FD == fd) {
+			return false;
+		}
+		struct stat statbuff;
+		if(fstat(fd, &statbuff) < 0) {
+			cbuild_log_error("Could not stat file \"%s\", error: \"%s\"", path,
+				strerror(errno));
+			cbuild_fd_close(fd);
+			return false;
+		}
+		size_t size = (size_t)statbuff.st_size;
+		if(S_ISREG(statbuff.st_mode) && size >= CBUILD_FILE_MAP_MIN) {
+			void* mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			cbuild_fd_close(fd);
+			if(mapped == MAP_FAILED) {
+				cbuild_log_error("Could not map file \"%s\", error: \"%s\"", path,
+					strerror(errno));
+				return false;
+			}
+			// Files are scanned from start to end, so kernel can read ahead
+			posix_madvise(mapped, size, POSIX_MADV_SEQUENTIAL);
+			posix_madvise(mapped, size, POSIX_MADV_WILLNEED);
+			map->buff = mapped;
+			map->capacity = size;
+			map->mapped = true;
+			map->content = cbuild_sv_from_parts(map->buff, size);
+			return true;
+		}
+		char* buff = NULL;
+		pthread_mutex_lock(&__cbuild_file_map_lock);
+		if(__cbuild_file_map_pool_size > 0) {
+			buff = __cbuild_file_map_pool[--__cbuild_file_map_pool_size];
+		}
+		pthread_mutex_unlock(&__cbuild_file_map_lock);
+		if(buff == NULL) {
+			buff = __CBUILD_MALLOC(CBUILD_FILE_MAP_MIN);
+			cbuild_assert(buff != NULL, "Allocation failed.\n");
+		}
+		map->buff = buff;
+		map->capacity = CBUILD_FILE_MAP_MIN;
+		// File can be special or can grow after 'fstat', so it is read until
+		// end of file
+		size = 0;
+		while(true) {
+			if(size == map->capacity) {
+				map->capacity *= 2;
+				map->buff = __CBUILD_REALLOC(map->buff, map->capacity);
+				cbuild_assert(map->buff != NULL, "Allocation failed.\n");
+			}
+			ssize_t len = cbuild_fd_read_file(fd, map->buff + size, map->capacity - size,
+				path);
+			if(len < 0) {
+				cbuild_fd_close(fd);
+				cbuild_file_unmap(map);
+				return false;
+			}
+			if(len == 0) break;
+			size += (size_t)len;
+		}
 		cbuild_fd_close(fd);
-		return false;
+		map->content = cbuild_sv_from_parts(map->buff, size);
+		return true;
 	}
-	data->size = (size_t)len;
-	cbuild_fd_close(fd);
-	return true;
-}
-CBUILDDEF bool cbuild_file_write(const char* path, cbuild_sb_t* data) {
-	cbuild_fd_t fd = cbuild_fd_open_write(path);
-	if(CBUILD_INVALID_FD == fd) {
-		return false;
+	CBUILDDEF void cbuild_file_unmap(cbuild_file_map_t* map) {
+		if(map->mapped) {
+			munmap(map->buff, map->capacity);
+		} else if(map->buff != NULL) {
+			if(map->capacity == CBUILD_FILE_MAP_MIN) {
+				pthread_mutex_lock(&__cbuild_file_map_lock);
+				if(__cbuild_file_map_pool_size < cbuild_arr_len(__cbuild_file_map_pool)) {
+					__cbuild_file_map_pool[__cbuild_file_map_pool_size++] = map->buff;
+					map->buff = NULL;
+				}
+				pthread_mutex_unlock(&__cbuild_file_map_lock);
+			}
+			if(map->buff != NULL) __CBUILD_FREE(map->buff);
+		}
+		*map = (cbuild_file_map_t){0};
 	}
-	char* buf = data->data;
-	ssize_t cnt = (ssize_t)data->size;
-	while(cnt > 0) {
-		ssize_t written = cbuild_fd_write_file(fd, buf, (size_t)cnt, path);
-		if(written < 0) {
-			cbuild_fd_close(fd);
+	// Writes all iovecs, 'iov' is modified
+	CBUILDDEF bool __cbuild_file_writer_writev(cbuild_file_writer_t* writer,
+		struct iovec* iov, int cnt) {
+		while(cnt > 0) {
+			ssize_t len = writev(writer->fd, iov, cnt);
+			if(len < 0) {
+				if(errno == EINTR) continue;
+				cbuild_log_error("Could not write to file \"%s\", error: \"%s\"",
+					writer->path, strerror(errno));
+				writer->failed = true;
+				return false;
+			}
+			size_t written = (size_t)len;
+			while(cnt > 0 && written >= iov->iov_len) {
+				written -= iov->iov_len;
+				iov++;
+				cnt--;
+			}
+			if(cnt > 0) {
+				iov->iov_base = (char*)iov->iov_base + written;
+				iov->iov_len -= written;
+			}
+		}
+		if(writer->temp_path == NULL) cbuild_stat_invalidate(writer->path);
+		return true;
+	}
+	pthread_mutex_t __cbuild_file_writer_lock = PTHREAD_MUTEX_INITIALIZER;
+	unsigned long __cbuild_file_writer_counter = 0;
+	CBUILDDEF bool cbuild_file_writer_open_opt(cbuild_file_writer_t* writer,
+		const char* path, struct cbuild_file_write_opts_t opts) {
+		*writer = (cbuild_file_writer_t){0};
+		writer->fd = CBUILD_INVALID_FD;
+		writer->capacity = opts.buff_size > 0 ? opts.buff_size : CBUILD_FILE_WRITER_SIZE;
+		writer->sync = opts.sync;
+		size_t len = strlen(path);
+		writer->path = __CBUILD_MALLOC(len + 1);
+		cbuild_assert(writer->path != NULL, "Allocation failed.\n");
+		memcpy(writer->path, path, len + 1);
+		struct stat statbuff;
+		bool exists = stat(path, &statbuff) == 0;
+		if(opts.in_place || (exists && !S_ISREG(statbuff.st_mode))) {
+			writer->fd = cbuild_fd_open_write(path);
+			if(writer->fd == CBUILD_INVALID_FD) {
+				cbuild_file_writer_abort(writer);
+				return false;
+			}
+			return true;
+		}
+		// Link is kept, its target is replaced
+		for(size_t depth = 0; exists && depth < 32; depth++) {
+			struct stat lstatbuff;
+			if(lstat(writer->path, &lstatbuff) < 0 || !S_ISLNK(lstatbuff.st_mode)) break;
+			size_t checkpoint = cbuild_temp_checkpoint();
+			char* target = cbuild_temp_malloc((size_t)lstatbuff.st_size + 1);
+			ssize_t target_len = readlink(writer->path, target, (size_t)lstatbuff.st_size + 1);
+			if(target_len < 0 || (size_t)target_len > (size_t)lstatbuff.st_size) {
+				cbuild_temp_reset(checkpoint);
+				break;
+			}
+			target[target_len] = '\0';
+			const char* dir = cbuild_path_base(writer->path);
+			const char* resolved = target[0] == '/' || *dir == '\0' ? target :
+				cbuild_temp_sprintf("%s/%s", dir, target);
+			__CBUILD_FREE(writer->path);
+			len = strlen(resolved);
+			writer->path = __CBUILD_MALLOC(len + 1);
+			cbuild_assert(writer->path != NULL, "Allocation failed.\n");
+			memcpy(writer->path, resolved, len + 1);
+			cbuild_temp_reset(checkpoint);
+		}
+		path = writer->path;
+		// Temporary file is created next to a destination, so 'rename' never
+		// crosses file systems
+		size_t temp_len = len + 64;
+		writer->temp_path = __CBUILD_MALLOC(temp_len);
+		cbuild_assert(writer->temp_path != NULL, "Allocation failed.\n");
+		cbuild_fd_t fd = CBUILD_INVALID_FD;
+		for(size_t i = 0; i < 64; i++) {
+			pthread_mutex_lock(&__cbuild_file_writer_lock);
+			unsigned long id = __cbuild_file_writer_counter++;
+			pthread_mutex_unlock(&__cbuild_file_writer_lock);
+			snprintf(writer->temp_path, temp_len, "%s.tmp.%ld.%lu", path,
+				(long)getpid(), id);
+			fd = open(writer->temp_path, O_WRONLY | O_CREAT | O_EXCL,
+				S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+			if(fd >= 0 || errno != EEXIST) break;
+		}
+		if(fd < 0) {
+			cbuild_log_error("Could not create temporary file for \"%s\", error: \"%s\"",
+				path, strerror(errno));
+			__CBUILD_FREE(writer->temp_path);
+			writer->temp_path = NULL;
+			cbuild_file_writer_abort(writer);
 			return false;
 		}
-		cnt -= written;
-		buf += written;
+		fcntl(fd, F_SETFD, FD_CLOEXEC);
+		// Replaced file keeps its permissions
+		if(exists) fchmod(fd, statbuff.st_mode & 07777);
+		writer->fd = fd;
+		return true;
 	}
-	cbuild_fd_close(fd);
-	return true;
-}
-CBUILDDEF bool cbuild_file_copy(const char* src, const char* dst) {
-	cbuild_fd_t src_fd = cbuild_fd_open_read(src);
-	cbuild_fd_t dst_fd = cbuild_fd_open_write(dst);
-	if(src_fd == CBUILD_INVALID_FD) {
-		return false;
+	CBUILDDEF bool cbuild_file_writer_write(cbuild_file_writer_t* writer,
+		const void* data, size_t size) {
+		if(writer->failed) return false;
+		if(size == 0) return true;
+		if(writer->size + size <= writer->capacity) {
+			if(writer->buff == NULL) {
+				writer->buff = __CBUILD_MALLOC(writer->capacity);
+				cbuild_assert(writer->buff != NULL, "Allocation failed.\n");
+			}
+			memcpy(writer->buff + writer->size, data, size);
+			writer->size += size;
+			return true;
+		}
+		struct iovec iov[2] = {
+			{ .iov_base = writer->buff, .iov_len = writer->size },
+			{ .iov_base = (void*)data, .iov_len = size },
+		};
+		writer->size = 0;
+		return __cbuild_file_writer_writev(writer, iov, 2);
 	}
-	if(dst_fd == CBUILD_INVALID_FD) {
-		cbuild_fd_close(src_fd);
-		return false;
+	CBUILDDEF bool cbuild_file_writer_flush(cbuild_file_writer_t* writer) {
+		if(writer->failed) return false;
+		if(writer->size == 0) return true;
+		struct iovec iov = { .iov_base = writer->buff, .iov_len = writer->size };
+		writer->size = 0;
+		return __cbuild_file_writer_writev(writer, &iov, 1);
+	}
+	CBUILDDEF bool __cbuild_file_writer_sync(cbuild_fd_t fd) {
+		#if defined(CBUILD_OS_MACOS)
+			return fsync(fd) == 0;
+		#else
+			return fdatasync(fd) == 0;
+		#endif // CBUILD_OS_MACOS
 	}
-	char* tmp_buff = (char*)__CBUILD_MALLOC(CBUILD_FS_TMP_SIZE);
-	cbuild_assert(tmp_buff != NULL, "Allocation failed.\n");
-	while(true) {
-		ssize_t cnt = cbuild_fd_read_file(src_fd, tmp_buff, CBUILD_FS_TMP_SIZE, src);
-		if(cnt == 0) {
-			break;
+	CBUILDDEF bool cbuild_file_writer_commit(cbuild_file_writer_t* writer) {
+		if(!cbuild_file_writer_flush(writer)) {
+			cbuild_file_writer_abort(writer);
+			return false;
 		}
-		if(cnt < 0) {
-			cbuild_fd_close(src_fd);
-			cbuild_fd_close(dst_fd);
-			__CBUILD_FREE(tmp_buff);
+		if(writer->sync && !__cbuild_file_writer_sync(writer->fd)) {
+			cbuild_log_error("Could not sync file \"%s\", error: \"%s\"",
+				writer->path, strerror(errno));
+			cbuild_file_writer_abort(writer);
 			return false;
 		}
-		char* buf = tmp_buff;
-		while(cnt > 0) {
-			ssize_t written = cbuild_fd_write_file(dst_fd, buf, (size_t)cnt, dst);
-			if(written < 0) {
-				cbuild_fd_close(src_fd);
-				cbuild_fd_close(dst_fd);
-				__CBUILD_FREE(tmp_buff);
+		// Some file systems report write errors only on close
+		bool ret = close(writer->fd) == 0;
+		writer->fd = CBUILD_INVALID_FD;
+		if(!ret) {
+			cbuild_log_error("Could not write to file \"%s\", error: \"%s\"",
+				writer->path, strerror(errno));
+			cbuild_file_writer_abort(writer);
+			return false;
+		}
+		if(writer->temp_path != NULL) {
+			if(rename(writer->temp_path, writer->path) < 0) {
+				cbuild_log_error("Could not rename \"%s\" to \"%s\", error: \"%s\"",
+					writer->temp_path, writer->path, strerror(errno));
+				cbuild_file_writer_abort(writer);
 				return false;
 			}
-			cnt -= written;
-			buf += written;
+			__CBUILD_FREE(writer->temp_path);
+			writer->temp_path = NULL;
+			if(writer->sync) {
+				// Rename itself is durable only after its directory is synced
+				size_t checkpoint = cbuild_temp_checkpoint();
+				const char* dir = cbuild_path_base(writer->path);
+				cbuild_fd_t dir_fd = open(*dir == '\0' ? "." : dir, O_RDONLY);
+				cbuild_temp_reset(checkpoint);
+				if(dir_fd >= 0) {
+					fsync(dir_fd);
+					close(dir_fd);
+				}
+			}
 		}
+		cbuild_file_writer_abort(writer);
+		return true;
 	}
-	cbuild_fd_close(src_fd);
-	cbuild_fd_close(dst_fd);
-	__CBUILD_FREE(tmp_buff);
-	return true;
+	CBUILDDEF void cbuild_file_writer_abort(cbuild_file_writer_t* writer) {
+		if(writer->fd != CBUILD_INVALID_FD) close(writer->fd);
+		if(writer->temp_path != NULL) {
+			unlink(writer->temp_path);
+			__CBUILD_FREE(writer->temp_path);
+		}
+		if(writer->path != NULL) {
+			cbuild_stat_invalidate(writer->path);
+			__CBUILD_FREE(writer->path);
+		}
+		if(writer->buff != NULL) __CBUILD_FREE(writer->buff);
+		*writer = (cbuild_file_writer_t){0};
+		writer->fd = CBUILD_INVALID_FD;
+	}
+#endif // CBUILD_API_*
+CBUILDDEF bool cbuild_file_write_opt(const char* path, cbuild_sb_t* data,
+	struct cbuild_file_write_opts_t opts) {
+	cbuild_file_writer_t writer;
+	if(!cbuild_file_writer_open_opt(&writer, path, opts)) {
+		return false;
+	}
+	// Content is written at once, so it does not need to be buffered
+	writer.capacity = 0;
+	cbuild_file_writer_write(&writer, data->data, data->size);
+	return cbuild_file_writer_commit(&writer);
 }
+#if defined(CBUILD_API_POSIX) && defined(CBUILD_OS_LINUX) && !defined(FICLONE)
+	#define FICLONE _IOW(0x94, 9, int)
+#endif // Extension check
+#if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
+	// Copy engines. Each one returns 1 if file was copied, 0 if it is not
+	// supported (and next engine should be tried) and -1 on error. Engines
+	// continue from current file offsets, so partially failed copy can be
+	// finished by next one.
+	CBUILDDEF int __cbuild_fs_copy_clone(cbuild_fd_t src_fd, cbuild_fd_t dst_fd) {
+		#if defined(CBUILD_API_POSIX) && defined(CBUILD_OS_LINUX)
+			if(ioctl(dst_fd, FICLONE, src_fd) == 0) return 1;
+		#else
+			(void)src_fd;
+			(void)dst_fd;
+		#endif // Extension check
+		return 0;
+	}
+	CBUILDDEF int __cbuild_fs_copy_range(cbuild_fd_t src_fd, cbuild_fd_t dst_fd,
+		const char* src, const char* dst) {
+		#if defined(CBUILD_API_POSIX) && defined(CBUILD_OS_LINUX) && defined(SYS_copy_file_range)
+			while(true) {
+				ssize_t cnt = (ssize_t)syscall(SYS_copy_file_range, src_fd, NULL, dst_fd,
+					NULL, (size_t)1 << 30, 0);
+				if(cnt == 0) return 1;
+				if(cnt > 0) continue;
+				if(errno == EINTR) continue;
+				if(errno == ENOSYS || errno == EXDEV || errno == EINVAL ||
+					errno == EOPNOTSUPP || errno == EPERM) {
+					return 0;
+				}
+				cbuild_log_error("Could not copy file \"%s\" to \"%s\", error: \"%s\"",
+					src, dst, strerror(errno));
+				return -1;
+			}
+		#else
+			(void)src_fd;
+			(void)dst_fd;
+			(void)src;
+			(void)dst;
+			return 0;
+		#endif // Extension check
+	}
+	CBUILDDEF int __cbuild_fs_copy_sendfile(cbuild_fd_t src_fd, cbuild_fd_t dst_fd,
+		const char* src, const char* dst) {
+		#if defined(CBUILD_API_POSIX) && defined(CBUILD_OS_LINUX)
+			while(true) {
+				ssize_t cnt = sendfile(dst_fd, src_fd, NULL, (size_t)1 << 30);
+				if(cnt == 0) return 1;
+				if(cnt > 0) continue;
+				if(errno == EINTR) continue;
+				if(errno == ENOSYS || errno == EINVAL) return 0;
+				cbuild_log_error("Could not copy file \"%s\" to \"%s\", error: \"%s\"",
+					src, dst, strerror(errno));
+				return -1;
+			}
+		#else
+			(void)src_fd;
+			(void)dst_fd;
+			(void)src;
+			(void)dst;
+			return 0;
+		#endif // Extension check
+	}
+	// Plain read-write loop. It is used by tree copy workers, so it does not
+	// touch stat cache or temp allocator, callers invalidate 'dst' themselves.
+	CBUILDDEF int __cbuild_fs_copy_loop(cbuild_fd_t src_fd, cbuild_fd_t dst_fd,
+		const char* src, const char* dst, size_t size) {
+		// Buffer is never bigger than a file
+		size_t buff_size = size < CBUILD_FS_TMP_SIZE ? size + 1 : CBUILD_FS_TMP_SIZE;
+		char* tmp_buff = (char*)__CBUILD_MALLOC(buff_size);
+		cbuild_assert(tmp_buff != NULL, "Allocation failed.\n");
+		int ret = 1;
+		while(ret > 0) {
+			ssize_t cnt = read(src_fd, tmp_buff, buff_size);
+			if(cnt == 0) break;
+			if(cnt < 0) {
+				if(errno == EINTR) continue;
+				cbuild_log_error("Could not read from file \"%s\", error: \"%s\"", src,
+					strerror(errno));
+				ret = -1;
+				break;
+			}
+			char* buf = tmp_buff;
+			while(cnt > 0) {
+				ssize_t written = write(dst_fd, buf, (size_t)cnt);
+				if(written < 0) {
+					if(errno == EINTR) continue;
+					cbuild_log_error("Could not write to file \"%s\", error: \"%s\"", dst,
+						strerror(errno));
+					ret = -1;
+					break;
+				}
+				cnt -= written;
+				buf += written;
+			}
+		}
+		__CBUILD_FREE(tmp_buff);
+		return ret;
+	}
+	// Copy content and permission bits between already opened files
+	CBUILDDEF bool __cbuild_fs_copy_fd(cbuild_fd_t src_fd, cbuild_fd_t dst_fd,
+		const char* src, const char* dst) {
+		struct stat statbuff;
+		if(fstat(src_fd, &statbuff) < 0) {
+			cbuild_log_error("Could not stat file \"%s\", error: \"%s\"", src,
+				strerror(errno));
+			return false;
+		}
+		// Kernel may report size 0 for special files (eg. in '/proc')
+		int ret = 0;
+		if(S_ISREG(statbuff.st_mode) && statbuff.st_size > 0) {
+			ret = __cbuild_fs_copy_clone(src_fd, dst_fd);
+		}
+		if(ret == 0 && S_ISREG(statbuff.st_mode) && statbuff.st_size > 0) {
+			ret = __cbuild_fs_copy_range(src_fd, dst_fd, src, dst);
+		}
+		if(ret == 0) ret = __cbuild_fs_copy_sendfile(src_fd, dst_fd, src, dst);
+		if(ret == 0) {
+			ret = __cbuild_fs_copy_loop(src_fd, dst_fd, src, dst, (size_t)statbuff.st_size);
+		}
+		if(ret > 0 && fchmod(dst_fd, statbuff.st_mode & 07777) < 0) {
+			cbuild_log_error("Could not set mode of file \"%s\", error: \"%s\"", dst,
+				strerror(errno));
+			ret = -1;
+		}
+		return ret > 0;
+	}
+	CBUILDDEF bool cbuild_file_copy(const char* src, const char* dst) {
+		cbuild_fd_t src_fd = cbuild_fd_open_read(src);
+		if(src_fd == CBUILD_INVALID_FD) {
+			return false;
+		}
+		cbuild_fd_t dst_fd = cbuild_fd_open_write(dst);
+		if(dst_fd == CBUILD_INVALID_FD) {
+			cbuild_fd_close(src_fd);
+			return false;
+		}
+		bool ret = __cbuild_fs_copy_fd(src_fd, dst_fd, src, dst);
+		cbuild_fd_close(src_fd);
+		cbuild_fd_close(dst_fd);
+		cbuild_stat_invalidate(dst);
+		return ret;
+	}
+#endif // CBUILD_API_*
 #if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
 	CBUILDDEF bool cbuild_file_move(const char* src, const char* dst) {
 		if(rename(src, dst) == 0) {
+			cbuild_stat_invalidate(src);
+			cbuild_stat_invalidate(dst);
 			return true;
 		}
 		if(errno == EXDEV) {
@@ -187,7 +718,7 @@ CBUILDDEF bool cbuild_file_copy(const char* src, const char* dst) {
 #endif // CBUILD_API_*
 CBUILDDEF bool cbuild_file_check(const char* path) {
 	struct stat statbuff;
-	return stat(path, &statbuff) == 0;
+	return cbuild_stat(path, &statbuff);
 }
 #if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
 	CBUILDDEF bool cbuild_file_remove(const char* path) {
@@ -196,6 +727,7 @@ CBUILDDEF bool cbuild_file_check(const char* path) {
 				path, strerror(errno));
 			return false;
 		}
+		cbuild_stat_invalidate(path);
 		return true;
 	}
 	CBUILDDEF bool cbuild_symlink(const char* src, const char* dst) {
@@ -227,16 +759,846 @@ CBUILDDEF bool cbuild_file_check(const char* path) {
 					break;
 				default: CBUILD_UNREACHABLE("Invalid filetype in create_symlink.");
 				}
-				if(symlink(src, dst) == 0) return true;
+				if(symlink(src, dst) == 0) {
+					cbuild_stat_invalidate(dst);
+					return true;
+				}
 			}
 			cbuild_log_error(
 				"Could not create symbolic link \"%s\", error: \"%s\"",
 				dst, strerror(errno));
 			return false;
 		}
+		cbuild_stat_invalidate(dst);
 		return true;
 	}
 #endif // CBUILD_API_*
+#if defined(__CBUILD_FS_URING)
+	// Kernel ABI of 'io_uring', so kernel headers are not needed
+	typedef struct __cbuild_uring_sqe_t {
+		uint8_t opcode;
+		uint8_t flags;
+		uint16_t ioprio;
+		int32_t fd;
+		uint64_t off; // Also 'addr2'
+		uint64_t addr;
+		uint32_t len;
+		uint32_t op_flags;
+		uint64_t user_data;
+		uint16_t buf_index;
+		uint16_t personality;
+		int32_t splice_fd_in;
+		uint64_t pad[2];
+	} __cbuild_uring_sqe_t;
+	typedef struct __cbuild_uring_cqe_t {
+		uint64_t user_data;
+		int32_t res;
+		uint32_t flags;
+	} __cbuild_uring_cqe_t;
+	typedef struct __cbuild_uring_params_t {
+		uint32_t sq_entries;
+		uint32_t cq_entries;
+		uint32_t flags;
+		uint32_t sq_thread_cpu;
+		uint32_t sq_thread_idle;
+		uint32_t features;
+		uint32_t wq_fd;
+		uint32_t resv[3];
+		struct {
+			uint32_t head, tail, ring_mask, ring_entries, flags, dropped, array, resv1;
+			uint64_t resv2;
+		} sq_off;
+		struct {
+			uint32_t head, tail, ring_mask, ring_entries, overflow, cqes, flags, resv1;
+			uint64_t resv2;
+		} cq_off;
+	} __cbuild_uring_params_t;
+	typedef struct __cbuild_uring_probe_t {
+		uint8_t last_op;
+		uint8_t ops_len;
+		uint16_t resv;
+		uint32_t resv2[3];
+		struct {
+			uint8_t op;
+			uint8_t resv;
+			uint16_t flags;
+			uint32_t resv2;
+		} ops[64];
+	} __cbuild_uring_probe_t;
+	typedef struct __cbuild_statx_time_t {
+		int64_t tv_sec;
+		uint32_t tv_nsec;
+		int32_t resv;
+	} __cbuild_statx_time_t;
+	typedef struct __cbuild_statx_t {
+		uint32_t mask;
+		uint32_t blksize;
+		uint64_t attributes;
+		uint32_t nlink;
+		uint32_t uid;
+		uint32_t gid;
+		uint16_t mode;
+		uint16_t spare0;
+		uint64_t ino;
+		uint64_t size;
+		uint64_t blocks;
+		uint64_t attributes_mask;
+		__cbuild_statx_time_t atime;
+		__cbuild_statx_time_t btime;
+		__cbuild_statx_time_t ctime;
+		__cbuild_statx_time_t mtime;
+		uint32_t rdev_major;
+		uint32_t rdev_minor;
+		uint32_t dev_major;
+		uint32_t dev_minor;
+		uint64_t spare[14];
+	} __cbuild_statx_t;
+	#define __CBUILD_URING_OP_OPENAT 18
+	#define __CBUILD_URING_OP_CLOSE 19
+	#define __CBUILD_URING_OP_STATX 21
+	#define __CBUILD_URING_OP_READ 22
+	#define __CBUILD_URING_OP_WRITE 23
+	#define __CBUILD_URING_OP_UNLINKAT 36
+	#define __CBUILD_URING_OFF_SQ_RING 0ULL
+	#define __CBUILD_URING_OFF_CQ_RING 0x8000000ULL
+	#define __CBUILD_URING_OFF_SQES 0x10000000ULL
+	#define __CBUILD_URING_FEAT_SINGLE_MMAP (1U << 0)
+	#define __CBUILD_URING_FEAT_RW_CUR_POS (1U << 3)
+	#define __CBUILD_URING_ENTER_GETEVENTS (1U << 0)
+	#define __CBUILD_URING_REGISTER_PROBE 8
+	#define __CBUILD_URING_OP_SUPPORTED (1U << 0)
+	#define __CBUILD_STATX_BASIC_STATS 0x7ffU
+	typedef struct __cbuild_uring_t {
+		int fd;
+		unsigned entries;
+		unsigned* sq_tail;
+		unsigned* sq_mask;
+		unsigned* sq_array;
+		unsigned* cq_head;
+		unsigned* cq_tail;
+		unsigned* cq_mask;
+		__cbuild_uring_sqe_t* sqes;
+		__cbuild_uring_cqe_t* cqes;
+		void* sq_ptr;
+		size_t sq_size;
+		void* cq_ptr; // Same as 'sq_ptr' if kernel maps both rings at once
+		size_t cq_size;
+		size_t sqes_size;
+		size_t* slots; // Operation of each submitted entry
+		bool* done; // If entry was completed
+		__cbuild_statx_t* statx;
+		bool supported[8]; // Indexed by 'cbuild_fs_op_kind_t'
+		bool cur_pos;
+	} __cbuild_uring_t;
+	// 'io_uring' can be disabled (sysctl, seccomp), so it is checked only once
+	pthread_mutex_t __cbuild_uring_lock = PTHREAD_MUTEX_INITIALIZER;
+	int __cbuild_uring_state = 0; // 1 - available, -1 - not available
+	CBUILDDEF void __cbuild_uring_free(__cbuild_uring_t* ring) {
+		if(ring->sqes != NULL) munmap(ring->sqes, ring->sqes_size);
+		if(ring->cq_ptr != NULL && ring->cq_ptr != ring->sq_ptr) {
+			munmap(ring->cq_ptr, ring->cq_size);
+		}
+		if(ring->sq_ptr != NULL) munmap(ring->sq_ptr, ring->sq_size);
+		if(ring->fd >= 0) close(ring->fd);
+		if(ring->slots != NULL) __CBUILD_FREE(ring->slots);
+		if(ring->done != NULL) __CBUILD_FREE(ring->done);
+		if(ring->statx != NULL) __CBUILD_FREE(ring->statx);
+		__CBUILD_FREE(ring);
+	}
+	CBUILDDEF void* __cbuild_uring_map(int fd, size_t size, uint64_t offset) {
+		void* ret = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+			fd, (off_t)offset);
+		return ret == MAP_FAILED ? NULL : ret;
+	}
+	CBUILDDEF __cbuild_uring_t* __cbuild_uring_create(void) {
+		pthread_mutex_lock(&__cbuild_uring_lock);
+		int state = __cbuild_uring_state;
+		pthread_mutex_unlock(&__cbuild_uring_lock);
+		if(state < 0) return NULL;
+		__cbuild_uring_params_t params = {0};
+		int fd = (int)syscall(SYS_io_uring_setup, CBUILD_FS_BATCH_SIZE, &params);
+		if(fd < 0) {
+			pthread_mutex_lock(&__cbuild_uring_lock);
+			__cbuild_uring_state = -1;
+			pthread_mutex_unlock(&__cbuild_uring_lock);
+			return NULL;
+		}
+		fcntl(fd, F_SETFD, FD_CLOEXEC);
+		__cbuild_uring_t* ring = __CBUILD_MALLOC(sizeof(__cbuild_uring_t));
+		cbuild_assert(ring != NULL, "Allocation failed.\n");
+		memset(ring, 0, sizeof(*ring));
+		ring->fd = fd;
+		ring->entries = params.sq_entries;
+		ring->sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		ring->cq_size = params.cq_off.cqes + params.cq_entries * sizeof(__cbuild_uring_cqe_t);
+		ring->sqes_size = params.sq_entries * sizeof(__cbuild_uring_sqe_t);
+		if(params.features & __CBUILD_URING_FEAT_SINGLE_MMAP) {
+			if(ring->cq_size > ring->sq_size) ring->sq_size = ring->cq_size;
+			ring->cq_size = ring->sq_size;
+		}
+		ring->sq_ptr = __cbuild_uring_map(fd, ring->sq_size, __CBUILD_URING_OFF_SQ_RING);
+		if(params.features & __CBUILD_URING_FEAT_SINGLE_MMAP) {
+			ring->cq_ptr = ring->sq_ptr;
+		} else {
+			ring->cq_ptr = __cbuild_uring_map(fd, ring->cq_size, __CBUILD_URING_OFF_CQ_RING);
+		}
+		ring->sqes = __cbuild_uring_map(fd, ring->sqes_size, __CBUILD_URING_OFF_SQES);
+		__cbuild_uring_probe_t probe = {0};
+		bool ok = ring->sq_ptr != NULL && ring->cq_ptr != NULL && ring->sqes != NULL;
+		// Probe is available since Linux 5.6, same as all used operations
+		// except 'unlinkat'
+		if(ok) {
+			ok = syscall(SYS_io_uring_register, fd, __CBUILD_URING_REGISTER_PROBE, &probe,
+				cbuild_arr_len(probe.ops)) == 0;
+		}
+		pthread_mutex_lock(&__cbuild_uring_lock);
+		__cbuild_uring_state = ok ? 1 : -1;
+		pthread_mutex_unlock(&__cbuild_uring_lock);
+		if(!ok) {
+			__cbuild_uring_free(ring);
+			return NULL;
+		}
+		char* sq = ring->sq_ptr;
+		char* cq = ring->cq_ptr;
+		ring->sq_tail = (unsigned*)(sq + params.sq_off.tail);
+		ring->sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+		ring->sq_array = (unsigned*)(sq + params.sq_off.array);
+		ring->cq_head = (unsigned*)(cq + params.cq_off.head);
+		ring->cq_tail = (unsigned*)(cq + params.cq_off.tail);
+		ring->cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+		ring->cqes = (__cbuild_uring_cqe_t*)(cq + params.cq_off.cqes);
+		ring->slots = __CBUILD_MALLOC(ring->entries * sizeof(size_t));
+		cbuild_assert(ring->slots != NULL, "Allocation failed.\n");
+		ring->done = __CBUILD_MALLOC(ring->entries * sizeof(bool));
+		cbuild_assert(ring->done != NULL, "Allocation failed.\n");
+		ring->statx = __CBUILD_MALLOC(ring->entries * sizeof(__cbuild_statx_t));
+		cbuild_assert(ring->statx != NULL, "Allocation failed.\n");
+		uint8_t ops[8] = {
+			[CBUILD_FS_OP_OPEN] = __CBUILD_URING_OP_OPENAT,
+			[CBUILD_FS_OP_READ] = __CBUILD_URING_OP_READ,
+			[CBUILD_FS_OP_WRITE] = __CBUILD_URING_OP_WRITE,
+			[CBUILD_FS_OP_STAT] = __CBUILD_URING_OP_STATX,
+			[CBUILD_FS_OP_LSTAT] = __CBUILD_URING_OP_STATX,
+			[CBUILD_FS_OP_UNLINK] = __CBUILD_URING_OP_UNLINKAT,
+			[CBUILD_FS_OP_RMDIR] = __CBUILD_URING_OP_UNLINKAT,
+			[CBUILD_FS_OP_CLOSE] = __CBUILD_URING_OP_CLOSE,
+		};
+		for(size_t i = 0; i < cbuild_arr_len(ops); i++) {
+			ring->supported[i] = ops[i] < probe.ops_len &&
+				(probe.ops[ops[i]].flags & __CBUILD_URING_OP_SUPPORTED);
+		}
+		ring->cur_pos = params.features & __CBUILD_URING_FEAT_RW_CUR_POS;
+		return ring;
+	}
+	CBUILDDEF bool __cbuild_uring_supports(__cbuild_uring_t* ring, cbuild_fs_op_t* op) {
+		if(!ring->supported[op->kind]) return false;
+		if(op->kind == CBUILD_FS_OP_READ || op->kind == CBUILD_FS_OP_WRITE) {
+			return op->offset >= 0 || ring->cur_pos;
+		}
+		return true;
+	}
+	CBUILDDEF void __cbuild_statx_to_stat(const __cbuild_statx_t* stx,
+		struct stat* statbuff) {
+		memset(statbuff, 0, sizeof(*statbuff));
+		statbuff->st_dev = makedev(stx->dev_major, stx->dev_minor);
+		statbuff->st_ino = stx->ino;
+		statbuff->st_mode = stx->mode;
+		statbuff->st_nlink = stx->nlink;
+		statbuff->st_uid = stx->uid;
+		statbuff->st_gid = stx->gid;
+		statbuff->st_rdev = makedev(stx->rdev_major, stx->rdev_minor);
+		statbuff->st_size = (off_t)stx->size;
+		statbuff->st_blksize = (blksize_t)stx->blksize;
+		statbuff->st_blocks = (blkcnt_t)stx->blocks;
+		statbuff->st_atim.tv_sec = stx->atime.tv_sec;
+		statbuff->st_atim.tv_nsec = stx->atime.tv_nsec;
+		statbuff->st_mtim.tv_sec = stx->mtime.tv_sec;
+		statbuff->st_mtim.tv_nsec = stx->mtime.tv_nsec;
+		statbuff->st_ctim.tv_sec = stx->ctime.tv_sec;
+		statbuff->st_ctim.tv_nsec = stx->ctime.tv_nsec;
+	}
+	CBUILDDEF bool __cbuild_fs_op_run(cbuild_fs_batch_t* batch, cbuild_fs_op_t* op);
+	// Reap all available completions
+	CBUILDDEF bool __cbuild_uring_reap(cbuild_fs_batch_t* batch, __cbuild_uring_t* ring,
+		size_t* completed) {
+		bool ok = true;
+		unsigned head = *ring->cq_head;
+		unsigned cq_tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+		for(; head != cq_tail; head++) {
+			__cbuild_uring_cqe_t* cqe = &ring->cqes[head & *ring->cq_mask];
+			size_t i = (size_t)cqe->user_data;
+			cbuild_fs_op_t* op = &batch->data[ring->slots[i]];
+			op->result = cqe->res;
+			if(cqe->res < 0) {
+				ok = false;
+			} else if(op->kind == CBUILD_FS_OP_STAT || op->kind == CBUILD_FS_OP_LSTAT) {
+				__cbuild_statx_to_stat(&ring->statx[i], op->statbuff);
+			}
+			ring->done[i] = true;
+			(*completed)++;
+		}
+		__atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+		return ok;
+	}
+	// Submits 'count' operations from 'ring->slots' and waits for all of them.
+	// If ring fails, operations that kernel already took are waited for, ring
+	// is freed and the rest are run synchronously. If even waiting fails,
+	// in-flight operations are marked as failed and ring is leaked, because
+	// kernel may still write into its buffers.
+	CBUILDDEF bool __cbuild_uring_run(cbuild_fs_batch_t* batch, __cbuild_uring_t* ring,
+		size_t count) {
+		unsigned tail = *ring->sq_tail;
+		for(size_t i = 0; i < count; i++) {
+			ring->done[i] = false;
+			cbuild_fs_op_t* op = &batch->data[ring->slots[i]];
+			unsigned idx = tail & *ring->sq_mask;
+			__cbuild_uring_sqe_t* sqe = &ring->sqes[idx];
+			memset(sqe, 0, sizeof(*sqe));
+			sqe->fd = op->fd;
+			sqe->user_data = i;
+			switch(op->kind) {
+			case CBUILD_FS_OP_OPEN:
+				sqe->opcode = __CBUILD_URING_OP_OPENAT;
+				sqe->addr = (uint64_t)(uintptr_t)op->path;
+				sqe->len = (uint32_t)op->mode;
+				sqe->op_flags = (uint32_t)op->flags;
+				break;
+			case CBUILD_FS_OP_READ:
+			case CBUILD_FS_OP_WRITE:
+				sqe->opcode = op->kind == CBUILD_FS_OP_READ ? __CBUILD_URING_OP_READ :
+					__CBUILD_URING_OP_WRITE;
+				sqe->addr = (uint64_t)(uintptr_t)op->buff;
+				// Same limit as for 'read' and 'write'
+				sqe->len = op->size > 0x7ffff000 ? 0x7ffff000 : (uint32_t)op->size;
+				sqe->off = op->offset < 0 ? (uint64_t)-1 : (uint64_t)op->offset;
+				break;
+			case CBUILD_FS_OP_STAT:
+			case CBUILD_FS_OP_LSTAT:
+				sqe->opcode = __CBUILD_URING_OP_STATX;
+				sqe->addr = (uint64_t)(uintptr_t)op->path;
+				sqe->len = __CBUILD_STATX_BASIC_STATS;
+				sqe->op_flags = op->kind == CBUILD_FS_OP_LSTAT ? AT_SYMLINK_NOFOLLOW : 0;
+				sqe->off = (uint64_t)(uintptr_t)&ring->statx[i];
+				break;
+			case CBUILD_FS_OP_UNLINK:
+			case CBUILD_FS_OP_RMDIR:
+				sqe->opcode = __CBUILD_URING_OP_UNLINKAT;
+				sqe->addr = (uint64_t)(uintptr_t)op->path;
+				sqe->op_flags = op->kind == CBUILD_FS_OP_RMDIR ? AT_REMOVEDIR : 0;
+				break;
+			case CBUILD_FS_OP_CLOSE:
+				sqe->opcode = __CBUILD_URING_OP_CLOSE;
+				break;
+			default: CBUILD_UNREACHABLE("Invalid file system operation.");
+			}
+			ring->sq_array[idx] = idx;
+			tail++;
+		}
+		__atomic_store_n(ring->sq_tail, tail, __ATOMIC_RELEASE);
+		size_t submitted = 0;
+		size_t completed = 0;
+		bool ok = true;
+		bool failed = false;
+		int lost = 0; // Error of a failed wait
+		while(completed < count) {
+			// After failure nothing is submitted, in-flight entries are only
+			// waited for
+			size_t to_submit = failed ? 0 : count - submitted;
+			size_t wait = failed ? submitted - completed : count - completed;
+			if(wait == 0) break;
+			int ret = (int)syscall(SYS_io_uring_enter, ring->fd, (unsigned)to_submit,
+				(unsigned)wait, __CBUILD_URING_ENTER_GETEVENTS, NULL, 0);
+			batch->syscalls++;
+			if(ret < 0) {
+				if(errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+				if(failed) {
+					lost = errno;
+					cbuild_log_error("Could not wait for file system operations, error: \"%s\"",
+						strerror(errno));
+					break;
+				}
+				cbuild_log_warn("Could not submit file system operations, error: \"%s\", "
+					"falling back to synchronous mode.", strerror(errno));
+				failed = true;
+				continue;
+			}
+			if(!failed) submitted += (size_t)ret;
+			if(!__cbuild_uring_reap(batch, ring, &completed)) ok = false;
+		}
+		if(!failed) return ok;
+		// Entries that were not submitted are still in submission queue, so
+		// ring can not be reused. Kernel takes entries in order, so first
+		// 'submitted' ones are in-flight.
+		for(size_t i = 0; i < count; i++) {
+			if(ring->done[i]) continue;
+			if(lost != 0 && i < submitted) {
+				batch->data[ring->slots[i]].result = -lost;
+				ok = false;
+				continue;
+			}
+			if(!__cbuild_fs_op_run(batch, &batch->data[ring->slots[i]])) ok = false;
+		}
+		if(lost == 0) __cbuild_uring_free(ring);
+		batch->ring = NULL;
+		return ok;
+	}
+#endif // __CBUILD_FS_URING
+#if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
+	CBUILDDEF size_t __cbuild_fs_batch_add(cbuild_fs_batch_t* batch,
+		cbuild_fs_op_t op) {
+		op.result = 0;
+		cbuild_da_append(batch, op);
+		return batch->size - 1;
+	}
+	CBUILDDEF size_t cbuild_fs_batch_open(cbuild_fs_batch_t* batch, cbuild_fd_t dir,
+		const char* path, int flags, mode_t mode) {
+		return __cbuild_fs_batch_add(batch, (cbuild_fs_op_t){
+				.kind = CBUILD_FS_OP_OPEN,
+				.fd = dir,
+				.path = path,
+				.flags = flags,
+				.mode = mode,
+			});
+	}
+	CBUILDDEF size_t cbuild_fs_batch_read(cbuild_fs_batch_t* batch, cbuild_fd_t fd,
+		void* buff, size_t size, off_t offset) {
+		return __cbuild_fs_batch_add(batch, (cbuild_fs_op_t){
+				.kind = CBUILD_FS_OP_READ,
+				.fd = fd,
+				.buff = buff,
+				.size = size,
+				.offset = offset,
+			});
+	}
+	CBUILDDEF size_t cbuild_fs_batch_write(cbuild_fs_batch_t* batch, cbuild_fd_t fd,
+		const void* buff, size_t size, off_t offset) {
+		return __cbuild_fs_batch_add(batch, (cbuild_fs_op_t){
+				.kind = CBUILD_FS_OP_WRITE,
+				.fd = fd,
+				.buff = (void*)buff,
+				.size = size,
+				.offset = offset,
+			});
+	}
+	CBUILDDEF size_t cbuild_fs_batch_stat(cbuild_fs_batch_t* batch, cbuild_fd_t dir,
+		const char* path, struct stat* statbuff, bool follow) {
+		return __cbuild_fs_batch_add(batch, (cbuild_fs_op_t){
+				.kind = follow ? CBUILD_FS_OP_STAT : CBUILD_FS_OP_LSTAT,
+				.fd = dir,
+				.path = path,
+				.statbuff = statbuff,
+			});
+	}
+	CBUILDDEF size_t cbuild_fs_batch_unlink(cbuild_fs_batch_t* batch, cbuild_fd_t dir,
+		const char* path, bool is_dir) {
+		return __cbuild_fs_batch_add(batch, (cbuild_fs_op_t){
+				.kind = is_dir ? CBUILD_FS_OP_RMDIR : CBUILD_FS_OP_UNLINK,
+				.fd = dir,
+				.path = path,
+			});
+	}
+	CBUILDDEF size_t cbuild_fs_batch_close(cbuild_fs_batch_t* batch, cbuild_fd_t fd) {
+		return __cbuild_fs_batch_add(batch, (cbuild_fs_op_t){
+				.kind = CBUILD_FS_OP_CLOSE,
+				.fd = fd,
+			});
+	}
+	CBUILDDEF bool __cbuild_fs_op_run(cbuild_fs_batch_t* batch, cbuild_fs_op_t* op) {
+		ssize_t ret = 0;
+		batch->syscalls++;
+		switch(op->kind) {
+		#if defined(__CBUILD_STAT_AT)
+			case CBUILD_FS_OP_OPEN: ret = openat(op->fd, op->path, op->flags, op->mode); break;
+			case CBUILD_FS_OP_STAT: ret = fstatat(op->fd, op->path, op->statbuff, 0); break;
+			case CBUILD_FS_OP_LSTAT:
+				ret = fstatat(op->fd, op->path, op->statbuff, AT_SYMLINK_NOFOLLOW);
+				break;
+			case CBUILD_FS_OP_UNLINK: ret = unlinkat(op->fd, op->path, 0); break;
+			case CBUILD_FS_OP_RMDIR: ret = unlinkat(op->fd, op->path, AT_REMOVEDIR); break;
+			case CBUILD_FS_OP_READ:
+				ret = op->offset < 0 ? read(op->fd, op->buff, op->size) :
+					pread(op->fd, op->buff, op->size, op->offset);
+				break;
+			case CBUILD_FS_OP_WRITE:
+				ret = op->offset < 0 ? write(op->fd, op->buff, op->size) :
+					pwrite(op->fd, op->buff, op->size, op->offset);
+				break;
+		#else
+			case CBUILD_FS_OP_OPEN: ret = open(op->path, op->flags, op->mode); break;
+			case CBUILD_FS_OP_STAT: ret = stat(op->path, op->statbuff); break;
+			case CBUILD_FS_OP_LSTAT: ret = lstat(op->path, op->statbuff); break;
+			case CBUILD_FS_OP_UNLINK: ret = unlink(op->path); break;
+			case CBUILD_FS_OP_RMDIR: ret = rmdir(op->path); break;
+			case CBUILD_FS_OP_READ:
+				if(op->offset >= 0 && lseek(op->fd, op->offset, SEEK_SET) < 0) ret = -1;
+				else ret = read(op->fd, op->buff, op->size);
+				break;
+			case CBUILD_FS_OP_WRITE:
+				if(op->offset >= 0 && lseek(op->fd, op->offset, SEEK_SET) < 0) ret = -1;
+				else ret = write(op->fd, op->buff, op->size);
+				break;
+		#endif // __CBUILD_STAT_AT
+		case CBUILD_FS_OP_CLOSE: ret = close(op->fd); break;
+		default: CBUILD_UNREACHABLE("Invalid file system operation.");
+		}
+		op->result = ret < 0 ? -errno : ret;
+		return ret >= 0;
+	}
+	CBUILDDEF bool cbuild_fs_batch_submit(cbuild_fs_batch_t* batch) {
+		bool ok = true;
+		size_t begin = batch->submitted;
+		batch->submitted = batch->size;
+		#if defined(__CBUILD_FS_URING)
+			// Ring is not worth it for a single operation
+			if(batch->ring == NULL && !batch->sync && batch->size - begin > 1) {
+				batch->ring = __cbuild_uring_create();
+			}
+			__cbuild_uring_t* ring = batch->sync ? NULL : batch->ring;
+			if(ring != NULL) {
+				size_t count = 0;
+				for(size_t i = begin; i < batch->size; i++) {
+					// Ring is freed if it fails
+					if(batch->ring == NULL || !__cbuild_uring_supports(ring, &batch->data[i])) {
+						if(!__cbuild_fs_op_run(batch, &batch->data[i])) ok = false;
+						continue;
+					}
+					ring->slots[count++] = i;
+					if(count == ring->entries) {
+						if(!__cbuild_uring_run(batch, ring, count)) ok = false;
+						count = 0;
+					}
+				}
+				if(count > 0 && !__cbuild_uring_run(batch, ring, count)) ok = false;
+				return ok;
+			}
+		#endif // __CBUILD_FS_URING
+		for(size_t i = begin; i < batch->size; i++) {
+			if(!__cbuild_fs_op_run(batch, &batch->data[i])) ok = false;
+		}
+		return ok;
+	}
+	CBUILDDEF void cbuild_fs_batch_reset(cbuild_fs_batch_t* batch) {
+		batch->size = 0;
+		batch->submitted = 0;
+	}
+	CBUILDDEF void cbuild_fs_batch_free(cbuild_fs_batch_t* batch) {
+		#if defined(__CBUILD_FS_URING)
+			if(batch->ring != NULL) __cbuild_uring_free(batch->ring);
+		#endif // __CBUILD_FS_URING
+		if(batch->data != NULL) __CBUILD_FREE(batch->data);
+		*batch = (cbuild_fs_batch_t){0};
+	}
+#endif // CBUILD_API_*
+#if defined(__CBUILD_STAT_AT)
+	// Parallel tree engine for recursive copy and remove. Every directory is
+	// a node that is processed by one of workers, entries are accessed
+	// relative to a directory fd and 'd_type' is used instead of 'stat'.
+	// Copy follows symbolic links, remove removes links themselves.
+	// Node is finished when it and all its child directories are done, for
+	// remove this is when directory itself is deleted.
+	typedef struct __cbuild_fs_tree_node_t {
+		struct __cbuild_fs_tree_node_t* parent;
+		struct __cbuild_fs_tree_node_t* next;
+		char* src;
+		char* dst; // NULL when removing
+		size_t pending; // Unfinished child directories plus node itself
+		mode_t mode; // Of a source directory, set on a copy when it is done
+	} __cbuild_fs_tree_node_t;
+	typedef struct __cbuild_fs_tree_t {
+		pthread_mutex_t lock;
+		pthread_cond_t cond;
+		__cbuild_fs_tree_node_t* stack; // LIFO, so depth-first
+		size_t active; // Nodes that are queued or processed
+		size_t group; // Files that one worker opens at once when copying
+		bool ok;
+	} __cbuild_fs_tree_t;
+	CBUILDDEF char* __cbuild_fs_tree_join(const char* dir, const char* name) {
+		size_t dir_len = dir == NULL ? 0 : strlen(dir);
+		size_t name_len = strlen(name);
+		char* ret = __CBUILD_MALLOC(dir_len + name_len + 2);
+		cbuild_assert(ret != NULL, "Allocation failed.\n");
+		char* it = ret;
+		if(dir != NULL) {
+			memcpy(it, dir, dir_len);
+			it += dir_len;
+			*it++ = '/';
+		}
+		memcpy(it, name, name_len + 1);
+		return ret;
+	}
+	CBUILDDEF void __cbuild_fs_tree_fail(__cbuild_fs_tree_t* tree) {
+		pthread_mutex_lock(&tree->lock);
+		tree->ok = false;
+		pthread_mutex_unlock(&tree->lock);
+	}
+	// Takes ownership of 'src' and 'dst'
+	CBUILDDEF void __cbuild_fs_tree_push(__cbuild_fs_tree_t* tree,
+		__cbuild_fs_tree_node_t* parent, char* src, char* dst) {
+		__cbuild_fs_tree_node_t* node = __CBUILD_MALLOC(sizeof(__cbuild_fs_tree_node_t));
+		cbuild_assert(node != NULL, "Allocation failed.\n");
+		node->parent = parent;
+		node->src = src;
+		node->dst = dst;
+		node->pending = 1;
+		node->mode = 0;
+		pthread_mutex_lock(&tree->lock);
+		if(parent != NULL) parent->pending++;
+		node->next = tree->stack;
+		tree->stack = node;
+		tree->active++;
+		pthread_cond_signal(&tree->cond);
+		pthread_mutex_unlock(&tree->lock);
+	}
+	CBUILDDEF void __cbuild_fs_tree_finish(__cbuild_fs_tree_t* tree,
+		__cbuild_fs_tree_node_t* node) {
+		while(node != NULL) {
+			pthread_mutex_lock(&tree->lock);
+			bool done = --node->pending == 0;
+			pthread_mutex_unlock(&tree->lock);
+			if(!done) return;
+			if(node->dst == NULL && rmdir(node->src) < 0) {
+				cbuild_log_error("Could not remove directory \"%s\", error: \"%s\"",
+					node->src, strerror(errno));
+				__cbuild_fs_tree_fail(tree);
+			}
+			// Mode is set last, so read-only directory can still be filled
+			if(node->dst != NULL && node->mode != 0 && chmod(node->dst, node->mode) < 0) {
+				cbuild_log_error("Could not set mode of directory \"%s\", error: \"%s\"",
+					node->dst, strerror(errno));
+				__cbuild_fs_tree_fail(tree);
+			}
+			__cbuild_fs_tree_node_t* parent = node->parent;
+			__CBUILD_FREE(node->src);
+			if(node->dst != NULL) __CBUILD_FREE(node->dst);
+			__CBUILD_FREE(node);
+			node = parent;
+		}
+	}
+	// 1 for directory, 0 for anything else and -1 on error. Links are
+	// resolved if 'follow' is set.
+	CBUILDDEF int __cbuild_fs_tree_is_dir(int dir_fd, struct dirent* ent, bool follow) {
+		#if defined(DT_UNKNOWN) && defined(DT_LNK)
+			if(ent->d_type != DT_UNKNOWN && !(follow && ent->d_type == DT_LNK)) {
+				return ent->d_type == DT_DIR;
+			}
+		#endif // DT_UNKNOWN
+		struct stat statbuff;
+		if(fstatat(dir_fd, ent->d_name, &statbuff, follow ? 0 : AT_SYMLINK_NOFOLLOW) < 0) {
+			return -1;
+		}
+		return S_ISDIR(statbuff.st_mode);
+	}
+	// Files of a directory are collected into 'names' and then removed, or
+	// opened and closed, with a batch
+	CBUILDDEF bool __cbuild_fs_tree_flush(__cbuild_fs_tree_node_t* node,
+		int src_fd, int dst_fd, cbuild_fs_batch_t* batch, cbuild_sb_t* names) {
+		bool ok = true;
+		cbuild_fs_batch_reset(batch);
+		for(size_t i = 0; i < names->size; i += strlen(names->data + i) + 1) {
+			const char* name = names->data + i;
+			if(node->dst == NULL) {
+				cbuild_fs_batch_unlink(batch, src_fd, name, false);
+			} else {
+				cbuild_fs_batch_open(batch, src_fd, name, O_RDONLY | O_CLOEXEC, 0);
+				cbuild_fs_batch_open(batch, dst_fd, name,
+					O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+			}
+		}
+		cbuild_fs_batch_submit(batch);
+		size_t count = batch->size;
+		for(size_t i = 0; node->dst == NULL && i < count; i++) {
+			if(batch->data[i].result < 0) {
+				cbuild_log_error("Could not remove file \"%s/%s\", error: \"%s\"",
+					node->src, batch->data[i].path, strerror((int)-batch->data[i].result));
+				ok = false;
+			}
+		}
+		// Stat cache is invalidated once by the caller, after the whole tree
+		for(size_t i = 0; node->dst != NULL && i < count; i += 2) {
+			const char* name = batch->data[i].path;
+			int src = (int)batch->data[i].result;
+			int dst = (int)batch->data[i + 1].result;
+			char* src_path = __cbuild_fs_tree_join(node->src, name);
+			char* dst_path = __cbuild_fs_tree_join(node->dst, name);
+			if(src < 0) {
+				cbuild_log_error("Could not open file \"%s\", error: \"%s\"", src_path,
+					strerror(-src));
+			}
+			if(dst < 0) {
+				cbuild_log_error("Could not open file \"%s\", error: \"%s\"", dst_path,
+					strerror(-dst));
+			}
+			if(src < 0 || dst < 0 || !__cbuild_fs_copy_fd(src, dst, src_path, dst_path)) {
+				ok = false;
+			}
+			__CBUILD_FREE(src_path);
+			__CBUILD_FREE(dst_path);
+			if(src >= 0) cbuild_fs_batch_close(batch, src);
+			if(dst >= 0) cbuild_fs_batch_close(batch, dst);
+		}
+		if(node->dst != NULL) cbuild_fs_batch_submit(batch);
+		cbuild_fs_batch_reset(batch);
+		names->size = 0;
+		return ok;
+	}
+	CBUILDDEF void __cbuild_fs_tree_process(__cbuild_fs_tree_t* tree,
+		__cbuild_fs_tree_node_t* node, cbuild_fs_batch_t* batch) {
+		int dst_fd = -1;
+		if(node->dst != NULL) {
+			dst_fd = open(node->dst, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+			if(dst_fd < 0) {
+				cbuild_log_error("Could not open directory \"%s\", error: \"%s\"",
+					node->dst, strerror(errno));
+				__cbuild_fs_tree_fail(tree);
+				__cbuild_fs_tree_finish(tree, node);
+				return;
+			}
+		}
+		int src_fd = open(node->src, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		DIR* dir = src_fd < 0 ? NULL : fdopendir(src_fd);
+		if(dir == NULL) {
+			cbuild_log_error("Could not open directory \"%s\", error: \"%s\"",
+				node->src, strerror(errno));
+			if(src_fd >= 0) close(src_fd);
+			if(dst_fd >= 0) close(dst_fd);
+			__cbuild_fs_tree_fail(tree);
+			__cbuild_fs_tree_finish(tree, node);
+			return;
+		}
+		struct stat statbuff;
+		if(node->dst != NULL && fstat(src_fd, &statbuff) == 0) {
+			node->mode = statbuff.st_mode & 07777;
+		}
+		cbuild_sb_t names = {0};
+		size_t files = 0;
+		size_t group = node->dst == NULL ? CBUILD_FS_BATCH_SIZE : tree->group;
+		while(true) {
+			errno = 0;
+			struct dirent* ent = readdir(dir);
+			if(ent == NULL) {
+				if(errno != 0) {
+					cbuild_log_error("Could not read directory \"%s\", error: \"%s\"",
+						node->src, strerror(errno));
+					__cbuild_fs_tree_fail(tree);
+				}
+				break;
+			}
+			const char* name = ent->d_name;
+			if(strcmp(name, ".") == 0 || strcmp(name, "..") == 0) continue;
+			int is_dir = __cbuild_fs_tree_is_dir(src_fd, ent, node->dst != NULL);
+			bool ok = is_dir >= 0;
+			if(!ok) {
+				cbuild_log_error("Could not stat file \"%s/%s\", error: \"%s\"",
+					node->src, name, strerror(errno));
+			} else if(is_dir && node->dst == NULL) {
+				__cbuild_fs_tree_push(tree, node, __cbuild_fs_tree_join(node->src, name), NULL);
+			} else if(is_dir) {
+				// Final mode is set when directory is done
+				ok = mkdirat(dst_fd, name, S_IRWXU) == 0 || errno == EEXIST;
+				if(ok) {
+					__cbuild_fs_tree_push(tree, node, __cbuild_fs_tree_join(node->src, name),
+						__cbuild_fs_tree_join(node->dst, name));
+				} else {
+					cbuild_log_error("Could not create directory \"%s/%s\", error: \"%s\"",
+						node->dst, name, strerror(errno));
+				}
+			} else {
+				cbuild_da_append_arr(&names, name, strlen(name) + 1);
+				if(++files == group) {
+					ok = __cbuild_fs_tree_flush(node, src_fd, dst_fd, batch, &names);
+					files = 0;
+				}
+			}
+			if(!ok) __cbuild_fs_tree_fail(tree);
+		}
+		if(files > 0 && !__cbuild_fs_tree_flush(node, src_fd, dst_fd, batch, &names)) {
+			__cbuild_fs_tree_fail(tree);
+		}
+		if(names.data != NULL) cbuild_da_clear(&names);
+		closedir(dir);
+		if(dst_fd >= 0) close(dst_fd);
+		__cbuild_fs_tree_finish(tree, node);
+	}
+	CBUILDDEF void __cbuild_fs_tree_work(__cbuild_fs_tree_t* tree,
+		cbuild_fs_batch_t* batch) {
+		pthread_mutex_lock(&tree->lock);
+		while(true) {
+			while(tree->stack == NULL && tree->active > 0) {
+				pthread_cond_wait(&tree->cond, &tree->lock);
+			}
+			if(tree->stack == NULL) break;
+			__cbuild_fs_tree_node_t* node = tree->stack;
+			tree->stack = node->next;
+			pthread_mutex_unlock(&tree->lock);
+			__cbuild_fs_tree_process(tree, node, batch);
+			pthread_mutex_lock(&tree->lock);
+			if(--tree->active == 0) pthread_cond_broadcast(&tree->cond);
+		}
+		pthread_mutex_unlock(&tree->lock);
+	}
+	// Every worker has its own batch
+	CBUILDDEF void* __cbuild_fs_tree_worker(void* arg) {
+		cbuild_fs_batch_t batch = {0};
+		__cbuild_fs_tree_work(arg, &batch);
+		cbuild_fs_batch_free(&batch);
+		return NULL;
+	}
+	// Copy 'src' into existing 'dst', or remove 'src' if 'dst' is NULL
+	CBUILDDEF bool __cbuild_fs_tree_run(const char* src, const char* dst) {
+		__cbuild_fs_tree_t tree = { .ok = true };
+		pthread_mutex_init(&tree.lock, NULL);
+		pthread_cond_init(&tree.cond, NULL);
+		__cbuild_fs_tree_push(&tree, NULL, __cbuild_fs_tree_join(NULL, src),
+			dst == NULL ? NULL : __cbuild_fs_tree_join(NULL, dst));
+		// Root is processed before starting workers, so flat directories
+		// never start threads
+		__cbuild_fs_tree_node_t* root = tree.stack;
+		tree.stack = NULL;
+		// Work is mostly waiting on a filesystem, so even single core
+		// benefits from few threads
+		int nproc = cbuild_nproc();
+		size_t workers = nproc < 4 ? 4 : (size_t)nproc;
+		// Every worker keeps two directories and a group of file pairs open,
+		// all workers together use at most half of descriptor limit
+		tree.group = CBUILD_FS_BATCH_SIZE / 2;
+		struct rlimit limit;
+		if(getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY) {
+			size_t per_worker = (size_t)limit.rlim_cur / 2 / workers;
+			size_t group = per_worker > 4 ? (per_worker - 2) / 2 : 1;
+			if(group < tree.group) tree.group = group;
+		}
+		cbuild_fs_batch_t batch = {0};
+		__cbuild_fs_tree_process(&tree, root, &batch);
+		tree.active--;
+		size_t queued = 0;
+		for(__cbuild_fs_tree_node_t* it = tree.stack; it != NULL; it = it->next) queued++;
+		if(workers > queued) workers = queued;
+		if(workers > 1) {
+			pthread_t* threads = __CBUILD_MALLOC((workers - 1) * sizeof(pthread_t));
+			cbuild_assert(threads != NULL, "Allocation failed.\n");
+			bool* started = __CBUILD_MALLOC((workers - 1) * sizeof(bool));
+			cbuild_assert(started != NULL, "Allocation failed.\n");
+			for(size_t i = 0; i < workers - 1; i++) {
+				started[i] = pthread_create(&threads[i], NULL, __cbuild_fs_tree_worker,
+					&tree) == 0;
+			}
+			__cbuild_fs_tree_work(&tree, &batch);
+			for(size_t i = 0; i < workers - 1; i++) {
+				if(started[i]) pthread_join(threads[i], NULL);
+			}
+			__CBUILD_FREE(started);
+			__CBUILD_FREE(threads);
+		} else if(queued > 0) {
+			__cbuild_fs_tree_work(&tree, &batch);
+		}
+		cbuild_fs_batch_free(&batch);
+		pthread_cond_destroy(&tree.cond);
+		pthread_mutex_destroy(&tree.lock);
+		cbuild_stat_invalidate_all();
+		return tree.ok;
+	}
+#endif // __CBUILD_STAT_AT
+CBUILDDEF cbuild_filetype_t __cbuild_path_filetype_resolved(const char* path);
 CBUILDDEF bool cbuild_dir_copy(const char* src, const char* dst) {
 	bool err = cbuild_dir_create(dst);
 	if(err == false) {
@@ -244,6 +1606,9 @@ CBUILDDEF bool cbuild_dir_copy(const char* src, const char* dst) {
 			dst);
 		return false;
 	}
+#if defined(__CBUILD_STAT_AT)
+	return __cbuild_fs_tree_run(src, dst);
+#else
 	cbuild_pathlist_t list = {0};
 	err = cbuild_dir_list(src, &list);
 	if(err == false) {
@@ -258,9 +1623,10 @@ CBUILDDEF bool cbuild_dir_copy(const char* src, const char* dst) {
 	for(size_t i = 0; i < list.size; i++) {
 		const char* tmpsrc = cbuild_temp_sprintf("%s/%s", src, list.data[i]);
 		const char* tmpdst = cbuild_temp_sprintf("%s/%s", dst, list.data[i]);
-		cbuild_filetype_t f = cbuild_path_filetype(tmpsrc);
+		// Copy follows symbolic links
+		cbuild_filetype_t f = __cbuild_path_filetype_resolved(tmpsrc);
 		if (f == CBUILD_FTYPE_MISSING) {
-			CBUILD_UNREACHABLE("cbuild_dir_list should not return invalid files.");
+			ret = false;
 		} else if(f == CBUILD_FTYPE_DIRECTORY) {
 			bool tmp = ret && cbuild_dir_copy(tmpsrc, tmpdst);
 			ret = tmp;
@@ -271,9 +1637,22 @@ CBUILDDEF bool cbuild_dir_copy(const char* src, const char* dst) {
 		cbuild_temp_reset(checkpoint);
 	}
 	cbuild_pathlist_clear(&list);
+	// Mode is set last, so read-only directory can still be filled
+	struct stat statbuff;
+	if(ret && cbuild_stat(src, &statbuff) &&
+		chmod(dst, statbuff.st_mode & 07777) < 0) {
+		cbuild_log_error("Could not set mode of directory \"%s\", error: \"%s\"",
+			dst, strerror(errno));
+		ret = false;
+	}
 	return ret;
+#endif // __CBUILD_STAT_AT
 }
 CBUILDDEF bool cbuild_dir_move(const char* src, const char* dst) {
+	if(rename(src, dst) == 0) {
+		cbuild_stat_invalidate_all();
+		return true;
+	}
 	bool ret = cbuild_dir_copy(src, dst);
 	if(ret == false) {
 		return false;
@@ -282,6 +1661,8 @@ CBUILDDEF bool cbuild_dir_move(const char* src, const char* dst) {
 }
 #if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
 	CBUILDDEF bool __cbuild_fs_rmdir(const char* path) {
+		// Paths inside of a directory may be cached too
+		cbuild_stat_invalidate_all();
 		int stat = rmdir(path);
 		if(stat < 0) {
 			cbuild_log_error(
@@ -293,6 +1674,9 @@ CBUILDDEF bool cbuild_dir_move(const char* src, const char* dst) {
 	}
 #endif // CBUILD_API_*
 CBUILDDEF bool cbuild_dir_remove(const char* path) {
+#if defined(__CBUILD_STAT_AT)
+	return __cbuild_fs_tree_run(path, NULL);
+#else
 	cbuild_pathlist_t list = {0};
 	bool err = cbuild_dir_list(path, &list);
 	if(err == false) {
@@ -324,6 +1708,7 @@ CBUILDDEF bool cbuild_dir_remove(const char* path) {
 	}
 	cbuild_pathlist_clear(&list);
 	return ret;
+#endif // __CBUILD_STAT_AT
 }
 CBUILDDEF bool cbuild_dir_check(const char* path) {
 	return cbuild_file_check(path);
@@ -347,7 +1732,9 @@ CBUILDDEF bool cbuild_dir_list(const char* path, cbuild_pathlist_t* elements) {
 		file_copy[len] = '\0';
 		cbuild_da_append(elements, file_copy);
 	}
-	qsort(elements->data, elements->size, sizeof(char*), __cbuild_fs_compare);
+	if (elements->size > 0) {
+		qsort(elements->data, elements->size, sizeof(char*), __cbuild_fs_compare);
+	}
 	if (!cbuild_dir_close(dir)) return false;
 	if (ret == -1) return false;
 	return true;
@@ -382,82 +1769,565 @@ CBUILDDEF bool cbuild_dir_list(const char* path, cbuild_pathlist_t* elements) {
 		return true;
 	}
 #endif // CBUILD_API_*
-CBUILDDEF cbuild_filetype_t __cbuild_path_filetype_resolved(const char* path);
-CBUILDDEF bool __cbuild_dir_walk_opt(cbuild_sb_t* path, size_t level, bool* abort,
-	cbuild_dir_walk_func_t func, struct cbuild_dir_walk_opts_t opts) {
-	size_t curr_path_len = path->size;
-	cbuild_sb_append_null(path);
-	cbuild_filetype_t ftype_raw = cbuild_path_filetype(path->data);
-	cbuild_filetype_t ftype = __cbuild_path_filetype_resolved(path->data);
-	if (!opts.visit_dir_last) {
-		enum cbuild_dir_walk_result_t res = CBUILD_DIR_WALK_CONTINUE;
+// Call walker callback. 1 means continue, 0 means skip and -1 is an error
+CBUILDDEF int __cbuild_dir_walk_call(cbuild_dir_walk_func_t func,
+	cbuild_dir_walk_func_args_t args, bool* abort) {
+	enum cbuild_dir_walk_result_t res = CBUILD_DIR_WALK_CONTINUE;
+	args.result = &res;
+	if (!func(args)) return -1;
+	switch (res) {
+	case CBUILD_DIR_WALK_CONTINUE: break;
+	case CBUILD_DIR_WALK_STOP: *abort = true; CBUILD_ATTR_FALLTHROUGH();
+	case CBUILD_DIR_WALK_NO_ENTER: return 0;
+	}
+	return 1;
+}
+#if defined(__CBUILD_STAT_AT)
+	// Directory reader for a walker. On Linux entries are read in bulk with
+	// 'getdents64', otherwise this is a thin wrapper around 'readdir'.
+	#if defined(CBUILD_API_POSIX) && defined(CBUILD_OS_LINUX) && defined(SYS_getdents64)
+		#define __CBUILD_GETDENTS
+		#define __CBUILD_GETDENTS_SIZE ((size_t)32 * (size_t)1024)
+		// Layout of 'struct linux_dirent64'
+		typedef struct __cbuild_dirent64_t {
+			uint64_t d_ino;
+			int64_t d_off;
+			unsigned short d_reclen;
+			unsigned char d_type;
+			char d_name[];
+		} __cbuild_dirent64_t;
+	#endif // Extension check
+	typedef struct __cbuild_dir_reader_t {
+		int fd;
+		#if defined(__CBUILD_GETDENTS)
+			char* buff;
+			size_t pos;
+			size_t len;
+		#else
+			DIR* dir;
+		#endif // __CBUILD_GETDENTS
+	} __cbuild_dir_reader_t;
+	// Takes ownership of 'fd'
+	CBUILDDEF bool __cbuild_dir_reader_open(__cbuild_dir_reader_t* reader, int fd) {
+		reader->fd = fd;
+		#if defined(__CBUILD_GETDENTS)
+			reader->buff = __CBUILD_MALLOC(__CBUILD_GETDENTS_SIZE);
+			cbuild_assert(reader->buff != NULL, "Allocation failed.\n");
+			reader->pos = 0;
+			reader->len = 0;
+		#else
+			reader->dir = fdopendir(fd);
+			if (reader->dir == NULL) {
+				close(fd);
+				return false;
+			}
+		#endif // __CBUILD_GETDENTS
+		return true;
+	}
+	CBUILDDEF void __cbuild_dir_reader_close(__cbuild_dir_reader_t* reader) {
+		#if defined(__CBUILD_GETDENTS)
+			__CBUILD_FREE(reader->buff);
+			close(reader->fd);
+		#else
+			closedir(reader->dir);
+		#endif // __CBUILD_GETDENTS
+	}
+	// Same return values as 'cbuild_dir_next', but skips '.' and '..'.
+	// Type is a 'DT_*' value, or 0 if it is not known.
+	CBUILDDEF int __cbuild_dir_reader_next(__cbuild_dir_reader_t* reader,
+		const char** name, unsigned char* type) {
+		while (true) {
+			#if defined(__CBUILD_GETDENTS)
+				if (reader->pos >= reader->len) {
+					long cnt = syscall(SYS_getdents64, reader->fd, reader->buff,
+						__CBUILD_GETDENTS_SIZE);
+					if (cnt < 0) return -1;
+					if (cnt == 0) return 1;
+					reader->pos = 0;
+					reader->len = (size_t)cnt;
+				}
+				__cbuild_dirent64_t* ent = (void*)(reader->buff + reader->pos);
+				reader->pos += ent->d_reclen;
+				*name = ent->d_name;
+				*type = ent->d_type;
+			#else
+				errno = 0;
+				struct dirent* ent = readdir(reader->dir);
+				if (ent == NULL) return errno == 0 ? 1 : -1;
+				*name = ent->d_name;
+				#if defined(DT_UNKNOWN)
+					*type = ent->d_type;
+				#else
+					*type = 0;
+				#endif // DT_UNKNOWN
+			#endif // __CBUILD_GETDENTS
+			if (strcmp(*name, ".")  == 0) continue;
+			if (strcmp(*name, "..")  == 0) continue;
+			return 0;
+		}
+	}
+	// 'CBUILD_FTYPE_MISSING' means that type is not known
+	CBUILDDEF cbuild_filetype_t __cbuild_dir_walk_dtype(unsigned char type) {
+		#if defined(DT_UNKNOWN)
+			switch (type) {
+			case DT_UNKNOWN: return CBUILD_FTYPE_MISSING;
+			case DT_REG: return CBUILD_FTYPE_REGULAR;
+			case DT_DIR: return CBUILD_FTYPE_DIRECTORY;
+			case DT_LNK: return CBUILD_FTYPE_SYMLINK;
+			default: return CBUILD_FTYPE_OTHER;
+			}
+		#else
+			(void)type;
+			return CBUILD_FTYPE_MISSING;
+		#endif // DT_UNKNOWN
+	}
+	CBUILDDEF cbuild_filetype_t __cbuild_dir_walk_mode(mode_t mode) {
+		if (S_ISREG(mode)) return CBUILD_FTYPE_REGULAR;
+		if (S_ISDIR(mode)) return CBUILD_FTYPE_DIRECTORY;
+		if (S_ISLNK(mode)) return CBUILD_FTYPE_SYMLINK;
+		return CBUILD_FTYPE_OTHER;
+	}
+	// Type from a directory listing is trusted, so entry is only stat-ed if
+	// its type is not known or if it is a symlink that needs to be resolved
+	CBUILDDEF void __cbuild_dir_walk_types(int dir_fd, const char* name,
+		const char* path, cbuild_filetype_t* ftype_raw, cbuild_filetype_t* ftype) {
+		struct stat statbuff;
+		if (*ftype_raw == CBUILD_FTYPE_MISSING) {
+			if (fstatat(dir_fd, name, &statbuff, AT_SYMLINK_NOFOLLOW) < 0) {
+				cbuild_log_error("Could not stat file \"%s\", error: \"%s\"", path,
+					strerror(errno));
+			} else {
+				*ftype_raw = __cbuild_dir_walk_mode(statbuff.st_mode);
+			}
+		}
+		*ftype = *ftype_raw;
+		if (*ftype_raw == CBUILD_FTYPE_SYMLINK) {
+			if (fstatat(dir_fd, name, &statbuff, 0) < 0) {
+				cbuild_log_error("Could not stat file \"%s\", error: \"%s\"", path,
+					strerror(errno));
+				*ftype = CBUILD_FTYPE_MISSING;
+			} else {
+				*ftype = __cbuild_dir_walk_mode(statbuff.st_mode);
+			}
+		}
+	}
+	CBUILDDEF bool __cbuild_dir_walk_at(cbuild_sb_t* path, int dir_fd,
+		const char* name, cbuild_filetype_t ftype_raw, size_t level, bool* abort,
+		cbuild_dir_walk_func_t func, struct cbuild_dir_walk_opts_t opts) {
+		size_t curr_path_len = path->size;
+		cbuild_sb_append_null(path);
+		cbuild_filetype_t ftype;
+		__cbuild_dir_walk_types(dir_fd, name, path->data, &ftype_raw, &ftype);
 		struct cbuild_dir_walk_func_args_t args = {
 			.path = path->data,
+			.name = name,
+			.dir_fd = dir_fd,
 			.type = ftype_raw,
 			.type_res = ftype,
 			.level = level,
-			.result = &res,
 			.context = opts.context,
+			.output = opts.output,
 		};
-		if (!func(args)) return false;
-		switch (res) {
-		case CBUILD_DIR_WALK_CONTINUE: break;
-		case CBUILD_DIR_WALK_STOP: *abort = true; CBUILD_ATTR_FALLTHROUGH();
-		case CBUILD_DIR_WALK_NO_ENTER: return true;
+		if (!opts.visit_dir_last) {
+			int ret = __cbuild_dir_walk_call(func, args, abort);
+			if (ret <= 0) return ret == 0;
 		}
-	}
-	if (ftype == CBUILD_FTYPE_DIRECTORY) {
-		cbuild_dir_t dir = cbuild_dir_open(path->data);
-		if (dir == CBUILD_INVALID_DIR) return false;
-		const char* file = NULL;
-		int ret = 0;
-		while ((ret = cbuild_dir_next(dir, &file)) == 0) {
-			if (strcmp(file, ".")  == 0) continue;
-			if (strcmp(file, "..")  == 0) continue;
-			path->size = curr_path_len;
-			cbuild_da_append(path, '/');
-			cbuild_sb_append_cstr(path, file);
-			if (!__cbuild_dir_walk_opt(path, level + 1, abort, func, opts)) {
-				if (!cbuild_dir_close(dir)) return false;
+		if (ftype == CBUILD_FTYPE_DIRECTORY) {
+			int fd = openat(dir_fd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+			__cbuild_dir_reader_t reader;
+			if (fd < 0 || !__cbuild_dir_reader_open(&reader, fd)) {
+				cbuild_log_error("Failed to open directory '%s': %s",
+					path->data, strerror(errno));
 				return false;
 			}
-			path->size = curr_path_len;
-			if (*abort) {
-				if (!cbuild_dir_close(dir)) return false;
-				return true;
+			const char* file = NULL;
+			unsigned char type = 0;
+			int ret = 0;
+			while ((ret = __cbuild_dir_reader_next(&reader, &file, &type)) == 0) {
+				path->size = curr_path_len;
+				cbuild_da_append(path, '/');
+				cbuild_sb_append_cstr(path, file);
+				if (!__cbuild_dir_walk_at(path, reader.fd, file,
+						__cbuild_dir_walk_dtype(type), level + 1, abort, func, opts)) {
+					__cbuild_dir_reader_close(&reader);
+					return false;
+				}
+				if (*abort) break;
 			}
+			if (ret == -1) {
+				cbuild_log_error("Failed to get next element from directory: %s",
+					strerror(errno));
+			}
+			__cbuild_dir_reader_close(&reader);
+			path->size = curr_path_len;
+			path->data[curr_path_len] = '\0';
+			if (ret == -1) return false;
+			if (*abort) return true;
+		}
+		if (opts.visit_dir_last) {
+			args.path = path->data;
+			if (__cbuild_dir_walk_call(func, args, abort) < 0) return false;
 		}
-		if (!cbuild_dir_close(dir)) return false;
-		if (ret == -1) return false;
+		return true;
 	}
-	if (opts.visit_dir_last) {
-		enum cbuild_dir_walk_result_t res = CBUILD_DIR_WALK_CONTINUE;
+#else
+	CBUILDDEF bool __cbuild_dir_walk_opt(cbuild_sb_t* path, size_t level, bool* abort,
+		cbuild_dir_walk_func_t func, struct cbuild_dir_walk_opts_t opts) {
+		size_t curr_path_len = path->size;
+		cbuild_sb_append_null(path);
+		cbuild_filetype_t ftype_raw = cbuild_path_filetype(path->data);
+		cbuild_filetype_t ftype = __cbuild_path_filetype_resolved(path->data);
+		const char* slash = strrchr(path->data, '/');
+		size_t name_off = level == 0 || slash == NULL ? 0 : (size_t)(slash - path->data) + 1;
 		struct cbuild_dir_walk_func_args_t args = {
 			.path = path->data,
+			.name = path->data + name_off,
+			.dir_fd = CBUILD_INVALID_FD,
 			.type = ftype_raw,
 			.type_res = ftype,
 			.level = level,
-			.result = &res,
 			.context = opts.context,
+			.output = opts.output,
 		};
-		if (!func(args)) return false;
-		switch (res) {
-		case CBUILD_DIR_WALK_CONTINUE: break;
-		case CBUILD_DIR_WALK_STOP: *abort = true; CBUILD_ATTR_FALLTHROUGH();
-		case CBUILD_DIR_WALK_NO_ENTER: return true;
+		if (!opts.visit_dir_last) {
+			int ret = __cbuild_dir_walk_call(func, args, abort);
+			if (ret <= 0) return ret == 0;
 		}
+		if (ftype == CBUILD_FTYPE_DIRECTORY) {
+			cbuild_dir_t dir = cbuild_dir_open(path->data);
+			if (dir == CBUILD_INVALID_DIR) return false;
+			const char* file = NULL;
+			int ret = 0;
+			while ((ret = cbuild_dir_next(dir, &file)) == 0) {
+				if (strcmp(file, ".")  == 0) continue;
+				if (strcmp(file, "..")  == 0) continue;
+				path->size = curr_path_len;
+				cbuild_da_append(path, '/');
+				cbuild_sb_append_cstr(path, file);
+				if (!__cbuild_dir_walk_opt(path, level + 1, abort, func, opts)) {
+					if (!cbuild_dir_close(dir)) return false;
+					return false;
+				}
+				path->size = curr_path_len;
+				if (*abort) {
+					if (!cbuild_dir_close(dir)) return false;
+					return true;
+				}
+			}
+			if (!cbuild_dir_close(dir)) return false;
+			if (ret == -1) return false;
+			path->data[curr_path_len] = '\0';
+		}
+		if (opts.visit_dir_last) {
+			args.path = path->data;
+			args.name = path->data + name_off;
+			if (__cbuild_dir_walk_call(func, args, abort) < 0) return false;
+		}
+		return true;
 	}
-	return true;
-}
+#endif // __CBUILD_STAT_AT
 CBUILDDEF bool cbuild_dir_walk_opt(const char* path, cbuild_dir_walk_func_t func,
 	struct cbuild_dir_walk_opts_t opts) {
 	cbuild_sb_t tmp_path = {0};
 	cbuild_sb_append_cstr(&tmp_path, path);
 	bool abort = false;
+#if defined(__CBUILD_STAT_AT)
+	bool ret = __cbuild_dir_walk_at(&tmp_path, AT_FDCWD, path, CBUILD_FTYPE_MISSING,
+		0, &abort, func, opts);
+#else
 	bool ret = __cbuild_dir_walk_opt(&tmp_path, 0, &abort, func, opts);
+#endif // __CBUILD_STAT_AT
 	cbuild_da_clear(&tmp_path);
 	return ret;
 }
+CBUILDDEF bool cbuild_dir_walk_stat(cbuild_dir_walk_func_args_t args,
+	struct stat* statbuff) {
+#if defined(__CBUILD_STAT_AT)
+	if (fstatat(args.dir_fd, args.name, statbuff, 0) < 0) return false;
+	return true;
+#else
+	return cbuild_stat(args.path, statbuff);
+#endif // __CBUILD_STAT_AT
+}
+CBUILDDEF void cbuild_dir_walk_collect(cbuild_dir_walk_func_args_t args) {
+	size_t len = strlen(args.path);
+	char* path = __CBUILD_MALLOC(len + 1);
+	cbuild_assert(path != NULL, "Allocation failed.\n");
+	memcpy(path, args.path, len + 1);
+	cbuild_da_append(args.output, path);
+}
+#if defined(__CBUILD_STAT_AT)
+	// Parallel walker. Every worker owns a deque of directories, it takes
+	// work from its back (depth-first) and steals from a front of other
+	// deques (breadth-first, so stolen directories are likely large).
+	typedef struct __cbuild_walk_task_t {
+		char* path;
+		size_t level;
+	} __cbuild_walk_task_t;
+	typedef struct __cbuild_walk_deque_t {
+		pthread_mutex_t lock;
+		__cbuild_walk_task_t* data;
+		size_t begin; // Front of a deque, elements before it are stolen
+		size_t size;
+		size_t capacity;
+	} __cbuild_walk_deque_t;
+	typedef struct __cbuild_walk_pool_t __cbuild_walk_pool_t;
+	typedef struct __cbuild_walk_worker_t {
+		__cbuild_walk_pool_t* pool;
+		size_t index;
+		pthread_t thread;
+		bool started;
+		__cbuild_walk_deque_t deque;
+		cbuild_sb_t path;
+		cbuild_pathlist_t output;
+	} __cbuild_walk_worker_t;
+	struct __cbuild_walk_pool_t {
+		pthread_mutex_t lock;
+		pthread_cond_t cond;
+		__cbuild_walk_worker_t* workers;
+		size_t num_workers;
+		size_t queued; // Tasks in deques
+		size_t pending; // Tasks in deques plus tasks being processed
+		bool abort;
+		bool ok;
+		cbuild_dir_walk_func_t func;
+		struct cbuild_dir_walk_parallel_opts_t opts;
+	};
+	CBUILDDEF void __cbuild_walk_push(__cbuild_walk_worker_t* worker,
+		__cbuild_walk_task_t task) {
+		// Task is counted before it is published, so a thief can not take it
+		// before it is counted
+		__cbuild_walk_pool_t* pool = worker->pool;
+		pthread_mutex_lock(&pool->lock);
+		pool->queued++;
+		pool->pending++;
+		pthread_mutex_unlock(&pool->lock);
+		__cbuild_walk_deque_t* deque = &worker->deque;
+		pthread_mutex_lock(&deque->lock);
+		if (deque->begin == deque->size) {
+			deque->begin = 0;
+			deque->size = 0;
+		}
+		cbuild_da_append(deque, task);
+		pthread_mutex_unlock(&deque->lock);
+		pthread_cond_signal(&pool->cond);
+	}
+	// 'skip' is set if walk was aborted and task should be dropped
+	CBUILDDEF bool __cbuild_walk_take(__cbuild_walk_worker_t* worker,
+		__cbuild_walk_task_t* task, bool* skip) {
+		__cbuild_walk_pool_t* pool = worker->pool;
+		bool found = false;
+		for (size_t i = 0; i < pool->num_workers && !found; i++) {
+			__cbuild_walk_deque_t* deque =
+				&pool->workers[(worker->index + i) % pool->num_workers].deque;
+			pthread_mutex_lock(&deque->lock);
+			if (deque->begin < deque->size) {
+				if (i == 0) *task = deque->data[--deque->size];
+				else *task = deque->data[deque->begin++];
+				found = true;
+			}
+			pthread_mutex_unlock(&deque->lock);
+		}
+		if (found) {
+			pthread_mutex_lock(&pool->lock);
+			pool->queued--;
+			*skip = pool->abort;
+			pthread_mutex_unlock(&pool->lock);
+		}
+		return found;
+	}
+	CBUILDDEF void __cbuild_walk_fail(__cbuild_walk_pool_t* pool, bool error) {
+		pthread_mutex_lock(&pool->lock);
+		pool->abort = true;
+		if (error) pool->ok = false;
+		pthread_cond_broadcast(&pool->cond);
+		pthread_mutex_unlock(&pool->lock);
+	}
+	CBUILDDEF void __cbuild_walk_process(__cbuild_walk_worker_t* worker,
+		__cbuild_walk_task_t task) {
+		__cbuild_walk_pool_t* pool = worker->pool;
+		int fd = open(task.path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		__cbuild_dir_reader_t reader;
+		if (fd < 0 || !__cbuild_dir_reader_open(&reader, fd)) {
+			cbuild_log_error("Failed to open directory '%s': %s",
+				task.path, strerror(errno));
+			__cbuild_walk_fail(pool, true);
+			return;
+		}
+		cbuild_sb_t* path = &worker->path;
+		path->size = 0;
+		cbuild_sb_append_cstr(path, task.path);
+		size_t dir_len = path->size;
+		const char* file = NULL;
+		unsigned char type = 0;
+		int ret = 0;
+		while ((ret = __cbuild_dir_reader_next(&reader, &file, &type)) == 0) {
+			path->size = dir_len;
+			cbuild_da_append(path, '/');
+			cbuild_sb_append_cstr(path, file);
+			cbuild_sb_append_null(path);
+			cbuild_filetype_t ftype_raw = __cbuild_dir_walk_dtype(type);
+			cbuild_filetype_t ftype;
+			__cbuild_dir_walk_types(reader.fd, file, path->data, &ftype_raw, &ftype);
+			enum cbuild_dir_walk_result_t res = CBUILD_DIR_WALK_CONTINUE;
+			struct cbuild_dir_walk_func_args_t args = {
+				.path = path->data,
+				.name = file,
+				.dir_fd = reader.fd,
+				.type = ftype_raw,
+				.type_res = ftype,
+				.level = task.level + 1,
+				.result = &res,
+				.context = pool->opts.contexts == NULL ? pool->opts.context :
+					pool->opts.contexts[worker->index],
+				.output = &worker->output,
+				.worker = worker->index,
+			};
+			if (!pool->func(args)) {
+				__cbuild_walk_fail(pool, true);
+				break;
+			}
+			if (res == CBUILD_DIR_WALK_STOP) {
+				__cbuild_walk_fail(pool, false);
+				break;
+			}
+			if (res == CBUILD_DIR_WALK_CONTINUE && ftype == CBUILD_FTYPE_DIRECTORY) {
+				char* sub = __CBUILD_MALLOC(path->size);
+				cbuild_assert(sub != NULL, "Allocation failed.\n");
+				memcpy(sub, path->data, path->size);
+				__cbuild_walk_push(worker, (__cbuild_walk_task_t){
+					.path = sub,
+					.level = task.level + 1,
+				});
+			}
+		}
+		if (ret == -1) {
+			cbuild_log_error("Failed to get next element from directory: %s",
+				strerror(errno));
+			__cbuild_walk_fail(pool, true);
+		}
+		__cbuild_dir_reader_close(&reader);
+	}
+	CBUILDDEF void* __cbuild_walk_worker(void* arg) {
+		__cbuild_walk_worker_t* worker = arg;
+		__cbuild_walk_pool_t* pool = worker->pool;
+		while (true) {
+			__cbuild_walk_task_t task;
+			bool skip = false;
+			if (__cbuild_walk_take(worker, &task, &skip)) {
+				if (!skip) __cbuild_walk_process(worker, task);
+				__CBUILD_FREE(task.path);
+				pthread_mutex_lock(&pool->lock);
+				if (--pool->pending == 0) pthread_cond_broadcast(&pool->cond);
+				pthread_mutex_unlock(&pool->lock);
+				continue;
+			}
+			pthread_mutex_lock(&pool->lock);
+			while (pool->queued == 0 && pool->pending > 0 && !pool->abort) {
+				pthread_cond_wait(&pool->cond, &pool->lock);
+			}
+			bool done = pool->pending == 0 || pool->abort;
+			pthread_mutex_unlock(&pool->lock);
+			if (done) break;
+		}
+		return NULL;
+	}
+#endif // __CBUILD_STAT_AT
+CBUILDDEF bool cbuild_dir_walk_parallel_opt(const char* path,
+	cbuild_dir_walk_func_t func, struct cbuild_dir_walk_parallel_opts_t opts) {
+	cbuild_pathlist_t output = {0};
+#if defined(__CBUILD_STAT_AT)
+	if (opts.jobs < 0) opts.jobs = cbuild_nproc();
+	size_t num_workers = opts.jobs < 1 ? 1 : (size_t)opts.jobs;
+	__cbuild_walk_pool_t pool = {
+		.num_workers = num_workers,
+		.ok = true,
+		.func = func,
+		.opts = opts,
+	};
+	pthread_mutex_init(&pool.lock, NULL);
+	pthread_cond_init(&pool.cond, NULL);
+	pool.workers = __CBUILD_MALLOC(num_workers * sizeof(__cbuild_walk_worker_t));
+	cbuild_assert(pool.workers != NULL, "Allocation failed.\n");
+	memset(pool.workers, 0, num_workers * sizeof(__cbuild_walk_worker_t));
+	for (size_t i = 0; i < num_workers; i++) {
+		pool.workers[i].pool = &pool;
+		pool.workers[i].index = i;
+		pthread_mutex_init(&pool.workers[i].deque.lock, NULL);
+	}
+	// Base directory is visited by calling thread as worker 0
+	cbuild_filetype_t ftype_raw = CBUILD_FTYPE_MISSING;
+	cbuild_filetype_t ftype;
+	__cbuild_dir_walk_types(AT_FDCWD, path, path, &ftype_raw, &ftype);
+	enum cbuild_dir_walk_result_t res = CBUILD_DIR_WALK_CONTINUE;
+	struct cbuild_dir_walk_func_args_t args = {
+		.path = path,
+		.name = path,
+		.dir_fd = AT_FDCWD,
+		.type = ftype_raw,
+		.type_res = ftype,
+		.level = 0,
+		.result = &res,
+		.context = opts.contexts == NULL ? opts.context : opts.contexts[0],
+		.output = &pool.workers[0].output,
+		.worker = 0,
+	};
+	if (!func(args)) {
+		pool.ok = false;
+	} else if (res == CBUILD_DIR_WALK_CONTINUE && ftype == CBUILD_FTYPE_DIRECTORY) {
+		size_t len = strlen(path);
+		char* root = __CBUILD_MALLOC(len + 1);
+		cbuild_assert(root != NULL, "Allocation failed.\n");
+		memcpy(root, path, len + 1);
+		__cbuild_walk_push(&pool.workers[0], (__cbuild_walk_task_t){
+			.path = root,
+			.level = 0,
+		});
+		for (size_t i = 1; i < num_workers; i++) {
+			// Missing thread only means less parallelism
+			pool.workers[i].started = pthread_create(&pool.workers[i].thread, NULL,
+				__cbuild_walk_worker, &pool.workers[i]) == 0;
+		}
+		__cbuild_walk_worker(&pool.workers[0]);
+		for (size_t i = 1; i < num_workers; i++) {
+			if (pool.workers[i].started) pthread_join(pool.workers[i].thread, NULL);
+		}
+	}
+	// Merge results and drop tasks left after abort
+	for (size_t i = 0; i < num_workers; i++) {
+		__cbuild_walk_worker_t* worker = &pool.workers[i];
+		if (worker->output.size > 0) {
+			cbuild_da_append_arr(&output, worker->output.data, worker->output.size);
+		}
+		cbuild_da_clear(&worker->output);
+		for (size_t j = worker->deque.begin; j < worker->deque.size; j++) {
+			__CBUILD_FREE(worker->deque.data[j].path);
+		}
+		cbuild_da_clear(&worker->deque);
+		pthread_mutex_destroy(&worker->deque.lock);
+		cbuild_da_clear(&worker->path);
+	}
+	__CBUILD_FREE(pool.workers);
+	pthread_cond_destroy(&pool.cond);
+	pthread_mutex_destroy(&pool.lock);
+	bool ret = pool.ok;
+#else
+	bool ret = cbuild_dir_walk_opt(path, func, (struct cbuild_dir_walk_opts_t){
+		.context = opts.contexts == NULL ? opts.context : opts.contexts[0],
+		.output = &output,
+	});
+#endif // __CBUILD_STAT_AT
+	if (opts.sorted && output.size > 0) {
+		qsort(output.data, output.size, sizeof(char*), __cbuild_fs_compare);
+	}
+	if (opts.output != NULL && output.size > 0) {
+		cbuild_da_append_arr(opts.output, output.data, output.size);
+		cbuild_da_clear(&output);
+	} else {
+		cbuild_pathlist_clear(&output);
+	}
+	return ret;
+}
 #if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
 	CBUILDDEF char* cbuild_dir_current(void) {
 		#if defined(CBUILD_API_POSIX) && \
@@ -499,6 +2369,8 @@ CBUILDDEF bool cbuild_dir_walk_opt(const char* path, cbuild_dir_walk_func_t func
 				path, strerror(errno));
 			return false;
 		}
+		// Relative paths now point to other files
+		cbuild_stat_invalidate_all();
 		return true;
 	}
 #endif // CBUILD_API_*
@@ -511,6 +2383,7 @@ CBUILDDEF void cbuild_pathlist_clear(cbuild_pathlist_t* list) {
 #if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
 	CBUILDDEF bool __cbuild_dir_create(const char* path_, bool inplace) {
 		int ret = mkdir(path_, 0755);
+		cbuild_stat_invalidate(path_);
 		if(ret < 0) {
 			if(errno == EEXIST) {
 				cbuild_log(CBUILD_LOG_WARN, "Directory \"%s\" exist", path_);
@@ -532,6 +2405,7 @@ CBUILDDEF void cbuild_pathlist_clear(cbuild_pathlist_t* list) {
 				}
 				if(slash) *slash = '/';
 				ret = mkdir(path, 0755);
+				cbuild_stat_invalidate(path);
 				if(ret == 0) {
 					if(!inplace) {
 						cbuild_temp_reset(checkpoint);
@@ -556,7 +2430,7 @@ CBUILDDEF void cbuild_pathlist_clear(cbuild_pathlist_t* list) {
 	}
 	CBUILDDEF cbuild_filetype_t cbuild_path_filetype(const char* path) {
 		struct stat statbuff;
-		if(lstat(path, &statbuff) < 0) {
+		if(!cbuild_lstat(path, &statbuff)) {
 			cbuild_log_error("Could not stat file \"%s\", error: \"%s\"", path,
 				strerror(errno));
 			return CBUILD_FTYPE_MISSING;
@@ -574,7 +2448,7 @@ CBUILDDEF void cbuild_pathlist_clear(cbuild_pathlist_t* list) {
 	}
 	CBUILDDEF cbuild_filetype_t __cbuild_path_filetype_resolved(const char* path) {
 		struct stat statbuff;
-		if(stat(path, &statbuff) < 0) {
+		if(!cbuild_stat(path, &statbuff)) {
 			cbuild_log_error("Could not stat file \"%s\", error: \"%s\"", path,
 				strerror(errno));
 			return CBUILD_FTYPE_MISSING;
@@ -655,25 +2529,25 @@ typedef struct __cbuild_da_cstr_t {
 	size_t size;
 	size_t capacity;
 } __cbuild_da_cstr_t;
-CBUILDDEF char* cbuild_path_normalize(const char* path_) {
-	cbuild_sb_t buff = {0};
+// Write normalized path to an empty buffer, without temp allocator
+CBUILDDEF void __cbuild_path_normalize_sb(const char* path_, cbuild_sb_t* buff) {
 	__cbuild_da_cstr_t dirs = {0};
 	cbuild_sv_t path = cbuild_sv_from_cstr(path_);
 	// Windows paths can have drive letter
 	// Drive letter is only one character
 	if (isalpha((unsigned char)path.data[0]) && path.data[1] == ':') {
-		cbuild_da_append_arr(&buff, path.data, 2);
+		cbuild_da_append_arr(buff, path.data, 2);
 		path.data += 2;
 		path.size -= 2;
 	}
 	if(*path.data == '/') {
-		cbuild_da_append(&buff, '/');
+		cbuild_da_append(buff, '/');
 	}
 	// Unix paths threat double slash differently
 	// POSIX threats paths starting with '//' specially.
 	if(cbuild_sv_prefix(path, cbuild_sv_from_lit("//")) &&
 		!cbuild_sv_prefix(path, cbuild_sv_from_lit("///"))) {
-		cbuild_da_append(&buff, '/');
+		cbuild_da_append(buff, '/');
 	}
 	do {
 		cbuild_sv_t dir = cbuild_sv_chop_by_delim(&path, '/');
@@ -682,7 +2556,7 @@ CBUILDDEF char* cbuild_path_normalize(const char* path_) {
 			// Do nothing
 		} else if(cbuild_sv_cmp(dir, cbuild_sv_from_lit("..")) == 0) {
 			if(dirs.size == 0) { // Underflow
-				cbuild_sb_append_cstr(&buff, "../");
+				cbuild_sb_append_cstr(buff, "../");
 				// Underflow on absolute path is undefined anyway
 				// and on relative path we can guarantee that this will be fine
 				// (we have nothing in directory stack anyway)
@@ -694,15 +2568,19 @@ CBUILDDEF char* cbuild_path_normalize(const char* path_) {
 		}
 	} while(path.size > 0);
 	for(size_t i = 0; i <	dirs.size; i++) {
-		cbuild_sb_appendf(&buff, CBuildSVFmt"/", CBuildSVArg(dirs.data[i]));
-	}
-	if(buff.size == 0) cbuild_da_append(&buff, '.');
-	if(!((buff.size == 1 && buff.data[0] == '/') ||
-			(buff.size == 2 && buff.data[0] == '/' && buff.data[1] == '/') ||
-			(buff.size == 3 && isalpha((unsigned char)buff.data[0]) && 
-				buff.data[1] == ':' && buff.data[2] == '/')) &&
-		(buff.data[buff.size - 1] == '/')) buff.size--;
+		cbuild_sb_appendf(buff, CBuildSVFmt"/", CBuildSVArg(dirs.data[i]));
+	}
+	if(buff->size == 0) cbuild_da_append(buff, '.');
+	if(!((buff->size == 1 && buff->data[0] == '/') ||
+			(buff->size == 2 && buff->data[0] == '/' && buff->data[1] == '/') ||
+			(buff->size == 3 && isalpha((unsigned char)buff->data[0]) && 
+				buff->data[1] == ':' && buff->data[2] == '/')) &&
+		(buff->data[buff->size - 1] == '/')) buff->size--;
 	cbuild_da_clear(&dirs);
+}
+CBUILDDEF char* cbuild_path_normalize(const char* path_) {
+	cbuild_sb_t buff = {0};
+	__cbuild_path_normalize_sb(path_, &buff);
 	char* ret = cbuild_temp_sprintf(CBuildSBFmt, CBuildSBArg(buff));
 	cbuild_da_clear(&buff);
 	return ret;
@@ -5,6 +5,7 @@
 
 #include "Common.h"
 #include "StringBuilder.h"
+#include "StringView.h"
 
 /// Dynamic array of paths
 typedef struct cbuild_pathlist_t {
@@ -79,15 +80,145 @@ CBUILDDEF ssize_t cbuild_fd_write_file(cbuild_fd_t fd, const void* buf,
 ///
 /// [r:] Length of file in bytes or `-1` on error.
 CBUILDDEF ssize_t cbuild_file_len(const char* path);
-/// Read file into string builder.
+/// Read file into string builder. Old content of [p:data] is replaced.
 CBUILDDEF bool cbuild_file_read(const char* path, cbuild_sb_t* data);
+/// Read-only view of a file content.
+///
+/// * [fl:content] File content.
+/// * [fl:buff] Buffer or mapping that holds content.
+/// * [fl:capacity] Size of a buffer or mapping.
+/// * [fl:mapped] If file is mapped with `mmap`{.c}.
+typedef struct cbuild_file_map_t {
+	cbuild_sv_t content;
+	char* buff;
+	size_t capacity;
+	bool mapped;
+} cbuild_file_map_t;
+/// Get read-only view of a file content.
+///
+/// Regular files of at least `CBUILD_FILE_MAP_MIN`{.c} bytes are mapped with
+/// `mmap`{.c}, so nothing is copied. Smaller files and special files (pipes,
+/// files in `/proc`) are read until end of file into a buffer taken from a
+/// pool, buffer grows if needed. Should be released with
+/// [`cbuild_file_unmap`](DOC:cbuild_file_unmap).
+///
+/// ::: note
+/// Content of a mapped file is not stable if file is changed while it is
+/// mapped, and truncating it can crash the process with `SIGBUS`{.c}.
+/// :::
+///
+/// * [pl:path] Path to a file.
+/// * [pl:map] View of a file content. Empty on error.
+CBUILDDEF bool cbuild_file_map(const char* path, cbuild_file_map_t* map);
+/// Release view created by [`cbuild_file_map`](DOC:cbuild_file_map).
+/// [p:map->content] can be modified (eg. chopped) before.
+CBUILDDEF void cbuild_file_unmap(cbuild_file_map_t* map);
+/// How file is written.
+///
+/// * [fl:buff_size] Size of a buffer of a file writer. `0`{.c} means `CBUILD_FILE_WRITER_SIZE`{.c}.
+/// * [fl:in_place] Truncate destination and write it in place. By default file is written into a temporary file next to a destination and `rename`{.c}-d over destination on commit, so readers never see partial file. Destination that exists and is not a regular file (eg. `/dev/null`{.c}) is always written in place.
+/// * [fl:sync] Flush data to disk (`fdatasync`{.c}) before file is closed.
+struct cbuild_file_write_opts_t {
+	size_t buff_size;
+	bool in_place;
+	bool sync;
+};
+/// Buffered file writer.
+///
+/// * [fl:fd] File descriptor of a file that is written.
+/// * [fl:path] Path to a destination.
+/// * [fl:temp_path] Path to a temporary file, `NULL`{.c} in in-place mode.
+/// * [fl:buff] Buffer, allocated on first buffered write.
+/// * [fl:size] Number of bytes in a buffer.
+/// * [fl:capacity] Size of a buffer.
+/// * [fl:sync] Flush data to disk on commit.
+/// * [fl:failed] Some write failed, file will not be committed.
+typedef struct cbuild_file_writer_t {
+	cbuild_fd_t fd;
+	char* path;
+	char* temp_path;
+	char* buff;
+	size_t size;
+	size_t capacity;
+	bool sync;
+	bool failed;
+} cbuild_file_writer_t;
+/// Open file writer. Semi-internal function.
+CBUILDDEF bool cbuild_file_writer_open_opt(cbuild_file_writer_t* writer,
+	const char* path, struct cbuild_file_write_opts_t opts);
+/// Open file writer. Writer should be closed with
+/// [`cbuild_file_writer_commit`](DOC:cbuild_file_writer_commit) or
+/// [`cbuild_file_writer_abort`](DOC:cbuild_file_writer_abort).
+///
+/// In in-place mode file is truncated on open. Otherwise symbolic link is
+/// resolved, so link is kept and its target is replaced, and replaced file
+/// keeps its permissions.
+///
+/// * [pl:writer:cbuild_file_writer_t*] Writer.
+/// * [pl:path:const char*] Path to a file.
+/// * [pl:...:...cbuild_file_write_opts_t] Fields of configuration structure in initializer-list form.
+///
+/// [r:bool]
+#define cbuild_file_writer_open(writer, path, ...)                                  \
+cbuild_file_writer_open_opt(writer, path,                                           \
+	(struct cbuild_file_write_opts_t){ __VA_ARGS__ })
+/// Write data to a file writer. Small writes are buffered. If data does not
+/// fit into a buffer, buffer and data are written with one `writev`{.c}.
+///
+/// After error writer is marked as failed and should be aborted.
+CBUILDDEF bool cbuild_file_writer_write(cbuild_file_writer_t* writer,
+	const void* data, size_t size);
+/// Write string view to a file writer.
+///
+/// * [pl:writer:cbuild_file_writer_t*] Writer.
+/// * [pl:sv:cbuild_sv_t] String view.
+///
+/// [r:bool]
+#define cbuild_file_writer_write_sv(writer, sv)                                     \
+cbuild_file_writer_write(writer, (sv).data, (sv).size)
+/// Write C-string to a file writer.
+///
+/// * [pl:writer:cbuild_file_writer_t*] Writer.
+/// * [pl:str:const char*] String.
+///
+/// [r:bool]
+#define cbuild_file_writer_write_cstr(writer, str)                                  \
+cbuild_file_writer_write(writer, str, strlen(str))
+/// Write buffered data to a file.
+CBUILDDEF bool cbuild_file_writer_flush(cbuild_file_writer_t* writer);
+/// Flush writer and close a file. Temporary file is renamed
+/// over destination. If writer failed, this works like
+/// [`cbuild_file_writer_abort`](DOC:cbuild_file_writer_abort).
+///
+/// [r:] `false`{.c} if something was not written.
+CBUILDDEF bool cbuild_file_writer_commit(cbuild_file_writer_t* writer);
+/// Close writer without committing it. Temporary file is removed and
+/// destination is not changed (in in-place mode it is already truncated).
+CBUILDDEF void cbuild_file_writer_abort(cbuild_file_writer_t* writer);
+/// Overwrite file with string builder content. Semi-internal function.
+CBUILDDEF bool cbuild_file_write_opt(const char* path, cbuild_sb_t* data,
+	struct cbuild_file_write_opts_t opts);
 /// Overwrite file with string builder content.
-CBUILDDEF bool cbuild_file_write(const char* path, cbuild_sb_t* data);
+///
+/// By default content is written to a temporary file that is renamed over
+/// [p:path], so crash or concurrent reader never sees partial file. With
+/// `.in_place = true`{.c} file is truncated and written in place.
+///
+/// * [pl:path:const char*] Path to a file.
+/// * [pl:data:cbuild_sb_t*] Content.
+/// * [pl:...:...cbuild_file_write_opts_t] Fields of configuration structure in initializer-list form.
+///
+/// [r:bool]
+#define cbuild_file_write(path, data, ...)                                          \
+cbuild_file_write_opt(path, data, (struct cbuild_file_write_opts_t){ __VA_ARGS__ })
 /// Copy file.
 /// 
 /// ::: note
-/// This copies file by reading from [p:src] and writing to [p:dst].
-/// "Chunked" copy is used to limit memory usage.
+/// On Linux copy is done in kernel if possible: first reflink is tried
+/// (`FICLONE`{.c}), then `copy_file_range` and `sendfile`. If none of them
+/// work, file is copied by reading from [p:src] and writing to [p:dst] in
+/// chunks of at most `CBUILD_FS_TMP_SIZE`{.c} bytes. Permission bits of
+/// [p:src] are preserved.
 /// :::
 CBUILDDEF bool cbuild_file_copy(const char* src, const char* dst);
 /// Move file.
@@ -111,12 +242,129 @@ CBUILDDEF bool cbuild_file_check(const char* path);
 CBUILDDEF bool cbuild_file_remove(const char* path);
 /// Create symbolic link. Will overwrite [p:dst] if it exists.
 CBUILDDEF bool cbuild_symlink(const char* src, const char* dst);
+/// Kind of a batched file system operation.
+typedef enum {
+	CBUILD_FS_OP_OPEN   = 0,
+	CBUILD_FS_OP_READ   = 1,
+	CBUILD_FS_OP_WRITE  = 2,
+	CBUILD_FS_OP_STAT   = 3,
+	CBUILD_FS_OP_LSTAT  = 4,
+	CBUILD_FS_OP_UNLINK = 5,
+	CBUILD_FS_OP_RMDIR  = 6,
+	CBUILD_FS_OP_CLOSE  = 7,
+} cbuild_fs_op_kind_t;
+/// Directory descriptor of current directory for batched operations.
+#if defined(AT_FDCWD)
+	#define CBUILD_FS_CWD AT_FDCWD
+#else
+	#define CBUILD_FS_CWD CBUILD_INVALID_FD
+#endif // AT_FDCWD
+/// Batched file system operation.
+///
+/// * [fl:kind] Kind of operation.
+/// * [fl:fd] Directory to which [fl:path] is relative for operations with a path (`CBUILD_FS_CWD`{.c} for current directory, ignored where `openat`{.c} is not available). File descriptor for other operations.
+/// * [fl:path] Path to an object.
+/// * [fl:flags] Flags of `open`{.c}.
+/// * [fl:mode] Mode of a created file.
+/// * [fl:buff] Buffer for read or write.
+/// * [fl:size] Size of [fl:buff].
+/// * [fl:offset] Offset in a file, negative value means current position.
+/// * [fl:statbuff] Result of stat.
+/// * [fl:result] Result of an operation: opened file descriptor, number of bytes read or written or `0`{.c}. Negated `errno`{.c} on error.
+typedef struct cbuild_fs_op_t {
+	cbuild_fs_op_kind_t kind;
+	cbuild_fd_t fd;
+	const char* path;
+	int flags;
+	mode_t mode;
+	void* buff;
+	size_t size;
+	off_t offset;
+	struct stat* statbuff;
+	ssize_t result;
+} cbuild_fs_op_t;
+/// Batch of file system operations. Zero-initialized batch is valid.
+///
+/// On Linux operations are submitted to kernel with `io_uring`{.c}, so whole
+/// batch costs few system calls. If `io_uring`{.c} (or some operation) is not
+/// supported by a running kernel, operations are executed one by one.
+///
+/// * [fl:data] Operations.
+/// * [fl:size] Number of operations.
+/// * [fl:capacity] Capacity of [fl:data].
+/// * [fl:submitted] Number of already submitted operations.
+/// * [fl:ring] Internal `io_uring`{.c} state, `NULL`{.c} if operations are executed one by one.
+/// * [fl:sync] Never use `io_uring`{.c}.
+/// * [fl:syscalls] Number of system calls used to execute operations.
+typedef struct cbuild_fs_batch_t {
+	cbuild_fs_op_t* data;
+	size_t size;
+	size_t capacity;
+	size_t submitted;
+	void* ring;
+	bool sync;
+	size_t syscalls;
+} cbuild_fs_batch_t;
+/// Queue `openat`{.c}.
+///
+/// [r:] Index of an operation.
+CBUILDDEF size_t cbuild_fs_batch_open(cbuild_fs_batch_t* batch, cbuild_fd_t dir,
+	const char* path, int flags, mode_t mode);
+/// Queue `pread`{.c} (or `read`{.c} for negative [p:offset]).
+///
+/// [r:] Index of an operation.
+CBUILDDEF size_t cbuild_fs_batch_read(cbuild_fs_batch_t* batch, cbuild_fd_t fd,
+	void* buff, size_t size, off_t offset);
+/// Queue `pwrite`{.c} (or `write`{.c} for negative [p:offset]).
+///
+/// [r:] Index of an operation.
+CBUILDDEF size_t cbuild_fs_batch_write(cbuild_fs_batch_t* batch, cbuild_fd_t fd,
+	const void* buff, size_t size, off_t offset);
+/// Queue `fstatat`{.c}. If [p:follow] is `false`{.c} symlinks are not resolved.
+///
+/// [r:] Index of an operation.
+CBUILDDEF size_t cbuild_fs_batch_stat(cbuild_fs_batch_t* batch, cbuild_fd_t dir,
+	const char* path, struct stat* statbuff, bool follow);
+/// Queue `unlinkat`{.c}. If [p:is_dir] is `true`{.c} empty directory is removed.
+///
+/// [r:] Index of an operation.
+CBUILDDEF size_t cbuild_fs_batch_unlink(cbuild_fs_batch_t* batch, cbuild_fd_t dir,
+	const char* path, bool is_dir);
+/// Queue `close`{.c}.
+///
+/// [r:] Index of an operation.
+CBUILDDEF size_t cbuild_fs_batch_close(cbuild_fs_batch_t* batch, cbuild_fd_t fd);
+/// Execute all operations queued since last submit. Results are stored in
+/// [fl:result] of each operation.
+///
+/// ::: note
+/// Operations of one submit are independent and can be executed in any order,
+/// so eg. file should not be opened and read in the same submit. Paths and
+/// buffers should be valid until this function returns. Stat cache is not
+/// invalidated. If 'io_uring' can not even wait for in-flight operations, they
+/// are reported as failed and their buffers should not be reused, as kernel
+/// may still write into them.
+/// :::
+///
+/// [r:] `false`{.c} if any operation failed.
+CBUILDDEF bool cbuild_fs_batch_submit(cbuild_fs_batch_t* batch);
+/// Remove all operations from a batch. Kernel resources are kept.
+CBUILDDEF void cbuild_fs_batch_reset(cbuild_fs_batch_t* batch);
+/// Free batch.
+CBUILDDEF void cbuild_fs_batch_free(cbuild_fs_batch_t* batch);
 /// Recursively copy a directory.
+///
+/// ::: note
+/// Where `openat`{.c} is available subdirectories are processed in parallel
+/// by a pool of threads, and type of an entry is taken from a directory
+/// listing instead of calling `stat`{.c} on it.
+/// :::
 CBUILDDEF bool cbuild_dir_copy(const char* src, const char* dst);
 /// Move a directory.
 ///
-/// Uses optimal method for moving directory, but in worst case falls back
-/// to `cbuild_dir_copy(src, dst); cbuild_dir_remove(src)`{.c}.
+/// First tries to simply rename a directory. If this is not possible (eg.
+/// [p:dst] is on a different filesystem) falls back to
+/// `cbuild_dir_copy(src, dst); cbuild_dir_remove(src)`{.c}.
 CBUILDDEF bool cbuild_dir_move(const char* src, const char* dst);
 /// Rename a directory. Alias to [`cbuild_dir_move`](DOC:cbuild_dir_move).
 ///
@@ -128,7 +376,11 @@ CBUILDDEF bool cbuild_dir_move(const char* src, const char* dst);
 ///
 /// [r:bool]
 #define cbuild_dir_rename(src, dst) cbuild_dir_move(src, dst)
-/// Delete directory.
+/// Recursively delete directory.
+///
+/// ::: note
+/// Parallel like [`cbuild_dir_copy`](DOC:cbuild_dir_copy).
+/// :::
 CBUILDDEF bool cbuild_dir_remove(const char* path);
 /// Check if directory exists.
 CBUILDDEF bool cbuild_dir_check(const char* path);
@@ -161,20 +413,28 @@ enum cbuild_dir_walk_result_t {
 ///
 /// * Current entry:
 ///   - [fl:path] Path to the file system object object (relative and including directory passed to [`cbuild_dir_walk`](DOC:cbuild_dir_walk).
+///   - [fl:name] Name of the object inside its parent directory. For base directory this is a path passed to [`cbuild_dir_walk`](DOC:cbuild_dir_walk).
+///   - [fl:dir_fd] Descriptor of a parent directory, [fl:name] is relative to it. Can be `AT_FDCWD`{.c} for base directory and `CBUILD_INVALID_FD`{.c} on platforms without `openat`{.c}.
 ///   - [fl:type] Type of current file-system object. 
 ///   - [fl:type_res] Type of current file-system object. Resolved type for symlinks.
 /// * Iteration state:
 ///   - [fl:level] How deep iteration goes (`0` means base directory).
+///   - [fl:worker] Index of a thread that visits this object. Always `0`{.c} for serial walker.
 /// * Context:
 ///   - [fl:context] Some arguments passed by user. 
 ///   - [fl:result] Return value.
+///   - [fl:output] List for results. Each worker of a parallel walker has its own list, see [`cbuild_dir_walk_collect`](DOC:cbuild_dir_walk_collect).
 typedef struct cbuild_dir_walk_func_args_t {
 	const char* path;
+	const char* name;
+	cbuild_fd_t dir_fd;
 	cbuild_filetype_t type;
 	cbuild_filetype_t type_res;
 	size_t level;
+	size_t worker;
 	enum cbuild_dir_walk_result_t* result;
 	void* context;
+	cbuild_pathlist_t* output;
 } cbuild_dir_walk_func_args_t;
 /// Function used as callback by directory walker.
 ///
@@ -184,20 +444,73 @@ typedef bool (*cbuild_dir_walk_func_t)(cbuild_dir_walk_func_args_t args);
 ///
 /// * [fl:context] Some arguments that will be passed to callback.
 /// * [fl:visit_dir_last] Inverts order. Now all child files are visited first and parent directory is visited last.
+/// * [fl:output] List that will be passed to callback.
 struct cbuild_dir_walk_opts_t {
 	void* context;
 	bool visit_dir_last;
+	cbuild_pathlist_t* output;
 };
 /// Walk over dir. Takes path, callback and some optional options. Semi-internal function.
 CBUILDDEF bool cbuild_dir_walk_opt(const char* path, cbuild_dir_walk_func_t func,
 	struct cbuild_dir_walk_opts_t opts);
 /// Walk over dir.
 ///
+/// Where `openat`{.c} is available directories are opened relative to their
+/// parent and type of an object comes from a directory listing (read in bulk
+/// with `getdents64`{.c} on Linux). Object is `stat`{.c}-ed only if listing
+/// does not report its type or if it is a symlink.
+///
 /// * [pl:path:const char*] Path to a file.
 /// * [pl:callback:cbuild_dir_walk_func_t] Function that will be called for each file system object.
 /// * [pl:...:...cbuild_dir_walk_opts_t] Fields of configuration structure in initializer-list form.
 #define cbuild_dir_walk(path, callback, ...)                                        \
 cbuild_dir_walk_opt(path, callback, (struct cbuild_dir_walk_opts_t){ __VA_ARGS__ })
+/// Get metadata of an object currently visited by directory walker.
+/// Symlinks are resolved.
+///
+/// Walker itself takes type of objects from a directory listing, so objects
+/// are only `stat`{.c}-ed when this function is called. Result is not cached.
+///
+/// [r:] `false`{.c} on error, `errno`{.c} is set.
+CBUILDDEF bool cbuild_dir_walk_stat(cbuild_dir_walk_func_args_t args,
+	struct stat* statbuff);
+/// Append copy of a path of current object to [fl:output] of walker arguments.
+CBUILDDEF void cbuild_dir_walk_collect(cbuild_dir_walk_func_args_t args);
+/// Arguments to a parallel directory walker.
+///
+/// * [fl:context] Some arguments that will be passed to callback.
+/// * [fl:contexts] Per-worker arguments, overrides [fl:context]. Should have an element for each worker.
+/// * [fl:jobs] Number of threads. `0`{.c} or `1`{.c} means that all work is done on calling thread, negative value means [`cbuild_nproc`](DOC:cbuild_nproc).
+/// * [fl:output] Where outputs of all workers are appended. If `NULL`{.c} outputs are discarded.
+/// * [fl:sorted] Sort output, so it does not depend on scheduling.
+struct cbuild_dir_walk_parallel_opts_t {
+	void* context;
+	void** contexts;
+	int jobs;
+	cbuild_pathlist_t* output;
+	bool sorted;
+};
+/// Walk over dir in parallel. Semi-internal function.
+CBUILDDEF bool cbuild_dir_walk_parallel_opt(const char* path,
+	cbuild_dir_walk_func_t func, struct cbuild_dir_walk_parallel_opts_t opts);
+/// Walk over dir in parallel.
+///
+/// Directories are distributed over a pool of threads and each thread
+/// steals directories from others when it runs out of work. Callback is
+/// called concurrently, so it should only touch its per-worker context and
+/// output (see [`cbuild_dir_walk_func_args_t`](DOC:cbuild_dir_walk_func_args_t)).
+/// Order of visits is not defined, directory is always visited before its
+/// content. `CBUILD_DIR_WALK_STOP`{.c} stops walker, but other threads
+/// still finish directories they are processing.
+///
+/// On platforms without `openat`{.c} this is a serial walk.
+///
+/// * [pl:path:const char*] Path to a directory.
+/// * [pl:callback:cbuild_dir_walk_func_t] Function that will be called for each file system object.
+/// * [pl:...:...cbuild_dir_walk_parallel_opts_t] Fields of configuration structure in initializer-list form.
+#define cbuild_dir_walk_parallel(path, callback, ...)                               \
+cbuild_dir_walk_parallel_opt(path, callback,                                        \
+	(struct cbuild_dir_walk_parallel_opts_t){ __VA_ARGS__ })
 /// Open directory.
 CBUILDDEF cbuild_dir_t cbuild_dir_open(const char* path);
 /// Get next element from directory.
@@ -213,6 +526,47 @@ CBUILDDEF int cbuild_dir_next(cbuild_dir_t dir, const char** element);
 CBUILDDEF bool cbuild_dir_close(cbuild_dir_t dir);
 /// Get type of file.
 CBUILDDEF cbuild_filetype_t cbuild_path_filetype(const char* path);
+/// Statistics of a stat cache.
+///
+/// * [fl:hits] Number of calls answered from a cache.
+/// * [fl:misses] Number of real `stat`{.c} and `lstat`{.c} calls.
+/// * [fl:invalidations] Number of invalidated paths plus number of full invalidations.
+typedef struct cbuild_stat_cache_stats_t {
+	size_t hits;
+	size_t misses;
+	size_t invalidations;
+} cbuild_stat_cache_stats_t;
+/// Statistics of process-wide stat cache. Can be reset by user.
+extern cbuild_stat_cache_stats_t cbuild_stat_cache_stats;
+/// `stat`{.c} with process-wide cache. Used by FS and Compile modules, so
+/// eg. output that is compared against many inputs is stat-ed only once.
+///
+/// Cache is keyed by normalized path (see [`cbuild_path_normalize`](DOC:cbuild_path_normalize))
+/// and failures are cached too. It is invalidated:
+///
+/// * Per path when file is written, moved or removed by CBuild itself.
+/// * Completely when child process is started or waited for, when directory
+///   is removed and when current directory changes.
+///
+/// If file is changed in any other way, [`cbuild_stat_invalidate`](DOC:cbuild_stat_invalidate)
+/// should be called. Cache can be disabled with `CBUILD_STAT_CACHE`.
+///
+/// Cache can be used from several threads, it is guarded by a single lock.
+///
+/// [r:] `false`{.c} on error, `errno`{.c} is set.
+CBUILDDEF bool cbuild_stat(const char* path, struct stat* statbuff);
+/// `lstat`{.c} with process-wide cache. Same as [`cbuild_stat`](DOC:cbuild_stat).
+CBUILDDEF bool cbuild_lstat(const char* path, struct stat* statbuff);
+/// Invalidate cached stat of a single path.
+CBUILDDEF void cbuild_stat_invalidate(const char* path);
+/// Invalidate whole stat cache by bumping its generation.
+///
+/// [r:] New generation.
+CBUILDDEF uint64_t cbuild_stat_invalidate_all(void);
+/// Get current generation of a stat cache. Generation changes each time
+/// cache is invalidated completely, so it can be used to detect that
+/// cached results may be outdated.
+CBUILDDEF uint64_t cbuild_stat_generation(void);
 /// Optional arguments for [`cbuild_path_ext`](DOC:cbuild_path_ext).
 ///
 /// * [fl:dot] Get extensions after n-th dot from the end. `0` is default value
@@ -0,0 +1,154 @@
+//! Dependency graph of build tasks.
+//!
+//! License: `GPL-3.0-or-later`.
+
+#include "Graph.h"
+#include "Common.h"
+#include "DynArray.h"
+#include "Span.h"
+#include "Log.h"
+#include "Proc.h"
+#include "Command.h"
+CBUILDDEF size_t __cbuild_graph_add(cbuild_graph_t* graph) {
+	__cbuild_graph_node_t node = {0};
+	cbuild_da_append(graph, node);
+	return graph->size - 1;
+}
+CBUILDDEF size_t cbuild_graph_add_cmd(cbuild_graph_t* graph, cbuild_cmd_t cmd) {
+	size_t idx = __cbuild_graph_add(graph);
+	cbuild_da_append_arr(&graph->data[idx].cmd, cmd.data, cmd.size);
+	return idx;
+}
+CBUILDDEF size_t cbuild_graph_add_func(cbuild_graph_t* graph,
+	cbuild_proc_func_t func, void* args) {
+	size_t idx = __cbuild_graph_add(graph);
+	graph->data[idx].func = func;
+	graph->data[idx].args = args;
+	return idx;
+}
+CBUILDDEF size_t cbuild_graph_add_func_inline(cbuild_graph_t* graph,
+	cbuild_proc_func_t func, void* args) {
+	size_t idx = cbuild_graph_add_func(graph, func, args);
+	graph->data[idx].inline_func = true;
+	return idx;
+}
+CBUILDDEF void cbuild_graph_depend(cbuild_graph_t* graph, size_t node, size_t dep) {
+	cbuild_assert(node < graph->size && dep < graph->size,
+		"Graph node index out of bounds.\n");
+	cbuild_da_append(&graph->data[dep].dependents, node);
+	graph->data[node].deps++;
+}
+CBUILDDEF cbuild_graph_status_t cbuild_graph_status(cbuild_graph_t* graph,
+	size_t node) {
+	cbuild_assert(node < graph->size, "Graph node index out of bounds.\n");
+	return graph->data[node].status;
+}
+CBUILDDEF void cbuild_graph_clear(cbuild_graph_t* graph) {
+	for(size_t i = 0; i < graph->size; i++) {
+		cbuild_da_clear(&graph->data[i].cmd);
+		cbuild_da_clear(&graph->data[i].dependents);
+	}
+	cbuild_da_clear(graph);
+}
+typedef cbuild_da_new(size_t) __cbuild_graph_queue_t;
+// Mark all nodes that transitively depend on 'node' as skipped
+CBUILDDEF void __cbuild_graph_skip(cbuild_graph_t* graph, size_t node) {
+	__cbuild_graph_queue_t stack = {0};
+	cbuild_da_append(&stack, node);
+	while(stack.size > 0) {
+		size_t n = cbuild_da_pop(&stack);
+		cbuild_span_foreach(&graph->data[n].dependents, dep) {
+			if(graph->data[*dep].status != CBUILD_GRAPH_PENDING) continue;
+			graph->data[*dep].status = CBUILD_GRAPH_SKIPPED;
+			cbuild_da_append(&stack, *dep);
+		}
+	}
+	cbuild_da_clear(&stack);
+}
+// Returns false if node failed
+CBUILDDEF bool __cbuild_graph_finish(cbuild_graph_t* graph, size_t node,
+	int code, __cbuild_graph_queue_t* ready) {
+	if(code != 0) {
+		graph->data[node].status = CBUILD_GRAPH_FAILED;
+		__cbuild_graph_skip(graph, node);
+		return false;
+	}
+	graph->data[node].status = CBUILD_GRAPH_DONE;
+	cbuild_span_foreach(&graph->data[node].dependents, dep) {
+		__cbuild_graph_node_t* n = &graph->data[*dep];
+		if(--n->pending == 0 && n->status == CBUILD_GRAPH_PENDING) {
+			cbuild_da_append(ready, *dep);
+		}
+	}
+	return true;
+}
+CBUILDDEF bool cbuild_graph_run_opt(cbuild_graph_t* graph,
+	struct cbuild_graph_opts_t opts) {
+	if(opts.jobs <= 0) opts.jobs = cbuild_nproc() + 1;
+	// Ready nodes are processed in FIFO order, so 'head' is used instead of pop
+	__cbuild_graph_queue_t ready = {0};
+	size_t head = 0;
+	for(size_t i = 0; i < graph->size; i++) {
+		graph->data[i].status = CBUILD_GRAPH_PENDING;
+		graph->data[i].pending = graph->data[i].deps;
+		if(graph->data[i].deps == 0) cbuild_da_append(&ready, i);
+	}
+	cbuild_proclist_t procs = {0};
+	__cbuild_graph_queue_t running = {0}; // Node for each element of 'procs'
+	bool failed = false;
+	bool stop = false;
+	while(true) {
+		while(!stop && head < ready.size && procs.size < (size_t)opts.jobs) {
+			size_t node = ready.data[head++];
+			__cbuild_graph_node_t* n = &graph->data[node];
+			n->status = CBUILD_GRAPH_RUNNING;
+			if(n->func != NULL && n->inline_func) {
+				if(!__cbuild_graph_finish(graph, node, n->func(n->args), &ready)) {
+					failed = true;
+					stop = !opts.keep_going;
+				}
+				continue;
+			}
+			cbuild_proc_t proc = CBUILD_INVALID_PROC;
+			if(n->func != NULL) {
+				fflush(NULL);
+				proc = cbuild_proc_start(n->func, n->args);
+			} else if(!cbuild_cmd_run(&n->cmd, .proc = &proc, .no_reset = true,
+					.no_print_cmd = opts.no_print_cmd, .autokill = opts.autokill)) {
+				proc = CBUILD_INVALID_PROC;
+			}
+			if(proc == CBUILD_INVALID_PROC) {
+				__cbuild_graph_finish(graph, node, -1, &ready);
+				failed = true;
+				stop = !opts.keep_going;
+				continue;
+			}
+			cbuild_da_append(&procs, proc);
+			cbuild_da_append(&running, node);
+		}
+		if(procs.size == 0) break;
+		int code = 0;
+		size_t idx = cbuild_procs_wait_any(procs, &code);
+		size_t node = running.data[idx];
+		cbuild_da_remove_unordered(&procs, idx);
+		cbuild_da_remove_unordered(&running, idx);
+		if(!__cbuild_graph_finish(graph, node, code, &ready)) {
+			cbuild_log_error("Graph node %zu failed with code %d", node, code);
+			failed = true;
+			stop = !opts.keep_going;
+		}
+	}
+	// Everything that was not reached is either aborted or part of a cycle
+	for(size_t i = 0; i < graph->size; i++) {
+		if(graph->data[i].status != CBUILD_GRAPH_PENDING) continue;
+		if(!stop) {
+			cbuild_log_error("Graph node %zu is part of (or depends on) a dependency cycle", i);
+			failed = true;
+		}
+		graph->data[i].status = CBUILD_GRAPH_SKIPPED;
+	}
+	cbuild_da_clear(&ready);
+	cbuild_da_clear(&procs);
+	cbuild_da_clear(&running);
+	return !failed;
+}
@@ -0,0 +1,132 @@
+#pragma once // For LSP
+//! Dependency graph of build tasks.
+//!
+//! License: `GPL-3.0-or-later`.
+//!
+//! Graph consists of nodes, each node is either a command or a function.
+//! Edges are dependencies between nodes. Scheduler keeps a fixed number of
+//! slots busy and starts node as soon as all of its dependencies finished,
+//! so there is no need to wait for a whole "phase" of a build to finish
+//! (like with [`cbuild_procs_wait`](DOC:cbuild_procs_wait)) before starting
+//! next one.
+//!
+//! ```c
+//! cbuild_graph_t graph = {0};
+//! size_t link = cbuild_graph_add_cmd(&graph, link_cmd);
+//! for(size_t i = 0; i < objs.size; i++) {
+//!     size_t obj = cbuild_graph_add_cmd(&graph, obj_cmds[i]);
+//!     cbuild_graph_depend(&graph, link, obj);
+//! }
+//! bool ok = cbuild_graph_run(&graph, .jobs = 8);
+//! cbuild_graph_clear(&graph);
+//! ```
+
+#include "Common.h"
+#include "Proc.h"
+#include "Command.h"
+
+/// State of a graph node.
+typedef enum cbuild_graph_status_t {
+	CBUILD_GRAPH_PENDING = 0, // Not started yet
+	CBUILD_GRAPH_RUNNING,     // Currently running
+	CBUILD_GRAPH_DONE,        // Finished successfully
+	CBUILD_GRAPH_FAILED,      // Finished with an error
+	CBUILD_GRAPH_SKIPPED,     // Not started because of failed dependency or abort
+} cbuild_graph_status_t;
+/// Node of a graph. Should not be used directly.
+typedef struct __cbuild_graph_node_t {
+	cbuild_cmd_t cmd;
+	cbuild_proc_func_t func;
+	void* args;
+	bool inline_func;
+	cbuild_graph_status_t status;
+	size_t deps;    // Number of dependencies
+	size_t pending; // Number of unfinished dependencies
+	cbuild_da_new(size_t) dependents;
+} __cbuild_graph_node_t;
+/// Dependency graph.
+///
+/// Should be zero-initialized.
+typedef struct cbuild_graph_t {
+	__cbuild_graph_node_t* data;
+	size_t size;
+	size_t capacity;
+} cbuild_graph_t;
+/// Add command node.
+///
+/// ::: note
+/// Only array of arguments is copied, strings itself should outlive a graph.
+/// :::
+///
+/// * [pl:graph] Graph object.
+/// * [pl:cmd] Command to run.
+///
+/// [r:] Node index.
+CBUILDDEF size_t cbuild_graph_add_cmd(cbuild_graph_t* graph, cbuild_cmd_t cmd);
+/// Add function node. Function is executed in a child process (using
+/// [`cbuild_proc_start`](DOC:cbuild_proc_start)), so it takes a slot and runs
+/// in parallel with other nodes. Changes to memory are not visible to parent.
+///
+/// * [pl:graph] Graph object.
+/// * [pl:func] Function to run. It should return exit code.
+/// * [pl:args] Argument for [p:func].
+///
+/// [r:] Node index.
+CBUILDDEF size_t cbuild_graph_add_func(cbuild_graph_t* graph,
+	cbuild_proc_func_t func, void* args);
+/// Add function node that is executed directly by scheduler. It does not take
+/// a slot, but scheduler can not react on other finished nodes while it runs,
+/// so it should be short.
+///
+/// * [pl:graph] Graph object.
+/// * [pl:func] Function to run. It should return `0`{.c} on success.
+/// * [pl:args] Argument for [p:func].
+///
+/// [r:] Node index.
+CBUILDDEF size_t cbuild_graph_add_func_inline(cbuild_graph_t* graph,
+	cbuild_proc_func_t func, void* args);
+/// Add dependency. [p:node] will start only after [p:dep] finished successfully.
+///
+/// * [pl:graph] Graph object.
+/// * [pl:node] Dependent node.
+/// * [pl:dep] Dependency.
+CBUILDDEF void cbuild_graph_depend(cbuild_graph_t* graph, size_t node, size_t dep);
+/// Get status of a node. Valid after [`cbuild_graph_run`](DOC:cbuild_graph_run).
+///
+/// * [pl:graph] Graph object.
+/// * [pl:node] Node index.
+CBUILDDEF cbuild_graph_status_t cbuild_graph_status(cbuild_graph_t* graph,
+	size_t node);
+/// Free all memory used by a graph.
+///
+/// * [pl:graph] Graph object.
+CBUILDDEF void cbuild_graph_clear(cbuild_graph_t* graph);
+/// Configuration for graph scheduler.
+///
+/// * [fl:jobs] Number of slots. `0` means implementation-defined.
+/// * [fl:keep_going] By default scheduler stops starting new nodes after first failure and only waits for already running ones. With this flag it continues with all nodes that do not depend on a failed one.
+/// * [fl:no_print_cmd] Do not print commands as `TRACE` log.
+/// * [fl:autokill] Passed to [`cbuild_cmd_run`](DOC:cbuild_cmd_run).
+struct cbuild_graph_opts_t {
+	int jobs;
+	union {
+		uint32_t flags;
+		struct {
+			uint32_t keep_going   : 1;
+			uint32_t no_print_cmd : 1;
+			uint32_t autokill     : 1;
+			uint32_t              : 29;
+		};
+	};
+};
+/// Run graph. This function is semi-internal.
+CBUILDDEF bool cbuild_graph_run_opt(cbuild_graph_t* graph,
+	struct cbuild_graph_opts_t opts);
+/// Run all nodes of a graph. Graph can be executed again, all statuses are reset.
+///
+/// * [pl:graph:cbuild_graph_t*] Graph object.
+/// * [pl:...:...cbuild_graph_opts_t] Fields of configuration structure in initializer-list form.
+///
+/// [r:bool] `false`{.c} if any node failed or graph has a dependency cycle.
+#define cbuild_graph_run(graph, ...)                                           \
+cbuild_graph_run_opt(graph, (struct cbuild_graph_opts_t){ __VA_ARGS__ })
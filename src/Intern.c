@@ -0,0 +1,161 @@
+//! String interning pool.
+//!
+//! License: `GPL-3.0-or-later`.
+
+#include "Intern.h"
+#include "Common.h"
+#include "Arena.h"
+#include "DynArray.h"
+#include "Span.h"
+#include "StringView.h"
+#include "Map.h"
+CBUILDDEF void __cbuild_intern_alloc(cbuild_intern_t* pool, size_t count) {
+	pool->shards = __CBUILD_MALLOC(count * sizeof(__cbuild_intern_shard_t));
+	cbuild_assert(pool->shards != NULL, "Allocation failed.\n");
+	for(size_t i = 0; i < count; i++) {
+		pool->shards[i] = (__cbuild_intern_shard_t){0};
+		cbuild_map_init_strkey(&pool->shards[i].index);
+	}
+}
+#if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
+	CBUILDDEF void cbuild_intern_init_threaded(cbuild_intern_t* pool) {
+		cbuild_assert(pool->shards == NULL, "Pool is already initialized.\n");
+		size_t count = 1;
+		while(count < CBUILD_INTERN_SHARDS) {
+			count <<= 1;
+			pool->shard_bits++;
+		}
+		__cbuild_intern_alloc(pool, count);
+		for(size_t i = 0; i < count; i++) {
+			pthread_mutex_init(&pool->shards[i].lock, NULL);
+		}
+		pool->threaded = true;
+	}
+#endif // CBUILD_API_*
+CBUILDDEF void __cbuild_intern_lock(cbuild_intern_t* pool,
+	__cbuild_intern_shard_t* shard) {
+	#if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
+		if(pool->threaded) pthread_mutex_lock(&shard->lock);
+	#else
+		CBUILD_UNUSED(pool);
+		CBUILD_UNUSED(shard);
+	#endif // CBUILD_API_*
+}
+CBUILDDEF void __cbuild_intern_unlock(cbuild_intern_t* pool,
+	__cbuild_intern_shard_t* shard) {
+	#if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
+		if(pool->threaded) pthread_mutex_unlock(&shard->lock);
+	#else
+		CBUILD_UNUSED(pool);
+		CBUILD_UNUSED(shard);
+	#endif // CBUILD_API_*
+}
+// Copy string to the last block. Strings are packed without arena padding.
+CBUILDDEF char* __cbuild_intern_store(__cbuild_intern_shard_t* shard,
+	cbuild_sv_t str) {
+	size_t size = str.size + 1;
+	cbuild_arena_t* block = NULL;
+	if(shard->blocks.size > 0) block = &shard->blocks.data[shard->blocks.size - 1];
+	if(block == NULL || block->capacity - block->pointer < size) {
+		// Long string gets a block of its own, so current block stays last
+		bool own = size > CBUILD_INTERN_BLOCK_SIZE / 4;
+		cbuild_arena_t new_block = {0};
+		cbuild_arena_base_malloc(&new_block, own ? size : CBUILD_INTERN_BLOCK_SIZE);
+		cbuild_da_append(&shard->blocks, new_block);
+		block = &shard->blocks.data[shard->blocks.size - 1];
+		if(own && shard->blocks.size > 1) {
+			cbuild_arena_t tmp = *block;
+			*block = shard->blocks.data[shard->blocks.size - 2];
+			shard->blocks.data[shard->blocks.size - 2] = tmp;
+			block = &shard->blocks.data[shard->blocks.size - 2];
+		}
+	}
+	char* dst = (char*)block->base + block->pointer;
+	memcpy(dst, str.data, str.size);
+	dst[str.size] = '\0';
+	block->pointer += size;
+	return dst;
+}
+CBUILDDEF __cbuild_intern_pair_t* __cbuild_intern_get(cbuild_intern_t* pool,
+	cbuild_sv_t str, bool insert, __cbuild_intern_shard_t** shard_out) {
+	if(pool->shards == NULL) __cbuild_intern_alloc(pool, 1);
+	cbuild_map_strkey_t key = cbuild_map_strkey_sv(str);
+	// Swiss map mixes hash before use, so low bits can also select a shard
+	uint32_t shard_idx = (uint32_t)key.hash & ((1u << pool->shard_bits) - 1);
+	__cbuild_intern_shard_t* shard = &pool->shards[shard_idx];
+	*shard_out = shard;
+	__cbuild_intern_lock(pool, shard);
+	if(!insert) return cbuild_smap_find(&shard->index, key);
+	bool found = false;
+	__cbuild_intern_pair_t* pair = cbuild_smap_get_ex(&shard->index, key, &found);
+	if(!found) {
+		size_t local = shard->strings.size;
+		cbuild_assert(local < (UINT32_MAX >> pool->shard_bits),
+			"Too many strings in interning pool.\n");
+		pair->key.data = __cbuild_intern_store(shard, str);
+		pair->id = ((uint32_t)local << pool->shard_bits) | shard_idx;
+		cbuild_da_append(&shard->strings,
+			cbuild_sv_from_parts(pair->key.data, str.size));
+	}
+	return pair;
+}
+CBUILDDEF uint32_t cbuild_intern(cbuild_intern_t* pool, cbuild_sv_t str) {
+	__cbuild_intern_shard_t* shard = NULL;
+	__cbuild_intern_pair_t* pair = __cbuild_intern_get(pool, str, true, &shard);
+	uint32_t id = pair->id;
+	__cbuild_intern_unlock(pool, shard);
+	return id;
+}
+CBUILDDEF uint32_t cbuild_intern_cstr(cbuild_intern_t* pool, const char* str) {
+	return cbuild_intern(pool, cbuild_sv_from_cstr(str));
+}
+CBUILDDEF cbuild_sv_t cbuild_intern_sv(cbuild_intern_t* pool, cbuild_sv_t str) {
+	__cbuild_intern_shard_t* shard = NULL;
+	__cbuild_intern_pair_t* pair = __cbuild_intern_get(pool, str, true, &shard);
+	cbuild_sv_t ret = cbuild_sv_from_parts(pair->key.data, pair->key.size);
+	__cbuild_intern_unlock(pool, shard);
+	return ret;
+}
+CBUILDDEF uint32_t cbuild_intern_find(cbuild_intern_t* pool, cbuild_sv_t str) {
+	__cbuild_intern_shard_t* shard = NULL;
+	__cbuild_intern_pair_t* pair = __cbuild_intern_get(pool, str, false, &shard);
+	uint32_t id = pair == NULL ? CBUILD_INTERN_NONE : pair->id;
+	__cbuild_intern_unlock(pool, shard);
+	return id;
+}
+CBUILDDEF cbuild_sv_t cbuild_intern_str(cbuild_intern_t* pool, uint32_t id) {
+	uint32_t mask = (1u << pool->shard_bits) - 1;
+	cbuild_assert(pool->shards != NULL, "Id %u is not in a pool.\n", id);
+	__cbuild_intern_shard_t* shard = &pool->shards[id & mask];
+	size_t local = id >> pool->shard_bits;
+	__cbuild_intern_lock(pool, shard);
+	cbuild_assert(local < shard->strings.size, "Id %u is not in a pool.\n", id);
+	cbuild_sv_t ret = shard->strings.data[local];
+	__cbuild_intern_unlock(pool, shard);
+	return ret;
+}
+CBUILDDEF size_t cbuild_intern_count(cbuild_intern_t* pool) {
+	if(pool->shards == NULL) return 0;
+	size_t count = 0;
+	for(size_t i = 0; i < ((size_t)1 << pool->shard_bits); i++) {
+		__cbuild_intern_lock(pool, &pool->shards[i]);
+		count += pool->shards[i].strings.size;
+		__cbuild_intern_unlock(pool, &pool->shards[i]);
+	}
+	return count;
+}
+CBUILDDEF void cbuild_intern_free(cbuild_intern_t* pool) {
+	if(pool->shards == NULL) return;
+	for(size_t i = 0; i < ((size_t)1 << pool->shard_bits); i++) {
+		__cbuild_intern_shard_t* shard = &pool->shards[i];
+		cbuild_span_foreach(&shard->blocks, block) cbuild_arena_base_free(block);
+		cbuild_da_clear(&shard->blocks);
+		cbuild_smap_clear(&shard->index);
+		cbuild_da_clear(&shard->strings);
+		#if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
+			if(pool->threaded) pthread_mutex_destroy(&shard->lock);
+		#endif // CBUILD_API_*
+	}
+	__CBUILD_FREE(pool->shards);
+	*pool = (cbuild_intern_t){0};
+}
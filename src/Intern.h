@@ -0,0 +1,115 @@
+#pragma once // For LSP
+//! String interning pool.
+//!
+//! License: `GPL-3.0-or-later`.
+//!
+//! Pool keeps one copy of every distinct string and gives it a stable 32-bit
+//! id, so strings can be compared with `==`{.c} instead of `strcmp`{.c}.
+//! Canonical string views can be used in the same way: two views returned by
+//! a pool are equal only if their data pointers are equal.
+//!
+//! Bytes are stored one after another, without padding and with
+//! `NULL`{.c}-terminator, in arena blocks of
+//! [`CBUILD_INTERN_BLOCK_SIZE`](DOC:CBUILD_INTERN_BLOCK_SIZE) bytes. Pool grows
+//! by adding new blocks, old ones are never moved, so canonical views stay
+//! valid until pool is freed. Strings are indexed by swiss map keyed by
+//! [`cbuild_map_strkey_t`](DOC:cbuild_map_strkey_t).
+//!
+//! ```cpp
+//! cbuild_intern_t pool = {0};
+//! uint32_t a = cbuild_intern_cstr(&pool, "src/Map.c");
+//! uint32_t b = cbuild_intern(&pool, cbuild_sv_from_parts("src/Map.c.o", 9));
+//! // a == b
+//! printf("%s\n", cbuild_intern_str(&pool, a).data);
+//! cbuild_intern_free(&pool);
+//! ```
+//!
+//! # Threaded mode
+//!
+//! Pool initialized with [`cbuild_intern_init_threaded`](DOC:cbuild_intern_init_threaded)
+//! can be used from several threads at once. Strings are split between
+//! [`CBUILD_INTERN_SHARDS`](DOC:CBUILD_INTERN_SHARDS) shards by their hash,
+//! each shard has its own lock, blocks and index, so threads interning
+//! different strings rarely wait for each other. Ids are still unique and
+//! stable, but not consecutive.
+
+#include "Common.h"
+#include "Arena.h"
+#include "DynArray.h"
+#include "StringView.h"
+#include "Map.h"
+
+/// Id that is never given to a string.
+#define CBUILD_INTERN_NONE UINT32_MAX
+/// Index pair of a pool. Should not be used directly.
+typedef struct __cbuild_intern_pair_t {
+	cbuild_map_strkey_t key;
+	uint32_t id;
+} __cbuild_intern_pair_t;
+/// Shard of a pool. Should not be used directly.
+typedef struct __cbuild_intern_shard_t {
+	cbuild_da_new(cbuild_arena_t) blocks; // Strings are added to the last one
+	struct {
+		__cbuild_intern_pair_t* data;
+		size_t size;
+		size_t capacity;
+		cbuild_map_hash_t hash;
+		cbuild_map_keycmp_t keycmp;
+		uint8_t* ctrl;
+		size_t deleted;
+	} index;
+	cbuild_da_new(cbuild_sv_t) strings; // By id without shard bits
+	#if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
+		pthread_mutex_t lock;
+	#endif // CBUILD_API_*
+} __cbuild_intern_shard_t;
+/// String interning pool.
+///
+/// Should be zero-initialized, in this case pool is not thread-safe and ids
+/// are given in order, starting from `0`{.c}. Should be freed with
+/// [`cbuild_intern_free`](DOC:cbuild_intern_free).
+///
+/// * [fl:shards] Shards, allocated on first use.
+/// * [fl:shard_bits] Number of low bits of id that select a shard.
+/// * [fl:threaded] If shards are locked.
+typedef struct cbuild_intern_t {
+	__cbuild_intern_shard_t* shards;
+	uint32_t shard_bits;
+	bool threaded;
+} cbuild_intern_t;
+#if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
+	/// Initialize empty pool for use from several threads. Should be called
+	/// before pool is shared.
+	CBUILDDEF void cbuild_intern_init_threaded(cbuild_intern_t* pool);
+#endif // CBUILD_API_*
+/// Intern a string.
+///
+/// * [pl:pool] Pool.
+/// * [pl:str] String. Copied if it is not in a pool yet.
+///
+/// [r:] Id of a string.
+CBUILDDEF uint32_t cbuild_intern(cbuild_intern_t* pool, cbuild_sv_t str);
+/// Intern a `NULL`{.c}-terminated string.
+///
+/// [r:] Id of a string.
+CBUILDDEF uint32_t cbuild_intern_cstr(cbuild_intern_t* pool, const char* str);
+/// Intern a string and get its canonical view.
+///
+/// [r:] View of a copy owned by pool. Data is `NULL`{.c}-terminated.
+CBUILDDEF cbuild_sv_t cbuild_intern_sv(cbuild_intern_t* pool, cbuild_sv_t str);
+/// Find id of a string without adding it.
+///
+/// [r:] Id of a string or [`CBUILD_INTERN_NONE`](DOC:CBUILD_INTERN_NONE) if string was never interned.
+CBUILDDEF uint32_t cbuild_intern_find(cbuild_intern_t* pool, cbuild_sv_t str);
+/// Get string by its id.
+///
+/// * [pl:pool] Pool.
+/// * [pl:id] Id returned by this pool.
+///
+/// [r:] Canonical view of a string. Data is `NULL`{.c}-terminated.
+CBUILDDEF cbuild_sv_t cbuild_intern_str(cbuild_intern_t* pool, uint32_t id);
+/// Number of distinct strings in a pool.
+CBUILDDEF size_t cbuild_intern_count(cbuild_intern_t* pool);
+/// Free all memory of a pool. All ids and canonical views are invalidated.
+/// Pool can be reused afterwards, it is not thread-safe anymore.
+CBUILDDEF void cbuild_intern_free(cbuild_intern_t* pool);
@@ -13,8 +13,8 @@ CBUILDDEF size_t __cbuild_map_cstr_hash(const void* map,
 	const void* key, size_t klen) {
 	CBUILD_UNUSED(map);
 	CBUILD_UNUSED(klen);
-	size_t len = strlen(key);
-	return CBUILD_MAP_DEFAULT_HASH(key, len);
+	const char* str = *(const char* const*)key;
+	return CBUILD_MAP_DEFAULT_HASH(str, strlen(str));
 }
 CBUILDDEF size_t __cbuild_map_sv_hash(const void* map,
 	const void* key, size_t klen) {
@@ -30,6 +30,12 @@ CBUILDDEF size_t __cbuild_map_sb_hash(const void* map,
 	const cbuild_sb_t* sb = key;
 	return CBUILD_MAP_DEFAULT_HASH(sb->data, sb->size);
 }
+CBUILDDEF size_t __cbuild_map_strkey_hash(const void* map,
+	const void* key, size_t klen) {
+	CBUILD_UNUSED(map);
+	CBUILD_UNUSED(klen);
+	return ((const cbuild_map_strkey_t*)key)->hash;
+}
 CBUILDDEF bool __cbuild_map_num_keycmp(const void* map,
 	const void* k1, const void* k2, size_t klen) {
 	CBUILD_UNUSED(map);
@@ -39,7 +45,7 @@ CBUILDDEF bool __cbuild_map_cstr_keycmp(const void* map,
 	const void* k1, const void* k2, size_t klen) {
 	CBUILD_UNUSED(map);
 	CBUILD_UNUSED(klen);
-	return strcmp(k1, k2) == 0;
+	return strcmp(*(const char* const*)k1, *(const char* const*)k2) == 0;
 }
 CBUILDDEF bool __cbuild_map_sv_keycmp(const void* map,
 	const void* k1, const void* k2, size_t klen) {
@@ -57,6 +63,25 @@ CBUILDDEF bool __cbuild_map_sb_keycmp(const void* map,
 	const cbuild_sb_t* sv2 = k2;
 	return cbuild_sb_cmp(*sv1, *sv2) == 0;
 }
+CBUILDDEF bool __cbuild_map_strkey_keycmp(const void* map,
+	const void* k1, const void* k2, size_t klen) {
+	CBUILD_UNUSED(map);
+	CBUILD_UNUSED(klen);
+	const cbuild_map_strkey_t* key1 = k1;
+	const cbuild_map_strkey_t* key2 = k2;
+	if(key1->hash != key2->hash || key1->size != key2->size) return false;
+	return key1->data == key2->data || memcmp(key1->data, key2->data, key1->size) == 0;
+}
+CBUILDDEF cbuild_map_strkey_t cbuild_map_strkey(const char* cstr) {
+	return cbuild_map_strkey_sv(cbuild_sv_from_cstr(cstr));
+}
+CBUILDDEF cbuild_map_strkey_t cbuild_map_strkey_sv(cbuild_sv_t sv) {
+	return (cbuild_map_strkey_t){
+		.hash = CBUILD_MAP_DEFAULT_HASH(sv.data, sv.size),
+		.size = sv.size,
+		.data = sv.data,
+	};
+}
 CBUILDDEF size_t __cbuild_map_step(size_t prev) {
 	// Splitmix64 with added  '| 1'.
 	prev += 0x9e3779b97f4a7c15;
@@ -66,6 +91,51 @@ CBUILDDEF size_t __cbuild_map_step(size_t prev) {
 	// We probably have less than 4GB of array and we need to have this number odd
 	return (z ^ (z >> 31)) | 1;
 }
+CBUILDDEF void __cbuild_map_compact(const void* map, cbuild_map_hash_t hash,
+	void* data, size_t capacity, size_t elem_size, size_t klen, size_t key,
+	size_t tombstone) {
+	uint8_t* base = data;
+	#define __CBUILD_MAP_TOMB(i) \
+		(*(cbuild_map_tombstone_t*)(base + (i) * elem_size + tombstone))
+	// Deleted slots become free, full slots are marked as deleted until their
+	// element is placed
+	for(size_t i = 0; i < capacity; i++) {
+		__CBUILD_MAP_TOMB(i) = __CBUILD_MAP_TOMB(i) == CBUILD_MAP_FULL ?
+			CBUILD_MAP_DELETED : CBUILD_MAP_EMPTY;
+	}
+	for(size_t i = 0; i < capacity; i++) {
+		while(__CBUILD_MAP_TOMB(i) == CBUILD_MAP_DELETED) {
+			uint8_t* elem = base + i * elem_size;
+			size_t h = hash(map, elem + key, klen);
+			size_t step = __cbuild_map_step(h);
+			size_t idx = h & (capacity - 1);
+			while(__CBUILD_MAP_TOMB(idx) == CBUILD_MAP_FULL) {
+				h += step;
+				idx = h & (capacity - 1);
+			}
+			if(idx == i) {
+				__CBUILD_MAP_TOMB(i) = CBUILD_MAP_FULL;
+				break;
+			}
+			uint8_t* target = base + idx * elem_size;
+			if(__CBUILD_MAP_TOMB(idx) == CBUILD_MAP_EMPTY) {
+				memcpy(target, elem, elem_size);
+				__CBUILD_MAP_TOMB(idx) = CBUILD_MAP_FULL;
+				__CBUILD_MAP_TOMB(i) = CBUILD_MAP_EMPTY;
+				break;
+			}
+			// Slot holds element that was not placed yet, so swap them and
+			// place that element on next iteration
+			for(size_t b = 0; b < elem_size; b++) {
+				uint8_t tmp = elem[b];
+				elem[b] = target[b];
+				target[b] = tmp;
+			}
+			__CBUILD_MAP_TOMB(idx) = CBUILD_MAP_FULL;
+		}
+	}
+	#undef __CBUILD_MAP_TOMB
+}
 CBUILDDEF size_t cbuild_map_hash_djb2(const void* data, size_t len) {
 	const uint8_t* ucPtr = data;
 	size_t hash = 5381;
@@ -100,3 +170,739 @@ CBUILDDEF size_t cbuild_map_hash_sdbm(void const *data, size_t len) {
 	}
 	return hash;
 }
+// wyhash (final version 4) by Wang Yi, public domain
+CBUILDDEF void __cbuild_wymum(uint64_t* a, uint64_t* b) {
+	#if defined(__SIZEOF_INT128__)
+		__uint128_t r = *a;
+		r *= *b;
+		*a = (uint64_t)r;
+		*b = (uint64_t)(r >> 64);
+	#else
+		uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+		uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+		uint64_t t = rl + (rm0 << 32), c = t < rl;
+		uint64_t lo = t + (rm1 << 32);
+		c += lo < t;
+		*a = lo;
+		*b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+	#endif // __SIZEOF_INT128__
+}
+CBUILDDEF uint64_t __cbuild_wymix(uint64_t a, uint64_t b) {
+	__cbuild_wymum(&a, &b);
+	return a ^ b;
+}
+CBUILDDEF uint64_t __cbuild_wyr8(const uint8_t* p) {
+	uint64_t v;
+	memcpy(&v, p, 8);
+	return v;
+}
+CBUILDDEF uint64_t __cbuild_wyr4(const uint8_t* p) {
+	uint32_t v;
+	memcpy(&v, p, 4);
+	return v;
+}
+CBUILDDEF uint64_t cbuild_map_hash_wyhash_seed(const void* data, size_t len,
+	uint64_t seed) {
+	static const uint64_t secret[4] = {
+		0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull,
+		0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull,
+	};
+	const uint8_t* p = data;
+	seed ^= __cbuild_wymix(seed ^ secret[0], secret[1]);
+	uint64_t a, b;
+	if(len <= 16) {
+		if(len >= 4) {
+			a = (__cbuild_wyr4(p) << 32) | __cbuild_wyr4(p + ((len >> 3) << 2));
+			b = (__cbuild_wyr4(p + len - 4) << 32) |
+				__cbuild_wyr4(p + len - 4 - ((len >> 3) << 2));
+		} else if(len > 0) {
+			a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+			b = 0;
+		} else {
+			a = b = 0;
+		}
+	} else {
+		size_t i = len;
+		if(i > 48) {
+			uint64_t see1 = seed, see2 = seed;
+			do {
+				seed = __cbuild_wymix(__cbuild_wyr8(p) ^ secret[1], __cbuild_wyr8(p + 8) ^ seed);
+				see1 = __cbuild_wymix(__cbuild_wyr8(p + 16) ^ secret[2], __cbuild_wyr8(p + 24) ^ see1);
+				see2 = __cbuild_wymix(__cbuild_wyr8(p + 32) ^ secret[3], __cbuild_wyr8(p + 40) ^ see2);
+				p += 48;
+				i -= 48;
+			} while(i > 48);
+			seed ^= see1 ^ see2;
+		}
+		while(i > 16) {
+			seed = __cbuild_wymix(__cbuild_wyr8(p) ^ secret[1], __cbuild_wyr8(p + 8) ^ seed);
+			i -= 16;
+			p += 16;
+		}
+		a = __cbuild_wyr8(p + i - 16);
+		b = __cbuild_wyr8(p + i - 8);
+	}
+	a ^= secret[1];
+	b ^= seed;
+	__cbuild_wymum(&a, &b);
+	return __cbuild_wymix(a ^ secret[0] ^ len, b ^ secret[1]);
+}
+CBUILDDEF size_t cbuild_map_hash_wyhash(const void* data, size_t len) {
+	return cbuild_map_hash_wyhash_seed(data, len, 0);
+}
+// XXH3 (64 bit variant) by Yann Collet, BSD-2-Clause
+#define __CBUILD_XXH_PRIME32_1 0x9e3779b1u
+#define __CBUILD_XXH_PRIME32_2 0x85ebca77u
+#define __CBUILD_XXH_PRIME32_3 0xc2b2ae3du
+#define __CBUILD_XXH_PRIME64_1 0x9e3779b185ebca87ull
+#define __CBUILD_XXH_PRIME64_2 0xc2b2ae3d27d4eb4full
+#define __CBUILD_XXH_PRIME64_3 0x165667b19e3779f9ull
+#define __CBUILD_XXH_PRIME64_4 0x85ebca77c2b2ae63ull
+#define __CBUILD_XXH_PRIME64_5 0x27d4eb2f165667c5ull
+#define __CBUILD_XXH_SECRET_SIZE 192
+#define __CBUILD_XXH_STRIPE 64
+static const uint8_t __cbuild_xxh3_secret[__CBUILD_XXH_SECRET_SIZE] = {
+	0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+	0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+	0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+	0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+	0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+	0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+	0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+	0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+	0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+	0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+	0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+	0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+CBUILDDEF uint64_t __cbuild_xxh3_mul_fold(uint64_t a, uint64_t b) {
+	__cbuild_wymum(&a, &b);
+	return a ^ b;
+}
+CBUILDDEF uint64_t __cbuild_xxh64_avalanche(uint64_t h) {
+	h ^= h >> 33;
+	h *= __CBUILD_XXH_PRIME64_2;
+	h ^= h >> 29;
+	h *= __CBUILD_XXH_PRIME64_3;
+	return h ^ (h >> 32);
+}
+CBUILDDEF uint64_t __cbuild_xxh3_avalanche(uint64_t h) {
+	h ^= h >> 37;
+	h *= 0x165667919e3779f9ull;
+	return h ^ (h >> 32);
+}
+CBUILDDEF uint64_t __cbuild_xxh3_rrmxmx(uint64_t h, size_t len) {
+	h ^= ((h << 49) | (h >> 15)) ^ ((h << 24) | (h >> 40));
+	h *= 0x9fb21c651e98df25ull;
+	h ^= (h >> 35) + len;
+	h *= 0x9fb21c651e98df25ull;
+	return h ^ (h >> 28);
+}
+CBUILDDEF uint64_t __cbuild_xxh3_mix16(const uint8_t* p, const uint8_t* secret,
+	uint64_t seed) {
+	return __cbuild_xxh3_mul_fold(__cbuild_wyr8(p) ^ (__cbuild_wyr8(secret) + seed),
+		__cbuild_wyr8(p + 8) ^ (__cbuild_wyr8(secret + 8) - seed));
+}
+// Long input is processed in 64-byte stripes by 8 independent lanes, which
+// maps directly to vector registers
+#if CBUILD_MAP_SIMD && defined(__AVX2__)
+	CBUILDDEF void __cbuild_xxh3_accumulate(uint64_t* acc, const uint8_t* p,
+		const uint8_t* secret, size_t stripes) {
+		__m256i vacc[2];
+		for(size_t i = 0; i < 2; i++) {
+			vacc[i] = _mm256_loadu_si256((const __m256i*)(const void*)(acc + i * 4));
+		}
+		for(size_t s = 0; s < stripes; s++) {
+			for(size_t i = 0; i < 2; i++) {
+				__m256i data = _mm256_loadu_si256(
+					(const __m256i*)(const void*)(p + s * __CBUILD_XXH_STRIPE + i * 32));
+				__m256i key = _mm256_loadu_si256(
+					(const __m256i*)(const void*)(secret + s * 8 + i * 32));
+				__m256i data_key = _mm256_xor_si256(data, key);
+				__m256i product = _mm256_mul_epu32(data_key, _mm256_srli_epi64(data_key, 32));
+				__m256i swap = _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+				vacc[i] = _mm256_add_epi64(_mm256_add_epi64(vacc[i], swap), product);
+			}
+		}
+		for(size_t i = 0; i < 2; i++) {
+			_mm256_storeu_si256((__m256i*)(void*)(acc + i * 4), vacc[i]);
+		}
+	}
+	CBUILDDEF void __cbuild_xxh3_scramble(uint64_t* acc, const uint8_t* secret) {
+		const __m256i prime = _mm256_set1_epi32((int)__CBUILD_XXH_PRIME32_1);
+		for(size_t i = 0; i < 2; i++) {
+			__m256i vacc = _mm256_loadu_si256((const __m256i*)(const void*)(acc + i * 4));
+			__m256i key = _mm256_loadu_si256((const __m256i*)(const void*)(secret + i * 32));
+			vacc = _mm256_xor_si256(vacc, _mm256_srli_epi64(vacc, 47));
+			vacc = _mm256_xor_si256(vacc, key);
+			__m256i lo = _mm256_mul_epu32(vacc, prime);
+			__m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(vacc, 32), prime);
+			vacc = _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+			_mm256_storeu_si256((__m256i*)(void*)(acc + i * 4), vacc);
+		}
+	}
+#elif CBUILD_MAP_SIMD && defined(__SSE2__)
+	CBUILDDEF void __cbuild_xxh3_accumulate(uint64_t* acc, const uint8_t* p,
+		const uint8_t* secret, size_t stripes) {
+		__m128i vacc[4];
+		for(size_t i = 0; i < 4; i++) {
+			vacc[i] = _mm_loadu_si128((const __m128i*)(const void*)(acc + i * 2));
+		}
+		for(size_t s = 0; s < stripes; s++) {
+			for(size_t i = 0; i < 4; i++) {
+				__m128i data = _mm_loadu_si128(
+					(const __m128i*)(const void*)(p + s * __CBUILD_XXH_STRIPE + i * 16));
+				__m128i key = _mm_loadu_si128(
+					(const __m128i*)(const void*)(secret + s * 8 + i * 16));
+				__m128i data_key = _mm_xor_si128(data, key);
+				__m128i product = _mm_mul_epu32(data_key, _mm_srli_epi64(data_key, 32));
+				__m128i swap = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+				vacc[i] = _mm_add_epi64(_mm_add_epi64(vacc[i], swap), product);
+			}
+		}
+		for(size_t i = 0; i < 4; i++) {
+			_mm_storeu_si128((__m128i*)(void*)(acc + i * 2), vacc[i]);
+		}
+	}
+	CBUILDDEF void __cbuild_xxh3_scramble(uint64_t* acc, const uint8_t* secret) {
+		const __m128i prime = _mm_set1_epi32((int)__CBUILD_XXH_PRIME32_1);
+		for(size_t i = 0; i < 4; i++) {
+			__m128i vacc = _mm_loadu_si128((const __m128i*)(const void*)(acc + i * 2));
+			__m128i key = _mm_loadu_si128((const __m128i*)(const void*)(secret + i * 16));
+			vacc = _mm_xor_si128(vacc, _mm_srli_epi64(vacc, 47));
+			vacc = _mm_xor_si128(vacc, key);
+			__m128i lo = _mm_mul_epu32(vacc, prime);
+			__m128i hi = _mm_mul_epu32(_mm_srli_epi64(vacc, 32), prime);
+			vacc = _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+			_mm_storeu_si128((__m128i*)(void*)(acc + i * 2), vacc);
+		}
+	}
+#elif CBUILD_MAP_SIMD && defined(__ARM_NEON)
+	CBUILDDEF void __cbuild_xxh3_accumulate(uint64_t* acc, const uint8_t* p,
+		const uint8_t* secret, size_t stripes) {
+		uint64x2_t vacc[4];
+		for(size_t i = 0; i < 4; i++) vacc[i] = vld1q_u64(acc + i * 2);
+		for(size_t s = 0; s < stripes; s++) {
+			for(size_t i = 0; i < 4; i++) {
+				uint64x2_t data = vreinterpretq_u64_u8(
+					vld1q_u8(p + s * __CBUILD_XXH_STRIPE + i * 16));
+				uint64x2_t key = vreinterpretq_u64_u8(vld1q_u8(secret + s * 8 + i * 16));
+				uint64x2_t data_key = veorq_u64(data, key);
+				vacc[i] = vaddq_u64(vacc[i], vextq_u64(data, data, 1));
+				vacc[i] = vmlal_u32(vacc[i], vmovn_u64(data_key), vshrn_n_u64(data_key, 32));
+			}
+		}
+		for(size_t i = 0; i < 4; i++) vst1q_u64(acc + i * 2, vacc[i]);
+	}
+	CBUILDDEF void __cbuild_xxh3_scramble(uint64_t* acc, const uint8_t* secret) {
+		const uint32x2_t prime = vdup_n_u32(__CBUILD_XXH_PRIME32_1);
+		for(size_t i = 0; i < 4; i++) {
+			uint64x2_t vacc = vld1q_u64(acc + i * 2);
+			uint64x2_t key = vreinterpretq_u64_u8(vld1q_u8(secret + i * 16));
+			vacc = veorq_u64(vacc, vshrq_n_u64(vacc, 47));
+			vacc = veorq_u64(vacc, key);
+			uint64x2_t hi = vshlq_n_u64(vmull_u32(vshrn_n_u64(vacc, 32), prime), 32);
+			vacc = vmlal_u32(hi, vmovn_u64(vacc), prime);
+			vst1q_u64(acc + i * 2, vacc);
+		}
+	}
+#else
+	CBUILDDEF void __cbuild_xxh3_accumulate(uint64_t* acc, const uint8_t* p,
+		const uint8_t* secret, size_t stripes) {
+		for(size_t s = 0; s < stripes; s++) {
+			for(size_t i = 0; i < 8; i++) {
+				uint64_t data = __cbuild_wyr8(p + s * __CBUILD_XXH_STRIPE + i * 8);
+				uint64_t data_key = data ^ __cbuild_wyr8(secret + s * 8 + i * 8);
+				acc[i ^ 1] += data;
+				acc[i] += (data_key & 0xffffffffull) * (data_key >> 32);
+			}
+		}
+	}
+	CBUILDDEF void __cbuild_xxh3_scramble(uint64_t* acc, const uint8_t* secret) {
+		for(size_t i = 0; i < 8; i++) {
+			uint64_t a = acc[i];
+			a ^= a >> 47;
+			a ^= __cbuild_wyr8(secret + i * 8);
+			acc[i] = a * __CBUILD_XXH_PRIME32_1;
+		}
+	}
+#endif // SIMD
+CBUILDDEF uint64_t __cbuild_xxh3_long(const uint8_t* p, size_t len,
+	const uint8_t* secret) {
+	uint64_t acc[8] = {
+		__CBUILD_XXH_PRIME32_3, __CBUILD_XXH_PRIME64_1, __CBUILD_XXH_PRIME64_2,
+		__CBUILD_XXH_PRIME64_3, __CBUILD_XXH_PRIME64_4, __CBUILD_XXH_PRIME32_2,
+		__CBUILD_XXH_PRIME64_5, __CBUILD_XXH_PRIME32_1,
+	};
+	// Secret advances by 8 bytes each stripe, block ends when it is consumed
+	const size_t stripes = (__CBUILD_XXH_SECRET_SIZE - __CBUILD_XXH_STRIPE) / 8;
+	const size_t block = stripes * __CBUILD_XXH_STRIPE;
+	const size_t blocks = (len - 1) / block;
+	for(size_t n = 0; n < blocks; n++) {
+		__cbuild_xxh3_accumulate(acc, p + n * block, secret, stripes);
+		__cbuild_xxh3_scramble(acc,
+			secret + __CBUILD_XXH_SECRET_SIZE - __CBUILD_XXH_STRIPE);
+	}
+	size_t last = ((len - 1) - blocks * block) / __CBUILD_XXH_STRIPE;
+	__cbuild_xxh3_accumulate(acc, p + blocks * block, secret, last);
+	__cbuild_xxh3_accumulate(acc, p + len - __CBUILD_XXH_STRIPE,
+		secret + __CBUILD_XXH_SECRET_SIZE - __CBUILD_XXH_STRIPE - 7, 1);
+	uint64_t result = len * __CBUILD_XXH_PRIME64_1;
+	for(size_t i = 0; i < 4; i++) {
+		result += __cbuild_xxh3_mul_fold(acc[i * 2] ^ __cbuild_wyr8(secret + 11 + i * 16),
+			acc[i * 2 + 1] ^ __cbuild_wyr8(secret + 11 + i * 16 + 8));
+	}
+	return __cbuild_xxh3_avalanche(result);
+}
+CBUILDDEF uint64_t cbuild_map_hash_xxh3_seed(const void* data, size_t len,
+	uint64_t seed) {
+	const uint8_t* p = data;
+	const uint8_t* secret = __cbuild_xxh3_secret;
+	if(len == 0) {
+		return __cbuild_xxh64_avalanche(seed ^ __cbuild_wyr8(secret + 56) ^
+			__cbuild_wyr8(secret + 64));
+	} else if(len <= 3) {
+		uint32_t combined = ((uint32_t)p[0] << 16) | ((uint32_t)p[len >> 1] << 24) |
+			(uint32_t)p[len - 1] | ((uint32_t)len << 8);
+		uint64_t bitflip = (__cbuild_wyr4(secret) ^ __cbuild_wyr4(secret + 4)) + seed;
+		return __cbuild_xxh64_avalanche(combined ^ bitflip);
+	} else if(len <= 8) {
+		seed ^= (uint64_t)__builtin_bswap32((uint32_t)seed) << 32;
+		uint64_t bitflip = (__cbuild_wyr8(secret + 8) ^ __cbuild_wyr8(secret + 16)) - seed;
+		uint64_t input = __cbuild_wyr4(p + len - 4) + (__cbuild_wyr4(p) << 32);
+		return __cbuild_xxh3_rrmxmx(input ^ bitflip, len);
+	} else if(len <= 16) {
+		uint64_t lo = __cbuild_wyr8(p) ^
+			((__cbuild_wyr8(secret + 24) ^ __cbuild_wyr8(secret + 32)) + seed);
+		uint64_t hi = __cbuild_wyr8(p + len - 8) ^
+			((__cbuild_wyr8(secret + 40) ^ __cbuild_wyr8(secret + 48)) - seed);
+		return __cbuild_xxh3_avalanche(len + __builtin_bswap64(lo) + hi +
+			__cbuild_xxh3_mul_fold(lo, hi));
+	} else if(len <= 128) {
+		uint64_t acc = len * __CBUILD_XXH_PRIME64_1;
+		if(len > 32) {
+			if(len > 64) {
+				if(len > 96) {
+					acc += __cbuild_xxh3_mix16(p + 48, secret + 96, seed);
+					acc += __cbuild_xxh3_mix16(p + len - 64, secret + 112, seed);
+				}
+				acc += __cbuild_xxh3_mix16(p + 32, secret + 64, seed);
+				acc += __cbuild_xxh3_mix16(p + len - 48, secret + 80, seed);
+			}
+			acc += __cbuild_xxh3_mix16(p + 16, secret + 32, seed);
+			acc += __cbuild_xxh3_mix16(p + len - 32, secret + 48, seed);
+		}
+		acc += __cbuild_xxh3_mix16(p, secret, seed);
+		acc += __cbuild_xxh3_mix16(p + len - 16, secret + 16, seed);
+		return __cbuild_xxh3_avalanche(acc);
+	} else if(len <= 240) {
+		uint64_t acc = len * __CBUILD_XXH_PRIME64_1;
+		for(size_t i = 0; i < 8; i++) {
+			acc += __cbuild_xxh3_mix16(p + i * 16, secret + i * 16, seed);
+		}
+		acc = __cbuild_xxh3_avalanche(acc);
+		for(size_t i = 8; i < len / 16; i++) {
+			acc += __cbuild_xxh3_mix16(p + i * 16, secret + (i - 8) * 16 + 3, seed);
+		}
+		acc += __cbuild_xxh3_mix16(p + len - 16, secret + 136 - 17, seed);
+		return __cbuild_xxh3_avalanche(acc);
+	}
+	if(seed == 0) return __cbuild_xxh3_long(p, len, secret);
+	// Seed is mixed into secret
+	uint8_t custom[__CBUILD_XXH_SECRET_SIZE];
+	for(size_t i = 0; i < __CBUILD_XXH_SECRET_SIZE; i += 16) {
+		uint64_t lo = __cbuild_wyr8(secret + i) + seed;
+		uint64_t hi = __cbuild_wyr8(secret + i + 8) - seed;
+		memcpy(custom + i, &lo, 8);
+		memcpy(custom + i + 8, &hi, 8);
+	}
+	return __cbuild_xxh3_long(p, len, custom);
+}
+CBUILDDEF size_t cbuild_map_hash_xxh3(const void* data, size_t len) {
+	return cbuild_map_hash_xxh3_seed(data, len, 0);
+}
+// Swiss map. Control bytes are followed by a copy of first group, so group
+// load starting at any slot never wraps around
+#if CBUILD_MAP_SIMD && defined(__SSE2__)
+	typedef __m128i __cbuild_smap_group_t;
+	#define __CBUILD_SMAP_MASK_SHIFT 0
+	CBUILDDEF __cbuild_smap_group_t __cbuild_smap_group_load(const uint8_t* ctrl) {
+		return _mm_loadu_si128((const __m128i*)(const void*)ctrl);
+	}
+	CBUILDDEF uint64_t __cbuild_smap_group_match(__cbuild_smap_group_t group,
+		uint8_t value) {
+		return (uint64_t)(uint32_t)_mm_movemask_epi8(
+			_mm_cmpeq_epi8(group, _mm_set1_epi8((char)value)));
+	}
+	// Empty and deleted slots have high bit set
+	CBUILDDEF uint64_t __cbuild_smap_group_free(__cbuild_smap_group_t group) {
+		return (uint64_t)(uint32_t)_mm_movemask_epi8(group);
+	}
+#elif CBUILD_MAP_SIMD && defined(__ARM_NEON)
+	typedef uint8x16_t __cbuild_smap_group_t;
+	// NEON has no movemask, so each slot gets 4 bits of a mask
+	#define __CBUILD_SMAP_MASK_SHIFT 2
+	CBUILDDEF __cbuild_smap_group_t __cbuild_smap_group_load(const uint8_t* ctrl) {
+		return vld1q_u8(ctrl);
+	}
+	CBUILDDEF uint64_t __cbuild_smap_group_mask(uint8x16_t eq) {
+		uint8x8_t narrow = vshrn_n_u16(vreinterpretq_u16_u8(eq), 4);
+		return vget_lane_u64(vreinterpret_u64_u8(narrow), 0) & 0x8888888888888888ull;
+	}
+	CBUILDDEF uint64_t __cbuild_smap_group_match(__cbuild_smap_group_t group,
+		uint8_t value) {
+		return __cbuild_smap_group_mask(vceqq_u8(group, vdupq_n_u8(value)));
+	}
+	CBUILDDEF uint64_t __cbuild_smap_group_free(__cbuild_smap_group_t group) {
+		return __cbuild_smap_group_mask(vcltq_s8(vreinterpretq_s8_u8(group), vdupq_n_s8(0)));
+	}
+#else
+	typedef const uint8_t* __cbuild_smap_group_t;
+	#define __CBUILD_SMAP_MASK_SHIFT 0
+	CBUILDDEF __cbuild_smap_group_t __cbuild_smap_group_load(const uint8_t* ctrl) {
+		return ctrl;
+	}
+	CBUILDDEF uint64_t __cbuild_smap_group_match(__cbuild_smap_group_t group,
+		uint8_t value) {
+		uint64_t mask = 0;
+		for(size_t i = 0; i < __CBUILD_SMAP_GROUP; i++) {
+			if(group[i] == value) mask |= (uint64_t)1 << i;
+		}
+		return mask;
+	}
+	CBUILDDEF uint64_t __cbuild_smap_group_free(__cbuild_smap_group_t group) {
+		uint64_t mask = 0;
+		for(size_t i = 0; i < __CBUILD_SMAP_GROUP; i++) {
+			if(group[i] & 0x80) mask |= (uint64_t)1 << i;
+		}
+		return mask;
+	}
+#endif // SIMD
+// Index of lowest slot in a mask
+#define __cbuild_smap_mask_first(mask)                                          \
+((size_t)__builtin_ctzll(mask) >> __CBUILD_SMAP_MASK_SHIFT)
+// Hash from user is mixed, 7 high bits go to control byte and low bits
+// select starting group
+CBUILDDEF uint64_t __cbuild_smap_hash(const void* map, cbuild_map_hash_t hash,
+	const void* key, size_t klen) {
+	uint64_t h = (uint64_t)hash(map, key, klen);
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdull;
+	h ^= h >> 33;
+	return h;
+}
+#define __cbuild_smap_h2(h) ((uint8_t)((h) >> 57))
+CBUILDDEF size_t __cbuild_smap_find(const void* map, cbuild_map_hash_t hash,
+	cbuild_map_keycmp_t keycmp, const void* data, const uint8_t* ctrl,
+	size_t capacity, size_t elem_size, const void* key, size_t klen) {
+	if(capacity == 0) return (size_t)-1;
+	uint64_t h = __cbuild_smap_hash(map, hash, key, klen);
+	uint8_t tag = __cbuild_smap_h2(h);
+	size_t mask = capacity - 1;
+	size_t pos = (size_t)h & mask;
+	// Most likely slot is loaded while control bytes are checked
+	__builtin_prefetch((const char*)data + pos * elem_size);
+	// Triangular probing over groups visits every group once
+	for(size_t step = __CBUILD_SMAP_GROUP; ; step += __CBUILD_SMAP_GROUP) {
+		__cbuild_smap_group_t group = __cbuild_smap_group_load(ctrl + pos);
+		uint64_t match = __cbuild_smap_group_match(group, tag);
+		while(match != 0) {
+			size_t idx = (pos + __cbuild_smap_mask_first(match)) & mask;
+			if(keycmp(map, (const char*)data + idx * elem_size, key, klen)) return idx;
+			match &= match - 1;
+		}
+		if(__cbuild_smap_group_match(group, __CBUILD_SMAP_EMPTY) != 0) return (size_t)-1;
+		if(step > capacity) return (size_t)-1;
+		pos = (pos + step) & mask;
+	}
+}
+CBUILDDEF size_t __cbuild_smap_insert(const void* map, cbuild_map_hash_t hash,
+	cbuild_map_keycmp_t keycmp, const void* data, uint8_t* ctrl, size_t capacity,
+	size_t elem_size, const void* key, size_t klen, size_t* deleted, bool* found) {
+	uint64_t h = __cbuild_smap_hash(map, hash, key, klen);
+	uint8_t tag = __cbuild_smap_h2(h);
+	size_t mask = capacity - 1;
+	size_t pos = (size_t)h & mask;
+	__builtin_prefetch((const char*)data + pos * elem_size);
+	size_t free_idx = (size_t)-1;
+	for(size_t step = __CBUILD_SMAP_GROUP; ; step += __CBUILD_SMAP_GROUP) {
+		__cbuild_smap_group_t group = __cbuild_smap_group_load(ctrl + pos);
+		uint64_t match = __cbuild_smap_group_match(group, tag);
+		while(match != 0) {
+			size_t idx = (pos + __cbuild_smap_mask_first(match)) & mask;
+			if(keycmp(map, (const char*)data + idx * elem_size, key, klen)) {
+				*found = true;
+				return idx;
+			}
+			match &= match - 1;
+		}
+		if(free_idx == (size_t)-1) {
+			uint64_t free_mask = __cbuild_smap_group_free(group);
+			if(free_mask != 0) free_idx = (pos + __cbuild_smap_mask_first(free_mask)) & mask;
+		}
+		if(__cbuild_smap_group_match(group, __CBUILD_SMAP_EMPTY) != 0) break;
+		if(step > capacity) break;
+		pos = (pos + step) & mask;
+	}
+	cbuild_assert(free_idx != (size_t)-1, "Swiss map has no free slots.\n");
+	if(ctrl[free_idx] == __CBUILD_SMAP_DELETED) (*deleted)--;
+	__cbuild_smap_set_ctrl(ctrl, capacity, free_idx, tag);
+	*found = false;
+	return free_idx;
+}
+CBUILDDEF void __cbuild_smap_rehash(const void* map, cbuild_map_hash_t hash,
+	const void* data, const uint8_t* ctrl, size_t capacity, void* new_data,
+	uint8_t* new_ctrl, size_t new_capacity, size_t elem_size, size_t klen) {
+	size_t mask = new_capacity - 1;
+	for(size_t i = 0; i < capacity; i++) {
+		if(ctrl[i] & 0x80) continue;
+		const char* elem = (const char*)data + i * elem_size;
+		uint64_t h = __cbuild_smap_hash(map, hash, elem, klen);
+		// Keys are unique, so only free slot is needed
+		size_t pos = (size_t)h & mask;
+		uint64_t free_mask;
+		for(size_t step = __CBUILD_SMAP_GROUP; ; step += __CBUILD_SMAP_GROUP) {
+			free_mask = __cbuild_smap_group_free(__cbuild_smap_group_load(new_ctrl + pos));
+			if(free_mask != 0) break;
+			pos = (pos + step) & mask;
+		}
+		size_t idx = (pos + __cbuild_smap_mask_first(free_mask)) & mask;
+		__cbuild_smap_set_ctrl(new_ctrl, new_capacity, idx, __cbuild_smap_h2(h));
+		memcpy((char*)new_data + idx * elem_size, elem, elem_size);
+	}
+}
+CBUILDDEF void __cbuild_smap_set_ctrl(uint8_t* ctrl, size_t capacity,
+	size_t idx, uint8_t value) {
+	ctrl[idx] = value;
+	if(idx < __CBUILD_SMAP_GROUP) ctrl[capacity + idx] = value;
+}
+CBUILDDEF uint8_t* __cbuild_smap_ctrl_alloc(size_t capacity) {
+	uint8_t* ctrl = __CBUILD_MALLOC(capacity + __CBUILD_SMAP_GROUP);
+	cbuild_assert(ctrl != NULL, "Allocation failed.\n");
+	memset(ctrl, __CBUILD_SMAP_EMPTY, capacity + __CBUILD_SMAP_GROUP);
+	return ctrl;
+}
+CBUILDDEF size_t __cbuild_smap_capacity(size_t elems) {
+	size_t capacity = __CBUILD_SMAP_GROUP;
+	while(capacity / 8 * 7 < elems) capacity *= 2;
+	return capacity;
+}
+CBUILDDEF size_t __cbuild_smap_grow(size_t size, size_t deleted, size_t capacity) {
+	if(capacity == 0) return __CBUILD_SMAP_GROUP;
+	if(size + deleted + 1 <= capacity / 8 * 7) return 0;
+	// Deleted slots pushed occupancy over the limit, but live elements with a
+	// new one still fit, so purge them by a rehash into same capacity
+	if((size + 1) * 32 <= capacity * 25) return capacity;
+	return capacity * 2;
+}
+CBUILDDEF void* __cbuild_smap_next(void* data, const uint8_t* ctrl,
+	size_t capacity, size_t elem_size, size_t idx) {
+	for(; idx < capacity; idx++) {
+		if(!(ctrl[idx] & 0x80)) return (char*)data + idx * elem_size;
+	}
+	return NULL;
+}
+#if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
+	CBUILDDEF void __cbuild_cmap_init(cbuild_cmap_t* map, size_t elem_size,
+		size_t key_size) {
+		cbuild_assert(key_size <= __CBUILD_CMAP_MAX_KEY,
+			"Key of concurrent map is longer than %d bytes.\n", __CBUILD_CMAP_MAX_KEY);
+		cbuild_assert(elem_size <= __CBUILD_CMAP_MAX_ELEM,
+			"Pair of concurrent map is longer than %d bytes.\n", __CBUILD_CMAP_MAX_ELEM);
+		map->elem_size = elem_size;
+		map->key_size = key_size;
+		map->shard_bits = 0;
+		while(((size_t)1 << map->shard_bits) < CBUILD_CMAP_SHARDS) map->shard_bits++;
+		size_t count = (size_t)1 << map->shard_bits;
+		map->shards = __CBUILD_MALLOC(count * sizeof(__cbuild_cmap_shard_t));
+		cbuild_assert(map->shards != NULL, "Allocation failed.\n");
+		for(size_t i = 0; i < count; i++) {
+			map->shards[i] = (__cbuild_cmap_shard_t){0};
+			pthread_mutex_init(&map->shards[i].lock, NULL);
+		}
+	}
+	// Position in a shard uses low bits of mixed hash and control byte uses
+	// high ones, so shard is selected by middle bits
+	CBUILDDEF __cbuild_cmap_shard_t* __cbuild_cmap_shard(cbuild_cmap_t* map,
+		uint64_t h) {
+		return &map->shards[(h >> 32) & (((size_t)1 << map->shard_bits) - 1)];
+	}
+	CBUILDDEF __cbuild_cmap_table_t* __cbuild_cmap_table_alloc(size_t elem_size,
+		size_t capacity) {
+		__cbuild_cmap_table_t* table = __CBUILD_MALLOC(sizeof(__cbuild_cmap_table_t));
+		cbuild_assert(table != NULL, "Allocation failed.\n");
+		table->retired = NULL;
+		table->capacity = capacity;
+		table->ctrl = __cbuild_smap_ctrl_alloc(capacity);
+		table->data = __CBUILD_MALLOC(capacity * elem_size);
+		cbuild_assert(table->data != NULL, "Allocation failed.\n");
+		return table;
+	}
+	// Readers race with writers by design. Anything read from a table is used
+	// only after sequence number confirms that shard was not modified meanwhile.
+	CBUILDDEF bool __cbuild_cmap_valid(__cbuild_cmap_shard_t* shard, size_t seq) {
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		return __atomic_load_n(&shard->seq, __ATOMIC_RELAXED) == seq;
+	}
+	CBUILDDEF void __cbuild_cmap_write_begin(__cbuild_cmap_shard_t* shard) {
+		__atomic_store_n(&shard->seq, shard->seq + 1, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+	}
+	CBUILDDEF void __cbuild_cmap_write_end(__cbuild_cmap_shard_t* shard) {
+		__atomic_store_n(&shard->seq, shard->seq + 1, __ATOMIC_RELEASE);
+	}
+	// 1 if key is found, 0 if not, -1 if shard was modified during lookup
+	CBUILDDEF int __cbuild_cmap_probe(cbuild_cmap_t* map,
+		__cbuild_cmap_shard_t* shard, size_t seq, uint64_t h, void* pair,
+		const void* query) {
+		__cbuild_cmap_table_t* table = __atomic_load_n(&shard->table, __ATOMIC_ACQUIRE);
+		if(table == NULL) return __cbuild_cmap_valid(shard, seq) ? 0 : -1;
+		uint64_t key[__CBUILD_CMAP_MAX_KEY / sizeof(uint64_t)];
+		uint8_t tag = __cbuild_smap_h2(h);
+		size_t mask = table->capacity - 1;
+		size_t pos = (size_t)h & mask;
+		for(size_t step = __CBUILD_SMAP_GROUP; ; step += __CBUILD_SMAP_GROUP) {
+			__cbuild_smap_group_t group = __cbuild_smap_group_load(table->ctrl + pos);
+			uint64_t match = __cbuild_smap_group_match(group, tag);
+			while(match != 0) {
+				size_t idx = (pos + __cbuild_smap_mask_first(match)) & mask;
+				const char* elem = (const char*)table->data + idx * map->elem_size;
+				// Key may be torn, it is compared only after a check
+				memcpy(key, elem, map->key_size);
+				if(!__cbuild_cmap_valid(shard, seq)) return -1;
+				if(map->keycmp(map, key, query, map->key_size)) {
+					// Pair may be torn too, caller sees it only after a check
+					uint64_t buff[__CBUILD_CMAP_MAX_ELEM / sizeof(uint64_t)];
+					memcpy(buff, elem, map->elem_size);
+					if(!__cbuild_cmap_valid(shard, seq)) return -1;
+					memcpy(pair, buff, map->elem_size);
+					return 1;
+				}
+				match &= match - 1;
+			}
+			if(__cbuild_smap_group_match(group, __CBUILD_SMAP_EMPTY) != 0) break;
+			if(step > table->capacity) break;
+			pos = (pos + step) & mask;
+		}
+		return __cbuild_cmap_valid(shard, seq) ? 0 : -1;
+	}
+	CBUILDDEF bool cbuild_cmap_find(cbuild_cmap_t* map, void* pair) {
+		uint64_t query[__CBUILD_CMAP_MAX_KEY / sizeof(uint64_t)];
+		memcpy(query, pair, map->key_size);
+		uint64_t h = __cbuild_smap_hash(map, map->hash, query, map->key_size);
+		__cbuild_cmap_shard_t* shard = __cbuild_cmap_shard(map, h);
+		for(;;) {
+			size_t seq = __atomic_load_n(&shard->seq, __ATOMIC_ACQUIRE);
+			if(seq & 1) {
+				// Writer is active, wait for it instead of spinning
+				pthread_mutex_lock(&shard->lock);
+				pthread_mutex_unlock(&shard->lock);
+				continue;
+			}
+			int res = __cbuild_cmap_probe(map, shard, seq, h, pair, query);
+			if(res >= 0) return res == 1;
+		}
+	}
+	// Make room for one more element. Growth replaces a table, purge of deleted
+	// slots rewrites it in place.
+	CBUILDDEF void __cbuild_cmap_reserve(cbuild_cmap_t* map,
+		__cbuild_cmap_shard_t* shard) {
+		__cbuild_cmap_table_t* table = shard->table;
+		size_t capacity = table == NULL ? 0 : table->capacity;
+		size_t new_capacity = __cbuild_smap_grow(shard->size, shard->deleted, capacity);
+		if(new_capacity == 0) return;
+		__cbuild_cmap_table_t* new_table = __cbuild_cmap_table_alloc(map->elem_size,
+			new_capacity);
+		if(table != NULL) {
+			__cbuild_smap_rehash(map, map->hash, table->data, table->ctrl, capacity,
+				new_table->data, new_table->ctrl, new_capacity, map->elem_size,
+				map->key_size);
+		}
+		shard->deleted = 0;
+		if(new_capacity == capacity) {
+			memcpy(table->ctrl, new_table->ctrl, capacity + __CBUILD_SMAP_GROUP);
+			memcpy(table->data, new_table->data, capacity * map->elem_size);
+			__CBUILD_FREE(new_table->ctrl);
+			__CBUILD_FREE(new_table->data);
+			__CBUILD_FREE(new_table);
+			return;
+		}
+		new_table->retired = table;
+		__atomic_store_n(&shard->table, new_table, __ATOMIC_RELEASE);
+	}
+	CBUILDDEF bool cbuild_cmap_get(cbuild_cmap_t* map, void* pair) {
+		uint64_t h = __cbuild_smap_hash(map, map->hash, pair, map->key_size);
+		__cbuild_cmap_shard_t* shard = __cbuild_cmap_shard(map, h);
+		pthread_mutex_lock(&shard->lock);
+		__cbuild_cmap_table_t* table = shard->table;
+		if(table != NULL) {
+			size_t idx = __cbuild_smap_find(map, map->hash, map->keycmp, table->data,
+				table->ctrl, table->capacity, map->elem_size, pair, map->key_size);
+			if(idx != (size_t)-1) {
+				memcpy(pair, (char*)table->data + idx * map->elem_size, map->elem_size);
+				pthread_mutex_unlock(&shard->lock);
+				return true;
+			}
+		}
+		__cbuild_cmap_write_begin(shard);
+		__cbuild_cmap_reserve(map, shard);
+		table = shard->table;
+		bool found = false;
+		size_t idx = __cbuild_smap_insert(map, map->hash, map->keycmp, table->data,
+			table->ctrl, table->capacity, map->elem_size, pair, map->key_size,
+			&shard->deleted, &found);
+		memcpy((char*)table->data + idx * map->elem_size, pair, map->elem_size);
+		__atomic_store_n(&shard->size, shard->size + 1, __ATOMIC_RELAXED);
+		__cbuild_cmap_write_end(shard);
+		pthread_mutex_unlock(&shard->lock);
+		return false;
+	}
+	CBUILDDEF bool cbuild_cmap_remove(cbuild_cmap_t* map, void* pair) {
+		uint64_t h = __cbuild_smap_hash(map, map->hash, pair, map->key_size);
+		__cbuild_cmap_shard_t* shard = __cbuild_cmap_shard(map, h);
+		pthread_mutex_lock(&shard->lock);
+		__cbuild_cmap_table_t* table = shard->table;
+		size_t idx = (size_t)-1;
+		if(table != NULL) {
+			idx = __cbuild_smap_find(map, map->hash, map->keycmp, table->data,
+				table->ctrl, table->capacity, map->elem_size, pair, map->key_size);
+		}
+		if(idx == (size_t)-1) {
+			pthread_mutex_unlock(&shard->lock);
+			return false;
+		}
+		memcpy(pair, (char*)table->data + idx * map->elem_size, map->elem_size);
+		__cbuild_cmap_write_begin(shard);
+		__cbuild_smap_set_ctrl(table->ctrl, table->capacity, idx, __CBUILD_SMAP_DELETED);
+		__atomic_store_n(&shard->size, shard->size - 1, __ATOMIC_RELAXED);
+		shard->deleted++;
+		__cbuild_cmap_write_end(shard);
+		pthread_mutex_unlock(&shard->lock);
+		return true;
+	}
+	CBUILDDEF size_t cbuild_cmap_size(cbuild_cmap_t* map) {
+		size_t size = 0;
+		for(size_t i = 0; i < ((size_t)1 << map->shard_bits); i++) {
+			size += __atomic_load_n(&map->shards[i].size, __ATOMIC_RELAXED);
+		}
+		return size;
+	}
+	CBUILDDEF void cbuild_cmap_free(cbuild_cmap_t* map) {
+		for(size_t i = 0; map->shards != NULL && i < ((size_t)1 << map->shard_bits); i++) {
+			__cbuild_cmap_table_t* table = map->shards[i].table;
+			while(table != NULL) {
+				__cbuild_cmap_table_t* retired = table->retired;
+				__CBUILD_FREE(table->ctrl);
+				__CBUILD_FREE(table->data);
+				__CBUILD_FREE(table);
+				table = retired;
+			}
+			pthread_mutex_destroy(&map->shards[i].lock);
+		}
+		if(map->shards != NULL) __CBUILD_FREE(map->shards);
+		map->shards = NULL;
+		map->shard_bits = 0;
+		map->elem_size = 0;
+		map->key_size = 0;
+	}
+#endif // CBUILD_API_*
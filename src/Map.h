@@ -7,12 +7,22 @@
 //! hashmap built on top of dynamic array. Below there is a few details about
 //! implementation.
 //!
-//! # No resize
+//! # Resize
 //!
-//! Resize is complex and slow. User need to perform it manually, as map can
-//! overflow. Each append operation may report failure. Also, you may manually
-//! calculate map utilization (both high number of *used* elements and a lot
-//! of *deleted* elements are bad signals).
+//! Basic operations (`cbuild_map_get`, `cbuild_map_append`) never resize map.
+//! User need to perform it manually, as map can overflow. Each append
+//! operation may report failure.
+//!
+//! If map structure also has counters of *used* and *deleted* slots, map can
+//! manage this by itself. `cbuild_map_put` and `cbuild_map_put_new` keep
+//! counters up to date and before insertion check load factor (both used and
+//! deleted slots count, as both make probe sequences longer). When it exceeds
+//! [`CBUILD_MAP_MAX_LOAD`](DOC:CBUILD_MAP_MAX_LOAD), map is either rehashed in
+//! place to purge deleted slots (if it is mostly deleted slots) or doubled.
+//! Elements then should be removed with `cbuild_map_remove`.
+//!
+//! Hash and comparison functions should be set before first insertion, as
+//! empty map has no storage yet.
 //!
 //! # Creating your map
 //!
@@ -25,11 +35,13 @@
 //!     size_t capacity;
 //!     cbuild_map_hash_t hash;
 //!     cbuild_map_keycmp_t keycmp;
-//!     cbuild_map_clear_t clear;
+//!     size_t used;    // Number of elements
+//!     size_t deleted; // Number of deleted slots
 //! } cbuild_map_t;
 //! ```
 //!
-//! You can init all function pointers to default values using one of
+//! Counters are optional, without them map should be resized manually (see
+//! above). You can init all function pointers to default values using one of
 //! `cbuild_map_init_*` functions.
 //!
 //! Pair structure also need to have some fields:
@@ -44,12 +56,27 @@
 //! Key can be any value, but you need to use `init` function that support
 //! specific type of keys.
 //!
+//! # String keys with cached hash
+//!
+//! With `cbuild_map_init_cstr` each probe calls `strlen` and `strcmp` on a
+//! stored key and each rehash hashes all keys again. For large string-keyed
+//! maps key type can be [`cbuild_map_strkey_t`](DOC:cbuild_map_strkey_t)
+//! instead. It stores full hash and length of a string inline, so they are
+//! computed once when key is created, probe rejects most mismatches without
+//! touching string memory and `cbuild_map_rehash` reuses stored hashes. Map
+//! should be initialized with `cbuild_map_init_strkey`. Works for swiss map
+//! too.
+//!
+//! ```cpp
+//! pair_t* pair = cbuild_map_find(&map, cbuild_map_strkey("src/Map.c"));
+//! ```
+//!
 //! # Removing memory
 //!
 //! To emove memory you first need to get pair, and then set tombstone to
-//! `CBUILD_MAP_DELETED`. You can also run `map->clear(map, pair)` if you
-//! actually used clear function for this map instance. Or you can manually
-//! clear what is needed for this specific pair.
+//! `CBUILD_MAP_DELETED` (or call `cbuild_map_remove` for map with counters).
+//! Before that you should manually clear what is needed for this specific
+//! pair.
 //!
 //! # Backing memory
 //!
@@ -60,6 +87,7 @@
 
 #include "Common.h"
 #include "DynArray.h"
+#include "StringView.h"
 
 /// Hash function for a key.
 ///
@@ -91,6 +119,20 @@ typedef enum cbuild_map_tombstone_t {
 	CBUILD_MAP_FULL,
 	CBUILD_MAP_DELETED,
 } cbuild_map_tombstone_t;
+/// String key with cached hash and length. String is not copied.
+///
+/// * [fl:hash] Hash of a string, computed with [`CBUILD_MAP_DEFAULT_HASH`](DOC:CBUILD_MAP_DEFAULT_HASH).
+/// * [fl:size] Length of a string.
+/// * [fl:data] String, not necessarily NULL-terminated.
+typedef struct cbuild_map_strkey_t {
+	size_t hash;
+	size_t size;
+	const char* data;
+} cbuild_map_strkey_t;
+/// Create string key from a c-string.
+CBUILDDEF cbuild_map_strkey_t cbuild_map_strkey(const char* cstr);
+/// Create string key from a string view. Data is not copied.
+CBUILDDEF cbuild_map_strkey_t cbuild_map_strkey_sv(cbuild_sv_t sv);
 /// Initialize map which uses numbers as keys (number can be arbitrary in size
 /// and is more like "a random binary blob").
 ///
@@ -116,6 +158,13 @@ typedef enum cbuild_map_tombstone_t {
 #define cbuild_map_init_sb(map)        \
 	(map)->hash = __cbuild_map_sb_hash;    \
 	(map)->keycmp = __cbuild_map_sb_keycmp;
+/// Initialize map which uses [`cbuild_map_strkey_t`](DOC:cbuild_map_strkey_t)
+/// as keys.
+///
+/// * [pl:map:cbuild_map_t*] Map object.
+#define cbuild_map_init_strkey(map)        \
+	(map)->hash = __cbuild_map_strkey_hash;    \
+	(map)->keycmp = __cbuild_map_strkey_keycmp;
 /// Find element in a map. This function is guaranteed to not modify map.
 ///
 /// This function may return NULL if element is not in a map.
@@ -285,9 +334,406 @@ typedef enum cbuild_map_tombstone_t {
 		(map)->size = (map)->capacity;                                      \
 		memset((map)->data, 0, (map)->size * sizeof(*(map)->data));         \
 	} while(0)
+/// Make sure that one more element can be inserted into a map with counters
+/// without exceeding [`CBUILD_MAP_MAX_LOAD`](DOC:CBUILD_MAP_MAX_LOAD). Empty
+/// map gets `CBUILD_INIT_CAPACITY` slots. Pointers to pairs are invalidated if
+/// map is rehashed.
+///
+/// If at most half of allowed load is taken by elements, map is compacted in
+/// place, otherwise its capacity is doubled.
+///
+/// * [pl:map:cbuild_map_t*] Map object.
+#define cbuild_map_grow(map)                                                     \
+	do {                                                                           \
+		if ((map)->capacity == 0) {                                                  \
+			cbuild_map_resize((map), CBUILD_INIT_CAPACITY);                            \
+			(map)->used = 0;                                                           \
+			(map)->deleted = 0;                                                        \
+		} else if (((map)->used + (map)->deleted + 1) * 100 >                        \
+			(map)->capacity * (size_t)CBUILD_MAP_MAX_LOAD) {                           \
+			if (((map)->used + 1) * 200 <=                                             \
+				(map)->capacity * (size_t)CBUILD_MAP_MAX_LOAD) {                         \
+				cbuild_map_compact(map);                                                 \
+			} else {                                                                   \
+				typeof(*(map)) __map_new = *(map);                                       \
+				__map_new.data = NULL;                                                   \
+				__map_new.size = 0;                                                      \
+				__map_new.capacity = 0;                                                  \
+				cbuild_map_resize(&__map_new, (map)->capacity * 2);                      \
+				cbuild_map_rehash((map), &__map_new);                                    \
+				__map_new.deleted = 0;                                                   \
+				*(map) = __map_new;                                                      \
+			}                                                                          \
+		}                                                                            \
+	} while(0)
+/// Rehash map with counters in place, turning all deleted slots into empty
+/// ones. Pointers to pairs are invalidated.
+///
+/// * [pl:map:cbuild_map_t*] Map object.
+#define cbuild_map_compact(map)                                             \
+	do {                                                                      \
+		if ((map)->capacity > 0) {                                              \
+			__cbuild_map_compact((map), (map)->hash, (map)->data, (map)->capacity,\
+				sizeof(*(map)->data), sizeof((map)->data[0].key),                   \
+				offsetof(typeof(*(map)->data), key),                                \
+				offsetof(typeof(*(map)->data), tombstone));                         \
+		}                                                                       \
+		(map)->deleted = 0;                                                     \
+	} while(0)
+/// Same as `cbuild_map_get`, but for map with counters. Map grows when needed,
+/// so this never returns NULL. Pointers to other pairs may be invalidated.
+///
+/// * [pl:map:cbuild_map_t*] Map object.
+/// * [pl:key_:typeof(map->data[0].key)] Key.
+///
+/// [r:typeof(map->data)] Pointer to a pair.
+#define cbuild_map_put(map, key_)                                          \
+	({                                                                       \
+		typeof((map)->data[0].key) __map_pk = key_;                            \
+		cbuild_map_grow(map);                                                  \
+		typeof((map)->data) __map_result = NULL;                               \
+		typeof((map)->data) __first_empty = NULL;                              \
+		size_t __map_ksize = sizeof((map)->data[0].key);                       \
+		size_t __map_hash = (map)->hash((map), &__map_pk, __map_ksize);        \
+		size_t __map_step = __cbuild_map_step(__map_hash);                     \
+		for (size_t __map_i = 0; __map_i < (map)->capacity;                    \
+			__map_i++, __map_hash += __map_step) {                               \
+			size_t __map_idx = __map_hash & ((map)->capacity - 1);               \
+			if ((map)->data[__map_idx].tombstone == CBUILD_MAP_EMPTY) {          \
+				if (!__first_empty) __first_empty = &(map)->data[__map_idx];       \
+				break;                                                             \
+			} else if ((map)->data[__map_idx].tombstone == CBUILD_MAP_DELETED) { \
+				if (!__first_empty) __first_empty = &(map)->data[__map_idx];       \
+			} else if ((map)->keycmp((map), &(map)->data[__map_idx].key,         \
+				&__map_pk, __map_ksize)) {                                         \
+				__map_result = &(map)->data[__map_idx];                            \
+				break;                                                             \
+			}                                                                    \
+		}                                                                      \
+		if (!__map_result) {                                                   \
+			__map_result = __first_empty;                                        \
+			if (__map_result->tombstone == CBUILD_MAP_DELETED) (map)->deleted--; \
+			(map)->used++;                                                       \
+			memcpy(&__map_result->key, &__map_pk, __map_ksize);                  \
+			__map_result->tombstone = CBUILD_MAP_FULL;                           \
+		}                                                                      \
+		__map_result;                                                          \
+	})
+/// Same as `cbuild_map_append`, but for map with counters. Map grows when
+/// needed, so this never returns NULL. Pointers to other pairs may be
+/// invalidated.
+///
+/// * [pl:map:cbuild_map_t*] Map object.
+/// * [pl:key_:typeof(map->data[0].key)] Key.
+///
+/// [r:typeof(map->data)] Pointer to a pair.
+#define cbuild_map_put_new(map, key_)                                       \
+	({                                                                        \
+		typeof((map)->data[0].key) __map_pk = key_;                             \
+		cbuild_map_grow(map);                                                   \
+		typeof((map)->data) __map_result = NULL;                                \
+		size_t __map_ksize = sizeof((map)->data[0].key);                        \
+		size_t __map_hash = (map)->hash((map), &__map_pk, __map_ksize);         \
+		size_t __map_step = __cbuild_map_step(__map_hash);                      \
+		for (size_t __map_i = 0; __map_i < (map)->capacity;                     \
+			__map_i++, __map_hash += __map_step) {                                \
+			size_t __map_idx = __map_hash & ((map)->capacity - 1);                \
+			if ((map)->data[__map_idx].tombstone != CBUILD_MAP_FULL) {            \
+				__map_result = &(map)->data[__map_idx];                             \
+				break;                                                              \
+			}                                                                     \
+		}                                                                       \
+		if (__map_result->tombstone == CBUILD_MAP_DELETED) (map)->deleted--;    \
+		(map)->used++;                                                          \
+		memcpy(&__map_result->key, &__map_pk, __map_ksize);                     \
+		__map_result->tombstone = CBUILD_MAP_FULL;                              \
+		__map_result;                                                           \
+	})
+/// Remove pair from a map with counters. Pair should be cleared by user
+/// beforehand, if needed.
+///
+/// * [pl:map:cbuild_map_t*] Map object.
+/// * [pl:pair:typeof(map->data)] Pair returned by a lookup.
+#define cbuild_map_remove(map, pair)           \
+	do {                                         \
+		(pair)->tombstone = CBUILD_MAP_DELETED;    \
+		(map)->used--;                             \
+		(map)->deleted++;                          \
+	} while(0)
+
+//! # Swiss map
+//!
+//! Alternative layout of open-addressing map, modelled after
+//! [SwissTable](https://abseil.io/about/design/swisstables). State of each
+//! slot lives in a separate array of control bytes. Full slot stores 7 bits of
+//! a hash there, so probe checks 16 slots at once with SSE2 or NEON (or with
+//! scalar code, see [`CBUILD_MAP_SIMD`](DOC:CBUILD_MAP_SIMD)) and calls `keycmp`
+//! only when these 7 bits match. Pairs are touched only on such match.
+//!
+//! Unlike normal map, swiss map grows automatically, keeping load factor below
+//! 7/8, and purges deleted slots during growth. Map structure:
+//!
+//! ```cpp
+//! typedef struct cbuild_smap_t {
+//!     cbuild_smap_pair_t* data;
+//!     size_t size;     // Number of elements
+//!     size_t capacity; // Number of slots
+//!     cbuild_map_hash_t hash;
+//!     cbuild_map_keycmp_t keycmp;
+//!     uint8_t* ctrl;
+//!     size_t deleted;
+//! } cbuild_smap_t;
+//! ```
+//!
+//! It should be zero-initialized and then initialized with one of
+//! `cbuild_map_init_*` macros. Pair does not have tombstone, key should be
+//! its first field:
+//!
+//! ```cpp
+//! typedef struct cbuild_smap_pair_t {
+//!     T key;
+//!     ...
+//! } cbuild_smap_pair_t;
+//! ```
+//!
+//! Pointers to pairs are invalidated when element is inserted.
+
+/// Find element in a swiss map.
+///
+/// This function may return NULL if element is not in a map.
+///
+/// * [pl:map:cbuild_smap_t*] Map object.
+/// * [pl:key_:typeof(map->data[0].key)] Key.
+///
+/// [r:typeof(map->data)] Pointer to a pair.
+#define cbuild_smap_find(map, key_)                                            \
+	({                                                                           \
+		typeof((map)->data) __smap_result = NULL;                                  \
+		typeof((map)->data[0].key) __smap_k = key_;                                \
+		size_t __smap_idx = __cbuild_smap_find((map), (map)->hash, (map)->keycmp,  \
+			(map)->data, (map)->ctrl, (map)->capacity, sizeof(*(map)->data),         \
+			&__smap_k, sizeof(__smap_k));                                            \
+		if (__smap_idx != (size_t)-1) __smap_result = &(map)->data[__smap_idx];    \
+		__smap_result;                                                             \
+	})
+/// Get element from a swiss map, inserting it if key is not already in a
+/// map. Key of a new element is copied using `memcpy`, rest of a pair is
+/// uninitialized. Map grows automatically when key is inserted, so this never
+/// returns NULL.
+///
+/// * [pl:map:cbuild_smap_t*] Map object.
+/// * [pl:key_:typeof(map->data[0].key)] Key.
+/// * [pl:found_:bool*] Set to `true`{.c} if key was already in a map. Can be NULL.
+///
+/// [r:typeof(map->data)] Pointer to a pair.
+#define cbuild_smap_get_ex(map, key_, found_)                                  \
+	({                                                                           \
+		typeof((map)->data[0].key) __smap_k = key_;                                \
+		size_t __smap_idx = __cbuild_smap_find((map), (map)->hash, (map)->keycmp,  \
+			(map)->data, (map)->ctrl, (map)->capacity, sizeof(*(map)->data),         \
+			&__smap_k, sizeof(__smap_k));                                            \
+		bool __smap_found = __smap_idx != (size_t)-1;                              \
+		if (!__smap_found) {                                                       \
+			size_t __smap_cap = __cbuild_smap_grow((map)->size, (map)->deleted,      \
+				(map)->capacity);                                                      \
+			if (__smap_cap != 0) __cbuild_smap_resize((map), __smap_cap);            \
+			__smap_idx = __cbuild_smap_insert((map), (map)->hash, (map)->keycmp,     \
+				(map)->data, (map)->ctrl, (map)->capacity, sizeof(*(map)->data),       \
+				&__smap_k, sizeof(__smap_k), &(map)->deleted, &__smap_found);          \
+			memcpy(&(map)->data[__smap_idx].key, &__smap_k, sizeof(__smap_k));       \
+			(map)->size++;                                                           \
+		}                                                                          \
+		typeof((map)->data) __smap_result = &(map)->data[__smap_idx];              \
+		bool* __smap_found_ptr = (found_);                                         \
+		if (__smap_found_ptr != NULL) *__smap_found_ptr = __smap_found;            \
+		__smap_result;                                                             \
+	})
+/// Same as [`cbuild_smap_get_ex`](DOC:cbuild_smap_get_ex) without
+/// reporting if key was in a map.
+///
+/// * [pl:map:cbuild_smap_t*] Map object.
+/// * [pl:key_:typeof(map->data[0].key)] Key.
+///
+/// [r:typeof(map->data)] Pointer to a pair.
+#define cbuild_smap_get(map, key_) cbuild_smap_get_ex(map, key_, NULL)
+/// Remove element from a swiss map. Pair should be cleared by user first.
+///
+/// * [pl:map:cbuild_smap_t*] Map object.
+/// * [pl:pair:typeof(map->data)] Pair returned by [`cbuild_smap_find`](DOC:cbuild_smap_find) or [`cbuild_smap_get`](DOC:cbuild_smap_get).
+#define cbuild_smap_remove(map, pair)                                          \
+	do {                                                                         \
+		__cbuild_smap_set_ctrl((map)->ctrl, (map)->capacity,                       \
+			(size_t)((pair) - (map)->data), __CBUILD_SMAP_DELETED);                  \
+		(map)->size--;                                                             \
+		(map)->deleted++;                                                          \
+	} while(0)
+/// Iterate over all elements of a swiss map.
+///
+/// * [pl:map:cbuild_smap_t*] Map object.
+/// * [pl:iter:name] Name of iterator variable, pointer to a pair.
+#define cbuild_smap_foreach(map, iter)                                         \
+	for (typeof((map)->data) iter = __cbuild_smap_next((map)->data,             \
+			(map)->ctrl, (map)->capacity, sizeof(*(map)->data), 0);                  \
+		iter != NULL;                                                              \
+		iter = __cbuild_smap_next((map)->data, (map)->ctrl, (map)->capacity,       \
+			sizeof(*(map)->data), (size_t)(iter - (map)->data) + 1))
+/// Make sure that map can hold specified number of elements without growth.
+/// Deleted slots are purged if map is reallocated.
+///
+/// * [pl:map:cbuild_smap_t*] Map object.
+/// * [pl:elems:size_t] Number of elements.
+#define cbuild_smap_reserve(map, elems)                                        \
+	do {                                                                         \
+		size_t __smap_rcap = __cbuild_smap_capacity(elems);                        \
+		if (__smap_rcap > (map)->capacity) __cbuild_smap_resize((map), __smap_rcap);\
+	} while(0)
+/// Free memory of a swiss map. Elements are not cleared. Hash and key
+/// comparison functions are kept, so map can be reused.
+///
+/// * [pl:map:cbuild_smap_t*] Map object.
+#define cbuild_smap_clear(map)                                                 \
+	do {                                                                         \
+		if ((map)->data != NULL) __CBUILD_FREE((map)->data);                       \
+		if ((map)->ctrl != NULL) __CBUILD_FREE((map)->ctrl);                       \
+		(map)->data = NULL;                                                        \
+		(map)->ctrl = NULL;                                                        \
+		(map)->size = 0;                                                           \
+		(map)->capacity = 0;                                                       \
+		(map)->deleted = 0;                                                        \
+	} while(0)
+/// Reallocate swiss map into new capacity (power-of-2) and rehash all
+/// elements into it.
+#define __cbuild_smap_resize(map, new_cap)                                     \
+	do {                                                                         \
+		size_t __smap_ncap = (new_cap);                                            \
+		typeof((map)->data) __smap_data =                                          \
+			__CBUILD_MALLOC(__smap_ncap * sizeof(*(map)->data));                     \
+		cbuild_assert(__smap_data != NULL, "Allocation failed.\n");                \
+		uint8_t* __smap_ctrl = __cbuild_smap_ctrl_alloc(__smap_ncap);              \
+		if ((map)->ctrl != NULL) {                                                 \
+			__cbuild_smap_rehash((map), (map)->hash, (map)->data, (map)->ctrl,       \
+				(map)->capacity, __smap_data, __smap_ctrl, __smap_ncap,                \
+				sizeof(*(map)->data), sizeof((map)->data[0].key));                     \
+			__CBUILD_FREE((map)->data);                                              \
+			__CBUILD_FREE((map)->ctrl);                                              \
+		}                                                                          \
+		(map)->data = __smap_data;                                                 \
+		(map)->ctrl = __smap_ctrl;                                                 \
+		(map)->capacity = __smap_ncap;                                             \
+		(map)->deleted = 0;                                                        \
+	} while(0)
+
+//! # Concurrent map
+//!
+//! Map that can be used from several threads at once without external lock.
+//! It is split into [`CBUILD_CMAP_SHARDS`](DOC:CBUILD_CMAP_SHARDS) shards by
+//! hash of a key, each shard is a swiss map with its own lock, so writers that
+//! touch different shards do not wait for each other. Lookups take no locks:
+//! each shard has a sequence number that is odd while shard is modified
+//! (seqlock), reader copies what it needs and retries if sequence number
+//! changed meanwhile. Tables replaced by growth are kept until map is freed, so
+//! readers never touch freed memory. Deleted slots are purged in place.
+//!
+//! Pairs are copied in and out of a map, pointers into a map are never given
+//! out. Key should be first field of a pair and should be at most 64 bytes,
+//! whole pair should be at most 256 bytes.
+//! Memory referenced by keys (eg. strings) should stay valid until map is
+//! freed, readers may compare against keys that were removed concurrently.
+//!
+//! Map should be zero-initialized, then initialized with one of
+//! `cbuild_map_init_*` macros and with [`cbuild_cmap_init`](DOC:cbuild_cmap_init)
+//! before it is shared between threads:
+//!
+//! ```cpp
+//! typedef struct pair_t {
+//!     cbuild_map_strkey_t key;
+//!     size_t val;
+//! } pair_t;
+//! cbuild_cmap_t map = {0};
+//! cbuild_map_init_strkey(&map);
+//! cbuild_cmap_init(&map, pair_t);
+//! // In any thread
+//! pair_t pair = { .key = cbuild_map_strkey("src/Map.c"), .val = 1 };
+//! if(cbuild_cmap_get(&map, &pair)) {
+//!     // Key was already there, pair.val holds stored value
+//! }
+//! ```
+
+#if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
+	/// Table of a concurrent map shard. Should not be used directly.
+	typedef struct __cbuild_cmap_table_t {
+		struct __cbuild_cmap_table_t* retired; // Previous table
+		size_t capacity;
+		uint8_t* ctrl;
+		void* data;
+	} __cbuild_cmap_table_t;
+	/// Shard of a concurrent map. Should not be used directly.
+	typedef struct __cbuild_cmap_shard_t {
+		size_t seq;
+		__cbuild_cmap_table_t* table;
+		size_t size;
+		size_t deleted;
+		pthread_mutex_t lock;
+		// Keeps fields of neighbour shards on separate cache lines
+		char pad[64];
+	} __cbuild_cmap_shard_t;
+	/// Concurrent map.
+	///
+	/// * [fl:hash] Hash function.
+	/// * [fl:keycmp] Key comparison function.
+	/// * [fl:elem_size] Size of a pair.
+	/// * [fl:key_size] Size of a key.
+	/// * [fl:shards] Shards.
+	/// * [fl:shard_bits] Log2 of number of shards.
+	typedef struct cbuild_cmap_t {
+		cbuild_map_hash_t hash;
+		cbuild_map_keycmp_t keycmp;
+		size_t elem_size;
+		size_t key_size;
+		__cbuild_cmap_shard_t* shards;
+		size_t shard_bits;
+	} cbuild_cmap_t;
+	/// Initialize concurrent map. Hash and key comparison functions should be
+	/// set already.
+	///
+	/// * [pl:map:cbuild_cmap_t*] Map object.
+	/// * [pl:pair_type:type] Type of a pair. Key should be its first field.
+	#define cbuild_cmap_init(map, pair_type)                                       \
+		__cbuild_cmap_init((map), sizeof(pair_type), sizeof(((pair_type*)NULL)->key))
+	/// Find element in a concurrent map. Does not lock.
+	///
+	/// * [pl:map] Map object.
+	/// * [pl:pair] Pair with a key to find. Whole pair is overwritten with stored one if key is found.
+	///
+	/// [r:] `true`{.c} if key was found.
+	CBUILDDEF bool cbuild_cmap_find(cbuild_cmap_t* map, void* pair);
+	/// Get element from a concurrent map or insert it if it does not exist.
+	///
+	/// * [pl:map] Map object.
+	/// * [pl:pair] Pair to insert. Whole pair is overwritten with stored one if key is found.
+	///
+	/// [r:] `true`{.c} if key was already in a map.
+	CBUILDDEF bool cbuild_cmap_get(cbuild_cmap_t* map, void* pair);
+	/// Remove element from a concurrent map.
+	///
+	/// * [pl:map] Map object.
+	/// * [pl:pair] Pair with a key to remove. Whole pair is overwritten with removed one if key is found.
+	///
+	/// [r:] `true`{.c} if key was found.
+	CBUILDDEF bool cbuild_cmap_remove(cbuild_cmap_t* map, void* pair);
+	/// Number of elements in a concurrent map. Can be outdated if map is
+	/// modified concurrently.
+	CBUILDDEF size_t cbuild_cmap_size(cbuild_cmap_t* map);
+	/// Free memory of a concurrent map. Elements are not cleared. Map should
+	/// not be used by other threads. Hash and key comparison functions are
+	/// kept, so map can be initialized again.
+	CBUILDDEF void cbuild_cmap_free(cbuild_cmap_t* map);
+#endif // CBUILD_API_*
 
 //! # This library provides some default hash functions. You can configure
 //! default one using macro [`CBUILD_MAP_DEFALT_HASH`](DOC:CBUILD_MAP_DEFAULT_HASH).
+//! Byte-at-a-time hashes are kept for compatibility, wyhash and XXH3 read
+//! whole words and have much better distribution.
 
 /// [DJB2 hash](http://www.cse.yorku.ca/~oz/hash.html#djb2).
 CBUILDDEF size_t cbuild_map_hash_djb2(const void* data, size_t len);
@@ -297,6 +743,25 @@ CBUILDDEF size_t cbuild_map_hash_fnv1(const void* data, size_t len);
 CBUILDDEF size_t cbuild_map_hash_fnv1a(const void* data, size_t len);
 /// [SDBM](http://www.cse.yorku.ca/~oz/hash.html#sdbm).
 CBUILDDEF size_t cbuild_map_hash_sdbm(const void* data, size_t len);
+/// [wyhash](https://github.com/wangyi-fudan/wyhash) (final version 4).
+/// Reads 8 bytes at a time, fastest on short keys. This is a default hash.
+CBUILDDEF size_t cbuild_map_hash_wyhash(const void* data, size_t len);
+/// [XXH3](https://github.com/Cyan4973/xxHash) (64 bit variant). Inputs
+/// longer than 240 bytes are processed by 8 independent lanes with AVX2, SSE2
+/// or NEON (see [`CBUILD_MAP_SIMD`](DOC:CBUILD_MAP_SIMD)). With AVX2 it is
+/// faster than wyhash on inputs longer than a few hundred bytes.
+CBUILDDEF size_t cbuild_map_hash_xxh3(const void* data, size_t len);
+/// Seeded wyhash. Random seed, that is not known to attacker, makes it hard
+/// to construct a lot of keys with colliding hashes.
+///
+/// * [pl:data] Data to hash.
+/// * [pl:len] Length of data.
+/// * [pl:seed] Seed. `cbuild_map_hash_wyhash`{.c} uses `0`{.c}.
+CBUILDDEF uint64_t cbuild_map_hash_wyhash_seed(const void* data, size_t len,
+	uint64_t seed);
+/// Seeded XXH3, same as [`cbuild_map_hash_wyhash_seed`](DOC:cbuild_map_hash_wyhash_seed).
+CBUILDDEF uint64_t cbuild_map_hash_xxh3_seed(const void* data, size_t len,
+	uint64_t seed);
 
 //! # Internal functions [line:cbuild-map-internal]
 
@@ -314,6 +779,9 @@ CBUILDDEF size_t __cbuild_map_sv_hash(const void* map,
 ///
 CBUILDDEF size_t __cbuild_map_sb_hash(const void* map,
 	const void* key, size_t klen);
+/// Returns cached hash.
+CBUILDDEF size_t __cbuild_map_strkey_hash(const void* map,
+	const void* key, size_t klen);
 ///
 CBUILDDEF bool __cbuild_map_num_keycmp(const void* map,
 	const void* k1, const void* k2, size_t klen);
@@ -326,5 +794,82 @@ CBUILDDEF bool __cbuild_map_sv_keycmp(const void* map,
 ///
 CBUILDDEF bool __cbuild_map_sb_keycmp(const void* map,
 	const void* k1, const void* k2, size_t klen);
+/// Compares hashes and lengths first, string memory is read only if they match.
+CBUILDDEF bool __cbuild_map_strkey_keycmp(const void* map,
+	const void* k1, const void* k2, size_t klen);
 /// Implements Splitmix64.
 CBUILDDEF size_t __cbuild_map_step(size_t prev);
+/// 64x64 -> 128 bit multiplication, low half goes to [pl:a], high to [pl:b].
+CBUILDDEF void __cbuild_wymum(uint64_t* a, uint64_t* b);
+/// Multiply and fold halves of a 128 bit result.
+CBUILDDEF uint64_t __cbuild_wymix(uint64_t a, uint64_t b);
+/// Read unaligned 8 bytes.
+CBUILDDEF uint64_t __cbuild_wyr8(const uint8_t* p);
+/// Read unaligned 4 bytes.
+CBUILDDEF uint64_t __cbuild_wyr4(const uint8_t* p);
+///
+CBUILDDEF uint64_t __cbuild_xxh3_mul_fold(uint64_t a, uint64_t b);
+///
+CBUILDDEF uint64_t __cbuild_xxh64_avalanche(uint64_t h);
+///
+CBUILDDEF uint64_t __cbuild_xxh3_avalanche(uint64_t h);
+///
+CBUILDDEF uint64_t __cbuild_xxh3_rrmxmx(uint64_t h, size_t len);
+/// Mix 16 bytes of input with 16 bytes of secret.
+CBUILDDEF uint64_t __cbuild_xxh3_mix16(const uint8_t* p, const uint8_t* secret,
+	uint64_t seed);
+/// Accumulate 64-byte stripes into 8 lanes, secret advances by 8 bytes each
+/// stripe.
+CBUILDDEF void __cbuild_xxh3_accumulate(uint64_t* acc, const uint8_t* p,
+	const uint8_t* secret, size_t stripes);
+/// Scramble lanes after each block.
+CBUILDDEF void __cbuild_xxh3_scramble(uint64_t* acc, const uint8_t* secret);
+/// XXH3 of input longer than 240 bytes.
+CBUILDDEF uint64_t __cbuild_xxh3_long(const uint8_t* p, size_t len,
+	const uint8_t* secret);
+/// Rehash map in place. Deleted slots become empty, then each element is
+/// moved to the first slot of its probe sequence that is not taken by already
+/// placed element, swapping with not yet placed ones.
+CBUILDDEF void __cbuild_map_compact(const void* map, cbuild_map_hash_t hash,
+	void* data, size_t capacity, size_t elem_size, size_t klen, size_t key,
+	size_t tombstone);
+/// Number of slots probed at once by swiss map.
+#define __CBUILD_SMAP_GROUP 16
+/// Control byte of empty slot of swiss map.
+#define __CBUILD_SMAP_EMPTY 0x80
+/// Control byte of deleted slot of swiss map.
+#define __CBUILD_SMAP_DELETED 0xfe
+/// Find index of a key in swiss map, `(size_t)-1`{.c} if key is not in map.
+CBUILDDEF size_t __cbuild_smap_find(const void* map, cbuild_map_hash_t hash,
+	cbuild_map_keycmp_t keycmp, const void* data, const uint8_t* ctrl,
+	size_t capacity, size_t elem_size, const void* key, size_t klen);
+/// Find index of a key in swiss map or claim free slot for it. Map should
+/// have free slot.
+CBUILDDEF size_t __cbuild_smap_insert(const void* map, cbuild_map_hash_t hash,
+	cbuild_map_keycmp_t keycmp, const void* data, uint8_t* ctrl, size_t capacity,
+	size_t elem_size, const void* key, size_t klen, size_t* deleted, bool* found);
+/// Move all elements into new arrays.
+CBUILDDEF void __cbuild_smap_rehash(const void* map, cbuild_map_hash_t hash,
+	const void* data, const uint8_t* ctrl, size_t capacity, void* new_data,
+	uint8_t* new_ctrl, size_t new_capacity, size_t elem_size, size_t klen);
+/// Set control byte, keeping its mirror after the end of array in sync.
+CBUILDDEF void __cbuild_smap_set_ctrl(uint8_t* ctrl, size_t capacity,
+	size_t idx, uint8_t value);
+/// Allocate control bytes for specified capacity.
+CBUILDDEF uint8_t* __cbuild_smap_ctrl_alloc(size_t capacity);
+/// Capacity that holds specified number of elements.
+CBUILDDEF size_t __cbuild_smap_capacity(size_t elems);
+/// New capacity if one more element does not fit, `0`{.c} otherwise.
+CBUILDDEF size_t __cbuild_smap_grow(size_t size, size_t deleted, size_t capacity);
+/// Pointer to a first full slot starting from index, NULL if there are no more.
+CBUILDDEF void* __cbuild_smap_next(void* data, const uint8_t* ctrl,
+	size_t capacity, size_t elem_size, size_t idx);
+#if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
+	/// Maximum size of a key of concurrent map.
+	#define __CBUILD_CMAP_MAX_KEY 64
+	/// Maximum size of a pair of concurrent map.
+	#define __CBUILD_CMAP_MAX_ELEM 256
+	///
+	CBUILDDEF void __cbuild_cmap_init(cbuild_cmap_t* map, size_t elem_size,
+		size_t key_size);
+#endif // CBUILD_API_*
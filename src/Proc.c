@@ -4,7 +4,49 @@
 #include "Common.h"
 #include "Log.h"
 #include "Span.h"
+#include "FS.h"
+#include "Map.h"
 #if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
+	#if defined(CBUILD_API_POSIX) && defined(CBUILD_OS_LINUX) && defined(SYS_pidfd_open)
+		// 'pidfd' of each waited process. It is opened on first wait and closed
+		// when process is reaped, before its pid can be reused.
+		typedef struct __cbuild_proc_pidfd_pair_t {
+			cbuild_proc_t key;
+			int fd;
+			cbuild_map_tombstone_t tombstone;
+		} __cbuild_proc_pidfd_pair_t;
+		struct {
+			__cbuild_proc_pidfd_pair_t* data;
+			size_t size;
+			size_t capacity;
+			cbuild_map_hash_t hash;
+			cbuild_map_keycmp_t keycmp;
+			size_t used;
+			size_t deleted;
+		} __cbuild_proc_pidfds = {
+			.hash = __cbuild_map_num_hash,
+			.keycmp = __cbuild_map_num_keycmp,
+		};
+		pthread_mutex_t __cbuild_proc_pidfd_lock = PTHREAD_MUTEX_INITIALIZER;
+	#endif // Extension check
+	// Called after process is reaped
+	CBUILDDEF void __cbuild_proc_reaped(cbuild_proc_t proc) {
+		// Child could change any file
+		cbuild_stat_invalidate_all();
+		#if defined(CBUILD_API_POSIX) && defined(CBUILD_OS_LINUX) && defined(SYS_pidfd_open)
+			pthread_mutex_lock(&__cbuild_proc_pidfd_lock);
+			if(__cbuild_proc_pidfds.capacity > 0) {
+				__cbuild_proc_pidfd_pair_t* pair = cbuild_map_find(&__cbuild_proc_pidfds, proc);
+				if(pair != NULL) {
+					close(pair->fd);
+					cbuild_map_remove(&__cbuild_proc_pidfds, pair);
+				}
+			}
+			pthread_mutex_unlock(&__cbuild_proc_pidfd_lock);
+		#else
+			(void)proc;
+		#endif // Extension check
+	}
 	CBUILDDEF int cbuild_proc_wait_code(cbuild_proc_t proc) {
 		if(proc == CBUILD_INVALID_PROC) {
 			return INT_MIN;
@@ -14,6 +56,7 @@
 			errno = 0;
 			if(waitpid(proc, &status, 0) < 0) {
 				if(errno ==	ECHILD) {
+					__cbuild_proc_reaped(proc);
 					return INT_MAX;
 				} else if (errno == EINTR) {
 					errno = 0;
@@ -23,6 +66,7 @@
 				}
 				errno = 0;
 			} else {
+				__cbuild_proc_reaped(proc);
 				if(WIFEXITED(status)) {
 					int code = WEXITSTATUS(status);
 					return code;
@@ -35,46 +79,194 @@
 			}
 		}
 	}
+	CBUILDDEF bool __cbuild_proc_try_wait(cbuild_proc_t proc, int* code) {
+		int status = 0;
+		errno = 0;
+		int ret = waitpid(proc, &status, WNOHANG);
+		if(ret > 0) __cbuild_proc_reaped(proc);
+		if(ret < 0) {
+			if(errno == ECHILD) {
+				__cbuild_proc_reaped(proc);
+				if(code != NULL) *code = INT_MAX;
+				return true;
+			}
+			cbuild_log_error("Could not wait for child process (pid %d), error: \"%s\"",
+				proc, strerror(errno));
+			errno = 0;
+		} else if(ret > 0) {
+			if(WIFEXITED(status)) {
+				if(code != NULL) *code = WEXITSTATUS(status);
+				return true;
+			}
+			if(WIFSIGNALED(status)) {
+				cbuild_log_error("Process (pid %d) was terminated by signal \"%d\"",
+					proc, WTERMSIG(status));
+				if(code != NULL) *code = -WTERMSIG(status);
+				return true;
+			}
+		}
+		return false;
+	}
+	// SIGCHLD self-pipe. Handler only writes a byte, so waiter can block in 'poll'.
+	cbuild_fd_t __cbuild_proc_sigchld_pipe[2] = {CBUILD_INVALID_FD, CBUILD_INVALID_FD};
+	struct sigaction __cbuild_proc_sigchld_old;
+	CBUILDDEF void __cbuild_proc_sigchld_handler(int sig, siginfo_t* info, void* uctx) {
+		int saved_errno = errno;
+		char c = 0;
+		if(write(__cbuild_proc_sigchld_pipe[1], &c, 1) < 0) {
+			// Pipe is full, so waiter will wake up anyway
+		}
+		// Chain to handler that was installed before us
+		if(__cbuild_proc_sigchld_old.sa_flags & SA_SIGINFO) {
+			if(__cbuild_proc_sigchld_old.sa_sigaction != NULL) {
+				__cbuild_proc_sigchld_old.sa_sigaction(sig, info, uctx);
+			}
+		} else if(__cbuild_proc_sigchld_old.sa_handler != SIG_DFL &&
+			__cbuild_proc_sigchld_old.sa_handler != SIG_IGN) {
+			__cbuild_proc_sigchld_old.sa_handler(sig);
+		}
+		errno = saved_errno;
+	}
+	CBUILDDEF bool __cbuild_proc_sigchld_init(void) {
+		if(__cbuild_proc_sigchld_pipe[0] != CBUILD_INVALID_FD) return true;
+		// Ignored SIGCHLD means that kernel reaps children. Handler would turn
+		// them into zombies, so caller polls instead.
+		struct sigaction current;
+		if(sigaction(SIGCHLD, NULL, &current) == 0 && !(current.sa_flags & SA_SIGINFO) &&
+			current.sa_handler == SIG_IGN) {
+			return false;
+		}
+		cbuild_fd_t fds[2];
+		if(pipe(fds) < 0) {
+			cbuild_log_error("Could not create SIGCHLD pipe, error: \"%s\"",
+				strerror(errno));
+			return false;
+		}
+		for(size_t i = 0; i < 2; i++) {
+			fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+			fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+		}
+		__cbuild_proc_sigchld_pipe[0] = fds[0];
+		__cbuild_proc_sigchld_pipe[1] = fds[1];
+		struct sigaction sa;
+		memset(&sa, 0, sizeof(sa));
+		sa.sa_sigaction = __cbuild_proc_sigchld_handler;
+		sa.sa_flags = SA_SIGINFO | SA_NOCLDSTOP;
+		#if defined(SA_RESTART)
+			sa.sa_flags |= SA_RESTART; // XSI, not in base POSIX.1-2001
+		#endif
+		#if defined(SA_NOCLDWAIT)
+			sa.sa_flags |= current.sa_flags & SA_NOCLDWAIT; // Same as SIG_IGN
+		#endif
+		sigemptyset(&sa.sa_mask);
+		if(sigaction(SIGCHLD, &sa, &__cbuild_proc_sigchld_old) < 0) {
+			cbuild_log_error("Could not install SIGCHLD handler, error: \"%s\"",
+				strerror(errno));
+			close(fds[0]);
+			close(fds[1]);
+			__cbuild_proc_sigchld_pipe[0] = CBUILD_INVALID_FD;
+			__cbuild_proc_sigchld_pipe[1] = CBUILD_INVALID_FD;
+			return false;
+		}
+		return true;
+	}
+	#if defined(CBUILD_API_POSIX) && defined(CBUILD_OS_LINUX) && defined(SYS_pidfd_open)
+		bool __cbuild_proc_pidfd_supported = true;
+		// Return (size_t)-1 if pidfd can not be used and caller should fallback.
+		CBUILDDEF size_t __cbuild_procs_wait_any_pidfd(cbuild_proclist_t procs, int* code) {
+			struct pollfd* fds = __CBUILD_MALLOC(procs.size * sizeof(struct pollfd));
+			cbuild_assert(fds != NULL, "Allocation failed.\n");
+			size_t ret = (size_t)-1;
+			size_t i = 0;
+			int error = 0;
+			pthread_mutex_lock(&__cbuild_proc_pidfd_lock);
+			for(; i < procs.size; i++) {
+				fds[i].events = POLLIN;
+				fds[i].revents = 0;
+				__cbuild_proc_pidfd_pair_t* pair = NULL;
+				if(__cbuild_proc_pidfds.capacity > 0) {
+					pair = cbuild_map_find(&__cbuild_proc_pidfds, procs.data[i]);
+				}
+				if(pair == NULL) {
+					int fd = (int)syscall(SYS_pidfd_open, procs.data[i], 0);
+					if(fd < 0) {
+						error = errno;
+						break;
+					}
+					pair = cbuild_map_put_new(&__cbuild_proc_pidfds, procs.data[i]);
+					pair->fd = fd;
+				}
+				fds[i].fd = pair->fd;
+			}
+			pthread_mutex_unlock(&__cbuild_proc_pidfd_lock);
+			if(i < procs.size) {
+				if(error == ENOSYS || error == EPERM || error == EINVAL) {
+					__cbuild_proc_pidfd_supported = false;
+				} else if(__cbuild_proc_try_wait(procs.data[i], code)) {
+					// Process is already gone, so it can be checked directly
+					ret = i;
+				}
+				goto cleanup;
+			}
+			while(true) {
+				int n = poll(fds, (nfds_t)procs.size, -1);
+				if(n < 0) {
+					if(errno == EINTR) continue;
+					cbuild_log_error("Could not poll child processes, error: \"%s\"",
+						strerror(errno));
+					goto cleanup;
+				}
+				for(i = 0; i < procs.size; i++) {
+					if(fds[i].revents == 0) continue;
+					fds[i].revents = 0;
+					if(__cbuild_proc_try_wait(procs.data[i], code)) {
+						ret = i;
+						goto cleanup;
+					}
+				}
+			}
+		cleanup:
+			__CBUILD_FREE(fds);
+			return ret;
+		}
+	#endif // Extension check
 	CBUILDDEF size_t cbuild_procs_wait_any(cbuild_proclist_t procs, int* code) {
 		if(procs.size == 0) {
 			if (code != NULL) *code = INT_MIN;
 			return 0;
 		}
+		#if defined(CBUILD_API_POSIX) && defined(CBUILD_OS_LINUX) && defined(SYS_pidfd_open)
+			if(__cbuild_proc_pidfd_supported) {
+				size_t idx = __cbuild_procs_wait_any_pidfd(procs, code);
+				if(idx != (size_t)-1) return idx;
+			}
+		#endif // Extension check
+		bool can_block = __cbuild_proc_sigchld_init();
 		while(true) {
+			if(can_block) {
+				char drain[64];
+				while(read(__cbuild_proc_sigchld_pipe[0], drain, sizeof(drain)) > 0) {}
+			}
 			for(size_t i = 0; i < procs.size; i++) {
-				cbuild_proc_t proc = procs.data[i];
-				int status = 0;
-				errno = 0;
-				int ret = waitpid(proc, &status, WNOHANG);
-				if(ret < 0) {
-					if(errno ==	ECHILD) {
-						if (code != NULL) *code = INT_MAX;
-						return i;
-					} else {
-						cbuild_log_error(
-							"Could not wait for child process (pid %d), error: \"%s\"", proc,
-							strerror(errno));
-					}
-					errno = 0;
-				} else if(ret > 0) {
-					if(WIFEXITED(status)) {
-						if(code != NULL) *code = WEXITSTATUS(status);
-						return i;
-					}
-					if(WIFSIGNALED(status)) {
-						cbuild_log_error(
-							"Process (pid %d) was terminated by signal \"%d\"", proc,
-							WTERMSIG(status));
-						if(code != NULL) *code = -WTERMSIG(status);
-						return i;
-					}
+				if(__cbuild_proc_try_wait(procs.data[i], code)) return i;
+			}
+			if(can_block) {
+				struct pollfd pfd = {
+					.fd = __cbuild_proc_sigchld_pipe[0],
+					.events = POLLIN,
+				};
+				if(poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+					cbuild_log_error("Could not wait for SIGCHLD, error: \"%s\"",
+						strerror(errno));
+					can_block = false;
 				}
+			} else {
+				const struct timespec duration = {
+					.tv_sec = 0,
+					.tv_nsec = 1000*100,
+				};
+				nanosleep(&duration, NULL);
 			}
-			const struct timespec duration = {
-				.tv_sec = 0,
-				.tv_nsec = 1000*100,
-			};
-			nanosleep(&duration, NULL);
 		}
 	}
 	CBUILDDEF bool cbuild_proc_is_running(cbuild_proc_t proc) {
@@ -158,6 +350,7 @@
 			int code = callback(context);
 			exit(code);
 		}
+		cbuild_stat_invalidate_all();
 		return proc;
 	}
 #endif // CBUILD_API_*
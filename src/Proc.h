@@ -25,6 +25,14 @@ CBUILDDEF bool cbuild_procs_wait(cbuild_proclist_t procs);
 CBUILDDEF int cbuild_proc_wait_code(cbuild_proc_t proc);
 /// Blocking wait until any process from list exits.
 ///
+/// Caller sleeps until a child actually exits. On Linux this polls `pidfd`s of
+/// all processes from [p:procs], they are opened once per process and closed
+/// when it is reaped. Elsewhere (or if `pidfd_open` is unavailable)
+/// process-wide `SIGCHLD` handler is installed on first call, and it wakes
+/// caller through a self-pipe. Previously installed `SIGCHLD` handler is still
+/// called. If `SIGCHLD` is ignored, handler is not installed and caller polls
+/// processes instead, so children are still reaped by kernel.
+///
 /// * [pl:procs] List of processess.
 /// * [pl:code] Return value for exit code of exited process, or INT_MAX in case of ECHILD, or INT_MIN in case of empty array. Could be `NULL`{.c}.
 ///
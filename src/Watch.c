@@ -0,0 +1,436 @@
+//! File system watcher for continuous incremental rebuilds.
+//!
+//! License: `GPL-3.0-or-later`.
+
+#include "Watch.h"
+#include "Common.h"
+#include "Log.h"
+#include "DynArray.h"
+#include "Span.h"
+#include "FS.h"
+#include "Temp.h"
+#include "Compile.h"
+#if defined(CBUILD_API_POSIX) && defined(CBUILD_OS_LINUX)
+	#define __CBUILD_WATCH_INOTIFY
+#endif // Backend check
+#if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
+	CBUILDDEF char* __cbuild_watch_strdup(const char* str) {
+		size_t len = strlen(str);
+		char* ret = __CBUILD_MALLOC(len + 1);
+		cbuild_assert(ret != NULL, "Allocation failed.\n");
+		memcpy(ret, str, len + 1);
+		return ret;
+	}
+	CBUILDDEF bool __cbuild_watch_is_root(cbuild_watch_t* watch, const char* path) {
+		cbuild_span_foreach(&watch->roots, root) {
+			if(strcmp(*root, path) == 0) return true;
+		}
+		return false;
+	}
+	// Sort and remove duplicates
+	CBUILDDEF void __cbuild_watch_finish(cbuild_pathlist_t* changed) {
+		if(changed->size == 0) return;
+		qsort(changed->data, changed->size, sizeof(char*), __cbuild_fs_compare);
+		size_t out = 1;
+		for(size_t i = 1; i < changed->size; i++) {
+			if(strcmp(changed->data[i], changed->data[out - 1]) == 0) {
+				__CBUILD_FREE(changed->data[i]);
+			} else {
+				changed->data[out++] = changed->data[i];
+			}
+		}
+		changed->size = out;
+	}
+	// Milliseconds left until timeout, negative if there is no timeout
+	CBUILDDEF int __cbuild_watch_time_left(uint64_t start, int timeout) {
+		if(timeout < 0) return -1;
+		uint64_t elapsed = (cbuild_time_nanos() - start) / 1000000;
+		if(elapsed >= (uint64_t)timeout) return 0;
+		return timeout - (int)elapsed;
+	}
+	// Polling backend. Snapshot is an array of entries sorted by path
+	typedef struct __cbuild_watch_entry_t {
+		char* path;
+		int64_t mtime;
+		int64_t size;
+		uint64_t ino;
+		uint32_t mode;
+	} __cbuild_watch_entry_t;
+	typedef struct __cbuild_watch_snapshot_t {
+		__cbuild_watch_entry_t* data;
+		size_t size;
+		size_t capacity;
+	} __cbuild_watch_snapshot_t;
+	CBUILDDEF int __cbuild_watch_entry_compare(const void* a, const void* b) {
+		return strcmp(((const __cbuild_watch_entry_t*)a)->path,
+			((const __cbuild_watch_entry_t*)b)->path);
+	}
+	CBUILDDEF bool __cbuild_watch_scan_func(cbuild_dir_walk_func_args_t args) {
+		__cbuild_watch_snapshot_t* snapshot = args.context;
+		struct stat statbuff;
+		// Object can be removed during a scan
+		if(!cbuild_stat(args.path, &statbuff)) return true;
+		__cbuild_watch_entry_t entry = {
+			.path = __cbuild_watch_strdup(args.path),
+			.mtime = __cbuild_compile_mtime_ns(&statbuff),
+			.size = (int64_t)statbuff.st_size,
+			.ino = (uint64_t)statbuff.st_ino,
+			.mode = (uint32_t)statbuff.st_mode,
+		};
+		cbuild_da_append(snapshot, entry);
+		return true;
+	}
+	CBUILDDEF void __cbuild_watch_scan_root(const char* root,
+		__cbuild_watch_snapshot_t* snapshot) {
+		struct stat statbuff;
+		if(!cbuild_stat(root, &statbuff)) return;
+		cbuild_dir_walk(root, __cbuild_watch_scan_func, .context = snapshot);
+	}
+	CBUILDDEF void __cbuild_watch_snapshot_set(cbuild_watch_t* watch,
+		__cbuild_watch_snapshot_t snapshot) {
+		__cbuild_watch_entry_t* old = watch->__snapshot;
+		for(size_t i = 0; i < watch->__snapshot_size; i++) __CBUILD_FREE(old[i].path);
+		if(old != NULL) __CBUILD_FREE(old);
+		if(snapshot.size == 0 && snapshot.data != NULL) {
+			__CBUILD_FREE(snapshot.data);
+			snapshot.data = NULL;
+		}
+		if(snapshot.size > 0) {
+			qsort(snapshot.data, snapshot.size, sizeof(__cbuild_watch_entry_t),
+				__cbuild_watch_entry_compare);
+		}
+		watch->__snapshot = snapshot.data;
+		watch->__snapshot_size = snapshot.size;
+	}
+	// Directories are compared only by type, their mtime changes with every
+	// created file
+	CBUILDDEF bool __cbuild_watch_entry_changed(const __cbuild_watch_entry_t* a,
+		const __cbuild_watch_entry_t* b) {
+		if(S_ISDIR(a->mode) != S_ISDIR(b->mode)) return true;
+		if(S_ISDIR(a->mode)) return false;
+		return a->mtime != b->mtime || a->size != b->size || a->ino != b->ino ||
+			a->mode != b->mode;
+	}
+	// Rescan all roots and report difference with a previous scan. Stat cache
+	// is refreshed by a scan, so reported paths are not invalidated
+	CBUILDDEF void __cbuild_watch_scan(cbuild_watch_t* watch, cbuild_pathlist_t* changed) {
+		cbuild_stat_invalidate_all();
+		__cbuild_watch_snapshot_t snapshot = {0};
+		cbuild_span_foreach(&watch->roots, root) __cbuild_watch_scan_root(*root, &snapshot);
+		if(snapshot.size > 0) {
+			qsort(snapshot.data, snapshot.size, sizeof(__cbuild_watch_entry_t),
+				__cbuild_watch_entry_compare);
+		}
+		__cbuild_watch_entry_t* old = watch->__snapshot;
+		size_t i = 0;
+		size_t j = 0;
+		while(i < watch->__snapshot_size || j < snapshot.size) {
+			int cmp;
+			if(i == watch->__snapshot_size) cmp = 1;
+			else if(j == snapshot.size) cmp = -1;
+			else cmp = strcmp(old[i].path, snapshot.data[j].path);
+			if(cmp < 0) {
+				cbuild_da_append(changed, __cbuild_watch_strdup(old[i++].path));
+			} else if(cmp > 0) {
+				cbuild_da_append(changed, __cbuild_watch_strdup(snapshot.data[j++].path));
+			} else {
+				if(__cbuild_watch_entry_changed(&old[i], &snapshot.data[j])) {
+					cbuild_da_append(changed, __cbuild_watch_strdup(old[i].path));
+				}
+				i++;
+				j++;
+			}
+		}
+		__cbuild_watch_snapshot_set(watch, snapshot);
+	}
+	CBUILDDEF bool __cbuild_watch_wait_poll(cbuild_watch_t* watch,
+		cbuild_pathlist_t* changed, int timeout) {
+		int interval = watch->interval > 0 ? watch->interval : CBUILD_WATCH_INTERVAL;
+		int debounce = watch->debounce > 0 ? watch->debounce : CBUILD_WATCH_DEBOUNCE;
+		uint64_t start = cbuild_time_nanos();
+		while(true) {
+			__cbuild_watch_scan(watch, changed);
+			if(changed->size > 0) break;
+			int left = __cbuild_watch_time_left(start, timeout);
+			if(left == 0) return true;
+			poll(NULL, 0, left < 0 || left > interval ? interval : left);
+		}
+		// Rescan until nothing changes during debounce window
+		size_t size;
+		do {
+			size = changed->size;
+			poll(NULL, 0, debounce);
+			__cbuild_watch_scan(watch, changed);
+		} while(changed->size != size);
+		return true;
+	}
+#endif // CBUILD_API_*
+#if defined(__CBUILD_WATCH_INOTIFY)
+	#define __CBUILD_WATCH_MASK                                                   \
+(IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB |               \
+IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF)
+	typedef struct __cbuild_watch_walk_t {
+		cbuild_watch_t* watch;
+		cbuild_pathlist_t* changed;
+	} __cbuild_watch_walk_t;
+	CBUILDDEF void __cbuild_watch_report(cbuild_pathlist_t* changed, const char* path) {
+		cbuild_stat_invalidate(path);
+		cbuild_da_append(changed, __cbuild_watch_strdup(path));
+	}
+	CBUILDDEF bool __cbuild_watch_inotify_func(cbuild_dir_walk_func_args_t args) {
+		__cbuild_watch_walk_t* ctx = args.context;
+		cbuild_watch_t* watch = ctx->watch;
+		if(args.level > 0 && ctx->changed != NULL) __cbuild_watch_report(ctx->changed, args.path);
+		if(args.level > 0 && args.type_res != CBUILD_FTYPE_DIRECTORY) return true;
+		int wd = inotify_add_watch(watch->__fd, args.path, __CBUILD_WATCH_MASK);
+		if(wd < 0) {
+			// Directory can be removed before it is watched
+			if(errno == ENOENT || errno == ENOTDIR) return true;
+			cbuild_log_error("Could not watch \"%s\", error: \"%s\"", args.path,
+				strerror(errno));
+			return false;
+		}
+		while(watch->__dirs.size <= (size_t)wd) cbuild_da_append(&watch->__dirs, NULL);
+		// Same directory can be reached by different paths
+		if(watch->__dirs.data[wd] != NULL) __CBUILD_FREE(watch->__dirs.data[wd]);
+		watch->__dirs.data[wd] = __cbuild_watch_strdup(args.path);
+		return true;
+	}
+	// Watch tree, report all objects inside it if 'changed' is not NULL
+	CBUILDDEF bool __cbuild_watch_inotify_walk(cbuild_watch_t* watch, const char* path,
+		cbuild_pathlist_t* changed) {
+		__cbuild_watch_walk_t ctx = {
+			.watch = watch,
+			.changed = changed,
+		};
+		return cbuild_dir_walk(path, __cbuild_watch_inotify_func, .context = &ctx);
+	}
+	// Stop watching tree, paths of moved directories are no longer valid
+	CBUILDDEF void __cbuild_watch_inotify_remove(cbuild_watch_t* watch, const char* path) {
+		size_t len = strlen(path);
+		for(size_t wd = 0; wd < watch->__dirs.size; wd++) {
+			char* dir = watch->__dirs.data[wd];
+			if(dir == NULL) continue;
+			if(strncmp(dir, path, len) == 0 && (dir[len] == '\0' || dir[len] == '/')) {
+				inotify_rm_watch(watch->__fd, (int)wd);
+				__CBUILD_FREE(dir);
+				watch->__dirs.data[wd] = NULL;
+			}
+		}
+	}
+	// Forget file that was created and then removed or renamed during one
+	// wait (eg. temporary file renamed over destination)
+	CBUILDDEF bool __cbuild_watch_inotify_transient(cbuild_pathlist_t* changed,
+		cbuild_pathlist_t* created, const char* path) {
+		size_t i = 0;
+		while(i < created->size && strcmp(created->data[i], path) != 0) i++;
+		if(i == created->size) return false;
+		__CBUILD_FREE(created->data[i]);
+		cbuild_da_remove_unordered(created, i);
+		size_t out = 0;
+		for(size_t j = 0; j < changed->size; j++) {
+			if(strcmp(changed->data[j], path) == 0) {
+				__CBUILD_FREE(changed->data[j]);
+			} else {
+				changed->data[out++] = changed->data[j];
+			}
+		}
+		changed->size = out;
+		return true;
+	}
+	CBUILDDEF void __cbuild_watch_inotify_event(cbuild_watch_t* watch,
+		const struct inotify_event* event, cbuild_pathlist_t* changed,
+		cbuild_pathlist_t* created) {
+		if(event->mask & IN_Q_OVERFLOW) {
+			// Events were lost, so anything could change
+			cbuild_stat_invalidate_all();
+			cbuild_span_foreach(&watch->roots, root) {
+				cbuild_da_append(changed, __cbuild_watch_strdup(*root));
+			}
+			return;
+		}
+		if(event->wd < 0 || (size_t)event->wd >= watch->__dirs.size) return;
+		char* dir = watch->__dirs.data[event->wd];
+		if(dir == NULL) return;
+		if(event->mask & IN_IGNORED) {
+			// Watched object is gone. Root is watched again if it was replaced
+			watch->__dirs.data[event->wd] = NULL;
+			if(__cbuild_watch_is_root(watch, dir)) {
+				__cbuild_watch_report(changed, dir);
+				struct stat statbuff;
+				if(cbuild_stat(dir, &statbuff)) __cbuild_watch_inotify_walk(watch, dir, changed);
+			}
+			__CBUILD_FREE(dir);
+			return;
+		}
+		size_t checkpoint = cbuild_temp_checkpoint();
+		const char* path = dir;
+		if(event->len > 0) path = cbuild_temp_sprintf("%s/%s", dir, event->name);
+		if(event->len > 0 && !(event->mask & IN_ISDIR)) {
+			if(event->mask & IN_CREATE) {
+				cbuild_da_append(created, __cbuild_watch_strdup(path));
+			} else if((event->mask & (IN_DELETE | IN_MOVED_FROM)) &&
+				__cbuild_watch_inotify_transient(changed, created, path)) {
+				cbuild_stat_invalidate(path);
+				cbuild_temp_reset(checkpoint);
+				return;
+			}
+		}
+		__cbuild_watch_report(changed, path);
+		if(event->mask & IN_ISDIR) {
+			if(event->mask & (IN_CREATE | IN_MOVED_TO)) {
+				__cbuild_watch_inotify_walk(watch, path, changed);
+			} else if(event->mask & IN_MOVED_FROM) {
+				__cbuild_watch_inotify_remove(watch, path);
+			}
+		}
+		if(event->mask & IN_MOVE_SELF) __cbuild_watch_inotify_remove(watch, dir);
+		cbuild_temp_reset(checkpoint);
+	}
+	// Read all queued events without blocking
+	CBUILDDEF bool __cbuild_watch_inotify_read(cbuild_watch_t* watch,
+		cbuild_pathlist_t* changed, cbuild_pathlist_t* created) {
+		union {
+			struct inotify_event event;
+			char buff[4096];
+		} events;
+		while(true) {
+			ssize_t len = read(watch->__fd, events.buff, sizeof(events.buff));
+			if(len < 0) {
+				if(errno == EINTR) continue;
+				if(errno == EAGAIN || errno == EWOULDBLOCK) return true;
+				cbuild_log_error("Could not read inotify events, error: \"%s\"",
+					strerror(errno));
+				return false;
+			}
+			for(char* ptr = events.buff; ptr < events.buff + len;) {
+				struct inotify_event* event = (struct inotify_event*)ptr;
+				ptr += sizeof(struct inotify_event) + event->len;
+				__cbuild_watch_inotify_event(watch, event, changed, created);
+			}
+		}
+	}
+	// Wait for events on inotify descriptor, 0 on timeout
+	CBUILDDEF int __cbuild_watch_inotify_poll(cbuild_watch_t* watch, int timeout) {
+		struct pollfd pfd = {
+			.fd = watch->__fd,
+			.events = POLLIN,
+		};
+		int ret;
+		do {
+			ret = poll(&pfd, 1, timeout);
+		} while(ret < 0 && errno == EINTR);
+		if(ret < 0) {
+			cbuild_log_error("Could not wait for inotify events, error: \"%s\"",
+				strerror(errno));
+		}
+		return ret;
+	}
+	CBUILDDEF bool __cbuild_watch_wait_inotify(cbuild_watch_t* watch,
+		cbuild_pathlist_t* changed, int timeout) {
+		int debounce = watch->debounce > 0 ? watch->debounce : CBUILD_WATCH_DEBOUNCE;
+		uint64_t start = cbuild_time_nanos();
+		// Files created during this wait
+		cbuild_pathlist_t created = {0};
+		bool ret = true;
+		// Some events, eg. removal of already removed watch, report nothing
+		while(ret && changed->size == 0) {
+			int n = __cbuild_watch_inotify_poll(watch, __cbuild_watch_time_left(start,
+					timeout));
+			if(n <= 0) {
+				ret = n == 0;
+				break;
+			}
+			ret = __cbuild_watch_inotify_read(watch, changed, &created);
+		}
+		if(ret && changed->size > 0) {
+			int n = 0;
+			while(ret && (n = __cbuild_watch_inotify_poll(watch, debounce)) > 0) {
+				ret = __cbuild_watch_inotify_read(watch, changed, &created);
+			}
+			if(ret) ret = n == 0;
+		}
+		cbuild_pathlist_clear(&created);
+		return ret;
+	}
+#endif // __CBUILD_WATCH_INOTIFY
+#if defined(CBUILD_API_POSIX) || defined(CBUILD_API_STRICT_POSIX)
+	CBUILDDEF bool cbuild_watch_add(cbuild_watch_t* watch, const char* path) {
+		struct stat statbuff;
+		if(!cbuild_stat(path, &statbuff)) {
+			cbuild_log_error("Could not watch \"%s\", error: \"%s\"", path,
+				strerror(errno));
+			return false;
+		}
+		if(!watch->__init) {
+			watch->__init = true;
+			watch->__fd = CBUILD_INVALID_FD;
+			#if defined(__CBUILD_WATCH_INOTIFY)
+				if(!watch->poll) {
+					watch->__fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+					if(watch->__fd < 0) {
+						cbuild_log_warn("inotify is not available, falling back to polling, error: \"%s\"",
+							strerror(errno));
+						watch->__fd = CBUILD_INVALID_FD;
+					} else {
+						watch->__inotify = true;
+					}
+				}
+			#endif // __CBUILD_WATCH_INOTIFY
+		}
+		cbuild_da_append(&watch->roots, __cbuild_watch_strdup(path));
+		#if defined(__CBUILD_WATCH_INOTIFY)
+			if(watch->__inotify) return __cbuild_watch_inotify_walk(watch, path, NULL);
+		#endif // __CBUILD_WATCH_INOTIFY
+		// Only new root is scanned, so changes of other roots are not lost
+		__cbuild_watch_snapshot_t snapshot = {
+			.data = watch->__snapshot,
+			.size = watch->__snapshot_size,
+			.capacity = watch->__snapshot_size,
+		};
+		watch->__snapshot = NULL;
+		watch->__snapshot_size = 0;
+		__cbuild_watch_scan_root(path, &snapshot);
+		__cbuild_watch_snapshot_set(watch, snapshot);
+		return true;
+	}
+	CBUILDDEF bool cbuild_watch_wait(cbuild_watch_t* watch, cbuild_pathlist_t* changed,
+		int timeout) {
+		cbuild_pathlist_clear(changed);
+		bool ret;
+		#if defined(__CBUILD_WATCH_INOTIFY)
+			if(watch->__inotify) ret = __cbuild_watch_wait_inotify(watch, changed, timeout);
+			else ret = __cbuild_watch_wait_poll(watch, changed, timeout);
+		#else
+			ret = __cbuild_watch_wait_poll(watch, changed, timeout);
+		#endif // __CBUILD_WATCH_INOTIFY
+		__cbuild_watch_finish(changed);
+		return ret;
+	}
+	CBUILDDEF void cbuild_watch_free(cbuild_watch_t* watch) {
+		if(watch->__fd != CBUILD_INVALID_FD && watch->__init) close(watch->__fd);
+		cbuild_pathlist_clear(&watch->roots);
+		cbuild_pathlist_clear(&watch->__dirs);
+		__cbuild_watch_snapshot_set(watch, (__cbuild_watch_snapshot_t){0});
+		watch->__init = false;
+		watch->__inotify = false;
+		watch->__fd = CBUILD_INVALID_FD;
+	}
+#endif // CBUILD_API_*
+CBUILDDEF bool cbuild_watch_run(cbuild_watch_t* watch, cbuild_watch_func_t func,
+	void* context) {
+	cbuild_pathlist_t changed = {0};
+	bool ret = true;
+	while(true) {
+		if(!cbuild_watch_wait(watch, &changed, -1)) {
+			ret = false;
+			break;
+		}
+		if(changed.size == 0) continue;
+		bool cont = func(&changed, context);
+		cbuild_pathlist_clear(&changed);
+		if(!cont) break;
+	}
+	cbuild_pathlist_clear(&changed);
+	return ret;
+}
@@ -0,0 +1,82 @@
+#pragma once // For LSP
+//! File system watcher for continuous incremental rebuilds.
+//!
+//! License: `GPL-3.0-or-later`.
+//!
+//! Watcher observes a set of root paths (files or whole directory trees) and
+//! reports paths that were created, modified or removed. Changes are
+//! coalesced: after the first change watcher waits until nothing changed for
+//! [fl:debounce] milliseconds and only then reports sorted list of changed
+//! paths with duplicates removed. So editor that writes a file in several
+//! steps, or `git checkout` that touches hundreds of files, produces single
+//! report.
+//!
+//! # Backends
+//!
+//! * `inotify` on Linux. Every directory of watched trees gets its own watch.
+//!   New directories are watched as soon as they are created and files
+//!   already placed inside them are reported too. File that was created and
+//!   then removed or renamed away before report (eg. temporary file renamed
+//!   over destination) is not reported. On queue overflow all roots are
+//!   reported.
+//! * Polling everywhere else. Each [fl:interval] roots are walked and
+//!   metadata of all objects is compared with previous scan. Scan goes through
+//!   stat cache, so next build can reuse its results. For directories only
+//!   creation and removal is reported, same as with `inotify`.
+//!
+//! In both cases stat cache entries of changed paths are invalidated.
+
+#include "Common.h"
+#include "FS.h"
+
+/// File system watcher.
+///
+/// Should be zero-initialized, only configuration fields need to be set.
+/// Roots are added with [`cbuild_watch_add`](DOC:cbuild_watch_add).
+///
+/// * Configuration:
+///   - [fl:debounce] Quiet time in milliseconds before changes are reported, `0` means `CBUILD_WATCH_DEBOUNCE`.
+///   - [fl:interval] Rescan interval of polling backend in milliseconds, `0` means `CBUILD_WATCH_INTERVAL`.
+///   - [fl:poll] Always use polling backend.
+/// * State:
+///   - [fl:roots] Watched roots.
+typedef struct cbuild_watch_t {
+	int debounce;
+	int interval;
+	bool poll;
+	cbuild_pathlist_t roots;
+	// Internal state
+	bool __init;
+	bool __inotify;
+	cbuild_fd_t __fd;
+	cbuild_pathlist_t __dirs; // Indexed by inotify watch descriptor
+	void* __snapshot;         // Sorted metadata of all objects
+	size_t __snapshot_size;
+} cbuild_watch_t;
+/// Callback of [`cbuild_watch_run`](DOC:cbuild_watch_run).
+///
+/// * [pl:changed] Sorted list of changed paths. Cleared after callback returns.
+/// * [pl:context] Context passed to [`cbuild_watch_run`](DOC:cbuild_watch_run).
+///
+/// [r:] `false`{.c} to stop watching.
+typedef bool (*cbuild_watch_func_t)(cbuild_pathlist_t* changed, void* context);
+/// Start watching file or directory tree. Path is copied.
+///
+/// [r:] `false`{.c} on error.
+CBUILDDEF bool cbuild_watch_add(cbuild_watch_t* watch, const char* path);
+/// Wait for changes.
+///
+/// * [pl:watch] Watcher.
+/// * [pl:changed] List of changed paths. It is cleared first, paths are sorted and unique.
+/// * [pl:timeout] Time in milliseconds to wait for a first change, negative value means no timeout.
+///
+/// [r:] `false`{.c} on error. On timeout `true`{.c} is returned and [pl:changed] is empty.
+CBUILDDEF bool cbuild_watch_wait(cbuild_watch_t* watch, cbuild_pathlist_t* changed,
+	int timeout);
+/// Call [pl:func] for each batch of changes until it returns `false`{.c}.
+///
+/// [r:] `false`{.c} on error.
+CBUILDDEF bool cbuild_watch_run(cbuild_watch_t* watch, cbuild_watch_func_t func,
+	void* context);
+/// Stop watching and free all resources. Watcher can be reused afterwards.
+CBUILDDEF void cbuild_watch_free(cbuild_watch_t* watch);
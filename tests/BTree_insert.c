@@ -0,0 +1,105 @@
+#define COUNT 20000
+// Keys in pseudo-random order, all distinct
+uint64_t key_at(size_t i) {
+	return (uint64_t)((i * 7919) % COUNT) * 3;
+}
+void check_tree(cbuild_btree_t* tree) {
+	TEST_ASSERT_EQ(tree->size, (size_t)COUNT, "Wrong number of elements"TEST_EXPECT_MSG(zu),
+		(size_t)COUNT, tree->size);
+	// Sorted iteration
+	uint64_t expected = 0;
+	cbuild_btree_foreach(tree, it) {
+		uint64_t key = *(uint64_t*)it.key;
+		TEST_ASSERT_EQ(key, expected, "Wrong key order"TEST_EXPECT_MSG(lu), expected, key);
+		TEST_ASSERT_EQ(*(uint64_t*)it.val, key + 1, "Wrong value of key %lu", key);
+		expected += 3;
+	}
+	TEST_ASSERT_EQ(expected, (uint64_t)COUNT * 3, "Not all keys were visited");
+	for(uint64_t key = 0; key < COUNT * 3; key++) {
+		uint64_t* val = cbuild_btree_find(tree, &key);
+		if(key % 3 == 0) {
+			TEST_ASSERT(val != NULL && *val == key + 1, "Key %lu was not found", key);
+		} else {
+			TEST_ASSERT(val == NULL, "Missing key %lu was found", key);
+		}
+		// Lower bound of any key is next multiple of 3
+		cbuild_btree_iter_t it = cbuild_btree_lower_bound(tree, &key);
+		uint64_t bound = (key + 2) / 3 * 3;
+		if(bound >= COUNT * 3) {
+			TEST_ASSERT(it.node == NULL, "Lower bound of %lu is not past the end", key);
+		} else {
+			TEST_ASSERT(it.node != NULL && *(uint64_t*)it.key == bound,
+				"Wrong lower bound of %lu", key);
+		}
+	}
+	// Range
+	uint64_t from = 100;
+	uint64_t to = 200;
+	size_t count = 0;
+	cbuild_btree_foreach_range(tree, &from, &to, it) {
+		uint64_t key = *(uint64_t*)it.key;
+		TEST_ASSERT(key >= from && key < to, "Key %lu is out of range", key);
+		count++;
+	}
+	TEST_ASSERT_EQ(count, (size_t)33, "Wrong number of keys in range"TEST_EXPECT_MSG(zu),
+		(size_t)33, count);
+	count = 0;
+	from = COUNT * 3 - 10;
+	cbuild_btree_foreach_range(tree, &from, NULL, it) count++;
+	TEST_ASSERT_EQ(count, (size_t)3, "Wrong number of keys in open range"TEST_EXPECT_MSG(zu),
+		(size_t)3, count);
+}
+int main(void) {
+	cbuild_btree_t tree = {0};
+	cbuild_btree_init_uint(&tree);
+	cbuild_btree_init(&tree, uint64_t, uint64_t, cbuild_allocator_from_libc());
+	for(size_t i = 0; i < COUNT; i++) {
+		uint64_t key = key_at(i);
+		uint64_t val = 0;
+		TEST_ASSERT(cbuild_btree_insert(&tree, &key, &val), "Key %lu was not new", key);
+	}
+	TEST_ASSERT(tree.height > 2, "Tree is too shallow, height is %zu", tree.height);
+	// Overwrite through insert and through get
+	for(size_t i = 0; i < COUNT; i += 2) {
+		uint64_t key = key_at(i);
+		uint64_t val = key + 1;
+		TEST_ASSERT(!cbuild_btree_insert(&tree, &key, &val), "Key %lu was inserted twice", key);
+	}
+	for(size_t i = 1; i < COUNT; i += 2) {
+		uint64_t key = key_at(i);
+		bool found = false;
+		*(uint64_t*)cbuild_btree_get(&tree, &key, &found) = key + 1;
+		TEST_ASSERT(found, "Key %lu was not found", key);
+	}
+	check_tree(&tree);
+	cbuild_btree_free(&tree);
+	TEST_ASSERT(cbuild_btree_begin(&tree).node == NULL, "Tree is not empty after free");
+	// Bulk load, same content
+	uint64_t* keys = malloc(COUNT * sizeof(uint64_t));
+	uint64_t* vals = malloc(COUNT * sizeof(uint64_t));
+	for(size_t i = 0; i < COUNT; i++) {
+		keys[i] = i * 3;
+		vals[i] = i * 3 + 1;
+	}
+	cbuild_btree_bulk_load(&tree, keys, vals, COUNT);
+	check_tree(&tree);
+	// Tree stays valid after inserts into packed leaves
+	for(uint64_t key = 1; key < 3000; key += 3) {
+		uint64_t val = key + 1;
+		TEST_ASSERT(cbuild_btree_insert(&tree, &key, &val), "Key %lu was not new", key);
+	}
+	uint64_t prev = 0;
+	size_t count = 0;
+	cbuild_btree_foreach(&tree, it) {
+		uint64_t key = *(uint64_t*)it.key;
+		TEST_ASSERT(count == 0 || key > prev, "Keys are not sorted after %lu", prev);
+		prev = key;
+		count++;
+	}
+	TEST_ASSERT_EQ(count, (size_t)COUNT + 1000, "Wrong number of elements"TEST_EXPECT_MSG(zu),
+		(size_t)COUNT + 1000, count);
+	cbuild_btree_free(&tree);
+	free(keys);
+	free(vals);
+	return 0;
+}
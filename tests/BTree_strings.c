@@ -0,0 +1,79 @@
+int main(void) {
+	// Nodes in an arena
+	cbuild_arena_t arena = {0};
+	cbuild_arena_base_malloc(&arena, 4 * 1024 * 1024);
+	cbuild_btree_t tree = {0};
+	cbuild_btree_init_cstr(&tree);
+	cbuild_btree_init(&tree, const char*, int, cbuild_allocator_from_arena(&arena));
+	const char* names[] = {
+		"src/Map.c", "src/FS.c", "tests/Map_get.c", "src/BTree.c", "README.md",
+		"src/Arena.c", "tests/FS_dir_list.c", "src/Map.h",
+	};
+	for(size_t i = 0; i < cbuild_arr_len(names); i++) {
+		int val = (int)i;
+		cbuild_btree_insert(&tree, &names[i], &val);
+	}
+	for(int i = 0; i < 500; i++) {
+		const char* name = cbuild_temp_sprintf("gen/file%03d.c", i);
+		cbuild_btree_insert(&tree, &name, &i);
+	}
+	const char* prev = NULL;
+	cbuild_btree_foreach(&tree, it) {
+		const char* key = *(const char**)it.key;
+		TEST_ASSERT(prev == NULL || strcmp(prev, key) < 0, "\"%s\" is not after \"%s\"", key,
+			prev);
+		prev = key;
+	}
+	// Everything in "src/"
+	const char* from = "src/";
+	const char* to = "src0";
+	const char* expected[] = { "src/Arena.c", "src/BTree.c", "src/FS.c", "src/Map.c",
+		"src/Map.h" };
+	size_t count = 0;
+	cbuild_btree_foreach_range(&tree, &from, &to, it) {
+		TEST_ASSERT(count < cbuild_arr_len(expected), "Too many keys in range");
+		TEST_ASSERT_STREQ(*(const char**)it.key, expected[count], "Wrong key"
+			TEST_EXPECT_MSG(s), expected[count], *(const char**)it.key);
+		count++;
+	}
+	TEST_ASSERT_EQ(count, cbuild_arr_len(expected), "Wrong number of keys in range"
+		TEST_EXPECT_MSG(zu), cbuild_arr_len(expected), count);
+	cbuild_btree_free(&tree);
+	cbuild_arena_base_free(&arena);
+	// String views, prefix is less than longer string
+	cbuild_btree_t svtree = {0};
+	cbuild_btree_init_sv(&svtree);
+	cbuild_btree_init(&svtree, cbuild_sv_t, char, cbuild_allocator_from_libc());
+	cbuild_sv_t svs[] = {
+		cbuild_sv_from_lit("abc"), cbuild_sv_from_lit("ab"), cbuild_sv_from_lit(""),
+		cbuild_sv_from_lit("b"), cbuild_sv_from_lit("abd"),
+	};
+	for(size_t i = 0; i < cbuild_arr_len(svs); i++) cbuild_btree_get(&svtree, &svs[i], NULL);
+	const char* order[] = { "", "ab", "abc", "abd", "b" };
+	count = 0;
+	cbuild_btree_foreach(&svtree, it) {
+		cbuild_sv_t sv = *(cbuild_sv_t*)it.key;
+		TEST_ASSERT(cbuild_sv_cmp(sv, cbuild_sv_from_cstr(order[count])) == 0,
+			"Wrong key \""CBuildSVFmt"\" at %zu", CBuildSVArg(sv), count);
+		count++;
+	}
+	TEST_ASSERT_EQ(count, cbuild_arr_len(order), "Wrong number of keys");
+	// Signed keys
+	cbuild_btree_t itree = {0};
+	cbuild_btree_init_int(&itree);
+	cbuild_btree_init(&itree, int32_t, int32_t, cbuild_allocator_from_libc());
+	for(int32_t i = -100; i <= 100; i++) {
+		int32_t key = i * 37 % 101;
+		cbuild_btree_get(&itree, &key, NULL);
+	}
+	int32_t expected_key = -100;
+	cbuild_btree_foreach(&itree, it) {
+		int32_t key = *(int32_t*)it.key;
+		TEST_ASSERT_EQ(key, expected_key, "Wrong key"TEST_EXPECT_MSG(d), expected_key, key);
+		expected_key++;
+	}
+	TEST_ASSERT_EQ(expected_key, 101, "Not all keys were visited");
+	cbuild_btree_free(&svtree);
+	cbuild_btree_free(&itree);
+	return 0;
+}
@@ -0,0 +1,68 @@
+int main(void) {
+	const char* log_path = TEST_TEMP_FILE_EX("log.bin");
+	const char* in = TEST_TEMP_FILE_EX("in.c");
+	const char* out = TEST_TEMP_FILE_EX("out.o");
+	if(cbuild_file_check(log_path)) cbuild_file_remove(log_path);
+	test_write_str(in, "int a;\n");
+	sleep(2);
+	cbuild_fd_close(cbuild_fd_open_write(out));
+	cbuild_cmd_t cmd = {0};
+	cbuild_da_append_many(&cmd, "cc", "-c", in, "-o", out);
+	const char* inputs[] = {in};
+	cbuild_buildlog_t log = {0};
+	TEST_ASSERT(cbuild_buildlog_open(&log, log_path), "Could not open build log.");
+	int r1 = cbuild_buildlog_check(&log, out, cmd, inputs, 1);
+	TEST_ASSERT_EQ(r1, 1, "Wrong result for unknown output"TEST_EXPECT_MSG(d), 1, r1);
+	TEST_ASSERT(cbuild_buildlog_record(&log, out, cmd, inputs, 1, 42),
+		"Could not record output.");
+	int r2 = cbuild_buildlog_check(&log, out, cmd, inputs, 1);
+	TEST_ASSERT_EQ(r2, 0, "Wrong result for recorded output"TEST_EXPECT_MSG(d), 0, r2);
+	cbuild_buildlog_close(&log);
+	// Log should survive reopen
+	TEST_ASSERT(cbuild_buildlog_open(&log, log_path), "Could not reopen build log.");
+	const cbuild_buildlog_entry_t* entry = cbuild_buildlog_find(&log, out);
+	TEST_ASSERT(entry != NULL, "Output was lost after reopen.");
+	TEST_ASSERT_EQ(entry->duration, 42, "Wrong duration after reopen"
+		TEST_EXPECT_MSG(lu), 42lu, (unsigned long)entry->duration);
+	int r3 = cbuild_buildlog_check(&log, out, cmd, inputs, 1);
+	TEST_ASSERT_EQ(r3, 0, "Wrong result after reopen"TEST_EXPECT_MSG(d), 0, r3);
+	// Changed command
+	cbuild_da_append(&cmd, "-O2");
+	int r4 = cbuild_buildlog_check(&log, out, cmd, inputs, 1);
+	TEST_ASSERT_EQ(r4, 1, "Wrong result for changed command"TEST_EXPECT_MSG(d), 1, r4);
+	cmd.size--;
+	// Touched input, same content
+	sleep(2);
+	test_write_str(in, "int a;\n");
+	int r5 = cbuild_buildlog_check(&log, out, cmd, inputs, 1);
+	TEST_ASSERT_EQ(r5, 0, "Wrong result for touched input"TEST_EXPECT_MSG(d), 0, r5);
+	// Changed input
+	test_write_str(in, "int b;\n");
+	int r6 = cbuild_buildlog_check(&log, out, cmd, inputs, 1);
+	TEST_ASSERT_EQ(r6, 1, "Wrong result for changed input"TEST_EXPECT_MSG(d), 1, r6);
+	// Removed input
+	const char* extra = TEST_TEMP_FILE_EX("extra.h");
+	test_write_str(extra, "int c;\n");
+	const char* inputs2[] = {in, extra};
+	TEST_ASSERT(cbuild_buildlog_record(&log, out, cmd, inputs2, 2, 42),
+		"Could not record output.");
+	cbuild_file_remove(extra);
+	int r7 = cbuild_buildlog_check(&log, out, cmd, inputs2, 2);
+	TEST_ASSERT_EQ(r7, 1, "Wrong result for removed input"TEST_EXPECT_MSG(d), 1, r7);
+	// Modified output
+	TEST_ASSERT(cbuild_buildlog_record(&log, out, cmd, inputs, 1, 42),
+		"Could not record output.");
+	sleep(2);
+	cbuild_fd_close(cbuild_fd_open_write(out));
+	int r8 = cbuild_buildlog_check(&log, out, cmd, inputs, 1);
+	TEST_ASSERT_EQ(r8, 1, "Wrong result for modified output"TEST_EXPECT_MSG(d), 1, r8);
+	// Removed output
+	TEST_ASSERT(cbuild_buildlog_record(&log, out, cmd, inputs, 1, 42),
+		"Could not record output.");
+	cbuild_file_remove(out);
+	int r9 = cbuild_buildlog_check(&log, out, cmd, inputs, 1);
+	TEST_ASSERT_EQ(r9, 1, "Wrong result for removed output"TEST_EXPECT_MSG(d), 1, r9);
+	cbuild_buildlog_close(&log);
+	cbuild_da_clear(&cmd);
+	return 0;
+}
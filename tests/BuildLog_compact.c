@@ -0,0 +1,39 @@
+int main(void) {
+	const char* log_path = TEST_TEMP_FILE_EX("log.bin");
+	const char* out = TEST_TEMP_FILE_EX("out.o");
+	const char* out2 = TEST_TEMP_FILE_EX("out2.o");
+	if(cbuild_file_check(log_path)) cbuild_file_remove(log_path);
+	cbuild_fd_close(cbuild_fd_open_write(out));
+	cbuild_fd_close(cbuild_fd_open_write(out2));
+	cbuild_cmd_t cmd = {0};
+	cbuild_da_append_many(&cmd, "true");
+	cbuild_buildlog_t log = {0};
+	TEST_ASSERT(cbuild_buildlog_open(&log, log_path), "Could not open build log.");
+	TEST_ASSERT(cbuild_buildlog_record(&log, out2, cmd, NULL, 0, 0),
+		"Could not record output.");
+	for(size_t i = 0; i < CBUILD_BUILDLOG_COMPACT_MIN; i++) {
+		TEST_ASSERT(cbuild_buildlog_record(&log, out, cmd, NULL, 0, i),
+			"Could not record output.");
+	}
+	cbuild_buildlog_close(&log);
+	// Simulate crash in the middle of a write
+	cbuild_fd_t fd = open(log_path, O_WRONLY | O_APPEND);
+	cbuild_fd_write(fd, "garbage", 7);
+	cbuild_fd_close(fd);
+	ssize_t big = cbuild_file_len(log_path);
+	TEST_ASSERT(cbuild_buildlog_open(&log, log_path), "Could not reopen build log.");
+	TEST_ASSERT_EQ(log.records, 2, "Log was not compacted"TEST_EXPECT_MSG(zu),
+		(size_t)2, log.records);
+	const cbuild_buildlog_entry_t* entry = cbuild_buildlog_find(&log, out);
+	TEST_ASSERT(entry != NULL, "Output was lost after compaction.");
+	TEST_ASSERT_EQ(entry->duration, CBUILD_BUILDLOG_COMPACT_MIN - 1,
+		"Latest record was not kept"TEST_EXPECT_MSG(zu),
+		CBUILD_BUILDLOG_COMPACT_MIN - 1, (size_t)entry->duration);
+	TEST_ASSERT(cbuild_buildlog_find(&log, out2) != NULL,
+		"Other output was lost after compaction.");
+	cbuild_buildlog_close(&log);
+	ssize_t small = cbuild_file_len(log_path);
+	TEST_ASSERT(small < big, "Log file did not shrink, %zd >= %zd.", small, big);
+	cbuild_da_clear(&cmd);
+	return 0;
+}
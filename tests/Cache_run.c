@@ -0,0 +1,79 @@
+int main(void) {
+	const char* dir = TEST_TEMP_FILE_EX("cache");
+	const char* in = TEST_TEMP_FILE_EX("in.c");
+	const char* out = TEST_TEMP_FILE_EX("out.o");
+	const char* dep = TEST_TEMP_FILE_EX("out.d");
+	if(cbuild_dir_check(dir)) cbuild_dir_remove(dir);
+	test_write_str(in, "int f(void) { return 42; }\n");
+	cbuild_cache_t cache = { .dir = dir };
+	cbuild_cmd_t cmd = {0};
+	cbuild_da_append_many(&cmd, "cc", "-c", in, "-o", out, "-MMD", "-MF", dep);
+	TEST_ASSERT(cbuild_cache_run(&cache, &cmd), "First compilation failed.");
+	TEST_ASSERT_EQ(cache.misses, 1, "Wrong number of misses"TEST_EXPECT_MSG(zu),
+		(size_t)1, cache.misses);
+	TEST_ASSERT_EQ(cache.stores, 1, "Wrong number of stores"TEST_EXPECT_MSG(zu),
+		(size_t)1, cache.stores);
+	cbuild_file_remove(out);
+	cbuild_file_remove(dep);
+	// Same source, should be restored from a cache
+	cbuild_da_append_many(&cmd, "cc", "-c", in, "-o", out, "-MMD", "-MF", dep);
+	TEST_ASSERT(cbuild_cache_run(&cache, &cmd), "Second compilation failed.");
+	TEST_ASSERT_EQ(cache.hits, 1, "Wrong number of hits"TEST_EXPECT_MSG(zu),
+		(size_t)1, cache.hits);
+	TEST_ASSERT(cbuild_file_check(out), "Object was not restored.");
+	TEST_ASSERT(cbuild_file_check(dep), "Depfile was not restored.");
+	TEST_ASSERT_EQ(cmd.size, 0, "Command was not reset"TEST_EXPECT_MSG(zu),
+		(size_t)0, cmd.size);
+	// Other output, depfile should name it as a target
+	const char* out2 = TEST_TEMP_FILE_EX("out2.o");
+	const char* dep2 = TEST_TEMP_FILE_EX("out2.d");
+	cbuild_da_append_many(&cmd, "cc", "-c", in, "-o", out2, "-MMD", "-MF", dep2);
+	TEST_ASSERT(cbuild_cache_run(&cache, &cmd), "Compilation to other output failed.");
+	TEST_ASSERT_EQ(cache.hits, 2, "Wrong number of hits"TEST_EXPECT_MSG(zu),
+		(size_t)2, cache.hits);
+	cbuild_depfile_t deps = {0};
+	TEST_ASSERT(cbuild_depfile_read(&deps, dep2), "Could not read restored depfile.");
+	cbuild_sb_t content = {0};
+	cbuild_file_read(dep2, &content);
+	cbuild_sb_append_null(&content);
+	const char* target = cbuild_temp_sprintf("%s:", out2);
+	TEST_ASSERT(strncmp(content.data, target, strlen(target)) == 0,
+		"Wrong target in depfile"TEST_EXPECT_MSG(s), target, content.data);
+	TEST_ASSERT(deps.deps.size > 0, "Restored depfile has no dependencies.");
+	cbuild_depfile_clear(&deps);
+	cbuild_file_remove(out2);
+	cbuild_file_remove(dep2);
+	// Explicit target
+	cbuild_da_append_many(&cmd, "cc", "-c", in, "-o", out2, "-MMD", "-MF", dep2,
+		"-MQ", "a b", "-MT", "obj");
+	TEST_ASSERT(cbuild_cache_run(&cache, &cmd), "Compilation with target failed.");
+	TEST_ASSERT_EQ(cache.hits, 3, "Wrong number of hits"TEST_EXPECT_MSG(zu),
+		(size_t)3, cache.hits);
+	cbuild_file_read(dep2, &content);
+	cbuild_sb_append_null(&content);
+	TEST_ASSERT(strncmp(content.data, "obj a\\ b:", 9) == 0,
+		"Wrong target in depfile"TEST_EXPECT_MSG(s), "obj a\\ b:", content.data);
+	cbuild_file_remove(out2);
+	cbuild_file_remove(dep2);
+	// Depfile without '-MF' is restored next to an object
+	cbuild_da_append_many(&cmd, "cc", "-c", in, "-o", out2, "-MMD");
+	TEST_ASSERT(cbuild_cache_run(&cache, &cmd), "Compilation without -MF failed.");
+	TEST_ASSERT_EQ(cache.hits, 4, "Wrong number of hits"TEST_EXPECT_MSG(zu),
+		(size_t)4, cache.hits);
+	const char* dep_implicit = cbuild_temp_sprintf("%.*s.d", (int)strlen(out2) - 2, out2);
+	TEST_ASSERT(cbuild_file_check(dep_implicit), "Implicit depfile was not restored.");
+	cbuild_file_remove(dep_implicit);
+	cbuild_da_clear(&content);
+	// Different flags, should be a miss
+	cbuild_da_append_many(&cmd, "cc", "-O2", "-c", in, "-o", out);
+	TEST_ASSERT(cbuild_cache_run(&cache, &cmd), "Third compilation failed.");
+	TEST_ASSERT_EQ(cache.misses, 2, "Wrong number of misses"TEST_EXPECT_MSG(zu),
+		(size_t)2, cache.misses);
+	// Eviction
+	cache.max_size = 1;
+	TEST_ASSERT(cbuild_cache_evict(&cache), "Eviction failed.");
+	TEST_ASSERT(cache.evictions > 0, "Nothing was evicted.");
+	cbuild_da_clear(&cmd);
+	cbuild_dir_remove(dir);
+	return 0;
+}
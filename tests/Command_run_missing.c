@@ -0,0 +1,20 @@
+int main(void) {
+	cbuild_cmd_t cmd = {0};
+	cbuild_da_append(&cmd, "cbuild-this-command-does-not-exist");
+	TEST_ASSERT(!cbuild_cmd_run(&cmd, .no_print_cmd = true, .no_reset = true),
+		"Missing command reported as success.");
+	cbuild_proc_t proc = CBUILD_INVALID_PROC;
+	bool ret = cbuild_cmd_run(&cmd, .proc = &proc, .no_print_cmd = true);
+	// Depending on backend error is reported at start or as exit code
+	TEST_ASSERT(!ret || cbuild_proc_wait_code(proc) != 0,
+		"Missing async command reported as success.");
+	// Autokill path should still run command normally
+	cbuild_da_append_many(&cmd, "sh", "-c", "exit 3");
+	TEST_ASSERT(!cbuild_cmd_run(&cmd, .autokill = true, .no_print_cmd = true),
+		"Command exit code was lost with autokill.");
+	cbuild_da_append_many(&cmd, "true");
+	TEST_ASSERT(cbuild_cmd_run(&cmd, .autokill = true, .no_print_cmd = true),
+		"Failed to run command with autokill.");
+	cbuild_da_clear(&cmd);
+	return 0;
+}
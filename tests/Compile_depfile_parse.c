@@ -0,0 +1,24 @@
+int main(void) {
+	cbuild_sv_t content = cbuild_sv_from_cstr(
+		"build/main.o: src/main.c src/a\\ b.h \\\n"
+		"  src/tab\\#1.h src/cost$$.h \\\r\n"
+		"  src/back\\\\\\ slash.h\n"
+		"src/a\\ b.h:\n"
+		"\n"
+		"src/tab\\#1.h:\n");
+	const char* expected[] = {
+		"src/main.c", "src/a b.h", "src/tab#1.h", "src/cost$.h", "src/back\\ slash.h",
+	};
+	cbuild_depfile_t depfile = {0};
+	cbuild_depfile_parse(&depfile, content);
+	TEST_ASSERT_EQ(depfile.deps.size, cbuild_arr_len(expected),
+		"Wrong number of prerequisites"TEST_EXPECT_MSG(zu),
+		cbuild_arr_len(expected), depfile.deps.size);
+	for(size_t i = 0; i < cbuild_arr_len(expected); i++) {
+		TEST_ASSERT_STREQ(cbuild_depfile_get(&depfile, i), expected[i],
+			"Wrong prerequisite %zu"TEST_EXPECT_RMSG("%s"), i, expected[i],
+			cbuild_depfile_get(&depfile, i));
+	}
+	cbuild_depfile_clear(&depfile);
+	return 0;
+}
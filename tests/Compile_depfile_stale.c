@@ -0,0 +1,29 @@
+int main(void) {
+	const char* src = TEST_TEMP_FILE_EX("src.c");
+	const char* hdr = TEST_TEMP_FILE_EX("hdr.h");
+	const char* obj = TEST_TEMP_FILE_EX("obj.o");
+	const char* dep = TEST_TEMP_FILE_EX("obj.d");
+	const char* missing = TEST_TEMP_FILE_EX("missing.h");
+	test_write_str(dep, cbuild_temp_sprintf("%s: %s \\\n %s\n", obj, src, hdr));
+	cbuild_fd_close(cbuild_fd_open_write(src));
+	cbuild_fd_close(cbuild_fd_open_write(hdr));
+	sleep(2);
+	cbuild_fd_close(cbuild_fd_open_write(obj));
+	int r1 = cbuild_compare_mtime_depfile(obj, dep);
+	TEST_ASSERT_EQ(r1, 0, "Wrong result when object is up to date"TEST_EXPECT_MSG(d),
+		0, r1);
+	sleep(2);
+	cbuild_fd_close(cbuild_fd_open_write(hdr));
+	int r2 = cbuild_compare_mtime_depfile(obj, dep);
+	TEST_ASSERT_EQ(r2, 1, "Wrong result when header was changed"TEST_EXPECT_MSG(d),
+		1, r2);
+	test_write_str(dep, cbuild_temp_sprintf("%s: %s %s\n", obj, src, missing));
+	int r3 = cbuild_compare_mtime_depfile(obj, dep);
+	TEST_ASSERT_EQ(r3, 1, "Wrong result when header was removed"TEST_EXPECT_MSG(d),
+		1, r3);
+	cbuild_file_remove(dep);
+	int r4 = cbuild_compare_mtime_depfile(obj, dep);
+	TEST_ASSERT_EQ(r4, 1, "Wrong result when depfile is missing"TEST_EXPECT_MSG(d),
+		1, r4);
+	return 0;
+}
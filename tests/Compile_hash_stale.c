@@ -0,0 +1,33 @@
+int main(void) {
+	const char* in1 = TEST_TEMP_FILE_EX("in1.c");
+	const char* in2 = TEST_TEMP_FILE_EX("in2.h");
+	const char* out = TEST_TEMP_FILE_EX("out.o");
+	const char* stamp = cbuild_temp_sprintf("%s.chash", out);
+	if(cbuild_file_check(stamp)) cbuild_file_remove(stamp);
+	test_write_str(in1, "int main(void) { return 0; }\n");
+	test_write_str(in2, "#define A 1\n");
+	test_write_str(out, "obj");
+	const char* inputs[] = {in1, in2};
+	int r1 = cbuild_compare_hash_many(out, inputs, 2);
+	TEST_ASSERT_EQ(r1, 1, "Wrong result without stamp"TEST_EXPECT_MSG(d), 1, r1);
+	TEST_ASSERT(cbuild_compare_hash_update(out, inputs, 2), "Could not write stamp.");
+	int r2 = cbuild_compare_hash_many(out, inputs, 2);
+	TEST_ASSERT_EQ(r2, 0, "Wrong result after update"TEST_EXPECT_MSG(d), 0, r2);
+	// Same content, new mtime (like after 'git checkout')
+	sleep(1);
+	test_write_str(in2, "#define A 1\n");
+	int r3 = cbuild_compare_hash_many(out, inputs, 2);
+	TEST_ASSERT_EQ(r3, 0, "Wrong result for touched input"TEST_EXPECT_MSG(d), 0, r3);
+	// Changed content
+	test_write_str(in2, "#define A 2\n");
+	int r4 = cbuild_compare_hash_many(out, inputs, 2);
+	TEST_ASSERT_EQ(r4, 1, "Wrong result for changed input"TEST_EXPECT_MSG(d), 1, r4);
+	int r5 = cbuild_compare_hash(out, in1);
+	TEST_ASSERT_EQ(r5, 1, "Wrong result for changed list of inputs"TEST_EXPECT_MSG(d),
+		1, r5);
+	uint64_t h1 = 0, h2 = 0;
+	TEST_ASSERT(cbuild_file_hash(in1, &h1) && cbuild_file_hash(in2, &h2),
+		"Could not hash files.");
+	TEST_ASSERT_NEQ(h1, h2, "Different files have same hash.");
+	return 0;
+}
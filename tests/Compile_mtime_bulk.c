@@ -0,0 +1,47 @@
+int main(void) {
+	const char* dir1 = TEST_TEMP_FILE_EX("dir1");
+	const char* dir2 = TEST_TEMP_FILE_EX("dir2");
+	if(!cbuild_dir_check(dir1)) cbuild_dir_create(dir1);
+	if(!cbuild_dir_check(dir2)) cbuild_dir_create(dir2);
+	const char* src1 = cbuild_temp_sprintf("%s/src1.c", dir1);
+	const char* src2 = cbuild_temp_sprintf("%s/src2.c", dir1);
+	const char* hdr = cbuild_temp_sprintf("%s/hdr.h", dir2);
+	const char* obj1 = cbuild_temp_sprintf("%s/obj1.o", dir2);
+	const char* obj2 = cbuild_temp_sprintf("%s/obj2.o", dir2);
+	const char* obj3 = cbuild_temp_sprintf("%s/obj3.o", dir2);
+	const char* missing = cbuild_temp_sprintf("%s/missing.c", dir1);
+	if(cbuild_file_check(obj3)) cbuild_file_remove(obj3);
+	cbuild_fd_close(cbuild_fd_open_write(src1));
+	cbuild_fd_close(cbuild_fd_open_write(hdr));
+	sleep(2);
+	cbuild_fd_close(cbuild_fd_open_write(obj1));
+	cbuild_fd_close(cbuild_fd_open_write(obj2));
+	sleep(2);
+	cbuild_fd_close(cbuild_fd_open_write(src2));
+	const char* in1[] = {src1, hdr};
+	const char* in2[] = {src2, hdr};
+	const char* in3[] = {src1};
+	const char* in4[] = {missing};
+	cbuild_mtime_target_t targets[] = {
+		{ .output = obj1, .inputs = in1, .num_inputs = 2 }, // Up to date
+		{ .output = obj2, .inputs = in2, .num_inputs = 2 }, // Input is newer
+		{ .output = obj3, .inputs = in3, .num_inputs = 1 }, // No output
+		{ .output = obj1, .inputs = NULL, .num_inputs = 0 }, // No inputs
+	};
+	for(int jobs = 0; jobs <= 4; jobs += 4) {
+		uint8_t stale[1] = {0xFF};
+		int ret = cbuild_compare_mtime_bulk(targets, 4, stale, .jobs = jobs);
+		TEST_ASSERT_EQ(ret, 2, "Wrong number of stale outputs"TEST_EXPECT_MSG(d), 2, ret);
+		TEST_NASSERT(cbuild_bitmap_get(stale, 0), "Up to date output marked as stale.");
+		TEST_ASSERT(cbuild_bitmap_get(stale, 1), "Stale output not marked.");
+		TEST_ASSERT(cbuild_bitmap_get(stale, 2), "Missing output not marked.");
+		TEST_NASSERT(cbuild_bitmap_get(stale, 3), "Output without inputs marked as stale.");
+	}
+	targets[0].inputs = in4;
+	targets[0].num_inputs = 1;
+	uint8_t stale[1] = {0};
+	int ret = cbuild_compare_mtime_bulk(targets, 1, stale);
+	TEST_ASSERT_EQ(ret, -1, "Missing input is not an error"TEST_EXPECT_MSG(d), -1, ret);
+	TEST_ASSERT(cbuild_bitmap_get(stale, 0), "Output with missing input not marked.");
+	return 0;
+}
@@ -0,0 +1,34 @@
+void touch(const char* path) {
+	// Enough for any filesystem timestamp granularity, but well below 1 second
+	struct timespec delay = { .tv_sec = 0, .tv_nsec = 50000000 };
+	nanosleep(&delay, NULL);
+	cbuild_fd_close(cbuild_fd_open_write(path));
+}
+int main(void) {
+	const char* in = TEST_TEMP_FILE_EX("in.c");
+	const char* out = TEST_TEMP_FILE_EX("out.o");
+	const char* dep = TEST_TEMP_FILE_EX("out.d");
+	// Input changed right after output was generated
+	touch(out);
+	touch(in);
+	int r1 = cbuild_compare_mtime(out, in);
+	TEST_ASSERT_EQ(r1, 1, "Wrong result when input is newer"TEST_EXPECT_MSG(d), 1, r1);
+	touch(dep);
+	cbuild_sb_t sb = {0};
+	cbuild_sb_appendf(&sb, "%s: %s\n", out, in);
+	cbuild_file_write(dep, &sb);
+	cbuild_da_clear(&sb);
+	int r2 = cbuild_compare_mtime_depfile(out, dep);
+	TEST_ASSERT_EQ(r2, 1, "Wrong depfile result when input is newer"TEST_EXPECT_MSG(d),
+		1, r2);
+#if defined(__CBUILD_MTIME_NS)
+	// Output regenerated right after input
+	touch(out);
+	int r3 = cbuild_compare_mtime(out, in);
+	TEST_ASSERT_EQ(r3, 0, "Wrong result when output is newer"TEST_EXPECT_MSG(d), 0, r3);
+	int r4 = cbuild_compare_mtime_depfile(out, dep);
+	TEST_ASSERT_EQ(r4, 0, "Wrong depfile result when output is newer"TEST_EXPECT_MSG(d),
+		0, r4);
+#endif // Feature check
+	return 0;
+}
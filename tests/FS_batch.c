@@ -0,0 +1,92 @@
+#define FILES 200
+void run(const char* dir, bool sync) {
+	cbuild_fs_batch_t batch = { .sync = sync };
+	const char* names[FILES];
+	for(size_t i = 0; i < FILES; i++) {
+		names[i] = cbuild_temp_sprintf("%s/file%zu", dir, i);
+		cbuild_fs_batch_open(&batch, CBUILD_FS_CWD, names[i],
+			O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	}
+	TEST_ASSERT(cbuild_fs_batch_submit(&batch), "Could not open files");
+	TEST_ASSERT_EQ(batch.submitted, FILES, "Wrong number of submitted operations"
+		TEST_EXPECT_MSG(zu), (size_t)FILES, batch.submitted);
+	cbuild_fd_t fds[FILES];
+	for(size_t i = 0; i < FILES; i++) {
+		fds[i] = (cbuild_fd_t)batch.data[i].result;
+		TEST_ASSERT(fds[i] >= 0, "Could not open \"%s\": %s", names[i],
+			strerror((int)-batch.data[i].result));
+	}
+	// Writes to different offsets do not depend on order
+	for(size_t i = 0; i < FILES; i++) {
+		cbuild_fs_batch_write(&batch, fds[i], "CD", 2, 2);
+		cbuild_fs_batch_write(&batch, fds[i], "AB", 2, 0);
+	}
+	TEST_ASSERT(cbuild_fs_batch_submit(&batch), "Could not write files");
+	for(size_t i = FILES; i < batch.size; i++) {
+		TEST_ASSERT_EQ(batch.data[i].result, 2, "Wrong number of bytes written"
+			TEST_EXPECT_MSG(zd), (ssize_t)2, batch.data[i].result);
+	}
+	cbuild_fs_batch_reset(&batch);
+	for(size_t i = 0; i < FILES; i++) cbuild_fs_batch_close(&batch, fds[i]);
+	TEST_ASSERT(cbuild_fs_batch_submit(&batch), "Could not close files");
+	cbuild_fs_batch_reset(&batch);
+	struct stat stats[FILES];
+	for(size_t i = 0; i < FILES; i++) {
+		cbuild_fs_batch_stat(&batch, CBUILD_FS_CWD, names[i], &stats[i], true);
+	}
+	TEST_ASSERT(cbuild_fs_batch_submit(&batch), "Could not stat files");
+	for(size_t i = 0; i < FILES; i++) {
+		TEST_ASSERT_EQ(stats[i].st_size, 4, "Wrong size of a file"
+			TEST_EXPECT_MSG(jd), (intmax_t)4, (intmax_t)stats[i].st_size);
+		TEST_ASSERT(S_ISREG(stats[i].st_mode), "\"%s\" is not a regular file",
+			names[i]);
+	}
+	cbuild_sb_t content = {0};
+	TEST_ASSERT(cbuild_file_read(names[FILES - 1], &content), "Could not read file");
+	cbuild_sb_append_null(&content);
+	TEST_ASSERT_STREQ(content.data, "ABCD", "Wrong content of a file"
+		TEST_EXPECT_MSG(s), "ABCD", content.data);
+	cbuild_da_clear(&content);
+	// Read back with a file offset
+	cbuild_fs_batch_reset(&batch);
+	cbuild_fs_batch_open(&batch, CBUILD_FS_CWD, names[0], O_RDONLY, 0);
+	TEST_ASSERT(cbuild_fs_batch_submit(&batch), "Could not open file");
+	cbuild_fd_t fd = (cbuild_fd_t)batch.data[0].result;
+	char buff[8] = {0};
+	size_t read_op = cbuild_fs_batch_read(&batch, fd, buff, sizeof(buff), -1);
+	TEST_ASSERT(cbuild_fs_batch_submit(&batch), "Could not read file");
+	TEST_ASSERT_EQ(batch.data[read_op].result, 4, "Wrong number of bytes read"
+		TEST_EXPECT_MSG(zd), (ssize_t)4, batch.data[read_op].result);
+	TEST_ASSERT_MEMEQ(buff, "ABCD", 4, "Wrong content read%s", "");
+	cbuild_fs_batch_close(&batch, fd);
+	TEST_ASSERT(cbuild_fs_batch_submit(&batch), "Could not close file");
+	// Errors are reported per operation
+	cbuild_fs_batch_reset(&batch);
+	for(size_t i = 0; i < FILES; i++) {
+		cbuild_fs_batch_unlink(&batch, CBUILD_FS_CWD, names[i], false);
+	}
+	size_t missing = cbuild_fs_batch_unlink(&batch, CBUILD_FS_CWD, names[0], false);
+	TEST_NASSERT(cbuild_fs_batch_submit(&batch), "Missing file was removed");
+	TEST_ASSERT_EQ(batch.data[missing].result + batch.data[0].result, -ENOENT,
+		"Wrong error"TEST_EXPECT_MSG(zd), (ssize_t)-ENOENT,
+		batch.data[missing].result + batch.data[0].result);
+	cbuild_fs_batch_reset(&batch);
+	cbuild_fs_batch_unlink(&batch, CBUILD_FS_CWD, dir, true);
+	TEST_ASSERT(cbuild_fs_batch_submit(&batch), "Could not remove directory");
+	cbuild_stat_invalidate(dir);
+	TEST_NASSERT(cbuild_dir_check(dir), "Directory was not removed");
+	if(sync) {
+		TEST_ASSERT(batch.ring == NULL, "Synchronous batch used io_uring%s", "");
+	}
+	cbuild_fs_batch_free(&batch);
+}
+int main(void) {
+	const char* dir = TEST_TEMP_FILE_EX("batch");
+	cbuild_dir_create(dir);
+	run(dir, true);
+	cbuild_temp_reset(0);
+	dir = TEST_TEMP_FILE_EX("batch");
+	cbuild_dir_create(dir);
+	run(dir, false);
+	return 0;
+}
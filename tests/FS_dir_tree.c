@@ -0,0 +1,71 @@
+// Deep and wide tree, so copy and remove use several workers
+void make_tree(const char* dir, size_t depth) {
+	cbuild_dir_create(dir);
+	for(size_t i = 0; i < 4; i++) {
+		cbuild_sb_t content = {0};
+		cbuild_sb_appendf(&content, "%s/%zu", dir, i);
+		cbuild_file_write(cbuild_temp_sprintf("%s/file%zu", dir, i), &content);
+		cbuild_da_clear(&content);
+		if(depth > 0) make_tree(cbuild_temp_sprintf("%s/dir%zu", dir, i), depth - 1);
+	}
+}
+size_t check_tree(const char* src, const char* dst, size_t depth) {
+	size_t errors = 0;
+	for(size_t i = 0; i < 4; i++) {
+		cbuild_sb_t f1 = {0};
+		cbuild_sb_t f2 = {0};
+		cbuild_file_read(cbuild_temp_sprintf("%s/file%zu", src, i), &f1);
+		cbuild_file_read(cbuild_temp_sprintf("%s/file%zu", dst, i), &f2);
+		if(f1.size == 0 || cbuild_sb_cmp(f1, f2) != 0) errors++;
+		cbuild_da_clear(&f1);
+		cbuild_da_clear(&f2);
+		if(depth > 0) {
+			errors += check_tree(cbuild_temp_sprintf("%s/dir%zu", src, i),
+				cbuild_temp_sprintf("%s/dir%zu", dst, i), depth - 1);
+		}
+	}
+	return errors;
+}
+int main(void) {
+	const char* src = TEST_TEMP_FILE_EX("tree_src");
+	const char* dst = TEST_TEMP_FILE_EX("tree_dst");
+	const char* moved = TEST_TEMP_FILE_EX("tree_moved");
+	make_tree(src, 3);
+	chmod(cbuild_temp_sprintf("%s/dir1/file2", src), 0700);
+	// Linked directory is copied as a directory, read-only directory is still
+	// filled
+	const char* link = cbuild_temp_sprintf("%s/dir0/link", src);
+	TEST_ASSERT(symlink("../dir2", link) == 0, "Could not create link");
+	chmod(cbuild_temp_sprintf("%s/dir3", src), 0555);
+	TEST_ASSERT(cbuild_dir_copy(src, dst), "cbuild_dir_copy returned error.");
+	size_t errors = check_tree(src, dst, 3);
+	TEST_ASSERT_EQ(errors, (size_t)0, "Copy differs from source in %zu files", errors);
+	struct stat statbuff;
+	TEST_ASSERT(stat(cbuild_temp_sprintf("%s/dir1/file2", dst), &statbuff) == 0,
+		"Could not stat copied file");
+	TEST_ASSERT_EQ(statbuff.st_mode & 0777, (mode_t)0700,
+		"Mode was not preserved, got %o", statbuff.st_mode & 0777);
+	TEST_ASSERT(stat(cbuild_temp_sprintf("%s/dir3", dst), &statbuff) == 0,
+		"Could not stat copied directory");
+	TEST_ASSERT_EQ(statbuff.st_mode & 0777, (mode_t)0555,
+		"Directory mode was not preserved, got %o", statbuff.st_mode & 0777);
+	TEST_ASSERT(lstat(cbuild_temp_sprintf("%s/dir0/link", dst), &statbuff) == 0 &&
+		S_ISDIR(statbuff.st_mode), "Linked directory was not copied");
+	errors = check_tree(cbuild_temp_sprintf("%s/dir2", src),
+		cbuild_temp_sprintf("%s/dir0/link", dst), 2);
+	TEST_ASSERT_EQ(errors, (size_t)0, "Linked directory differs in %zu files", errors);
+	chmod(cbuild_temp_sprintf("%s/dir3", src), 0755);
+	chmod(cbuild_temp_sprintf("%s/dir3", dst), 0755);
+	// Same filesystem, so this is just a rename
+	TEST_ASSERT(cbuild_dir_move(dst, moved), "cbuild_dir_move returned error.");
+	TEST_NASSERT(cbuild_dir_check(dst), "Source still exists after move");
+	errors = check_tree(src, moved, 3);
+	TEST_ASSERT_EQ(errors, (size_t)0, "Moved tree differs from source in %zu files",
+		errors);
+	TEST_ASSERT(cbuild_dir_remove(moved), "cbuild_dir_remove returned error.");
+	TEST_NASSERT(cbuild_dir_check(moved), "Directory exists after remove");
+	TEST_ASSERT(cbuild_dir_remove(src), "cbuild_dir_remove returned error.");
+	TEST_ASSERT(lstat(link, &statbuff) < 0, "Link was not removed");
+	TEST_NASSERT(cbuild_dir_check(src), "Directory exists after remove");
+	return 0;
+}
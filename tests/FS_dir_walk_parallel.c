@@ -0,0 +1,77 @@
+// Deep and wide tree, so walk is split between several workers
+void make_tree(const char* dir, size_t depth) {
+	cbuild_dir_create(dir);
+	for(size_t i = 0; i < 4; i++) {
+		cbuild_fd_t fd = cbuild_fd_open_write(cbuild_temp_sprintf("%s/file%zu", dir, i));
+		cbuild_fd_close(fd);
+		if(depth > 0) make_tree(cbuild_temp_sprintf("%s/dir%zu", dir, i), depth - 1);
+	}
+}
+bool collect_files(cbuild_dir_walk_func_args_t args) {
+	if(args.type == CBUILD_FTYPE_REGULAR) cbuild_dir_walk_collect(args);
+	size_t* counts = args.context;
+	counts[args.worker]++;
+	return true;
+}
+bool stop_early(cbuild_dir_walk_func_args_t args) {
+	if(args.level == 2) *args.result = CBUILD_DIR_WALK_STOP;
+	return true;
+}
+bool no_enter(cbuild_dir_walk_func_args_t args) {
+	if(args.level == 1) *args.result = CBUILD_DIR_WALK_NO_ENTER;
+	if(args.level > 1) return false;
+	return true;
+}
+bool fail(cbuild_dir_walk_func_args_t args) {
+	return args.level < 3;
+}
+int main(void) {
+	const char* dir = TEST_TEMP_FILE_EX("tree");
+	make_tree(dir, 4);
+	// 4 + 16 + 64 + 256 + 1024 files and 1 + 4 + 16 + 64 + 256 directories
+	cbuild_pathlist_t serial = {0};
+	size_t serial_count = 0;
+	TEST_ASSERT(cbuild_dir_walk(dir, collect_files, .context = &serial_count,
+			.output = &serial), "Serial walk failed.");
+	qsort(serial.data, serial.size, sizeof(char*), __cbuild_fs_compare);
+	TEST_ASSERT_EQ(serial.size, 1364, "Wrong number of files"TEST_EXPECT_MSG(zu),
+		(size_t)1364, serial.size);
+	size_t counts[4] = {0};
+	cbuild_pathlist_t parallel = {0};
+	TEST_ASSERT(cbuild_dir_walk_parallel(dir, collect_files, .context = counts,
+			.jobs = 4, .output = &parallel, .sorted = true), "Parallel walk failed.");
+	TEST_ASSERT_EQ(parallel.size, serial.size, "Wrong number of files"
+		TEST_EXPECT_MSG(zu), serial.size, parallel.size);
+	for(size_t i = 0; i < serial.size; i++) {
+		TEST_ASSERT_STREQ(parallel.data[i], serial.data[i], "Outputs differ at %zu"
+			TEST_EXPECT_RMSG("%s"), i, serial.data[i], parallel.data[i]);
+	}
+	size_t total = counts[0] + counts[1] + counts[2] + counts[3];
+	TEST_ASSERT_EQ(total, serial_count, "Wrong number of visits"TEST_EXPECT_MSG(zu),
+		serial_count, total);
+	// Per-worker contexts
+	size_t ctx_counts[4][4] = {0};
+	void* contexts[4] = {ctx_counts[0], ctx_counts[1], ctx_counts[2], ctx_counts[3]};
+	TEST_ASSERT(cbuild_dir_walk_parallel(dir, collect_files, .contexts = contexts,
+			.jobs = 4), "Parallel walk failed.");
+	total = 0;
+	for(size_t i = 0; i < 4; i++) {
+		for(size_t j = 0; j < 4; j++) {
+			if(i != j) TEST_ASSERT_EQ(ctx_counts[i][j], 0, "Worker used wrong context");
+			total += ctx_counts[i][j];
+		}
+	}
+	TEST_ASSERT_EQ(total, serial_count, "Wrong number of visits"TEST_EXPECT_MSG(zu),
+		serial_count, total);
+	// Results and errors
+	TEST_ASSERT(cbuild_dir_walk_parallel(dir, stop_early, .jobs = 4),
+		"Stopped walk should not fail.");
+	TEST_ASSERT(cbuild_dir_walk_parallel(dir, no_enter, .jobs = 4),
+		"Directories were entered.");
+	TEST_NASSERT(cbuild_dir_walk_parallel(dir, fail, .jobs = 4),
+		"Callback error was not reported.");
+	cbuild_pathlist_clear(&serial);
+	cbuild_pathlist_clear(&parallel);
+	cbuild_dir_remove(dir);
+	return 0;
+}
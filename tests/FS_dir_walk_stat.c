@@ -0,0 +1,65 @@
+size_t files = 0;
+size_t dirs = 0;
+size_t links = 0;
+size_t bytes = 0;
+size_t bad_names = 0;
+bool walker(cbuild_dir_walk_func_args_t args) {
+	if (args.level > 0 && strcmp(args.name, cbuild_path_name(args.path)) != 0) {
+		bad_names++;
+	}
+	if (args.type == CBUILD_FTYPE_REGULAR) files++;
+	if (args.type == CBUILD_FTYPE_DIRECTORY) dirs++;
+	if (args.type == CBUILD_FTYPE_SYMLINK) {
+		links++;
+		TEST_ASSERT_EQ(args.type_res, CBUILD_FTYPE_REGULAR,
+			"Symlink was not resolved"TEST_EXPECT_MSG(d), CBUILD_FTYPE_REGULAR,
+			args.type_res);
+	}
+	if (args.type_res == CBUILD_FTYPE_REGULAR) {
+		struct stat statbuff;
+		TEST_ASSERT(cbuild_dir_walk_stat(args, &statbuff),
+			"Could not stat \"%s\": %s", args.path, strerror(errno));
+		bytes += (size_t)statbuff.st_size;
+	}
+	return true;
+}
+bool walker_last(cbuild_dir_walk_func_args_t args) {
+	// Parent path should not be clobbered by its children
+	if (args.level == 1 && args.type == CBUILD_FTYPE_DIRECTORY) {
+		TEST_ASSERT_STREQ(args.name, "sub", "Wrong name of a directory"
+			TEST_EXPECT_RMSG("%s"), "sub", args.name);
+		TEST_ASSERT(cbuild_sv_suffix(cbuild_sv_from_cstr(args.path),
+				cbuild_sv_from_lit("/sub")), "Wrong path of a directory: \"%s\"",
+			args.path);
+	}
+	return true;
+}
+int main(void) {
+	const char* dir = TEST_TEMP_FILE_EX("walk");
+	cbuild_dir_create(cbuild_temp_sprintf("%s/sub", dir));
+	test_write_str(cbuild_temp_sprintf("%s/a", dir), "ABCD");
+	test_write_str(cbuild_temp_sprintf("%s/sub/b", dir), "AB");
+	test_write_str(cbuild_temp_sprintf("%s/sub/c", dir), "A");
+	symlink("a", cbuild_temp_sprintf("%s/d", dir));
+	cbuild_stat_cache_stats = (cbuild_stat_cache_stats_t){0};
+	TEST_ASSERT(cbuild_dir_walk(dir, walker), "Failed to walk directory tree.");
+	TEST_ASSERT_EQ(files, 3, "Wrong number of files"TEST_EXPECT_MSG(zu),
+		(size_t)3, files);
+	TEST_ASSERT_EQ(dirs, 2, "Wrong number of directories"TEST_EXPECT_MSG(zu),
+		(size_t)2, dirs);
+	TEST_ASSERT_EQ(links, 1, "Wrong number of symlinks"TEST_EXPECT_MSG(zu),
+		(size_t)1, links);
+	TEST_ASSERT_EQ(bytes, 11, "Wrong total size"TEST_EXPECT_MSG(zu),
+		(size_t)11, bytes);
+	TEST_ASSERT_EQ(bad_names, 0, "Wrong entry names"TEST_EXPECT_MSG(zu),
+		(size_t)0, bad_names);
+#if defined(__CBUILD_STAT_AT)
+	// Types come from a directory listing
+	TEST_ASSERT_EQ(cbuild_stat_cache_stats.misses, 0,
+		"Walker used stat cache"TEST_EXPECT_MSG(zu), (size_t)0,
+		cbuild_stat_cache_stats.misses);
+#endif // __CBUILD_STAT_AT
+	TEST_ASSERT(cbuild_dir_walk(dir, walker_last, .visit_dir_last = true),
+		"Failed to walk directory tree.");
+	return 0;
+}
@@ -0,0 +1,51 @@
+typedef int (*engine_t)(cbuild_fd_t, cbuild_fd_t, const char*, const char*);
+int clone_engine(cbuild_fd_t src_fd, cbuild_fd_t dst_fd, const char* src,
+	const char* dst) {
+	(void)src;
+	(void)dst;
+	return __cbuild_fs_copy_clone(src_fd, dst_fd);
+}
+int loop_engine(cbuild_fd_t src_fd, cbuild_fd_t dst_fd, const char* src,
+	const char* dst) {
+	return __cbuild_fs_copy_loop(src_fd, dst_fd, src, dst, 64 * 1024);
+}
+int main(void) {
+	const char* tsrc = TEST_TEMP_FILE_EX("src");
+	const char* tdst = TEST_TEMP_FILE_EX("dst");
+	cbuild_cmd_t file_writer = {0};
+	cbuild_da_append_many(&file_writer, "dd", "bs=1024", "count=64",
+		"status=none", "if=/dev/urandom", cbuild_temp_sprintf("of=%s", tsrc));
+	cbuild_cmd_run(&file_writer);
+	cbuild_sb_t f1 = {0};
+	cbuild_sb_t f2 = {0};
+	cbuild_file_read(tsrc, &f1);
+	// Every engine should produce same file, or report that it is unsupported
+	engine_t engines[] = {
+		clone_engine, __cbuild_fs_copy_range, __cbuild_fs_copy_sendfile, loop_engine,
+	};
+	for(size_t i = 0; i < cbuild_arr_len(engines); i++) {
+		cbuild_fd_t src_fd = cbuild_fd_open_read(tsrc);
+		cbuild_fd_t dst_fd = cbuild_fd_open_write(tdst);
+		int ret = engines[i](src_fd, dst_fd, tsrc, tdst);
+		cbuild_fd_close(src_fd);
+		cbuild_fd_close(dst_fd);
+		TEST_ASSERT(ret >= 0, "Copy engine %zu returned error.", i);
+		if(ret == 0) continue;
+		cbuild_file_read(tdst, &f2);
+		TEST_ASSERT_EQ(f1.size, f2.size, "Wrong size after copy by engine %zu"
+			TEST_EXPECT_MSG(zu), i, f1.size, f2.size);
+		TEST_ASSERT_MEMEQ(f1.data, f2.data, f1.size,
+			"Content does not match after copy by engine %zu", i);
+	}
+	// Mode bits are preserved
+	chmod(tsrc, 0751);
+	TEST_ASSERT(cbuild_file_copy(tsrc, tdst), "cbuild_file_copy returned error.");
+	struct stat statbuff;
+	stat(tdst, &statbuff);
+	TEST_ASSERT_EQ(statbuff.st_mode & 0777, 0751, "Mode was not preserved"
+		TEST_EXPECT_MSG(o), 0751u, (unsigned)(statbuff.st_mode & 0777));
+	cbuild_da_clear(&file_writer);
+	cbuild_da_clear(&f1);
+	cbuild_da_clear(&f2);
+	return 0;
+}
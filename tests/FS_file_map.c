@@ -0,0 +1,70 @@
+void check_file(const char* path, size_t size) {
+	cbuild_file_map_t map = {0};
+	TEST_ASSERT(cbuild_file_map(path, &map), "cbuild_file_map returned error.");
+	cbuild_sv_t view = map.content;
+	TEST_ASSERT_EQ(view.size, size, "Wrong size of a view"TEST_EXPECT_MSG(zu),
+		size, view.size);
+	cbuild_sb_t sb = {0};
+	TEST_ASSERT(cbuild_file_read(path, &sb), "cbuild_file_read returned error.");
+	TEST_ASSERT_EQ(sb.size, size, "Wrong size of a read"TEST_EXPECT_MSG(zu),
+		size, sb.size);
+	TEST_ASSERT_MEMEQ(view.data, sb.data, size, "View does not match file content.");
+	// Chopped view is still released correctly
+	cbuild_sv_chop(&map.content, size / 2);
+	cbuild_file_unmap(&map);
+	TEST_ASSERT_EQ(map.content.data, NULL, "View is not empty after unmap.");
+	cbuild_da_clear(&sb);
+}
+int main(void) {
+	const char* small = TEST_TEMP_FILE_EX("small");
+	const char* large = TEST_TEMP_FILE_EX("large");
+	const char* empty = TEST_TEMP_FILE_EX("empty");
+	cbuild_sb_t pattern = {0};
+	for(size_t i = 0; i < CBUILD_FILE_MAP_MIN * 3 + 7; i++) {
+		cbuild_da_append(&pattern, (char)('a' + i % 26));
+	}
+	test_write_file(small, pattern.data, 100);
+	test_write_file(large, pattern.data, pattern.size);
+	test_write_file(empty, pattern.data, 0);
+	cbuild_da_clear(&pattern);
+	// Repeated maps reuse pooled buffers
+	for(size_t i = 0; i < 3; i++) {
+		check_file(small, 100);
+		check_file(large, CBUILD_FILE_MAP_MIN * 3 + 7);
+		check_file(empty, 0);
+	}
+	// Read replaces old content
+	cbuild_sb_t sb = {0};
+	cbuild_sb_append_cstr(&sb, "old content that is longer than file");
+	TEST_ASSERT(cbuild_file_read(small, &sb), "cbuild_file_read returned error.");
+	TEST_ASSERT_EQ(sb.size, 100, "Wrong size of a read"TEST_EXPECT_MSG(zu),
+		(size_t)100, sb.size);
+	cbuild_da_clear(&sb);
+	cbuild_file_map_t map = {0};
+	TEST_NASSERT(cbuild_file_map(TEST_TEMP_FILE_EX("missing"), &map),
+		"Missing file was mapped.");
+	TEST_ASSERT_EQ(map.content.data, NULL, "View is not empty after error.");
+	// Pipe is read until end of file, even past the size of pooled buffer
+	int fds[2];
+	TEST_ASSERT(pipe(fds) == 0, "Could not create pipe.");
+	pid_t pid = fork();
+	if(pid == 0) {
+		close(fds[0]);
+		char chunk[4096];
+		memset(chunk, 'p', sizeof(chunk));
+		for(size_t i = 0; i < CBUILD_FILE_MAP_MIN * 2 / sizeof(chunk) + 1; i++) {
+			if(write(fds[1], chunk, sizeof(chunk)) < 0) _exit(1);
+		}
+		_exit(0);
+	}
+	close(fds[1]);
+	const char* fifo = cbuild_temp_sprintf("/dev/fd/%d", fds[0]);
+	TEST_ASSERT(cbuild_file_map(fifo, &map), "Pipe could not be mapped.");
+	size_t expected = (CBUILD_FILE_MAP_MIN * 2 / 4096 + 1) * 4096;
+	TEST_ASSERT_EQ(map.content.size, expected, "Pipe was truncated"TEST_EXPECT_MSG(zu),
+		expected, map.content.size);
+	cbuild_file_unmap(&map);
+	close(fds[0]);
+	waitpid(pid, NULL, 0);
+	return 0;
+}
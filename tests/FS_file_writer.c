@@ -0,0 +1,82 @@
+void check_file(const char* path, const char* expected) {
+	cbuild_sb_t check = {0};
+	TEST_ASSERT(cbuild_file_read(path, &check), "cbuild_file_read returned error");
+	cbuild_sb_append_null(&check);
+	TEST_ASSERT_STREQ(check.data, expected,
+		"Wrong value read from a file"TEST_EXPECT_MSG(s), expected, check.data);
+	cbuild_da_clear(&check);
+}
+size_t count_files(const char* dir) {
+	cbuild_pathlist_t list = {0};
+	TEST_ASSERT(cbuild_dir_list(dir, &list), "Could not list \"%s\"", dir);
+	size_t ret = list.size;
+	cbuild_pathlist_clear(&list);
+	return ret;
+}
+int main(void) {
+	const char* dir = TEST_TEMP_FILE_EX("writer");
+	cbuild_dir_create(dir);
+	const char* path = cbuild_temp_sprintf("%s/file", dir);
+	// Small writes are buffered, big bypass buffer
+	cbuild_file_writer_t writer;
+	TEST_ASSERT(cbuild_file_writer_open(&writer, path, .buff_size = 8),
+		"Could not open writer");
+	cbuild_file_writer_write_cstr(&writer, "AB");
+	cbuild_file_writer_write_cstr(&writer, "CD");
+	TEST_ASSERT_EQ(writer.size, 4, "Data was not buffered"TEST_EXPECT_MSG(zu),
+		(size_t)4, writer.size);
+	cbuild_file_writer_write_sv(&writer, cbuild_sv_from_lit("0123456789"));
+	TEST_ASSERT_EQ(writer.size, 0, "Buffer was not flushed"TEST_EXPECT_MSG(zu),
+		(size_t)0, writer.size);
+	cbuild_file_writer_write_cstr(&writer, "EF");
+	TEST_ASSERT(cbuild_file_writer_commit(&writer), "Could not commit writer");
+	check_file(path, "ABCD0123456789EF");
+	// Writer does not touch destination until commit
+	chmod(path, 0600);
+	TEST_ASSERT(cbuild_file_writer_open(&writer, path, .sync = true),
+		"Could not open writer");
+	cbuild_file_writer_write_cstr(&writer, "new");
+	TEST_ASSERT(cbuild_file_writer_flush(&writer), "Could not flush writer");
+	check_file(path, "ABCD0123456789EF");
+	TEST_ASSERT_EQ(count_files(dir), 2, "Temporary file was not created"
+		TEST_EXPECT_MSG(zu), (size_t)2, count_files(dir));
+	cbuild_file_writer_abort(&writer);
+	check_file(path, "ABCD0123456789EF");
+	TEST_ASSERT_EQ(count_files(dir), 1, "Temporary file was not removed"
+		TEST_EXPECT_MSG(zu), (size_t)1, count_files(dir));
+	TEST_ASSERT(cbuild_file_writer_open(&writer, path),
+		"Could not open writer");
+	cbuild_file_writer_write_cstr(&writer, "new");
+	TEST_ASSERT(cbuild_file_writer_commit(&writer), "Could not commit writer");
+	check_file(path, "new");
+	TEST_ASSERT_EQ(count_files(dir), 1, "Temporary file was not renamed"
+		TEST_EXPECT_MSG(zu), (size_t)1, count_files(dir));
+	struct stat statbuff;
+	TEST_ASSERT(stat(path, &statbuff) == 0, "Could not stat \"%s\"", path);
+	TEST_ASSERT_EQ(statbuff.st_mode & 0777, 0600, "Permissions were not kept"
+		TEST_EXPECT_MSG(o), 0600, statbuff.st_mode & 0777);
+	// Whole file at once
+	cbuild_sb_t sb = {0};
+	cbuild_sb_append_cstr(&sb, "ABCD");
+	TEST_ASSERT(cbuild_file_write(path, &sb), "cbuild_file_write returned error.");
+	check_file(path, "ABCD");
+	// In-place writer truncates destination on open
+	TEST_ASSERT(cbuild_file_writer_open(&writer, path, .in_place = true),
+		"Could not open writer");
+	TEST_ASSERT_EQ(count_files(dir), 1, "Temporary file was created"
+		TEST_EXPECT_MSG(zu), (size_t)1, count_files(dir));
+	check_file(path, "");
+	cbuild_file_writer_write_cstr(&writer, "in place");
+	TEST_ASSERT(cbuild_file_writer_commit(&writer), "Could not commit writer");
+	check_file(path, "in place");
+	// Link is kept, its target is replaced
+	const char* link = cbuild_temp_sprintf("%s/link", dir);
+	TEST_ASSERT(symlink("file", link) == 0, "Could not create link");
+	TEST_ASSERT(cbuild_file_write(link, &sb), "cbuild_file_write returned error.");
+	struct stat lstatbuff;
+	TEST_ASSERT(lstat(link, &lstatbuff) == 0 && S_ISLNK(lstatbuff.st_mode),
+		"Link was replaced");
+	check_file(path, "ABCD");
+	cbuild_da_clear(&sb);
+	return 0;
+}
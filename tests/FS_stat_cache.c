@@ -0,0 +1,73 @@
+// Threads share some paths, so lookups, inserts and invalidations of the
+// same entries race with each other
+const char* shared[8];
+void* worker(void* arg) {
+	size_t id = (size_t)arg;
+	struct stat statbuff;
+	for(size_t i = 0; i < 2000; i++) {
+		const char* path = shared[(i + id) % 8];
+		TEST_ASSERT(cbuild_stat(path, &statbuff), "Shared file was not found.");
+		if(i % 7 == id) cbuild_stat_invalidate(path);
+		if(i % 500 == 0) cbuild_stat_invalidate_all();
+		char missing[64];
+		snprintf(missing, sizeof(missing), "missing/%zu/%zu", id, i % 100);
+		TEST_NASSERT(cbuild_lstat(missing, &statbuff), "Missing file was found.");
+	}
+	return NULL;
+}
+int main(void) {
+	const char* in1 = TEST_TEMP_FILE_EX("in1");
+	const char* in2 = TEST_TEMP_FILE_EX("in2");
+	const char* in3 = TEST_TEMP_FILE_EX("in3");
+	const char* out = TEST_TEMP_FILE_EX("out");
+	test_write_str(in1, "a");
+	test_write_str(in2, "b");
+	test_write_str(in3, "c");
+	test_write_str(out, "abc");
+	// Output should be stat-ed only once
+	cbuild_stat_cache_stats = (cbuild_stat_cache_stats_t){0};
+	const char* inputs[] = {in1, in2, in3};
+	cbuild_compare_mtime_many(out, inputs, 3);
+	TEST_ASSERT_EQ(cbuild_stat_cache_stats.misses, 4, "Wrong number of stat calls"
+		TEST_EXPECT_MSG(zu), (size_t)4, cbuild_stat_cache_stats.misses);
+	TEST_ASSERT_EQ(cbuild_stat_cache_stats.hits, 2, "Wrong number of cache hits"
+		TEST_EXPECT_MSG(zu), (size_t)2, cbuild_stat_cache_stats.hits);
+	// Same file via other path
+	TEST_ASSERT(cbuild_file_check(cbuild_temp_sprintf("./%s", out)), "File not found.");
+	TEST_ASSERT_EQ(cbuild_stat_cache_stats.hits, 3, "Normalized path missed a cache"
+		TEST_EXPECT_MSG(zu), (size_t)3, cbuild_stat_cache_stats.hits);
+	// Writes by CBuild invalidate a cache
+	test_write_str(out, "abcdef");
+	ssize_t len = cbuild_file_len(out);
+	TEST_ASSERT_EQ(len, 6, "Stale size after write"TEST_EXPECT_MSG(zd), (ssize_t)6, len);
+	cbuild_file_remove(out);
+	TEST_NASSERT(cbuild_file_check(out), "Removed file is still cached.");
+	// Foreign writes need explicit invalidation
+	test_write_str(out, "abc");
+	TEST_ASSERT_EQ(cbuild_file_len(out), 3, "Wrong size");
+	FILE* f = fopen(out, "a");
+	fputs("def", f);
+	fclose(f);
+	TEST_ASSERT_EQ(cbuild_file_len(out), 3, "Foreign write was not cached");
+	cbuild_stat_invalidate(out);
+	TEST_ASSERT_EQ(cbuild_file_len(out), 6, "Stale size after invalidation");
+	// Child processes invalidate everything
+	uint64_t gen = cbuild_stat_generation();
+	cbuild_cmd_t cmd = {0};
+	cbuild_da_append_many(&cmd, "rm", out);
+	cbuild_cmd_run(&cmd);
+	TEST_ASSERT(cbuild_stat_generation() > gen, "Generation did not change.");
+	TEST_NASSERT(cbuild_file_check(out), "File removed by child is still cached.");
+	cbuild_da_clear(&cmd);
+	// Concurrent use
+	for(size_t i = 0; i < 8; i++) {
+		shared[i] = TEST_TEMP_FILE_EX("shared%zu", i);
+		test_write_str(shared[i], "x");
+	}
+	pthread_t threads[4];
+	for(size_t i = 0; i < 4; i++) {
+		pthread_create(&threads[i], NULL, worker, (void*)i);
+	}
+	for(size_t i = 0; i < 4; i++) pthread_join(threads[i], NULL);
+	return 0;
+}
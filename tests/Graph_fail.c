@@ -0,0 +1,45 @@
+int calls = 0;
+int ok(void* args) {
+	(void)args;
+	calls++;
+	return 0;
+}
+int fail(void* args) {
+	(void)args;
+	calls++;
+	return 1;
+}
+int main(void) {
+	cbuild_graph_t graph = {0};
+	size_t bad = cbuild_graph_add_func_inline(&graph, fail, NULL);
+	size_t after_bad = cbuild_graph_add_func_inline(&graph, ok, NULL);
+	size_t other = cbuild_graph_add_func_inline(&graph, ok, NULL);
+	cbuild_graph_depend(&graph, after_bad, bad);
+	// Default policy stops after first failure
+	TEST_NASSERT(cbuild_graph_run(&graph, .jobs = 1), "Failure was not reported.");
+	TEST_ASSERT_EQ(calls, 1, "Wrong number of executed nodes"TEST_EXPECT_MSG(d),
+		1, calls);
+	TEST_ASSERT_EQ(cbuild_graph_status(&graph, other), CBUILD_GRAPH_SKIPPED,
+		"Independent node was not skipped on abort.");
+	// Keep going runs everything that does not depend on failed node
+	calls = 0;
+	TEST_NASSERT(cbuild_graph_run(&graph, .jobs = 1, .keep_going = true),
+		"Failure was not reported.");
+	TEST_ASSERT_EQ(calls, 2, "Wrong number of executed nodes"TEST_EXPECT_MSG(d),
+		2, calls);
+	TEST_ASSERT_EQ(cbuild_graph_status(&graph, bad), CBUILD_GRAPH_FAILED,
+		"Failed node has wrong status.");
+	TEST_ASSERT_EQ(cbuild_graph_status(&graph, after_bad), CBUILD_GRAPH_SKIPPED,
+		"Dependent of failed node has wrong status.");
+	TEST_ASSERT_EQ(cbuild_graph_status(&graph, other), CBUILD_GRAPH_DONE,
+		"Independent node has wrong status.");
+	cbuild_graph_clear(&graph);
+	// Cycle is an error
+	size_t x = cbuild_graph_add_func_inline(&graph, ok, NULL);
+	size_t y = cbuild_graph_add_func_inline(&graph, ok, NULL);
+	cbuild_graph_depend(&graph, x, y);
+	cbuild_graph_depend(&graph, y, x);
+	TEST_NASSERT(cbuild_graph_run(&graph), "Dependency cycle was not reported.");
+	cbuild_graph_clear(&graph);
+	return 0;
+}
@@ -0,0 +1,33 @@
+int main(void) {
+	const char* out = TEST_TEMP_FILE;
+	cbuild_file_remove(out);
+	cbuild_graph_t graph = {0};
+	cbuild_cmd_t cmd = {0};
+	// 'b' waits for slow 'a', 'c' does not depend on anything
+	cbuild_da_append_many(&cmd, "sh", "-c",
+		cbuild_temp_sprintf("sleep 1; printf a >> %s", out));
+	size_t a = cbuild_graph_add_cmd(&graph, cmd);
+	cmd.size = 0;
+	cbuild_da_append_many(&cmd, "sh", "-c", cbuild_temp_sprintf("printf b >> %s", out));
+	size_t b = cbuild_graph_add_cmd(&graph, cmd);
+	cmd.size = 0;
+	cbuild_da_append_many(&cmd, "sh", "-c", cbuild_temp_sprintf("printf c >> %s", out));
+	size_t c = cbuild_graph_add_cmd(&graph, cmd);
+	cbuild_graph_depend(&graph, b, a);
+	TEST_ASSERT(cbuild_graph_run(&graph, .jobs = 2, .no_print_cmd = true),
+		"Graph run failed.");
+	cbuild_sb_t sb = {0};
+	TEST_ASSERT(cbuild_file_read(out, &sb), "Could not read graph output.");
+	TEST_ASSERT_EQ(sb.size, 3, "Wrong output length"TEST_EXPECT_MSG(zu),
+		(size_t)3, sb.size);
+	TEST_ASSERT_MEMEQ(sb.data, "cab", 3,
+		"Wrong node execution order"TEST_EXPECT_RMSG(CBuildSVFmt),
+		cbuild_sv_from_cstr("cab"), CBuildSBArg(sb));
+	TEST_ASSERT_EQ(cbuild_graph_status(&graph, c), CBUILD_GRAPH_DONE,
+		"Wrong node status"TEST_EXPECT_MSG(d), CBUILD_GRAPH_DONE,
+		cbuild_graph_status(&graph, c));
+	cbuild_da_clear(&sb);
+	cbuild_da_clear(&cmd);
+	cbuild_graph_clear(&graph);
+	return 0;
+}
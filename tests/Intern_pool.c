@@ -0,0 +1,59 @@
+#define COUNT 5000
+int main(void) {
+	cbuild_intern_t pool = {0};
+	TEST_ASSERT_EQ(cbuild_intern_find(&pool, cbuild_sv_from_lit("a")), CBUILD_INTERN_NONE,
+		"String was found in empty pool%s", "");
+	// Ids are given in order
+	for(size_t i = 0; i < COUNT; i++) {
+		uint32_t id = cbuild_intern_cstr(&pool, cbuild_temp_sprintf("src/file%zu.c", i));
+		TEST_ASSERT_EQ(id, (uint32_t)i, "Wrong id"TEST_EXPECT_MSG(u), (uint32_t)i, id);
+	}
+	TEST_ASSERT_EQ(cbuild_intern_count(&pool), (size_t)COUNT, "Wrong number of strings"
+		TEST_EXPECT_MSG(zu), (size_t)COUNT, cbuild_intern_count(&pool));
+	// Same string from another buffer and from a prefix of longer string
+	for(size_t i = 0; i < COUNT; i++) {
+		const char* str = cbuild_temp_sprintf("src/file%zu.c.o", i);
+		cbuild_sv_t sv = cbuild_sv_from_parts(str, strlen(str) - 2);
+		uint32_t id = cbuild_intern(&pool, sv);
+		TEST_ASSERT_EQ(id, (uint32_t)i, "Wrong id of \""CBuildSVFmt"\""TEST_EXPECT_MSG(u),
+			CBuildSVArg(sv), (uint32_t)i, id);
+		TEST_ASSERT_EQ(cbuild_intern_find(&pool, sv), (uint32_t)i, "String \""CBuildSVFmt
+			"\" was not found", CBuildSVArg(sv));
+	}
+	TEST_ASSERT_EQ(cbuild_intern_count(&pool), (size_t)COUNT, "Existing strings were added%s",
+		"");
+	TEST_ASSERT_EQ(cbuild_intern_find(&pool, cbuild_sv_from_lit("src/file")),
+		CBUILD_INTERN_NONE, "Missing string was found%s", "");
+	// Canonical views are stable and NULL-terminated
+	cbuild_sv_t first = cbuild_intern_str(&pool, 0);
+	TEST_ASSERT_STREQ(first.data, "src/file0.c", "Wrong string"TEST_EXPECT_MSG(s), "src/file0.c",
+		first.data);
+	TEST_ASSERT_EQ(first.size, (size_t)11, "Wrong length"TEST_EXPECT_MSG(zu), (size_t)11,
+		first.size);
+	cbuild_sv_t copy = cbuild_sv_from_cstr(cbuild_temp_sprintf("src/file0.c"));
+	TEST_ASSERT(cbuild_intern_sv(&pool, copy).data == first.data,
+		"Canonical view changed%s", "");
+	// Empty and long strings
+	uint32_t empty = cbuild_intern(&pool, cbuild_sv_from_lit(""));
+	TEST_ASSERT_EQ(cbuild_intern_str(&pool, empty).size, (size_t)0, "Empty string is not empty%s",
+		"");
+	size_t long_len = CBUILD_INTERN_BLOCK_SIZE * 2;
+	char* long_str = malloc(long_len + 1);
+	memset(long_str, 'x', long_len);
+	long_str[long_len] = '\0';
+	uint32_t long_id = cbuild_intern_cstr(&pool, long_str);
+	uint32_t after = cbuild_intern_cstr(&pool, "after");
+	TEST_ASSERT_STREQ(cbuild_intern_str(&pool, long_id).data, long_str,
+		"Long string was corrupted%s", "");
+	TEST_ASSERT_STREQ(cbuild_intern_str(&pool, after).data, "after",
+		"String after long one was corrupted%s", "");
+	TEST_ASSERT_STREQ(first.data, "src/file0.c", "Canonical view was invalidated%s", "");
+	free(long_str);
+	// Pool is reusable after free
+	cbuild_intern_free(&pool);
+	TEST_ASSERT_EQ(cbuild_intern_count(&pool), (size_t)0, "Pool is not empty after free%s", "");
+	TEST_ASSERT_EQ(cbuild_intern_cstr(&pool, "again"), (uint32_t)0, "Wrong id after free%s",
+		"");
+	cbuild_intern_free(&pool);
+	return 0;
+}
@@ -0,0 +1,67 @@
+#define THREADS 8
+#define SHARED 4000
+#define OWN 1000
+typedef struct worker_t {
+	pthread_t thread;
+	cbuild_intern_t* pool;
+	size_t idx;
+	uint32_t shared[SHARED];
+	uint32_t own[OWN];
+} worker_t;
+// Every thread interns all shared strings, each starting from a different
+// place, and some strings of its own
+void* worker(void* arg) {
+	worker_t* w = arg;
+	char buf[64];
+	for(size_t i = 0; i < SHARED; i++) {
+		size_t n = (i + w->idx * (SHARED / THREADS)) % SHARED;
+		snprintf(buf, sizeof(buf), "shared/%zu", n);
+		w->shared[n] = cbuild_intern_cstr(w->pool, buf);
+		if(i % OWN == 0) continue;
+		snprintf(buf, sizeof(buf), "own/%zu/%zu", w->idx, i % OWN);
+		w->own[i % OWN] = cbuild_intern_cstr(w->pool, buf);
+	}
+	snprintf(buf, sizeof(buf), "own/%zu/0", w->idx);
+	w->own[0] = cbuild_intern_cstr(w->pool, buf);
+	return NULL;
+}
+worker_t workers[THREADS];
+int main(void) {
+	cbuild_intern_t pool = {0};
+	cbuild_intern_init_threaded(&pool);
+	for(size_t i = 0; i < THREADS; i++) {
+		workers[i].pool = &pool;
+		workers[i].idx = i;
+		TEST_ASSERT_EQ(pthread_create(&workers[i].thread, NULL, worker, &workers[i]), 0,
+			"Could not start thread %zu", i);
+	}
+	for(size_t i = 0; i < THREADS; i++) pthread_join(workers[i].thread, NULL);
+	size_t total = SHARED + THREADS * OWN;
+	TEST_ASSERT_EQ(cbuild_intern_count(&pool), total, "Wrong number of strings"
+		TEST_EXPECT_MSG(zu), total, cbuild_intern_count(&pool));
+	// Same string got same id in all threads
+	for(size_t i = 0; i < SHARED; i++) {
+		for(size_t t = 1; t < THREADS; t++) {
+			TEST_ASSERT_EQ(workers[t].shared[i], workers[0].shared[i],
+				"Threads got different ids of string %zu"TEST_EXPECT_MSG(u), i,
+				workers[0].shared[i], workers[t].shared[i]);
+		}
+		const char* expected = cbuild_temp_sprintf("shared/%zu", i);
+		TEST_ASSERT_STREQ(cbuild_intern_str(&pool, workers[0].shared[i]).data, expected,
+			"Wrong string"TEST_EXPECT_MSG(s), expected,
+			cbuild_intern_str(&pool, workers[0].shared[i]).data);
+	}
+	// Different strings got different ids
+	for(size_t t = 0; t < THREADS; t++) {
+		for(size_t i = 0; i < OWN; i++) {
+			const char* expected = cbuild_temp_sprintf("own/%zu/%zu", t, i);
+			cbuild_sv_t str = cbuild_intern_str(&pool, workers[t].own[i]);
+			TEST_ASSERT_STREQ(str.data, expected, "Wrong string"TEST_EXPECT_MSG(s), expected,
+				str.data);
+			TEST_ASSERT_EQ(cbuild_intern_find(&pool, str), workers[t].own[i],
+				"String \"%s\" has wrong id", expected);
+		}
+	}
+	cbuild_intern_free(&pool);
+	return 0;
+}
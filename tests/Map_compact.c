@@ -0,0 +1,55 @@
+// Key is not the first field of a pair
+typedef struct pair_t {
+	int val;
+	int key;
+	cbuild_map_tombstone_t tombstone;
+} pair_t;
+typedef struct map_t {
+	pair_t* data;
+	size_t size;
+	size_t capacity;
+	cbuild_map_hash_t hash;
+	cbuild_map_keycmp_t keycmp;
+	size_t used;
+	size_t deleted;
+} map_t;
+#define COUNT 50
+void check_all(map_t* map, int from, int to) {
+	for(int i = from; i < to; i++) {
+		pair_t* pair = cbuild_map_find(map, i);
+		TEST_ASSERT(pair != NULL, "Key %d was not found", i);
+		TEST_ASSERT_EQ(pair->val, i * 2, "Wrong value of key %d"TEST_EXPECT_MSG(d),
+			i, i * 2, pair->val);
+	}
+}
+int main(void) {
+	map_t map = {0};
+	cbuild_map_init_num(&map);
+	for(int i = 0; i < COUNT; i++) cbuild_map_put(&map, i)->val = i * 2;
+	// Churn that keeps number of elements small, so tombstones are purged in
+	// place
+	size_t capacity = map.capacity;
+	for(int round = 0; round < 100; round++) {
+		int key = COUNT + round;
+		cbuild_map_put_new(&map, key)->val = key * 2;
+		cbuild_map_remove(&map, cbuild_map_find(&map, key));
+		check_all(&map, 0, COUNT);
+	}
+	TEST_ASSERT_EQ(map.capacity, capacity, "Map grew during churn"
+		TEST_EXPECT_MSG(zu), capacity, map.capacity);
+	// Explicit compaction
+	for(int i = 0; i < COUNT; i += 2) cbuild_map_remove(&map, cbuild_map_find(&map, i));
+	cbuild_map_compact(&map);
+	TEST_ASSERT_EQ(map.deleted, (size_t)0, "Deleted slots left after compaction"
+		TEST_EXPECT_MSG(zu), (size_t)0, map.deleted);
+	for(int i = 0; i < COUNT; i++) {
+		pair_t* pair = cbuild_map_find(&map, i);
+		if(i % 2 == 0) {
+			TEST_ASSERT(pair == NULL, "Removed key %d was found", i);
+		} else {
+			TEST_ASSERT(pair != NULL && pair->val == i * 2, "Key %d was not found", i);
+		}
+	}
+	cbuild_da_clear(&map);
+	return 0;
+}
@@ -0,0 +1,106 @@
+typedef struct pair_t {
+	size_t key;
+	size_t val;
+} pair_t;
+#define COUNT 20000
+#define THREADS 4
+cbuild_cmap_t map = {0};
+size_t stop = 0;
+size_t torn = 0;
+typedef struct worker_t {
+	pthread_t thread;
+	size_t idx;
+} worker_t;
+// Each writer owns a range of keys and repeatedly inserts and removes them,
+// value is always derived from a key
+void* writer(void* arg) {
+	worker_t* w = arg;
+	for(size_t round = 0; round < 5; round++) {
+		for(size_t i = w->idx; i < COUNT; i += THREADS) {
+			pair_t pair = { .key = i, .val = i * 3 };
+			cbuild_cmap_get(&map, &pair);
+		}
+		for(size_t i = w->idx; i < COUNT; i += THREADS) {
+			if((i / THREADS) % 2 == round % 2) continue;
+			pair_t pair = { .key = i };
+			cbuild_cmap_remove(&map, &pair);
+		}
+	}
+	return NULL;
+}
+void* reader(void* arg) {
+	CBUILD_UNUSED(arg);
+	size_t i = 0;
+	while(!__atomic_load_n(&stop, __ATOMIC_RELAXED)) {
+		pair_t pair = { .key = i % COUNT, .val = 0 };
+		if(cbuild_cmap_find(&map, &pair) && (pair.key != i % COUNT || pair.val != pair.key * 3)) {
+			__atomic_store_n(&torn, 1, __ATOMIC_RELAXED);
+		}
+		i += 7;
+	}
+	return NULL;
+}
+int main(void) {
+	cbuild_map_init_num(&map);
+	cbuild_cmap_init(&map, pair_t);
+	// Single thread
+	for(size_t i = 0; i < COUNT; i++) {
+		pair_t pair = { .key = i, .val = i * 2 };
+		TEST_ASSERT(!cbuild_cmap_get(&map, &pair), "Key %zu was found before insertion", i);
+	}
+	TEST_ASSERT_EQ(cbuild_cmap_size(&map), (size_t)COUNT, "Wrong number of elements"
+		TEST_EXPECT_MSG(zu), (size_t)COUNT, cbuild_cmap_size(&map));
+	for(size_t i = 0; i < COUNT; i++) {
+		pair_t pair = { .key = i, .val = 0 };
+		TEST_ASSERT(cbuild_cmap_find(&map, &pair), "Key %zu was not found", i);
+		TEST_ASSERT_EQ(pair.val, i * 2, "Wrong value of key %zu"TEST_EXPECT_MSG(zu), i, i * 2,
+			pair.val);
+		pair.val = 0;
+		TEST_ASSERT(cbuild_cmap_get(&map, &pair), "Key %zu was inserted twice", i);
+		TEST_ASSERT_EQ(pair.val, i * 2, "Existing value was not returned%s", "");
+	}
+	pair_t missing = { .key = COUNT, .val = 5 };
+	TEST_ASSERT(!cbuild_cmap_find(&map, &missing), "Missing key was found%s", "");
+	TEST_ASSERT(missing.key == COUNT && missing.val == 5, "Pair was changed by failed lookup%s",
+		"");
+	for(size_t i = 0; i < COUNT; i += 2) {
+		pair_t pair = { .key = i };
+		TEST_ASSERT(cbuild_cmap_remove(&map, &pair), "Key %zu was not removed", i);
+		TEST_ASSERT_EQ(pair.val, i * 2, "Removed pair was not returned%s", "");
+	}
+	pair_t removed = { .key = 0 };
+	TEST_ASSERT(!cbuild_cmap_remove(&map, &removed), "Key was removed twice%s", "");
+	TEST_ASSERT(!cbuild_cmap_find(&map, &removed), "Removed key was found%s", "");
+	TEST_ASSERT_EQ(cbuild_cmap_size(&map), (size_t)COUNT / 2, "Wrong number of elements"
+		TEST_EXPECT_MSG(zu), (size_t)COUNT / 2, cbuild_cmap_size(&map));
+	cbuild_cmap_free(&map);
+	// Writers and readers at once
+	cbuild_cmap_init(&map, pair_t);
+	worker_t writers[THREADS];
+	worker_t readers[THREADS];
+	for(size_t i = 0; i < THREADS; i++) {
+		readers[i].idx = i;
+		TEST_ASSERT_EQ(pthread_create(&readers[i].thread, NULL, reader, &readers[i]), 0,
+			"Could not start reader %zu", i);
+	}
+	for(size_t i = 0; i < THREADS; i++) {
+		writers[i].idx = i;
+		TEST_ASSERT_EQ(pthread_create(&writers[i].thread, NULL, writer, &writers[i]), 0,
+			"Could not start writer %zu", i);
+	}
+	for(size_t i = 0; i < THREADS; i++) pthread_join(writers[i].thread, NULL);
+	__atomic_store_n(&stop, 1, __ATOMIC_RELAXED);
+	for(size_t i = 0; i < THREADS; i++) pthread_join(readers[i].thread, NULL);
+	TEST_ASSERT(!torn, "Reader got inconsistent pair%s", "");
+	// Last round removed keys with odd index in each writer's range
+	for(size_t i = 0; i < COUNT; i++) {
+		pair_t pair = { .key = i };
+		bool expected = (i / THREADS) % 2 == 0;
+		TEST_ASSERT_EQ(cbuild_cmap_find(&map, &pair), expected,
+			"Wrong presence of key %zu"TEST_EXPECT_MSG(d), i, expected, !expected);
+	}
+	TEST_ASSERT_EQ(cbuild_cmap_size(&map), (size_t)COUNT / 2, "Wrong number of elements"
+		TEST_EXPECT_MSG(zu), (size_t)COUNT / 2, cbuild_cmap_size(&map));
+	cbuild_cmap_free(&map);
+	return 0;
+}
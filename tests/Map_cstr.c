@@ -0,0 +1,29 @@
+typedef struct pair_t {
+	const char* key;
+	int val;
+	cbuild_map_tombstone_t tombstone;
+} pair_t;
+typedef struct map_t {
+	pair_t* data;
+	size_t size;
+	size_t capacity;
+	cbuild_map_hash_t hash;
+	cbuild_map_keycmp_t keycmp;
+} map_t;
+int main(void) {
+	map_t map = {0};
+	cbuild_map_init_cstr(&map);
+	cbuild_map_resize(&map, 16);
+	char key1[] = "key";
+	char key2[] = "key";
+	pair_t* elem = cbuild_map_get(&map, key1);
+	elem->val = 1;
+	// Lookup must compare string content, not pointers
+	pair_t* found = cbuild_map_find(&map, (const char*)key2);
+	TEST_ASSERT(found != NULL, "Key with same content was not found.");
+	TEST_ASSERT_EQ(found->val, 1, "Wrong value was found"TEST_EXPECT_MSG(d),
+		1, found->val);
+	TEST_ASSERT(cbuild_map_find(&map, "other") == NULL, "Missing key was found.");
+	cbuild_da_clear(&map);
+	return 0;
+}
@@ -0,0 +1,109 @@
+typedef struct pair_t {
+	int key;
+	int val;
+	cbuild_map_tombstone_t tombstone;
+} pair_t;
+typedef struct map_t {
+	pair_t* data;
+	size_t size;
+	size_t capacity;
+	cbuild_map_hash_t hash;
+	cbuild_map_keycmp_t keycmp;
+	size_t used;
+	size_t deleted;
+} map_t;
+// Only 4 distinct hashes, so compaction has to swap elements of long chains
+size_t bad_hash(const void* map, const void* key, size_t klen) {
+	CBUILD_UNUSED(map);
+	CBUILD_UNUSED(klen);
+	return (size_t)(*(const int*)key & 3);
+}
+#define COUNT 5000
+void check_counters(map_t* map) {
+	size_t used = 0;
+	size_t deleted = 0;
+	cbuild_span_foreach(map, pair) {
+		if(pair->tombstone == CBUILD_MAP_FULL) used++;
+		else if(pair->tombstone == CBUILD_MAP_DELETED) deleted++;
+	}
+	TEST_ASSERT_EQ(map->used, used, "Wrong number of used slots"TEST_EXPECT_MSG(zu),
+		used, map->used);
+	TEST_ASSERT_EQ(map->deleted, deleted, "Wrong number of deleted slots"
+		TEST_EXPECT_MSG(zu), deleted, map->deleted);
+	TEST_ASSERT((map->used + map->deleted) * 100 <= map->capacity * CBUILD_MAP_MAX_LOAD,
+		"Map is overloaded: %zu used, %zu deleted, %zu slots", map->used,
+		map->deleted, map->capacity);
+}
+void check_all(map_t* map, int from, int to, int step) {
+	for(int i = from; i < to; i += step) {
+		pair_t* pair = cbuild_map_find(map, i);
+		TEST_ASSERT(pair != NULL, "Key %d was not found", i);
+		TEST_ASSERT_EQ(pair->val, i * 2, "Wrong value of key %d"TEST_EXPECT_MSG(d),
+			i, i * 2, pair->val);
+	}
+}
+void run(map_t* map, int count) {
+	for(int i = 0; i < count; i++) cbuild_map_put(map, i)->val = i * 2;
+	check_counters(map);
+	TEST_ASSERT_EQ(map->used, (size_t)count, "Wrong number of elements"
+		TEST_EXPECT_MSG(zu), (size_t)count, map->used);
+	check_all(map, 0, count, 1);
+	// Existing key is not inserted again
+	pair_t* pair = cbuild_map_put(map, 7);
+	TEST_ASSERT_EQ(pair->val, 14, "Wrong value"TEST_EXPECT_MSG(d), 14, pair->val);
+	TEST_ASSERT_EQ(map->used, (size_t)count, "Existing key was inserted"
+		TEST_EXPECT_MSG(zu), (size_t)count, map->used);
+	// Churn, map may grow once, but then number of elements is small enough
+	// for tombstones to be purged in place
+	size_t capacity = 0;
+	for(int round = 0; round < 20; round++) {
+		if(round == 1) capacity = map->capacity;
+		for(int i = 0; i < count; i += 2) {
+			cbuild_map_remove(map, cbuild_map_find(map, round * count + i));
+		}
+		for(int i = 0; i < count; i += 2) {
+			int key = (round + 1) * count + i;
+			cbuild_map_put_new(map, key)->val = key * 2;
+		}
+		for(int i = 1; i < count; i += 2) {
+			int key = round * count + i;
+			pair_t* old = cbuild_map_find(map, key);
+			cbuild_map_remove(map, old);
+			cbuild_map_put(map, key + count)->val = (key + count) * 2;
+		}
+		check_counters(map);
+	}
+	TEST_ASSERT_EQ(map->capacity, capacity, "Map grew during churn"
+		TEST_EXPECT_MSG(zu), capacity, map->capacity);
+	check_all(map, 20 * count, 21 * count, 1);
+	TEST_ASSERT(cbuild_map_find(map, 0) == NULL, "Removed key was found%s", "");
+	// Explicit compaction
+	for(int i = 20 * count; i < 21 * count; i += 3) {
+		cbuild_map_remove(map, cbuild_map_find(map, i));
+	}
+	cbuild_map_compact(map);
+	check_counters(map);
+	TEST_ASSERT_EQ(map->deleted, 0, "Deleted slots left after compaction"
+		TEST_EXPECT_MSG(zu), (size_t)0, map->deleted);
+	for(int i = 20 * count; i < 21 * count; i++) {
+		pair = cbuild_map_find(map, i);
+		if((i - 20 * count) % 3 == 0) {
+			TEST_ASSERT(pair == NULL, "Removed key %d was found", i);
+		} else {
+			TEST_ASSERT(pair != NULL, "Key %d was not found", i);
+			TEST_ASSERT_EQ(pair->val, i * 2, "Wrong value of key %d"
+				TEST_EXPECT_MSG(d), i, i * 2, pair->val);
+		}
+	}
+	cbuild_da_clear(map);
+}
+int main(void) {
+	map_t map = {0};
+	cbuild_map_init_num(&map);
+	run(&map, COUNT);
+	map = (map_t){0};
+	cbuild_map_init_num(&map);
+	map.hash = bad_hash;
+	run(&map, 200);
+	return 0;
+}
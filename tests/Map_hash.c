@@ -0,0 +1,101 @@
+// Reference vectors of wyhash (from its repository) and XXH3 (computed by
+// xxHash 0.8)
+typedef struct str_vec_t {
+	const char* str;
+	uint64_t wyhash; // Seed is an index of a vector
+	uint64_t xxh3;   // Seed is 0
+} str_vec_t;
+const str_vec_t str_vecs[] = {
+	{ "", 0x93228a4de0eec5a2ull, 0x2d06800538d394c2ull },
+	{ "a", 0xc5bac3db178713c4ull, 0xe6c632b61e964e1full },
+	{ "abc", 0xa97f2f7b1d9b3314ull, 0x78af5f94892f3950ull },
+	{ "message digest", 0x786d1f1df3801df4ull, 0x160d8e9329be94f9ull },
+	{ "abcdefghijklmnopqrstuvwxyz", 0xdca5a8138ad37c87ull, 0 },
+};
+// Every length class of XXH3, including several blocks of long input
+typedef struct buf_vec_t {
+	size_t len;
+	uint64_t wyhash;
+	uint64_t wyhash_seed;
+	uint64_t xxh3;
+	uint64_t xxh3_seed;
+} buf_vec_t;
+#define SEED 42
+const buf_vec_t buf_vecs[] = {
+	{    0, 0x93228a4de0eec5a2ull, 0x2ac44db3deb05300ull, 0x2d06800538d394c2ull, 0xb029411ff43d84d2ull },
+	{    1, 0x8e6d4af7d310c8c4ull, 0x033b5aab97d9c425ull, 0xc44bdff4074eecdbull, 0x5cf10f10bf2dd245ull },
+	{    3, 0x57ca40286327d6d8ull, 0x46fda20fbd80d1afull, 0xa1c4a8259b827291ull, 0xcd38fe0f74226819ull },
+	{    4, 0x3e5336585d632a92ull, 0x8c892f648e9315feull, 0xbb4e3d89ee0b271dull, 0x9e3a8a31a4c4fdceull },
+	{    8, 0x27faa98c5716e3c8ull, 0xf083e51c05ec1187ull, 0x79d02238b80e37b1ull, 0x4472add06b15edf7ull },
+	{    9, 0x408759c1cd940b0aull, 0x1bd561a488fcd3a3ull, 0xf64cecc4271ff461ull, 0xf66b88cefb6d5625ull },
+	{   16, 0xc7fabce17f6e3f3aull, 0xb76ff9fa2e2ec351ull, 0x222e9aead6bddd51ull, 0xd1ba1dcda2f6778cull },
+	{   17, 0x52e47ad9b65739b8ull, 0x568e0c5667b735d9ull, 0x47aad6b375eb4bbaull, 0x769e0ffc22b290b3ull },
+	{   64, 0x4ee0ca2168cd8953ull, 0x8ad829f970d9e2d2ull, 0x70a70e66815e67e5ull, 0x5ca1e87b1789279cull },
+	{  128, 0xf1e99e355be0f7b9ull, 0xa2aa9d158e0fb4b3ull, 0x421a9c905c6e66baull, 0x6bfeb1b10c515798ull },
+	{  129, 0xb195cdec0b0110c0ull, 0xfdc601147f460463ull, 0x9e2414800f83768aull, 0x527bdc0b2429724eull },
+	{  240, 0x9835ae20f324ec2full, 0xc339d8d0c1791f59ull, 0xb714c5fd22744964ull, 0x5dc25eadc00a1af8ull },
+	{  241, 0x56172b5e55c90552ull, 0xa7d274156858b2d3ull, 0xbc424a2c480dd281ull, 0x56089514715a4698ull },
+	{ 1024, 0xe2500ac194cc5684ull, 0x2a700bbcb2ce11b0ull, 0x1fd15e7d36f5e1bcull, 0x63fe9bf90b755f7eull },
+	{ 1025, 0x0ba5d1baceb4a39bull, 0xf1f1b109c12dc466ull, 0xfe08e5a874d23fd2ull, 0x5b0a2c6064468fddull },
+	{ 2048, 0x13ca55548e58f847ull, 0xc1ea94fa19809db8ull, 0x81ec4a6a9ee23d55ull, 0x6cc3524995d429e4ull },
+};
+#define BUF_SIZE 2048
+typedef struct pair_t {
+	cbuild_sv_t key;
+	cbuild_map_tombstone_t tombstone;
+} pair_t;
+int main(void) {
+	for(size_t i = 0; i < cbuild_arr_len(str_vecs); i++) {
+		const str_vec_t* vec = &str_vecs[i];
+		size_t len = strlen(vec->str);
+		uint64_t hash = cbuild_map_hash_wyhash_seed(vec->str, len, i);
+		TEST_ASSERT_EQ(hash, vec->wyhash, "Wrong wyhash of \"%s\""TEST_EXPECT_RMSG("0x%016"PRIx64),
+			vec->str, vec->wyhash, hash);
+		if(vec->xxh3 == 0) continue;
+		hash = cbuild_map_hash_xxh3_seed(vec->str, len, 0);
+		TEST_ASSERT_EQ(hash, vec->xxh3, "Wrong XXH3 of \"%s\""TEST_EXPECT_RMSG("0x%016"PRIx64),
+			vec->str, vec->xxh3, hash);
+	}
+	uint8_t* buf = malloc(BUF_SIZE + 1);
+	for(size_t i = 0; i < BUF_SIZE; i++) buf[i] = (uint8_t)(i * 2654435761u >> 13);
+	for(size_t i = 0; i < cbuild_arr_len(buf_vecs); i++) {
+		const buf_vec_t* vec = &buf_vecs[i];
+		uint64_t res[4] = {
+			cbuild_map_hash_wyhash_seed(buf, vec->len, 0),
+			cbuild_map_hash_wyhash_seed(buf, vec->len, SEED),
+			cbuild_map_hash_xxh3_seed(buf, vec->len, 0),
+			cbuild_map_hash_xxh3_seed(buf, vec->len, SEED),
+		};
+		uint64_t expected[4] = { vec->wyhash, vec->wyhash_seed, vec->xxh3, vec->xxh3_seed };
+		const char* names[4] = { "wyhash", "seeded wyhash", "XXH3", "seeded XXH3" };
+		for(size_t j = 0; j < 4; j++) {
+			TEST_ASSERT_EQ(res[j], expected[j], "Wrong %s of %zu bytes"
+				TEST_EXPECT_RMSG("0x%016"PRIx64), names[j], vec->len, expected[j], res[j]);
+		}
+		// Unaligned input
+		memmove(buf + 1, buf, BUF_SIZE);
+		uint64_t hash = cbuild_map_hash_xxh3_seed(buf + 1, vec->len, SEED);
+		memmove(buf, buf + 1, BUF_SIZE);
+		TEST_ASSERT_EQ(hash, vec->xxh3_seed, "Wrong XXH3 of unaligned %zu bytes"
+			TEST_EXPECT_RMSG("0x%016"PRIx64), vec->len, vec->xxh3_seed, hash);
+	}
+	TEST_ASSERT_EQ(cbuild_map_hash_wyhash(buf, 100), cbuild_map_hash_wyhash_seed(buf, 100, 0),
+		"Unseeded wyhash does not use seed 0%s", "");
+	TEST_ASSERT_EQ(cbuild_map_hash_xxh3(buf, 300), cbuild_map_hash_xxh3_seed(buf, 300, 0),
+		"Unseeded XXH3 does not use seed 0%s", "");
+	free(buf);
+	// Default helpers hash content of a string, not its container
+	const char* cstr = "some/path/to/file.c";
+	cbuild_sv_t sv = cbuild_sv_from_cstr(cstr);
+	cbuild_sb_t sb = {0};
+	cbuild_sb_append_cstr(&sb, cstr);
+	size_t expected = CBUILD_MAP_DEFAULT_HASH(cstr, strlen(cstr));
+	TEST_ASSERT_EQ(__cbuild_map_cstr_hash(NULL, &cstr, sizeof(cstr)), expected,
+		"Wrong hash of c-string%s", "");
+	TEST_ASSERT_EQ(__cbuild_map_sv_hash(NULL, &sv, sizeof(sv)), expected,
+		"Wrong hash of string view%s", "");
+	TEST_ASSERT_EQ(__cbuild_map_sb_hash(NULL, &sb, sizeof(sb)), expected,
+		"Wrong hash of string builder%s", "");
+	cbuild_da_clear(&sb);
+	return 0;
+}
@@ -0,0 +1,2 @@
+// Same as Map_hash, but is built with CBUILD_MAP_SIMD=0
+#include "Map_hash.c"
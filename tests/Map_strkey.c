@@ -0,0 +1,92 @@
+typedef struct pair_t {
+	cbuild_map_strkey_t key;
+	size_t val;
+	cbuild_map_tombstone_t tombstone;
+} pair_t;
+typedef struct map_t {
+	pair_t* data;
+	size_t size;
+	size_t capacity;
+	cbuild_map_hash_t hash;
+	cbuild_map_keycmp_t keycmp;
+	size_t used;
+	size_t deleted;
+} map_t;
+typedef struct spair_t {
+	cbuild_map_strkey_t key;
+	size_t val;
+} spair_t;
+typedef struct smap_t {
+	spair_t* data;
+	size_t size;
+	size_t capacity;
+	cbuild_map_hash_t hash;
+	cbuild_map_keycmp_t keycmp;
+	uint8_t* ctrl;
+	size_t deleted;
+} smap_t;
+#define COUNT 3000
+int main(void) {
+	char** paths = malloc(COUNT * sizeof(char*));
+	for(size_t i = 0; i < COUNT; i++) {
+		paths[i] = cbuild_temp_sprintf("src/module%zu/file%zu.c", i % 17, i);
+	}
+	// Key from c-string and from a prefix of longer string are same
+	cbuild_map_strkey_t k1 = cbuild_map_strkey("src/Map.c");
+	cbuild_map_strkey_t k2 = cbuild_map_strkey_sv(cbuild_sv_from_parts("src/Map.c/other", 9));
+	TEST_ASSERT_EQ(k1.size, (size_t)9, "Wrong key length"TEST_EXPECT_MSG(zu), (size_t)9,
+		k1.size);
+	TEST_ASSERT_EQ(k1.hash, k2.hash, "Key hash does not depend only on content%s", "");
+	TEST_ASSERT(__cbuild_map_strkey_keycmp(NULL, &k1, &k2, sizeof(k1)),
+		"Same keys are not equal%s", "");
+	map_t map = {0};
+	cbuild_map_init_strkey(&map);
+	for(size_t i = 0; i < COUNT; i++) {
+		cbuild_map_put(&map, cbuild_map_strkey(paths[i]))->val = i;
+	}
+	TEST_ASSERT_EQ(map.used, (size_t)COUNT, "Wrong number of elements"TEST_EXPECT_MSG(zu),
+		(size_t)COUNT, map.used);
+	// Lookup with a copy of a string, so data pointers differ
+	for(size_t i = 0; i < COUNT; i++) {
+		char* copy = cbuild_temp_sprintf("%s", paths[i]);
+		pair_t* pair = cbuild_map_find(&map, cbuild_map_strkey(copy));
+		TEST_ASSERT(pair != NULL, "Key \"%s\" was not found", copy);
+		TEST_ASSERT_EQ(pair->val, i, "Wrong value of \"%s\""TEST_EXPECT_MSG(zu), copy, i,
+			pair->val);
+	}
+	TEST_ASSERT(cbuild_map_find(&map, cbuild_map_strkey("src/module0/file1.c")) == NULL,
+		"Missing key was found%s", "");
+	// Same hash and length, but different content
+	cbuild_map_strkey_t fake = cbuild_map_strkey(paths[1]);
+	char* other = cbuild_temp_sprintf("%s", paths[1]);
+	other[0] = 'X';
+	fake.data = other;
+	TEST_ASSERT(cbuild_map_find(&map, fake) == NULL, "Key with colliding hash was found%s", "");
+	// Stored hashes are reused by rehash, so key with hash that does not
+	// match its content survives growth
+	cbuild_map_strkey_t odd = cbuild_map_strkey("odd");
+	odd.hash = 12345;
+	cbuild_map_put(&map, odd)->val = COUNT;
+	size_t capacity = map.capacity;
+	for(size_t i = 0; i < COUNT; i++) {
+		cbuild_map_put(&map, cbuild_map_strkey(cbuild_temp_sprintf("more/%zu", i)));
+	}
+	TEST_ASSERT(map.capacity > capacity, "Map did not grow%s", "");
+	pair_t* pair = cbuild_map_find(&map, odd);
+	TEST_ASSERT(pair != NULL && pair->val == COUNT, "Key was lost during rehash%s", "");
+	cbuild_da_clear(&map);
+	// Swiss map
+	smap_t smap = {0};
+	cbuild_map_init_strkey(&smap);
+	for(size_t i = 0; i < COUNT; i++) {
+		cbuild_smap_get(&smap, cbuild_map_strkey(paths[i]))->val = i;
+	}
+	for(size_t i = 0; i < COUNT; i++) {
+		spair_t* spair = cbuild_smap_find(&smap, cbuild_map_strkey(paths[i]));
+		TEST_ASSERT(spair != NULL && spair->val == i, "Key \"%s\" was not found in swiss map",
+			paths[i]);
+	}
+	cbuild_smap_clear(&smap);
+	free(paths);
+	return 0;
+}
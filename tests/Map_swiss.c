@@ -0,0 +1,115 @@
+typedef struct pair_t {
+	int key;
+	int val;
+} pair_t;
+typedef struct map_t {
+	pair_t* data;
+	size_t size;
+	size_t capacity;
+	cbuild_map_hash_t hash;
+	cbuild_map_keycmp_t keycmp;
+	uint8_t* ctrl;
+	size_t deleted;
+} map_t;
+typedef struct str_pair_t {
+	const char* key;
+	size_t val;
+} str_pair_t;
+typedef struct str_map_t {
+	str_pair_t* data;
+	size_t size;
+	size_t capacity;
+	cbuild_map_hash_t hash;
+	cbuild_map_keycmp_t keycmp;
+	uint8_t* ctrl;
+	size_t deleted;
+} str_map_t;
+// Only 4 distinct hashes, so groups overflow and full keys are compared
+size_t bad_hash(const void* map, const void* key, size_t klen) {
+	CBUILD_UNUSED(map);
+	CBUILD_UNUSED(klen);
+	return (size_t)(*(const int*)key & 3);
+}
+#define COUNT 5000
+void check_all(map_t* map, int from, int to, int step) {
+	for(int i = from; i < to; i += step) {
+		pair_t* pair = cbuild_smap_find(map, i);
+		TEST_ASSERT(pair != NULL, "Key %d was not found", i);
+		TEST_ASSERT_EQ(pair->val, i * 2, "Wrong value of key %d"TEST_EXPECT_MSG(d),
+			i, i * 2, pair->val);
+	}
+}
+void run(map_t* map) {
+	TEST_ASSERT(cbuild_smap_find(map, 0) == NULL, "Key was found in empty map%s", "");
+	for(int i = 0; i < COUNT; i++) {
+		bool found = true;
+		pair_t* pair = cbuild_smap_get_ex(map, i, &found);
+		TEST_NASSERT(found, "Key %d was found before insertion", i);
+		pair->val = i * 2;
+	}
+	TEST_ASSERT_EQ(map->size, COUNT, "Wrong size of a map"TEST_EXPECT_MSG(zu),
+		(size_t)COUNT, map->size);
+	TEST_ASSERT(map->size <= map->capacity / 8 * 7, "Map is overloaded%s", "");
+	check_all(map, 0, COUNT, 1);
+	TEST_ASSERT(cbuild_smap_find(map, COUNT) == NULL, "Missing key was found%s", "");
+	bool found = false;
+	pair_t* pair = cbuild_smap_get_ex(map, 7, &found);
+	TEST_ASSERT(found, "Existing key was not found%s", "");
+	TEST_ASSERT_EQ(pair->val, 14, "Wrong value"TEST_EXPECT_MSG(d), 14, pair->val);
+	// Remove odd keys
+	for(int i = 1; i < COUNT; i += 2) {
+		pair = cbuild_smap_find(map, i);
+		cbuild_smap_remove(map, pair);
+	}
+	TEST_ASSERT_EQ(map->size, COUNT / 2, "Wrong size after removal"TEST_EXPECT_MSG(zu),
+		(size_t)COUNT / 2, map->size);
+	for(int i = 1; i < COUNT; i += 2) {
+		TEST_ASSERT(cbuild_smap_find(map, i) == NULL, "Removed key %d was found", i);
+	}
+	check_all(map, 0, COUNT, 2);
+	// Churn reuses deleted slots without growing
+	size_t capacity = map->capacity;
+	for(int round = 0; round < 20; round++) {
+		for(int i = COUNT; i < COUNT + COUNT / 4; i++) cbuild_smap_get(map, i)->val = i * 2;
+		for(int i = COUNT; i < COUNT + COUNT / 4; i++) {
+			cbuild_smap_remove(map, cbuild_smap_find(map, i));
+		}
+	}
+	TEST_ASSERT_EQ(map->capacity, capacity, "Map grew during churn"TEST_EXPECT_MSG(zu),
+		capacity, map->capacity);
+	check_all(map, 0, COUNT, 2);
+	size_t count = 0;
+	cbuild_smap_foreach(map, iter) {
+		TEST_ASSERT(iter->key % 2 == 0, "Removed key %d was iterated", iter->key);
+		count++;
+	}
+	TEST_ASSERT_EQ(count, map->size, "Wrong number of iterated elements"
+		TEST_EXPECT_MSG(zu), map->size, count);
+	cbuild_smap_clear(map);
+}
+int main(void) {
+	map_t map = {0};
+	cbuild_map_init_num(&map);
+	run(&map);
+	map.hash = bad_hash;
+	run(&map);
+	cbuild_smap_reserve(&map, 1000);
+	size_t capacity = map.capacity;
+	for(int i = 0; i < 1000; i++) cbuild_smap_get(&map, i)->val = i * 2;
+	TEST_ASSERT_EQ(map.capacity, capacity, "Reserved map grew"TEST_EXPECT_MSG(zu),
+		capacity, map.capacity);
+	cbuild_smap_clear(&map);
+	// String keys are compared by content
+	str_map_t smap = {0};
+	cbuild_map_init_cstr(&smap);
+	char key1[] = "key";
+	char key2[] = "key";
+	cbuild_smap_get(&smap, key1)->val = 1;
+	str_pair_t* elem = cbuild_smap_find(&smap, (const char*)key2);
+	TEST_ASSERT(elem != NULL, "Key with same content was not found%s", "");
+	TEST_ASSERT_EQ(elem->val, 1, "Wrong value was found"TEST_EXPECT_MSG(zu),
+		(size_t)1, elem->val);
+	TEST_ASSERT(cbuild_smap_find(&smap, "other") == NULL, "Missing key was found%s", "");
+	cbuild_smap_clear(&smap);
+	return 0;
+}
@@ -0,0 +1,2 @@
+// Same as Map_swiss, but is built with CBUILD_MAP_SIMD=0
+#include "Map_swiss.c"
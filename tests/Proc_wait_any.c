@@ -0,0 +1,41 @@
+int child(void* context) {
+	struct timespec duration = {
+		.tv_sec = 0,
+		.tv_nsec = (long)(size_t)context * 100000000l,
+	};
+	nanosleep(&duration, NULL);
+	return (int)(size_t)context;
+}
+void wait_all(bool ignored) {
+	cbuild_proclist_t procs = {0};
+	for(size_t i = 1; i <= 4; i++) {
+		cbuild_da_append(&procs, cbuild_proc_start(child, (void*)(5 - i)));
+	}
+	size_t count = procs.size;
+	for(size_t i = 0; i < count; i++) {
+		int code = 0;
+		size_t idx = cbuild_procs_wait_any(procs, &code);
+		TEST_ASSERT(idx < procs.size, "Wrong index %zu of exited process.", idx);
+		if(ignored) {
+			TEST_ASSERT_EQ(code, INT_MAX, "Wrong code of reaped process"TEST_EXPECT_MSG(d),
+				INT_MAX, code);
+		} else {
+			TEST_ASSERT(code >= 1 && code <= 4, "Wrong exit code %d.", code);
+		}
+		cbuild_da_remove_unordered(&procs, idx);
+	}
+	cbuild_da_clear(&procs);
+}
+int main(void) {
+	// Ignored SIGCHLD should stay ignored
+	signal(SIGCHLD, SIG_IGN);
+	wait_all(true);
+	struct sigaction sa;
+	sigaction(SIGCHLD, NULL, &sa);
+	TEST_ASSERT(sa.sa_handler == SIG_IGN, "SIGCHLD disposition was changed.");
+	signal(SIGCHLD, SIG_DFL);
+	// Each list is waited several times
+	wait_all(false);
+	wait_all(false);
+	return 0;
+}
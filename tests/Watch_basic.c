@@ -0,0 +1,74 @@
+bool contains(cbuild_pathlist_t* list, const char* path) {
+	cbuild_span_foreach(list, elem) {
+		if(strcmp(*elem, path) == 0) return true;
+	}
+	return false;
+}
+void check(cbuild_pathlist_t* changed, const char** expected, size_t count) {
+	TEST_ASSERT_EQ(changed->size, count, "Wrong number of changed paths"
+		TEST_EXPECT_MSG(zu), count, changed->size);
+	for(size_t i = 0; i < count; i++) {
+		TEST_ASSERT_STREQ(changed->data[i], expected[i], "Wrong changed path"
+			TEST_EXPECT_MSG(s), expected[i], changed->data[i]);
+	}
+}
+bool stop(cbuild_pathlist_t* changed, void* context) {
+	*(size_t*)context = changed->size;
+	return false;
+}
+void run(const char* dir, bool poll) {
+	cbuild_watch_t watch = { .debounce = 20, .interval = 20, .poll = poll };
+	const char* a = cbuild_temp_sprintf("%s/a", dir);
+	const char* sub = cbuild_temp_sprintf("%s/sub", dir);
+	const char* b = cbuild_temp_sprintf("%s/sub/b", dir);
+	test_write_str(a, "A");
+	TEST_ASSERT(cbuild_watch_add(&watch, dir), "Could not watch \"%s\"", dir);
+	if(poll) TEST_NASSERT(watch.__inotify, "Polling watcher uses inotify%s", "");
+	cbuild_pathlist_t changed = {0};
+	TEST_ASSERT(cbuild_watch_wait(&watch, &changed, 0), "Wait failed%s", "");
+	TEST_ASSERT_EQ(changed.size, 0, "Changes reported without changes"
+		TEST_EXPECT_MSG(zu), (size_t)0, changed.size);
+	// Changes are coalesced, new directory is reported together with its content
+	test_write_str(a, "AAAA");
+	cbuild_dir_create(sub);
+	test_write_str(b, "B");
+	TEST_ASSERT(cbuild_watch_wait(&watch, &changed, 5000), "Wait failed%s", "");
+	check(&changed, (const char*[]){ a, sub, b }, 3);
+	// Files inside new directory are watched
+	test_write_str(b, "BB");
+	TEST_ASSERT(cbuild_watch_wait(&watch, &changed, 5000), "Wait failed%s", "");
+	check(&changed, (const char*[]){ b }, 1);
+	cbuild_file_remove(a);
+	TEST_ASSERT(cbuild_watch_wait(&watch, &changed, 5000), "Wait failed%s", "");
+	check(&changed, (const char*[]){ a }, 1);
+	// Moved directory is watched under its new path
+	const char* moved = cbuild_temp_sprintf("%s/moved", dir);
+	const char* moved_b = cbuild_temp_sprintf("%s/moved/b", dir);
+	TEST_ASSERT(rename(sub, moved) == 0, "Could not rename \"%s\"", sub);
+	TEST_ASSERT(cbuild_watch_wait(&watch, &changed, 5000), "Wait failed%s", "");
+	TEST_ASSERT(contains(&changed, sub), "\"%s\" was not reported", sub);
+	TEST_ASSERT(contains(&changed, moved), "\"%s\" was not reported", moved);
+	TEST_ASSERT(contains(&changed, moved_b), "\"%s\" was not reported", moved_b);
+	test_write_str(moved_b, "BBB");
+	TEST_ASSERT(cbuild_watch_wait(&watch, &changed, 5000), "Wait failed%s", "");
+	check(&changed, (const char*[]){ moved_b }, 1);
+	// Callback loop
+	test_write_str(a, "A");
+	size_t count = 0;
+	TEST_ASSERT(cbuild_watch_run(&watch, stop, &count), "Watch loop failed%s", "");
+	TEST_ASSERT_EQ(count, 1, "Wrong number of changed paths"TEST_EXPECT_MSG(zu),
+		(size_t)1, count);
+	cbuild_pathlist_clear(&changed);
+	cbuild_watch_free(&watch);
+}
+int main(void) {
+	const char* dir = TEST_TEMP_FILE_EX("watch");
+	if(cbuild_dir_check(dir)) cbuild_dir_remove(dir);
+	cbuild_dir_create(dir);
+	run(dir, false);
+	cbuild_dir_remove(dir);
+	cbuild_dir_create(dir);
+	run(dir, true);
+	cbuild_dir_remove(dir);
+	return 0;
+}
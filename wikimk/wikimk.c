@@ -578,10 +578,9 @@ typedef struct {
 } comments_t;
 // Parse and extract comments out of file
 // NOTE: This assumes one space between comment starter and comment body
-bool docgen_parse_file(const char* src_, void** file, comments_t* comments, lines_t* lines) {
-	cbuild_sb_t src_sb = {0};
-	if (!cbuild_file_read(src_, &src_sb)) return false;
-	cbuild_sv_t src = cbuild_sb_to_sv(src_sb);
+bool docgen_parse_file(const char* src_, cbuild_file_map_t* file, comments_t* comments, lines_t* lines) {
+	if (!cbuild_file_map(src_, file)) return false;
+	cbuild_sv_t src = file->content;
 	size_t lnum = 1;
 	comment_t curr = {0};
 	while (src.size > 0) {
@@ -625,7 +624,6 @@ bool docgen_parse_file(const char* src_, void** file, comments_t* comments, line
 		}
 		lnum++;
 	}
-	*file = src_sb.data;
 	return true;
 }
 bool md_dsl_arg_delim(const cbuild_sv_t* sv, size_t idx, void* args) {
@@ -921,7 +919,7 @@ bool docgen_process_file(const char* src, const char* output, symbols_t* symbol_
 	comments_t comments = {0};
 	lines_t lines = {0};
 	cbuild_sb_t dst = {0};
-	void* file_content = NULL;
+	cbuild_file_map_t file_content = {0};
 	if (!docgen_parse_file(src, &file_content, &comments, &lines)) return false;
 	cbuild_sb_appendf(&dst, "---\n");
 	cbuild_sb_appendf(&dst, "title: %s\n", cbuild_path_name(src));
@@ -954,7 +952,7 @@ bool docgen_process_file(const char* src, const char* output, symbols_t* symbol_
 	}
 	cbuild_da_clear(&comments);
 	cbuild_da_clear(&lines);
-	free(file_content);
+	cbuild_file_unmap(&file_content);
 	return true;
 }
 // NOTE: This uses rather crude check for extension.